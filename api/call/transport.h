@@ -14,6 +14,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "rtc_base/copyonwritebuffer.h"
+
 namespace webrtc {
 
 // TODO(holmer): Look into unifying this with the PacketOptions in
@@ -29,6 +31,14 @@ class Transport {
   virtual bool SendRtp(const uint8_t* packet,
                        size_t length,
                        const PacketOptions& options) = 0;
+  // Same as SendRtp(), for a packet that is already held in a reference
+  // counted buffer. Transports that need to keep the packet, e.g. to send it
+  // from another thread, can share |packet| instead of copying it. Spare
+  // capacity in |packet| may be used to protect it in place.
+  virtual bool SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                             const PacketOptions& options) {
+    return SendRtp(packet.cdata(), packet.size(), options);
+  }
   virtual bool SendRtcp(const uint8_t* packet, size_t length) = 0;
 
  protected:
@@ -31,6 +31,7 @@
 namespace webrtc {
 
 class AudioProcessing;
+class ProcessThreadPool;
 class RtcEventLog;
 
 enum class MediaType {
@@ -112,6 +113,11 @@ class Call {
     // RtcEventLog to use for this call. Required.
     // Use webrtc::RtcEventLog::CreateNull() for a null implementation.
     RtcEventLog* event_log = nullptr;
+
+    // If set, the pacer runs on a worker of this pool instead of on a thread
+    // of its own, so that many calls can share a few pacing threads. Must
+    // outlive the call.
+    ProcessThreadPool* pacer_thread_pool = nullptr;
   };
 
   struct Stats {
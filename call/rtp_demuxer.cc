@@ -10,6 +10,8 @@
 
 #include "call/rtp_demuxer.h"
 
+#include <algorithm>
+
 #include "call/rtp_packet_sink_interface.h"
 #include "call/rtp_rtcp_demuxer_helper.h"
 #include "call/ssrc_binding_observer.h"
@@ -19,6 +21,20 @@
 #include "rtc_base/logging.h"
 
 namespace webrtc {
+namespace {
+
+bool RawExtensionEquals(const std::string& cached,
+                        rtc::ArrayView<const uint8_t> raw) {
+  return cached.size() == raw.size() &&
+         std::equal(raw.begin(), raw.end(),
+                    reinterpret_cast<const uint8_t*>(cached.data()));
+}
+
+std::string RawExtensionToString(rtc::ArrayView<const uint8_t> raw) {
+  return std::string(reinterpret_cast<const char*>(raw.data()), raw.size());
+}
+
+}  // namespace
 
 RtpDemuxerCriteria::RtpDemuxerCriteria() = default;
 RtpDemuxerCriteria::~RtpDemuxerCriteria() = default;
@@ -71,6 +87,7 @@ bool RtpDemuxer::AddSink(const RtpDemuxerCriteria& criteria,
   }
 
   RefreshKnownMids();
+  resolved_sink_by_ssrc_.clear();
 
   return true;
 }
@@ -148,6 +165,7 @@ bool RtpDemuxer::RemoveSink(const RtpPacketSinkInterface* sink) {
                        RemoveFromMapByValue(&sink_by_mid_and_rsid_, sink) +
                        RemoveFromMapByValue(&sink_by_rsid_, sink);
   RefreshKnownMids();
+  resolved_sink_by_ssrc_.clear();
   return num_removed > 0;
 }
 
@@ -162,6 +180,49 @@ bool RtpDemuxer::OnRtpPacket(const RtpPacketReceived& packet) {
 
 RtpPacketSinkInterface* RtpDemuxer::ResolveSink(
     const RtpPacketReceived& packet) {
+  const uint32_t ssrc = packet.Ssrc();
+  const rtc::ArrayView<const uint8_t> raw_mid =
+      packet.GetRawExtension<RtpMid>();
+  const rtc::ArrayView<const uint8_t> raw_rsid =
+      packet.GetRawExtension<RtpStreamId>();
+  const rtc::ArrayView<const uint8_t> raw_rrid =
+      packet.GetRawExtension<RepairedRtpStreamId>();
+
+  ResolvedSink* resolved = resolved_sink_by_ssrc_.Find(ssrc);
+  if (resolved != nullptr && RawExtensionEquals(resolved->raw_mid, raw_mid) &&
+      RawExtensionEquals(resolved->raw_rsid, raw_rsid) &&
+      RawExtensionEquals(resolved->raw_rrid, raw_rrid)) {
+    return resolved->sink;
+  }
+
+  RtpPacketSinkInterface* sink = ResolveSinkSlow(packet);
+
+  // The slow path may have latched new IDs for the SSRC, so the previous
+  // result is replaced or dropped. A result is only kept if the SSRC ended up
+  // bound to the sink; otherwise it may have been chosen by payload type.
+  const auto ssrc_sink_it = sink_by_ssrc_.find(ssrc);
+  if (sink == nullptr || ssrc_sink_it == sink_by_ssrc_.end() ||
+      ssrc_sink_it->second != sink) {
+    if (resolved != nullptr) {
+      resolved_sink_by_ssrc_.Erase(ssrc);
+    }
+    return sink;
+  }
+  if (resolved == nullptr) {
+    if (resolved_sink_by_ssrc_.size() >= kMaxSsrcBindings) {
+      return sink;
+    }
+    resolved = resolved_sink_by_ssrc_.Insert(ssrc, ResolvedSink()).first;
+  }
+  resolved->sink = sink;
+  resolved->raw_mid = RawExtensionToString(raw_mid);
+  resolved->raw_rsid = RawExtensionToString(raw_rsid);
+  resolved->raw_rrid = RawExtensionToString(raw_rrid);
+  return sink;
+}
+
+RtpPacketSinkInterface* RtpDemuxer::ResolveSinkSlow(
+    const RtpPacketReceived& packet) {
   // See the BUNDLE spec for high level reference to this algorithm:
   // https://tools.ietf.org/html/draft-ietf-mmusic-sdp-bundle-negotiation-38#section-10.2
 
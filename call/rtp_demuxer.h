@@ -17,6 +17,8 @@
 #include <utility>
 #include <vector>
 
+#include "rtc_base/flat_hash_map.h"
+
 namespace webrtc {
 
 class RtpPacketReceived;
@@ -81,6 +83,12 @@ struct RtpDemuxerCriteria {
 // In summary, the routing algorithm will always try to first match MID and RSID
 // (including through SSRC binding), match SSRC directly as needed, and use
 // payload types only if all else fails.
+//
+// Once a packet has been routed to the sink its SSRC is bound to, the result is
+// remembered together with the packet's raw MID, RSID and RRID extensions.
+// Later packets on that SSRC carrying byte-identical extensions are forwarded
+// to the same sink without running the algorithm again, since it would reach
+// the same decision. Adding or removing a sink forgets all such results.
 class RtpDemuxer {
  public:
   // Maximum number of unique SSRC bindings allowed. This limit is to prevent
@@ -148,6 +156,10 @@ class RtpDemuxer {
   // If the packet should be dropped, this method returns null.
   RtpPacketSinkInterface* ResolveSink(const RtpPacketReceived& packet);
 
+  // Runs the full demux algorithm; ResolveSink only skips it for packets that
+  // match an entry in |resolved_sink_by_ssrc_|.
+  RtpPacketSinkInterface* ResolveSinkSlow(const RtpPacketReceived& packet);
+
   // Used by the ResolveSink algorithm.
   RtpPacketSinkInterface* ResolveSinkByMid(const std::string& mid,
                                            uint32_t ssrc);
@@ -194,6 +206,18 @@ class RtpDemuxer {
   // sink. Returns false if the binding was unchanged.
   bool AddSsrcSinkBinding(uint32_t ssrc, RtpPacketSinkInterface* sink);
 
+  // The routing decision of the last packet on each SSRC, along with the raw
+  // header extensions it was based on. Only decisions that forwarded the packet
+  // to the sink bound to its SSRC are kept, which makes them independent of
+  // anything but the extensions and the sink mappings.
+  struct ResolvedSink {
+    RtpPacketSinkInterface* sink = nullptr;
+    std::string raw_mid;
+    std::string raw_rsid;
+    std::string raw_rrid;
+  };
+  rtc::FlatHashMap<uint32_t, ResolvedSink> resolved_sink_by_ssrc_;
+
   // Observers which will be notified when an RSID association to an SSRC is
   // resolved by this object.
   std::vector<SsrcBindingObserver*> ssrc_binding_observers_;
@@ -13,6 +13,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "call/ssrc_binding_observer.h"
 #include "call/test/mock_rtp_packet_sink_interface.h"
@@ -23,8 +24,12 @@
 #include "rtc_base/arraysize.h"
 #include "rtc_base/basictypes.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
 #include "rtc_base/ptr_util.h"
+#include "rtc_base/random.h"
 #include "rtc_base/safe_conversions.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/timeutils.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
@@ -1479,6 +1484,77 @@ TEST_F(RtpDemuxerTest, MaliciousPeerCannotCauseMemoryOveruse) {
   }
 }
 
+TEST_F(RtpDemuxerTest, BoundSsrcStillFollowsChangedMid) {
+  const std::string mid1 = "v";
+  const std::string mid2 = "a";
+  constexpr uint32_t ssrc = 10;
+
+  MockRtpPacketSink sink1;
+  AddSinkOnlyMid(mid1, &sink1);
+  MockRtpPacketSink sink2;
+  AddSinkOnlyMid(mid2, &sink2);
+
+  auto p1 = CreatePacketWithSsrcMid(ssrc, mid1);
+  auto p2 = CreatePacketWithSsrcMid(ssrc, mid1);
+  EXPECT_CALL(sink1, OnRtpPacket(_)).Times(2);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*p1));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*p2));
+
+  // An unknown MID is dropped even though the SSRC is bound.
+  auto p3 = CreatePacketWithSsrcMid(ssrc, "x");
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*p3));
+
+  auto p4 = CreatePacketWithSsrcMid(ssrc, mid2);
+  auto p5 = CreatePacketWithSsrc(ssrc);
+  EXPECT_CALL(sink2, OnRtpPacket(_)).Times(2);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*p4));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*p5));
+}
+
+class CountingSink : public RtpPacketSinkInterface {
+ public:
+  void OnRtpPacket(const RtpPacketReceived& packet) override { ++packets_; }
+  int packets() const { return packets_; }
+
+ private:
+  int packets_ = 0;
+};
+
+// Demuxes packets from many bundled streams in random order, once with the
+// MID header extension on every packet and once with SSRC-only packets.
+TEST_F(RtpDemuxerTest, DISABLED_DemuxPerformance) {
+  const int kNumStreams = 500;
+  const int kNumPackets = 1000000;
+  const uint32_t kFirstSsrc = 1000;
+  std::vector<CountingSink> sinks(kNumStreams);
+  std::vector<std::unique_ptr<RtpPacketReceived>> packets_with_mid;
+  std::vector<std::unique_ptr<RtpPacketReceived>> packets_without_mid;
+  for (int i = 0; i < kNumStreams; ++i) {
+    const std::string mid = rtc::ToString(i);
+    ASSERT_TRUE(AddSinkOnlyMid(mid, &sinks[i]));
+    packets_with_mid.push_back(CreatePacketWithSsrcMid(kFirstSsrc + i, mid));
+    packets_without_mid.push_back(CreatePacketWithSsrc(kFirstSsrc + i));
+  }
+  Random random(4711);
+  std::vector<int> order(kNumPackets);
+  for (int& index : order)
+    index = random.Rand(kNumStreams - 1);
+
+  for (const auto* packets : {&packets_with_mid, &packets_without_mid}) {
+    int64_t start_ns = rtc::TimeNanos();
+    int routed = 0;
+    for (int index : order)
+      routed += demuxer_.OnRtpPacket(*(*packets)[index]);
+    int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+    EXPECT_EQ(kNumPackets, routed);
+    LOG(LS_INFO) << (packets == &packets_with_mid ? "With" : "Without")
+                 << " MID: " << routed << " packets demuxed across "
+                 << kNumStreams << " SSRCs in "
+                 << elapsed_ns / rtc::kNumNanosecsPerMillisec << " ms, "
+                 << elapsed_ns / kNumPackets << " ns per packet.";
+  }
+}
+
 #if RTC_DCHECK_IS_ON && GTEST_HAS_DEATH_TEST && !defined(WEBRTC_ANDROID)
 
 TEST_F(RtpDemuxerTest, CriteriaMustBeNonEmpty) {
@@ -10,6 +10,8 @@
 
 #include "common_video/include/i420_buffer_pool.h"
 
+#include <utility>
+
 #include "rtc_base/checks.h"
 
 namespace webrtc {
@@ -19,6 +21,14 @@ I420BufferPool::I420BufferPool(bool zero_initialize,
     : zero_initialize_(zero_initialize),
       max_number_of_buffers_(max_number_of_buffers) {}
 
+I420BufferPool::I420BufferPool(
+    rtc::scoped_refptr<SharedI420BufferPool> shared_pool)
+    : zero_initialize_(false),
+      max_number_of_buffers_(std::numeric_limits<size_t>::max()),
+      shared_pool_(std::move(shared_pool)) {
+  RTC_DCHECK(shared_pool_);
+}
+
 void I420BufferPool::Release() {
   buffers_.clear();
 }
@@ -26,6 +36,8 @@ void I420BufferPool::Release() {
 rtc::scoped_refptr<I420Buffer> I420BufferPool::CreateBuffer(int width,
                                                             int height) {
   RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  if (shared_pool_)
+    return shared_pool_->CreateBuffer(width, height);
   // Release buffers with wrong resolution.
   for (auto it = buffers_.begin(); it != buffers_.end();) {
     if ((*it)->width() != width || (*it)->height() != height)
@@ -8,6 +8,7 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <limits>
 #include <string>
 
 #include "common_video/include/i420_buffer_pool.h"
@@ -70,4 +71,20 @@ TEST(TestI420BufferPool, MaxNumberOfBuffers) {
   EXPECT_EQ(nullptr, pool.CreateBuffer(16, 16).get());
 }
 
+TEST(TestI420BufferPool, ReusesBuffersOfOtherPoolsThroughSharedPool) {
+  rtc::scoped_refptr<SharedI420BufferPool> shared_pool =
+      SharedI420BufferPool::Create(std::numeric_limits<size_t>::max(), false);
+  I420BufferPool pool1(shared_pool);
+  I420BufferPool pool2(shared_pool);
+  rtc::scoped_refptr<I420BufferInterface> buffer = pool1.CreateBuffer(16, 16);
+  const uint8_t* y_ptr = buffer->DataY();
+  buffer = nullptr;
+  // A switch to another resolution doesn't drop the buffer.
+  EXPECT_NE(y_ptr, pool1.CreateBuffer(32, 16)->DataY());
+
+  buffer = pool2.CreateBuffer(16, 16);
+  EXPECT_EQ(y_ptr, buffer->DataY());
+  EXPECT_EQ(1u, shared_pool->GetStats().buffers_in_use);
+}
+
 }  // namespace webrtc
@@ -15,6 +15,7 @@
 #include <limits>
 
 #include "api/video/i420_buffer.h"
+#include "common_video/include/shared_i420_buffer_pool.h"
 #include "rtc_base/race_checker.h"
 #include "rtc_base/refcountedobject.h"
 
@@ -34,6 +35,12 @@ class I420BufferPool {
   explicit I420BufferPool(bool zero_initialize)
       : I420BufferPool(zero_initialize, std::numeric_limits<size_t>::max()) {}
   I420BufferPool(bool zero_initialze, size_t max_number_of_buffers);
+  // Takes the buffers from |shared_pool| instead, so that their memory is
+  // reused by all users of |shared_pool|, at any resolution. The shared pool
+  // decides whether new buffers are zero-initialized, and the number of
+  // buffers is not limited.
+  explicit I420BufferPool(
+      rtc::scoped_refptr<SharedI420BufferPool> shared_pool);
 
   // Returns a buffer from the pool. If no suitable buffer exist in the pool
   // and there are less than |max_number_of_buffers| pending, a buffer is
@@ -58,6 +65,8 @@ class I420BufferPool {
   const bool zero_initialize_;
   // Max number of buffers this pool can have pending.
   const size_t max_number_of_buffers_;
+  // If set, buffers come from here and |buffers_| is not used.
+  const rtc::scoped_refptr<SharedI420BufferPool> shared_pool_;
 };
 
 }  // namespace webrtc
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_VIDEO_INCLUDE_SHARED_I420_BUFFER_POOL_H_
+#define COMMON_VIDEO_INCLUDE_SHARED_I420_BUFFER_POOL_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/flat_hash_map.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/scoped_ref_ptr.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Thread safe pool of I420Buffers that can be shared by any number of decoders
+// and scalers in a process, of any resolutions. Unlike I420BufferPool, a
+// buffer is put back in the pool by its own Release() when the last reference
+// to it goes away, so CreateBuffer never has to search for a free buffer. Free
+// buffers are kept in one list per resolution.
+//
+// At most |max_pooled_bytes| are kept in free buffers. When a returned buffer
+// would exceed that, free buffers of the resolution that was least recently
+// asked for are deleted first. Buffers that are in use are not limited.
+//
+// The pool stays alive as long as any of its buffers are in use. Decoders use
+// it through an I420BufferPool constructed with the shared pool.
+class SharedI420BufferPool : public rtc::RefCountInterface {
+ public:
+  struct Stats {
+    // Number of CreateBuffer calls that reused a free buffer, and that had to
+    // allocate a new one.
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t buffers_in_use = 0;
+    size_t bytes_in_use = 0;
+    size_t buffers_pooled = 0;
+    size_t bytes_pooled = 0;
+  };
+
+  // If |zero_initialize| is true, newly allocated buffers are zero-initialized,
+  // as I420BufferPool does for FFmpeg. Recycled buffers are not.
+  static rtc::scoped_refptr<SharedI420BufferPool> Create(
+      size_t max_pooled_bytes,
+      bool zero_initialize);
+
+  // Returns a free buffer of the given resolution, or allocates a new one.
+  rtc::scoped_refptr<I420Buffer> CreateBuffer(int width, int height);
+
+  // Changes the limit on free buffers, deleting buffers if needed.
+  void SetMaxPooledBytes(size_t max_pooled_bytes);
+
+  // Deletes all free buffers.
+  void Trim();
+
+  Stats GetStats() const;
+
+ protected:
+  SharedI420BufferPool(size_t max_pooled_bytes, bool zero_initialize);
+  ~SharedI420BufferPool() override;
+
+ private:
+  class PooledBuffer;
+
+  struct Resolution {
+    Resolution(int width, int height);
+
+    int width;
+    int height;
+    // Value of |use_counter_| when a buffer of this resolution was last asked
+    // for.
+    uint64_t last_used = 0;
+    std::vector<PooledBuffer*> free_buffers;
+  };
+
+  // Called by PooledBuffer::Release() when the last reference is gone.
+  void ReturnBuffer(PooledBuffer* buffer);
+
+  // Deletes free buffers until at most |max_bytes| are pooled.
+  void TrimTo(size_t max_bytes) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  const bool zero_initialize_;
+
+  rtc::CriticalSection crit_;
+  size_t max_pooled_bytes_ RTC_GUARDED_BY(crit_);
+  uint64_t use_counter_ RTC_GUARDED_BY(crit_) = 0;
+  Stats stats_ RTC_GUARDED_BY(crit_);
+  // Every resolution asked for so far. Entries are never removed, since
+  // buffers refer to their resolution by index.
+  std::vector<Resolution> resolutions_ RTC_GUARDED_BY(crit_);
+  // Index into |resolutions_|, keyed by width and height.
+  rtc::FlatHashMap<uint64_t, size_t> resolution_index_ RTC_GUARDED_BY(crit_);
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_VIDEO_INCLUDE_SHARED_I420_BUFFER_POOL_H_
@@ -0,0 +1,179 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/include/shared_i420_buffer_pool.h"
+
+#include <utility>
+
+#include "rtc_base/atomicops.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/refcountedobject.h"
+
+namespace webrtc {
+
+namespace {
+
+uint64_t ResolutionKey(int width, int height) {
+  return (static_cast<uint64_t>(width) << 32) | static_cast<uint32_t>(height);
+}
+
+// Same layout as I420Buffer::Create(width, height).
+size_t BufferSize(int width, int height) {
+  const size_t chroma_width = (width + 1) / 2;
+  const size_t chroma_height = (height + 1) / 2;
+  return static_cast<size_t>(width) * height +
+         2 * chroma_width * chroma_height;
+}
+
+}  // namespace
+
+// An I420Buffer that goes back to its pool instead of being deleted when the
+// last reference is released. While it is in use it keeps the pool alive.
+class SharedI420BufferPool::PooledBuffer : public I420Buffer {
+ public:
+  PooledBuffer(int width, int height, size_t resolution_index)
+      : I420Buffer(width, height), resolution_index_(resolution_index) {}
+  ~PooledBuffer() override {}
+
+  size_t resolution_index() const { return resolution_index_; }
+  void set_pool(SharedI420BufferPool* pool) { pool_ = pool; }
+
+  int AddRef() const override { return rtc::AtomicOps::Increment(&ref_count_); }
+
+  int Release() const override {
+    int count = rtc::AtomicOps::Decrement(&ref_count_);
+    if (!count) {
+      // The pool may delete this buffer, and it may itself be deleted when
+      // |pool| goes out of scope.
+      rtc::scoped_refptr<SharedI420BufferPool> pool = std::move(pool_);
+      pool->ReturnBuffer(const_cast<PooledBuffer*>(this));
+    }
+    return count;
+  }
+
+ private:
+  // Index of the buffer's resolution in |resolutions_| of the pool.
+  const size_t resolution_index_;
+  mutable volatile int ref_count_ = 0;
+  mutable rtc::scoped_refptr<SharedI420BufferPool> pool_;
+};
+
+SharedI420BufferPool::Resolution::Resolution(int width, int height)
+    : width(width), height(height) {}
+
+rtc::scoped_refptr<SharedI420BufferPool> SharedI420BufferPool::Create(
+    size_t max_pooled_bytes,
+    bool zero_initialize) {
+  return new rtc::RefCountedObject<SharedI420BufferPool>(max_pooled_bytes,
+                                                         zero_initialize);
+}
+
+SharedI420BufferPool::SharedI420BufferPool(size_t max_pooled_bytes,
+                                           bool zero_initialize)
+    : zero_initialize_(zero_initialize), max_pooled_bytes_(max_pooled_bytes) {}
+
+SharedI420BufferPool::~SharedI420BufferPool() {
+  // Buffers in use hold a reference to the pool, so all are free by now.
+  RTC_DCHECK_EQ(0, stats_.buffers_in_use);
+  for (Resolution& resolution : resolutions_) {
+    for (PooledBuffer* buffer : resolution.free_buffers)
+      delete buffer;
+  }
+}
+
+rtc::scoped_refptr<I420Buffer> SharedI420BufferPool::CreateBuffer(int width,
+                                                                  int height) {
+  const size_t size = BufferSize(width, height);
+  PooledBuffer* buffer = nullptr;
+  size_t index;
+  {
+    rtc::CritScope lock(&crit_);
+    auto inserted = resolution_index_.Insert(ResolutionKey(width, height),
+                                             resolutions_.size());
+    if (inserted.second)
+      resolutions_.emplace_back(width, height);
+    index = *inserted.first;
+    Resolution& resolution = resolutions_[index];
+    resolution.last_used = ++use_counter_;
+    if (!resolution.free_buffers.empty()) {
+      buffer = resolution.free_buffers.back();
+      resolution.free_buffers.pop_back();
+      --stats_.buffers_pooled;
+      stats_.bytes_pooled -= size;
+    }
+    if (buffer) {
+      ++stats_.hits;
+    } else {
+      ++stats_.misses;
+    }
+    ++stats_.buffers_in_use;
+    stats_.bytes_in_use += size;
+  }
+
+  // Allocate outside of the lock, since other threads may be returning
+  // buffers meanwhile.
+  if (!buffer) {
+    buffer = new PooledBuffer(width, height, index);
+    if (zero_initialize_)
+      buffer->InitializeData();
+  }
+  buffer->set_pool(this);
+  return buffer;
+}
+
+void SharedI420BufferPool::ReturnBuffer(PooledBuffer* buffer) {
+  const size_t size = BufferSize(buffer->width(), buffer->height());
+  rtc::CritScope lock(&crit_);
+  RTC_DCHECK_GT(stats_.buffers_in_use, 0);
+  --stats_.buffers_in_use;
+  stats_.bytes_in_use -= size;
+  resolutions_[buffer->resolution_index()].free_buffers.push_back(buffer);
+  ++stats_.buffers_pooled;
+  stats_.bytes_pooled += size;
+  TrimTo(max_pooled_bytes_);
+}
+
+void SharedI420BufferPool::SetMaxPooledBytes(size_t max_pooled_bytes) {
+  rtc::CritScope lock(&crit_);
+  max_pooled_bytes_ = max_pooled_bytes;
+  TrimTo(max_pooled_bytes_);
+}
+
+void SharedI420BufferPool::Trim() {
+  rtc::CritScope lock(&crit_);
+  TrimTo(0);
+}
+
+SharedI420BufferPool::Stats SharedI420BufferPool::GetStats() const {
+  rtc::CritScope lock(&crit_);
+  return stats_;
+}
+
+void SharedI420BufferPool::TrimTo(size_t max_bytes) {
+  while (stats_.bytes_pooled > max_bytes) {
+    // Delete from the resolution that was least recently asked for, which
+    // most likely belongs to a stream that has changed resolution or ended.
+    Resolution* oldest = nullptr;
+    for (Resolution& resolution : resolutions_) {
+      if (!resolution.free_buffers.empty() &&
+          (!oldest || resolution.last_used < oldest->last_used)) {
+        oldest = &resolution;
+      }
+    }
+    RTC_DCHECK(oldest);
+    PooledBuffer* buffer = oldest->free_buffers.back();
+    oldest->free_buffers.pop_back();
+    --stats_.buffers_pooled;
+    stats_.bytes_pooled -= BufferSize(buffer->width(), buffer->height());
+    delete buffer;
+  }
+}
+
+}  // namespace webrtc
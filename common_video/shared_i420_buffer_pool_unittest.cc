@@ -0,0 +1,247 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <deque>
+#include <limits>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "common_video/include/i420_buffer_pool.h"
+#include "common_video/include/shared_i420_buffer_pool.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+constexpr size_t kUnlimited = std::numeric_limits<size_t>::max();
+// Size of a 16x16 I420 buffer.
+constexpr size_t kBufferSize16x16 = 16 * 16 + 2 * 8 * 8;
+
+void CreateAndReleaseBuffers(void* obj) {
+  SharedI420BufferPool* pool = static_cast<SharedI420BufferPool*>(obj);
+  for (int i = 0; i < 10000; ++i) {
+    rtc::scoped_refptr<I420Buffer> buffer = pool->CreateBuffer(16, 16 + i % 3);
+    buffer->MutableDataY()[0] = i;
+  }
+}
+
+}  // namespace
+
+TEST(SharedI420BufferPoolTest, ReusesReleasedBuffer) {
+  rtc::scoped_refptr<SharedI420BufferPool> pool =
+      SharedI420BufferPool::Create(kUnlimited, false);
+  rtc::scoped_refptr<I420Buffer> buffer = pool->CreateBuffer(16, 16);
+  EXPECT_EQ(16, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  const uint8_t* y_ptr = buffer->DataY();
+  // Another buffer can not reuse the one in use.
+  rtc::scoped_refptr<I420Buffer> other_buffer = pool->CreateBuffer(16, 16);
+  EXPECT_NE(y_ptr, other_buffer->DataY());
+  SharedI420BufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(2u, stats.buffers_in_use);
+  EXPECT_EQ(2 * kBufferSize16x16, stats.bytes_in_use);
+
+  buffer = nullptr;
+  stats = pool->GetStats();
+  EXPECT_EQ(1u, stats.buffers_in_use);
+  EXPECT_EQ(1u, stats.buffers_pooled);
+  EXPECT_EQ(kBufferSize16x16, stats.bytes_pooled);
+
+  buffer = pool->CreateBuffer(16, 16);
+  EXPECT_EQ(y_ptr, buffer->DataY());
+  stats = pool->GetStats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(0u, stats.buffers_pooled);
+}
+
+TEST(SharedI420BufferPoolTest, KeepsResolutionsApart) {
+  rtc::scoped_refptr<SharedI420BufferPool> pool =
+      SharedI420BufferPool::Create(kUnlimited, false);
+  rtc::scoped_refptr<I420Buffer> buffer = pool->CreateBuffer(16, 16);
+  const uint8_t* y_ptr = buffer->DataY();
+  buffer = nullptr;
+
+  buffer = pool->CreateBuffer(32, 16);
+  EXPECT_EQ(32, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  EXPECT_NE(y_ptr, buffer->DataY());
+  // The 16x16 buffer is still there for the next 16x16 stream.
+  EXPECT_EQ(y_ptr, pool->CreateBuffer(16, 16)->DataY());
+}
+
+TEST(SharedI420BufferPoolTest, DeletesLeastRecentlyUsedResolutionFirst) {
+  rtc::scoped_refptr<SharedI420BufferPool> pool =
+      SharedI420BufferPool::Create(2 * kBufferSize16x16, false);
+  rtc::scoped_refptr<I420Buffer> old_buffer = pool->CreateBuffer(16, 16);
+  rtc::scoped_refptr<I420Buffer> buffer1 = pool->CreateBuffer(16, 17);
+  rtc::scoped_refptr<I420Buffer> buffer2 = pool->CreateBuffer(16, 17);
+  const uint8_t* y_ptr1 = buffer1->DataY();
+  const uint8_t* y_ptr2 = buffer2->DataY();
+
+  old_buffer = nullptr;
+  buffer1 = nullptr;
+  buffer2 = nullptr;
+  SharedI420BufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(1u, stats.buffers_pooled);
+  EXPECT_LE(stats.bytes_pooled, 2 * kBufferSize16x16);
+
+  // The 16x16 buffer was pooled first but deleted as 16x16 was least recently
+  // asked for.
+  buffer1 = pool->CreateBuffer(16, 17);
+  EXPECT_TRUE(buffer1->DataY() == y_ptr1 || buffer1->DataY() == y_ptr2);
+  pool->CreateBuffer(16, 16);
+  EXPECT_EQ(1u, pool->GetStats().hits);
+}
+
+TEST(SharedI420BufferPoolTest, TrimDeletesFreeBuffers) {
+  rtc::scoped_refptr<SharedI420BufferPool> pool =
+      SharedI420BufferPool::Create(kUnlimited, false);
+  rtc::scoped_refptr<I420Buffer> buffer = pool->CreateBuffer(16, 16);
+  pool->CreateBuffer(32, 32);
+  pool->CreateBuffer(64, 64);
+  EXPECT_EQ(2u, pool->GetStats().buffers_pooled);
+
+  pool->Trim();
+  SharedI420BufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(0u, stats.buffers_pooled);
+  EXPECT_EQ(0u, stats.bytes_pooled);
+  EXPECT_EQ(1u, stats.buffers_in_use);
+
+  buffer = nullptr;
+  EXPECT_EQ(1u, pool->GetStats().buffers_pooled);
+  pool->SetMaxPooledBytes(0);
+  EXPECT_EQ(0u, pool->GetStats().buffers_pooled);
+}
+
+TEST(SharedI420BufferPoolTest, BufferValidAfterPoolIsReleased) {
+  rtc::scoped_refptr<I420Buffer> buffer;
+  rtc::scoped_refptr<I420Buffer> free_buffer;
+  {
+    rtc::scoped_refptr<SharedI420BufferPool> pool =
+        SharedI420BufferPool::Create(kUnlimited, false);
+    buffer = pool->CreateBuffer(16, 16);
+    free_buffer = pool->CreateBuffer(16, 16);
+  }
+  free_buffer = nullptr;
+  EXPECT_EQ(16, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  // Try to trigger use-after-free errors by writing to y-plane.
+  memset(buffer->MutableDataY(), 0xA5, 16 * buffer->StrideY());
+}
+
+TEST(SharedI420BufferPoolTest, ZeroInitializesNewBuffers) {
+  rtc::scoped_refptr<SharedI420BufferPool> pool =
+      SharedI420BufferPool::Create(kUnlimited, true);
+  rtc::scoped_refptr<I420Buffer> buffer = pool->CreateBuffer(16, 16);
+  for (int i = 0; i < 16 * 16; ++i)
+    EXPECT_EQ(0, buffer->DataY()[i]);
+}
+
+TEST(SharedI420BufferPoolTest, SharedBetweenThreads) {
+  rtc::scoped_refptr<SharedI420BufferPool> pool =
+      SharedI420BufferPool::Create(kUnlimited, false);
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(new rtc::PlatformThread(&CreateAndReleaseBuffers,
+                                                 pool.get(), "Decoder"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+
+  SharedI420BufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(40000u, stats.hits + stats.misses);
+  EXPECT_EQ(0u, stats.buffers_in_use);
+  EXPECT_EQ(0u, stats.bytes_in_use);
+  // At most one buffer per thread and resolution.
+  EXPECT_LE(stats.buffers_pooled, 12u);
+}
+
+// Runs the output pools of the decoders of a host receiving 16 streams. Every
+// stream switches to another of three simulcast layers each second, and every
+// 10 seconds a stream ends and a new decoder takes its place. Each frame is
+// written in full, as a decoder does, and kept for two more frames, as a
+// render queue does. Compares a pool per decoder with pools that are backed by
+// one SharedI420BufferPool.
+TEST(SharedI420BufferPoolTest, DISABLED_DecoderHostPerformance) {
+  const int kNumStreams = 16;
+  const int kNumFrames = 30000;
+  const int kFramesPerLayer = 30;
+  const int kFramesPerDecoder = 300;
+  const size_t kFramesInFlight = 3;
+  const int kLayers[][2] = {{320, 180}, {640, 360}, {1280, 720}};
+
+  for (bool shared : {false, true}) {
+    rtc::scoped_refptr<SharedI420BufferPool> shared_pool =
+        SharedI420BufferPool::Create(64 * 1024 * 1024, false);
+    std::vector<std::unique_ptr<I420BufferPool>> pools(kNumStreams);
+    std::vector<std::deque<rtc::scoped_refptr<I420Buffer>>> in_flight(
+        kNumStreams);
+    // The buffers each I420BufferPool owns, to count its allocations. It drops
+    // all of them when asked for another resolution.
+    std::vector<std::set<const I420Buffer*>> owned(kNumStreams);
+    int allocations = 0;
+
+    int64_t start_ns = rtc::TimeNanos();
+    for (int i = 0; i < kNumFrames; ++i) {
+      const int stream = i % kNumStreams;
+      // Spread the layer switches and decoder restarts over the streams.
+      const int frame = i / kNumStreams + stream * kFramesPerDecoder /
+                                              kNumStreams;
+      if (frame % kFramesPerDecoder == 0 || !pools[stream]) {
+        in_flight[stream].clear();
+        owned[stream].clear();
+        pools[stream].reset(shared ? new I420BufferPool(shared_pool)
+                                   : new I420BufferPool());
+      }
+      const int layer = (frame / kFramesPerLayer + stream) % 3;
+      rtc::scoped_refptr<I420Buffer> buffer = pools[stream]->CreateBuffer(
+          kLayers[layer][0], kLayers[layer][1]);
+      if (!shared) {
+        if (!owned[stream].empty() &&
+            (*owned[stream].begin())->width() != buffer->width()) {
+          owned[stream].clear();
+        }
+        if (owned[stream].insert(buffer.get()).second)
+          ++allocations;
+      }
+      memset(buffer->MutableDataY(), i, buffer->StrideY() * buffer->height());
+      memset(buffer->MutableDataU(), i,
+             buffer->StrideU() * buffer->ChromaHeight());
+      memset(buffer->MutableDataV(), i,
+             buffer->StrideV() * buffer->ChromaHeight());
+      in_flight[stream].push_back(buffer);
+      if (in_flight[stream].size() > kFramesInFlight)
+        in_flight[stream].pop_front();
+    }
+    int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+    LOG(LS_INFO) << (shared ? "Shared pool" : "Pool per decoder") << ": "
+                 << elapsed_ns / kNumFrames << " ns per frame.";
+    if (shared) {
+      SharedI420BufferPool::Stats stats = shared_pool->GetStats();
+      LOG(LS_INFO) << "Hits: " << stats.hits << ", misses: " << stats.misses
+                   << ", bytes in use: " << stats.bytes_in_use
+                   << ", bytes pooled: " << stats.bytes_pooled << ".";
+    } else {
+      LOG(LS_INFO) << "Allocations: " << allocations << ".";
+    }
+  }
+}
+
+}  // namespace webrtc
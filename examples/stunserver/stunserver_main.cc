@@ -13,15 +13,19 @@
 #endif  // WEBRTC_POSIX
 
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "p2p/base/stunserver.h"
+#include "rtc_base/networkthreadpool.h"
+#include "rtc_base/stringencode.h"
 #include "rtc_base/thread.h"
 
 using cricket::StunServer;
 
 int main(int argc, char* argv[]) {
-  if (argc != 2) {
-    std::cerr << "usage: stunserver address" << std::endl;
+  if (argc != 2 && argc != 3) {
+    std::cerr << "usage: stunserver address [num-threads]" << std::endl;
     return 1;
   }
 
@@ -31,8 +35,48 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  size_t num_threads = 1;
+  if (argc == 3 && (!rtc::FromString(argv[2], &num_threads) ||
+                    num_threads == 0)) {
+    std::cerr << "Invalid thread count: " << argv[2] << std::endl;
+    return 1;
+  }
+
   rtc::Thread *pthMain = rtc::Thread::Current();
 
+  if (num_threads > 1) {
+    // One server per shard, all listening on |server_addr| via SO_REUSEPORT.
+    rtc::NetworkThreadPool pool(num_threads);
+    pool.Start();
+    std::vector<std::unique_ptr<StunServer>> servers(num_threads);
+    bool started = true;
+    for (size_t i = 0; i < num_threads && started; ++i) {
+      rtc::Thread* shard = pool.shard(i);
+      shard->Invoke<void>(RTC_FROM_HERE, [&] {
+        rtc::AsyncUDPSocket* socket =
+            rtc::NetworkThreadPool::CreateReusePortUdpSocket(
+                shard->socketserver(), server_addr);
+        if (socket)
+          servers[i].reset(new StunServer(socket));
+      });
+      started = servers[i] != nullptr;
+    }
+
+    if (started) {
+      std::cout << "Listening at " << server_addr.ToString() << " on "
+                << num_threads << " threads" << std::endl;
+      pthMain->Run();
+    } else {
+      std::cerr << "Failed to create a shared UDP socket" << std::endl;
+    }
+
+    // Servers must be destroyed on the shard that owns their socket.
+    for (size_t i = 0; i < num_threads; ++i) {
+      pool.shard(i)->Invoke<void>(RTC_FROM_HERE, [&] { servers[i].reset(); });
+    }
+    return started ? 0 : 1;
+  }
+
   rtc::AsyncUDPSocket* server_socket =
       rtc::AsyncUDPSocket::Create(pthMain->socketserver(), server_addr);
   if (!server_socket) {
@@ -12,6 +12,7 @@
 #define LOGGING_RTC_EVENT_LOG_ENCODER_RTC_EVENT_LOG_ENCODER_H_
 
 #include <string>
+#include <vector>
 
 #include "logging/rtc_event_log/events/rtc_event.h"
 
@@ -21,6 +22,15 @@ class RtcEventLogEncoder {
   virtual ~RtcEventLogEncoder() = default;
 
   virtual std::string Encode(const RtcEvent& event) = 0;
+
+  // Encodes |events| together, which lets an encoder share information
+  // between them. By default, they are encoded one at a time.
+  virtual std::string EncodeBatch(const std::vector<const RtcEvent*>& events) {
+    std::string output;
+    for (const RtcEvent* event : events)
+      output += Encode(*event);
+    return output;
+  }
 };
 
 }  // namespace webrtc
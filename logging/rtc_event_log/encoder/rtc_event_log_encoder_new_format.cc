@@ -0,0 +1,331 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_incoming.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_outgoing.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtp_packet.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ignore_wundef.h"
+
+#ifdef ENABLE_RTC_EVENT_LOG
+
+// *.pb.h files are generated at build-time by the protobuf compiler.
+RTC_PUSH_IGNORING_WUNDEF()
+#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
+#include "external/webrtc/webrtc/logging/rtc_event_log/rtc_event_log.pb.h"
+#else
+#include "logging/rtc_event_log/rtc_event_log.pb.h"
+#endif
+RTC_POP_IGNORING_WUNDEF()
+
+namespace webrtc {
+
+namespace {
+// Bounds the size of a serialized batch, which the parser reads as a whole.
+constexpr size_t kMaxEventsInBatch = 1000;
+
+constexpr size_t kFixedRtpHeaderSize = 12;
+
+// The tag of rtclog::EventStream::batch, i.e. (field number << 3) | wire type,
+// where the wire type of a length-delimited field is 2.
+constexpr uint64_t kEventStreamBatchTag = (2 << 3) | 2;
+
+// The values of the columns of one rtclog::RtpPacketBatch, before
+// delta-encoding.
+struct RtpPacketColumns {
+  uint32_t ssrc = 0;
+  bool incoming = false;
+  // True if the batch holds single packets of several SSRCs, which are then
+  // stored in |ssrcs|.
+  bool mixed = false;
+  std::vector<uint32_t> ssrcs;
+  std::vector<int64_t> timestamp_us;
+  std::vector<int64_t> sequence_number;
+  std::vector<int64_t> rtp_timestamp;
+  std::vector<int64_t> header_flags;
+  std::vector<int64_t> packet_length;
+  std::vector<int64_t> header_tail_length;
+  std::vector<int64_t> probe_cluster_id;
+  std::string header_tails;
+};
+
+// The values of the columns of one rtclog::AudioPlayoutBatch.
+struct AudioPlayoutColumns {
+  uint32_t local_ssrc = 0;
+  bool mixed = false;
+  std::vector<uint32_t> local_ssrcs;
+  std::vector<int64_t> timestamp_us;
+};
+
+void AddRtpPacket(int64_t timestamp_us,
+                  const RtpPacket& header,
+                  size_t packet_length,
+                  int probe_cluster_id,
+                  RtpPacketColumns* columns) {
+  RTC_DCHECK_GE(header.size(), kFixedRtpHeaderSize);
+  if (columns->mixed)
+    columns->ssrcs.push_back(header.Ssrc());
+  columns->timestamp_us.push_back(timestamp_us);
+  columns->sequence_number.push_back(header.SequenceNumber());
+  columns->rtp_timestamp.push_back(header.Timestamp());
+  columns->header_flags.push_back((header.data()[0] << 8) | header.data()[1]);
+  columns->packet_length.push_back(packet_length);
+  columns->header_tail_length.push_back(header.size() - kFixedRtpHeaderSize);
+  columns->probe_cluster_id.push_back(
+      probe_cluster_id == PacedPacketInfo::kNotAProbe ? 0
+                                                      : probe_cluster_id + 1);
+  columns->header_tails.append(
+      reinterpret_cast<const char*>(header.data()) + kFixedRtpHeaderSize,
+      header.size() - kFixedRtpHeaderSize);
+}
+
+// Delta-encodes |values| into |column|, which is left empty if all of them
+// are zero.
+void EncodeColumn(const std::vector<int64_t>& values,
+                  google::protobuf::RepeatedField<int64_t>* column) {
+  if (std::all_of(values.begin(), values.end(),
+                  [](int64_t value) { return value == 0; })) {
+    return;
+  }
+  column->Reserve(values.size());
+  int64_t previous = 0;
+  for (int64_t value : values) {
+    column->Add(value - previous);
+    previous = value;
+  }
+}
+
+void AppendVarInt(uint64_t value, std::string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>(0x80 | (value & 0x7F)));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+}  // namespace
+
+std::string RtcEventLogEncoderNewFormat::Encode(const RtcEvent& event) {
+  const RtcEvent* const events[] = {&event};
+  return EncodeSingleBatch(events);
+}
+
+std::string RtcEventLogEncoderNewFormat::EncodeBatch(
+    const std::vector<const RtcEvent*>& events) {
+  std::string output;
+  for (size_t begin = 0; begin < events.size(); begin += kMaxEventsInBatch) {
+    const size_t size = std::min(kMaxEventsInBatch, events.size() - begin);
+    output += EncodeSingleBatch(
+        rtc::ArrayView<const RtcEvent* const>(events.data() + begin, size));
+  }
+  return output;
+}
+
+std::string RtcEventLogEncoderNewFormat::EncodeSingleBatch(
+    rtc::ArrayView<const RtcEvent* const> events) {
+  // First group the RTP packets and audio playouts by stream, by sorting the
+  // indices of the events by the key of their stream; the SSRC, and for RTP
+  // packets the direction in the lowest bit.
+  std::vector<std::pair<uint64_t, size_t>> rtp_packet_streams;
+  std::vector<std::pair<uint32_t, size_t>> audio_playout_streams;
+  for (size_t i = 0; i < events.size(); ++i) {
+    switch (events[i]->GetType()) {
+      case RtcEvent::Type::RtpPacketIncoming: {
+        auto* rtc_event =
+            static_cast<const RtcEventRtpPacketIncoming*>(events[i]);
+        rtp_packet_streams.emplace_back(
+            (static_cast<uint64_t>(rtc_event->header_.Ssrc()) << 1) | 1, i);
+        break;
+      }
+      case RtcEvent::Type::RtpPacketOutgoing: {
+        auto* rtc_event =
+            static_cast<const RtcEventRtpPacketOutgoing*>(events[i]);
+        rtp_packet_streams.emplace_back(
+            static_cast<uint64_t>(rtc_event->header_.Ssrc()) << 1, i);
+        break;
+      }
+      case RtcEvent::Type::AudioPlayout: {
+        auto* rtc_event = static_cast<const RtcEventAudioPlayout*>(events[i]);
+        audio_playout_streams.emplace_back(rtc_event->ssrc_, i);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  std::sort(rtp_packet_streams.begin(), rtp_packet_streams.end());
+  std::sort(audio_playout_streams.begin(), audio_playout_streams.end());
+
+  // Then assign the streams to the columns they are stored in. The location of
+  // the columns of every event is as in rtclog::EventBatch::order, so 0 for the
+  // events that are not stored in columns. A stream with a single event would
+  // cost more in the fields of its own columns than it saves, so all such
+  // streams share the same columns, one for each direction of RTP packets and
+  // one for audio playouts.
+  std::vector<size_t> event_locations(events.size(), 0);
+  std::vector<RtpPacketColumns> rtp_packets;
+  size_t mixed_rtp_packets[2] = {0, 0};
+  for (size_t begin = 0, end = 0; begin < rtp_packet_streams.size();
+       begin = end) {
+    const uint64_t key = rtp_packet_streams[begin].first;
+    while (end < rtp_packet_streams.size() &&
+           rtp_packet_streams[end].first == key) {
+      ++end;
+    }
+    const bool incoming = key & 1;
+    const bool single = end - begin == 1;
+    size_t location = single ? mixed_rtp_packets[incoming] : 0;
+    if (location == 0) {
+      rtp_packets.emplace_back();
+      rtp_packets.back().ssrc = static_cast<uint32_t>(key >> 1);
+      rtp_packets.back().incoming = incoming;
+      rtp_packets.back().mixed = single;
+      location = rtp_packets.size();
+      if (single)
+        mixed_rtp_packets[incoming] = location;
+    }
+    for (size_t i = begin; i < end; ++i)
+      event_locations[rtp_packet_streams[i].second] = location;
+  }
+  std::vector<AudioPlayoutColumns> audio_playouts;
+  size_t mixed_audio_playouts = 0;
+  for (size_t begin = 0, end = 0; begin < audio_playout_streams.size();
+       begin = end) {
+    const uint32_t ssrc = audio_playout_streams[begin].first;
+    while (end < audio_playout_streams.size() &&
+           audio_playout_streams[end].first == ssrc) {
+      ++end;
+    }
+    const bool single = end - begin == 1;
+    size_t location = single ? mixed_audio_playouts : 0;
+    if (location == 0) {
+      audio_playouts.emplace_back();
+      audio_playouts.back().local_ssrc = ssrc;
+      audio_playouts.back().mixed = single;
+      location = rtp_packets.size() + audio_playouts.size();
+      if (single)
+        mixed_audio_playouts = location;
+    }
+    for (size_t i = begin; i < end; ++i)
+      event_locations[audio_playout_streams[i].second] = location;
+  }
+
+  // Then fill in the columns in the order the events were logged. A legacy
+  // encoded event is an rtclog::EventStream holding the event in field 1,
+  // which serializes to the same bytes as an rtclog::EventBatch holding it in
+  // |events|. The legacy encoder is therefore used for the other events, and
+  // its output concatenated with the serialized columns.
+  std::string legacy_events;
+  rtclog::EventBatch batch;
+  batch.mutable_order()->Reserve(events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    const RtcEvent* event = events[i];
+    const size_t location = event_locations[i];
+    batch.add_order(location);
+    if (location == 0) {
+      legacy_events += legacy_encoder_.Encode(*event);
+      continue;
+    }
+    switch (event->GetType()) {
+      case RtcEvent::Type::RtpPacketIncoming: {
+        auto* rtc_event = static_cast<const RtcEventRtpPacketIncoming*>(event);
+        AddRtpPacket(rtc_event->timestamp_us_, rtc_event->header_,
+                     rtc_event->packet_length_, PacedPacketInfo::kNotAProbe,
+                     &rtp_packets[location - 1]);
+        break;
+      }
+      case RtcEvent::Type::RtpPacketOutgoing: {
+        auto* rtc_event = static_cast<const RtcEventRtpPacketOutgoing*>(event);
+        AddRtpPacket(rtc_event->timestamp_us_, rtc_event->header_,
+                     rtc_event->packet_length_, rtc_event->probe_cluster_id_,
+                     &rtp_packets[location - 1]);
+        break;
+      }
+      case RtcEvent::Type::AudioPlayout: {
+        auto* rtc_event = static_cast<const RtcEventAudioPlayout*>(event);
+        AudioPlayoutColumns& columns =
+            audio_playouts[location - 1 - rtp_packets.size()];
+        if (columns.mixed)
+          columns.local_ssrcs.push_back(rtc_event->ssrc_);
+        columns.timestamp_us.push_back(rtc_event->timestamp_us_);
+        break;
+      }
+      default:
+        RTC_NOTREACHED();
+        break;
+    }
+  }
+
+  for (RtpPacketColumns& columns : rtp_packets) {
+    rtclog::RtpPacketBatch* rtp_packet_batch = batch.add_rtp_packets();
+    rtp_packet_batch->set_incoming(columns.incoming);
+    if (columns.mixed) {
+      rtp_packet_batch->mutable_ssrcs()->Reserve(columns.ssrcs.size());
+      for (uint32_t ssrc : columns.ssrcs)
+        rtp_packet_batch->add_ssrcs(ssrc);
+    } else {
+      rtp_packet_batch->set_ssrc(columns.ssrc);
+    }
+    rtp_packet_batch->set_number_of_packets(columns.timestamp_us.size());
+    EncodeColumn(columns.timestamp_us,
+                 rtp_packet_batch->mutable_timestamp_us());
+    EncodeColumn(columns.sequence_number,
+                 rtp_packet_batch->mutable_sequence_number());
+    EncodeColumn(columns.rtp_timestamp,
+                 rtp_packet_batch->mutable_rtp_timestamp());
+    EncodeColumn(columns.header_flags,
+                 rtp_packet_batch->mutable_header_flags());
+    EncodeColumn(columns.packet_length,
+                 rtp_packet_batch->mutable_packet_length());
+    EncodeColumn(columns.header_tail_length,
+                 rtp_packet_batch->mutable_header_tail_length());
+    EncodeColumn(columns.probe_cluster_id,
+                 rtp_packet_batch->mutable_probe_cluster_id());
+    if (!columns.header_tails.empty())
+      rtp_packet_batch->mutable_header_tails()->swap(columns.header_tails);
+  }
+  for (const AudioPlayoutColumns& columns : audio_playouts) {
+    rtclog::AudioPlayoutBatch* audio_playout_batch =
+        batch.add_audio_playouts();
+    if (columns.mixed) {
+      audio_playout_batch->mutable_local_ssrcs()->Reserve(
+          columns.local_ssrcs.size());
+      for (uint32_t ssrc : columns.local_ssrcs)
+        audio_playout_batch->add_local_ssrcs(ssrc);
+    } else {
+      audio_playout_batch->set_local_ssrc(columns.local_ssrc);
+    }
+    audio_playout_batch->set_number_of_events(columns.timestamp_us.size());
+    EncodeColumn(columns.timestamp_us,
+                 audio_playout_batch->mutable_timestamp_us());
+  }
+  const size_t columns_size = batch.ByteSizeLong();
+
+  std::string output;
+  AppendVarInt(kEventStreamBatchTag, &output);
+  AppendVarInt(legacy_events.size() + columns_size, &output);
+  output.reserve(output.size() + legacy_events.size() + columns_size);
+  output += legacy_events;
+  const size_t columns_offset = output.size();
+  output.resize(columns_offset + columns_size);
+  batch.SerializeWithCachedSizesToArray(
+      reinterpret_cast<uint8_t*>(&output[columns_offset]));
+  return output;
+}
+
+}  // namespace webrtc
+
+#endif  // ENABLE_RTC_EVENT_LOG
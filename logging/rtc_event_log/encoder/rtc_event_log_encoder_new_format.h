@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef LOGGING_RTC_EVENT_LOG_ENCODER_RTC_EVENT_LOG_ENCODER_NEW_FORMAT_H_
+#define LOGGING_RTC_EVENT_LOG_ENCODER_RTC_EVENT_LOG_ENCODER_NEW_FORMAT_H_
+
+#include <string>
+#include <vector>
+
+#include "api/array_view.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+
+#if defined(ENABLE_RTC_EVENT_LOG)
+
+namespace webrtc {
+
+// Encodes events in batches (rtclog::EventBatch). RTP packets and audio
+// playout events are stored column-wise per stream, with delta-encoded
+// columns, so the more events are encoded together, the smaller the output.
+// The streams with a single event in the batch share their columns, which
+// then hold the SSRC of each event. Other events are stored as the legacy encoder would store them.
+class RtcEventLogEncoderNewFormat final : public RtcEventLogEncoder {
+ public:
+  ~RtcEventLogEncoderNewFormat() override = default;
+
+  std::string Encode(const RtcEvent& event) override;
+  std::string EncodeBatch(const std::vector<const RtcEvent*>& events) override;
+
+ private:
+  // Encodes all of |events| as one rtclog::EventBatch.
+  std::string EncodeSingleBatch(rtc::ArrayView<const RtcEvent* const> events);
+
+  RtcEventLogEncoderLegacy legacy_encoder_;
+};
+
+}  // namespace webrtc
+
+#endif  // ENABLE_RTC_EVENT_LOG
+
+#endif  // LOGGING_RTC_EVENT_LOG_ENCODER_RTC_EVENT_LOG_ENCODER_NEW_FORMAT_H_
@@ -11,10 +11,13 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "api/rtpparameters.h"  // RtpExtension
 #include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_network_adaptation.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_receive_stream_config.h"
@@ -35,9 +38,13 @@
 #include "logging/rtc_event_log/rtc_event_log_parser.h"
 #include "modules/audio_coding/audio_network_adaptor/include/audio_network_adaptor_config.h"
 #include "modules/remote_bitrate_estimator/include/bwe_defines.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/bye.h"  // Arbitrary RTCP message.
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/fakeclock.h"
 #include "rtc_base/ptr_util.h"
 #include "rtc_base/random.h"
 #include "rtc_base/safe_conversions.h"
@@ -48,12 +55,22 @@ namespace webrtc {
 namespace {
 const char* const arbitrary_uri =  // Just a recognized URI.
     "urn:ietf:params:rtp-hdrext:sdes:rtp-stream-id";
+
+std::unique_ptr<RtcEventLogEncoder> CreateEncoder(bool new_format) {
+  if (new_format)
+    return rtc::MakeUnique<RtcEventLogEncoderNewFormat>();
+  return rtc::MakeUnique<RtcEventLogEncoderLegacy>();
+}
 }  // namespace
 
-class RtcEventLogEncoderTest : public testing::TestWithParam<int> {
+// The parameters are the random seed, and whether to use the new format
+// encoder rather than the legacy one.
+class RtcEventLogEncoderTest
+    : public testing::TestWithParam<std::tuple<int, bool>> {
  protected:
   RtcEventLogEncoderTest()
-      : encoder_(new RtcEventLogEncoderLegacy), prng_(GetParam()) {}
+      : encoder_(CreateEncoder(std::get<1>(GetParam()))),
+        prng_(std::get<0>(GetParam())) {}
   ~RtcEventLogEncoderTest() override = default;
 
   // ANA events have some optional fields, so we want to make sure that we get
@@ -66,6 +83,16 @@ class RtcEventLogEncoderTest : public testing::TestWithParam<int> {
   void TestRtcEventRtcpPacket(PacketDirection direction);
   void TestRtcEventRtpPacket(PacketDirection direction);
 
+  // Creates |num_events| events, mostly RTP packets and audio playouts of a
+  // few streams, logged between 0 and |max_interval_us| apart on |clock|.
+  // Unlike the session in rtc_event_log_unittest.cc, whose packets all have
+  // random headers, the streams' headers change the way real streams do, so
+  // that the new format's per-stream columns are exercised.
+  std::vector<std::unique_ptr<RtcEvent>> CreateRandomEvents(
+      size_t num_events,
+      int max_interval_us,
+      rtc::ScopedFakeClock* clock);
+
   int RandomInt() {
     // Don't run this on a SNES.
     static_assert(8 * sizeof(int) >= 32, "Don't run this on a SNES.");
@@ -89,13 +116,85 @@ class RtcEventLogEncoderTest : public testing::TestWithParam<int> {
 
   int RandomBitrate() { return RandomInt(); }
 
-  // TODO(eladalon): Once we have more than once possible encoder, parameterize
-  // encoder selection.
   std::unique_ptr<RtcEventLogEncoder> encoder_;
   ParsedRtcEventLog parsed_log_;
   Random prng_;
 };
 
+std::vector<std::unique_ptr<RtcEvent>>
+RtcEventLogEncoderTest::CreateRandomEvents(size_t num_events,
+                                           int max_interval_us,
+                                           rtc::ScopedFakeClock* clock) {
+  struct RtpStream {
+    bool incoming;
+    uint32_t ssrc;
+    uint16_t sequence_number;
+    uint32_t rtp_timestamp;
+    std::vector<uint32_t> csrcs;
+  };
+  std::vector<RtpStream> rtp_streams;
+  for (int i = 0; i < 4; ++i) {
+    rtp_streams.push_back({i % 2 == 0, RandomSsrc(),
+                           static_cast<uint16_t>(RandomInt()),
+                           static_cast<uint32_t>(RandomInt()), {}});
+  }
+  rtp_streams[3].csrcs = {RandomSsrc(), RandomSsrc()};
+  const uint32_t playout_ssrcs[] = {RandomSsrc(), RandomSsrc()};
+  RtpPacketToSend::ExtensionManager extensions;
+  extensions.Register<TransportSequenceNumber>(5);
+  extensions.Register<AbsoluteSendTime>(3);
+  uint16_t transport_sequence_number = 0;
+
+  std::vector<std::unique_ptr<RtcEvent>> events;
+  for (size_t i = 0; i < num_events; ++i) {
+    clock->AdvanceTimeMicros(prng_.Rand(0, max_interval_us));
+    const uint32_t event_type = prng_.Rand(0u, 19u);
+    if (event_type < 16) {
+      RtpStream& stream = rtp_streams[event_type % rtp_streams.size()];
+      RtpPacketToSend packet(&extensions);
+      packet.SetMarker(prng_.Rand<bool>());
+      packet.SetPayloadType(96 + (event_type % 2));
+      packet.SetSequenceNumber(stream.sequence_number++);
+      packet.SetTimestamp(stream.rtp_timestamp);
+      stream.rtp_timestamp += prng_.Rand<bool>() ? 3000 : 0;
+      packet.SetSsrc(stream.ssrc);
+      packet.SetCsrcs(stream.csrcs);
+      if (!stream.incoming) {
+        packet.SetExtension<TransportSequenceNumber>(
+            transport_sequence_number++);
+      }
+      if (prng_.Rand<bool>())
+        packet.SetExtension<AbsoluteSendTime>(prng_.Rand(0x00FFFFFFu));
+      packet.SetPayloadSize(prng_.Rand(0u, 1200u));
+      if (stream.incoming) {
+        RtpPacketReceived packet_received(&extensions);
+        packet_received.Parse(packet.data(), packet.size());
+        events.push_back(
+            rtc::MakeUnique<RtcEventRtpPacketIncoming>(packet_received));
+      } else {
+        const int probe_cluster_id = prng_.Rand(0, 9) == 0
+                                         ? prng_.Rand(0, 100)
+                                         : PacedPacketInfo::kNotAProbe;
+        events.push_back(rtc::MakeUnique<RtcEventRtpPacketOutgoing>(
+            packet, probe_cluster_id));
+      }
+    } else if (event_type < 18) {
+      events.push_back(
+          rtc::MakeUnique<RtcEventAudioPlayout>(playout_ssrcs[event_type % 2]));
+    } else if (event_type < 19) {
+      rtcp::Bye bye_packet;
+      bye_packet.SetSenderSsrc(RandomSsrc());
+      auto rtcp_packet = bye_packet.Build();
+      events.push_back(
+          rtc::MakeUnique<RtcEventRtcpPacketIncoming>(rtcp_packet));
+    } else {
+      events.push_back(rtc::MakeUnique<RtcEventBweUpdateDelayBased>(
+          RandomBitrate(), BandwidthUsage::kBwNormal));
+    }
+  }
+  return events;
+}
+
 void RtcEventLogEncoderTest::TestRtcEventAudioNetworkAdaptation(
     std::unique_ptr<AudioEncoderRuntimeConfig> runtime_config) {
   auto original_runtime_config = *runtime_config;
@@ -530,8 +629,80 @@ TEST_P(RtcEventLogEncoderTest, RtcEventVideoSendStreamConfig) {
   EXPECT_EQ(parsed_event, original_stream_config);
 }
 
-INSTANTIATE_TEST_CASE_P(RandomSeeds,
-                        RtcEventLogEncoderTest,
-                        ::testing::Values(1, 2, 3, 4, 5));
+// Events encoded together should be parsed the same as when each is encoded by
+// itself by the legacy encoder.
+TEST_P(RtcEventLogEncoderTest, EventBatch) {
+  std::vector<std::unique_ptr<RtcEvent>> events;
+  {
+    rtc::ScopedFakeClock clock;
+    clock.SetTimeMicros(RandomPositiveInt());
+    events = CreateRandomEvents(2500, 2000, &clock);
+  }
+  std::vector<const RtcEvent*> batch;
+  std::string legacy_encoded;
+  RtcEventLogEncoderLegacy legacy_encoder;
+  for (const auto& event : events) {
+    batch.push_back(event.get());
+    legacy_encoded += legacy_encoder.Encode(*event);
+  }
+  ParsedRtcEventLog legacy_log;
+  ASSERT_TRUE(legacy_log.ParseString(legacy_encoded));
+  ASSERT_TRUE(parsed_log_.ParseString(encoder_->EncodeBatch(batch)));
+  ASSERT_EQ(parsed_log_.GetNumberOfEvents(), legacy_log.GetNumberOfEvents());
+
+  for (size_t i = 0; i < legacy_log.GetNumberOfEvents(); ++i) {
+    ASSERT_EQ(parsed_log_.GetEventType(i), legacy_log.GetEventType(i));
+    EXPECT_EQ(parsed_log_.GetTimestamp(i), legacy_log.GetTimestamp(i));
+    switch (legacy_log.GetEventType(i)) {
+      case ParsedRtcEventLog::RTP_EVENT: {
+        PacketDirection direction[2];
+        uint8_t header[2][IP_PACKET_SIZE];
+        size_t header_length[2];
+        size_t total_length[2];
+        int probe_cluster_id[2];
+        legacy_log.GetRtpHeader(i, &direction[0], header[0], &header_length[0],
+                                &total_length[0], &probe_cluster_id[0]);
+        parsed_log_.GetRtpHeader(i, &direction[1], header[1],
+                                 &header_length[1], &total_length[1],
+                                 &probe_cluster_id[1]);
+        EXPECT_EQ(direction[1], direction[0]);
+        ASSERT_EQ(header_length[1], header_length[0]);
+        EXPECT_EQ(memcmp(header[1], header[0], header_length[0]), 0);
+        EXPECT_EQ(total_length[1], total_length[0]);
+        EXPECT_EQ(probe_cluster_id[1], probe_cluster_id[0]);
+        break;
+      }
+      case ParsedRtcEventLog::RTCP_EVENT: {
+        PacketDirection direction[2];
+        uint8_t packet[2][IP_PACKET_SIZE];
+        size_t length[2];
+        legacy_log.GetRtcpPacket(i, &direction[0], packet[0], &length[0]);
+        parsed_log_.GetRtcpPacket(i, &direction[1], packet[1], &length[1]);
+        EXPECT_EQ(direction[1], direction[0]);
+        ASSERT_EQ(length[1], length[0]);
+        EXPECT_EQ(memcmp(packet[1], packet[0], length[0]), 0);
+        break;
+      }
+      case ParsedRtcEventLog::AUDIO_PLAYOUT_EVENT: {
+        uint32_t ssrc[2];
+        legacy_log.GetAudioPlayout(i, &ssrc[0]);
+        parsed_log_.GetAudioPlayout(i, &ssrc[1]);
+        EXPECT_EQ(ssrc[1], ssrc[0]);
+        break;
+      }
+      case ParsedRtcEventLog::DELAY_BASED_BWE_UPDATE:
+        EXPECT_EQ(parsed_log_.GetDelayBasedBweUpdate(i).bitrate_bps,
+                  legacy_log.GetDelayBasedBweUpdate(i).bitrate_bps);
+        break;
+      default:
+        ADD_FAILURE() << "Unexpected event type.";
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    RandomSeedsAndEncoders,
+    RtcEventLogEncoderTest,
+    ::testing::Combine(::testing::Values(1, 2, 3, 4, 5), ::testing::Bool()));
 
 }  // namespace webrtc
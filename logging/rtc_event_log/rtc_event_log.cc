@@ -10,6 +10,7 @@
 
 #include "logging/rtc_event_log/rtc_event_log.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <functional>
@@ -19,6 +20,7 @@
 #include <vector>
 
 #include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
 #include "logging/rtc_event_log/events/rtc_event_logging_started.h"
 #include "logging/rtc_event_log/events/rtc_event_logging_stopped.h"
 #include "logging/rtc_event_log/output/rtc_event_log_output_file.h"
@@ -39,6 +41,15 @@ namespace webrtc {
 namespace {
 const int kEventsInHistory = 10000;
 
+// How long events wait to be written to the output with the new format, and
+// how many may wait before they are written regardless.
+const int64_t kNewFormatOutputPeriodMs = 5000;
+const size_t kMaxPendingEvents = 10000;
+// Pending events are encoded and written this many at a time, so that when
+// the output is nearly full, the writes that still fit are made. This is also
+// the number of events the new format encoder puts in one batch.
+const size_t kMaxEventsPerWrite = 1000;
+
 // Observe a limit on the number of concurrent logs, so as not to run into
 // OS-imposed limits on open files and/or threads/task-queues.
 // TODO(eladalon): Known issue - there's a race over |rtc_event_log_count|.
@@ -69,6 +80,8 @@ std::unique_ptr<RtcEventLogEncoder> CreateEncoder(
   switch (type) {
     case RtcEventLog::EncodingType::Legacy:
       return rtc::MakeUnique<RtcEventLogEncoderLegacy>();
+    case RtcEventLog::EncodingType::NewFormat:
+      return rtc::MakeUnique<RtcEventLogEncoderNewFormat>();
     default:
       LOG(LS_ERROR) << "Unknown RtcEventLog encoder type (" << int(type) << ")";
       RTC_NOTREACHED();
@@ -78,7 +91,12 @@ std::unique_ptr<RtcEventLogEncoder> CreateEncoder(
 
 class RtcEventLogImpl final : public RtcEventLog {
  public:
-  explicit RtcEventLogImpl(std::unique_ptr<RtcEventLogEncoder> event_encoder);
+  // If |output_period_ms| is positive, events are written to the output
+  // together, at most that long after they were logged, so that the encoder
+  // can encode them as a batch. Otherwise, each event is written as soon as
+  // it is logged.
+  RtcEventLogImpl(std::unique_ptr<RtcEventLogEncoder> event_encoder,
+                  int64_t output_period_ms);
   ~RtcEventLogImpl() override;
 
   // TODO(eladalon): We should change these name to reflect that what we're
@@ -105,6 +123,10 @@ class RtcEventLogImpl final : public RtcEventLog {
   void LogToOutput(std::unique_ptr<RtcEvent> event) RTC_RUN_ON(&task_queue_);
   void StopOutput() RTC_RUN_ON(&task_queue_);
 
+  // Encodes |pending_| in batches and writes them to the output, in order,
+  // until one doesn't fit, in which case the output is stopped.
+  void WritePendingEvents() RTC_RUN_ON(&task_queue_);
+
   void WriteToOutput(const std::string& output_string) RTC_RUN_ON(&task_queue_);
 
   void StopLoggingInternal() RTC_RUN_ON(&task_queue_);
@@ -120,6 +142,11 @@ class RtcEventLogImpl final : public RtcEventLog {
   // History containing the most recent (non-configuration) events (~10s).
   std::deque<std::unique_ptr<RtcEvent>> history_ RTC_ACCESS_ON(task_queue_);
 
+  // Events waiting to be written to the output as a batch.
+  std::vector<std::unique_ptr<RtcEvent>> pending_ RTC_ACCESS_ON(task_queue_);
+  const int64_t output_period_ms_;
+  bool output_scheduled_ RTC_ACCESS_ON(task_queue_);
+
   size_t max_size_bytes_ RTC_ACCESS_ON(task_queue_);
   size_t written_bytes_ RTC_ACCESS_ON(task_queue_);
 
@@ -134,8 +161,11 @@ class RtcEventLogImpl final : public RtcEventLog {
 };
 
 RtcEventLogImpl::RtcEventLogImpl(
-    std::unique_ptr<RtcEventLogEncoder> event_encoder)
-    : max_size_bytes_(std::numeric_limits<decltype(max_size_bytes_)>::max()),
+    std::unique_ptr<RtcEventLogEncoder> event_encoder,
+    int64_t output_period_ms)
+    : output_period_ms_(output_period_ms),
+      output_scheduled_(false),
+      max_size_bytes_(std::numeric_limits<decltype(max_size_bytes_)>::max()),
       written_bytes_(0),
       event_encoder_(std::move(event_encoder)),
       task_queue_("rtc_event_log") {}
@@ -250,6 +280,22 @@ void RtcEventLogImpl::LogToMemory(std::unique_ptr<RtcEvent> event) {
 void RtcEventLogImpl::LogEventsFromMemoryToOutput() {
   RTC_DCHECK(event_output_ && event_output_->IsActive());
 
+  if (output_period_ms_ > 0) {
+    // As below, the configs are written first, after the start event, so that
+    // they are in the output even if the event queue doesn't fit.
+    for (auto& event : config_history_)
+      pending_.push_back(std::move(event));
+    config_history_.clear();
+    WritePendingEvents();
+    if (!event_output_)
+      return;
+    for (auto& event : history_)
+      pending_.push_back(std::move(event));
+    history_.clear();
+    WritePendingEvents();
+    return;
+  }
+
   std::string output_string;
 
   // Serialize the config information for all old streams, including streams
@@ -285,6 +331,24 @@ void RtcEventLogImpl::LogEventsFromMemoryToOutput() {
 void RtcEventLogImpl::LogToOutput(std::unique_ptr<RtcEvent> event) {
   RTC_DCHECK(event_output_ && event_output_->IsActive());
 
+  if (output_period_ms_ > 0) {
+    pending_.push_back(std::move(event));
+    if (pending_.size() >= kMaxPendingEvents) {
+      WritePendingEvents();
+    } else if (!output_scheduled_) {
+      output_scheduled_ = true;
+      task_queue_.PostDelayedTask(
+          [this]() {
+            RTC_DCHECK_RUN_ON(&task_queue_);
+            output_scheduled_ = false;
+            if (event_output_ && !pending_.empty())
+              WritePendingEvents();
+          },
+          rtc::dchecked_cast<uint32_t>(output_period_ms_));
+    }
+    return;
+  }
+
   std::string output_string;
 
   bool appended = AppendEventToString(*event, &output_string);
@@ -308,6 +372,55 @@ void RtcEventLogImpl::LogToOutput(std::unique_ptr<RtcEvent> event) {
   WriteToOutput(output_string);
 }
 
+void RtcEventLogImpl::WritePendingEvents() {
+  RTC_DCHECK(event_output_ && event_output_->IsActive());
+
+  size_t num_written = 0;
+  std::vector<const RtcEvent*> events;
+  events.reserve(std::min(pending_.size(), kMaxEventsPerWrite));
+  while (event_output_ && num_written < pending_.size()) {
+    const size_t end =
+        std::min(pending_.size(), num_written + kMaxEventsPerWrite);
+    events.clear();
+    for (size_t i = num_written; i < end; ++i)
+      events.push_back(pending_[i].get());
+    const std::string output_string = event_encoder_->EncodeBatch(events);
+    if (written_bytes_ + output_string.size() > max_size_bytes_)
+      break;
+    WriteToOutput(output_string);
+    // A failed write, e.g. because the output is full, closes the output.
+    // The events are then kept for the next output, like those that didn't
+    // fit.
+    if (!event_output_)
+      break;
+    num_written = end;
+  }
+
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    std::unique_ptr<RtcEvent>& event = pending_[i];
+    if (event->IsConfigEvent()) {
+      // Config events need to be kept in memory too, so that they may be
+      // rewritten into future outputs, too.
+      config_history_.push_back(std::move(event));
+    } else if (i >= num_written) {
+      // Keep the events that will not fit into the output, so that they might
+      // be logged into the next output (if any).
+      history_.push_back(std::move(event));
+      if (history_.size() > kEventsInHistory) {
+        history_.pop_front();
+      }
+    }
+  }
+  const bool all_written = num_written == pending_.size();
+  pending_.clear();
+
+  if (event_output_ && !all_written) {
+    // Some events could not be written; the output should be closed, to avoid
+    // gaps.
+    StopOutput();
+  }
+}
+
 void RtcEventLogImpl::StopOutput() {
   max_size_bytes_ = std::numeric_limits<decltype(max_size_bytes_)>::max();
   written_bytes_ = 0;
@@ -315,6 +428,8 @@ void RtcEventLogImpl::StopOutput() {
 }
 
 void RtcEventLogImpl::StopLoggingInternal() {
+  if (event_output_ && !pending_.empty())
+    WritePendingEvents();
   if (event_output_) {
     RTC_DCHECK(event_output_->IsActive());
     event_output_->Write(
@@ -352,7 +467,10 @@ std::unique_ptr<RtcEventLog> RtcEventLog::Create(EncodingType encoding_type) {
     return CreateNull();
   }
   auto encoder = CreateEncoder(encoding_type);
-  return rtc::MakeUnique<RtcEventLogImpl>(std::move(encoder));
+  const int64_t output_period_ms =
+      encoding_type == EncodingType::NewFormat ? kNewFormatOutputPeriodMs : 0;
+  return rtc::MakeUnique<RtcEventLogImpl>(std::move(encoder),
+                                          output_period_ms);
 #else
   return CreateNull();
 #endif  // ENABLE_RTC_EVENT_LOG
@@ -27,10 +27,11 @@ class RtcEventLog {
  public:
   enum : size_t { kUnlimitedOutput = 0 };
 
-  // TODO(eladalon): Two stages are upcoming.
-  // 1. Extend this to actually support the new encoding.
-  // 2. Get rid of the legacy encoding, allowing us to get rid of this enum.
-  enum class EncodingType { Legacy };
+  // NewFormat encodes events in delta-encoded batches, which are written to
+  // the output every few seconds rather than as each event is logged.
+  // TODO(eladalon): Get rid of the legacy encoding, allowing us to get rid of
+  // this enum.
+  enum class EncodingType { Legacy, NewFormat };
 
   virtual ~RtcEventLog() {}
 
@@ -389,231 +389,213 @@ int main(int argc, char* argv[]) {
   webrtc::RtpHeaderExtensionMap default_map = GetDefaultHeaderExtensionMap();
   bool default_map_used = false;
 
+  // The log is read a chunk of events at a time, so that it doesn't have to
+  // fit in memory.
+  const size_t kEventsPerChunk = 10000;
   webrtc::ParsedRtcEventLog parsed_stream;
-  if (!parsed_stream.ParseFile(input_file)) {
+  if (!parsed_stream.StartStreamingFile(input_file)) {
     std::cerr << "Error while parsing input file: " << input_file << std::endl;
     return -1;
   }
 
-  for (size_t i = 0; i < parsed_stream.GetNumberOfEvents(); i++) {
-    bool event_recognized = false;
-    switch (parsed_stream.GetEventType(i)) {
-      case webrtc::ParsedRtcEventLog::UNKNOWN_EVENT: {
-        if (FLAG_unknown) {
-          std::cout << parsed_stream.GetTimestamp(i) << "\tUNKNOWN_EVENT"
-                    << std::endl;
+  while (parsed_stream.ParseNextEvents(kEventsPerChunk)) {
+    for (size_t i = 0; i < parsed_stream.GetNumberOfEvents(); i++) {
+      bool event_recognized = false;
+      switch (parsed_stream.GetEventType(i)) {
+        case webrtc::ParsedRtcEventLog::UNKNOWN_EVENT: {
+          if (FLAG_unknown) {
+            std::cout << parsed_stream.GetTimestamp(i) << "\tUNKNOWN_EVENT"
+                      << std::endl;
+          }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::LOG_START: {
-        if (FLAG_startstop) {
-          std::cout << parsed_stream.GetTimestamp(i) << "\tLOG_START"
-                    << std::endl;
+        case webrtc::ParsedRtcEventLog::LOG_START: {
+          if (FLAG_startstop) {
+            std::cout << parsed_stream.GetTimestamp(i) << "\tLOG_START"
+                      << std::endl;
+          }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::LOG_END: {
-        if (FLAG_startstop) {
-          std::cout << parsed_stream.GetTimestamp(i) << "\tLOG_END"
-                    << std::endl;
+        case webrtc::ParsedRtcEventLog::LOG_END: {
+          if (FLAG_startstop) {
+            std::cout << parsed_stream.GetTimestamp(i) << "\tLOG_END"
+                      << std::endl;
+          }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::RTP_EVENT: {
-        if (FLAG_rtp) {
-          size_t header_length;
-          size_t total_length;
-          uint8_t header[IP_PACKET_SIZE];
-          webrtc::PacketDirection direction;
-          webrtc::RtpHeaderExtensionMap* extension_map =
-              parsed_stream.GetRtpHeader(i, &direction, header, &header_length,
-                                         &total_length, nullptr);
-
-          if (extension_map == nullptr) {
-            extension_map = &default_map;
-            if (!default_map_used)
-              LOG(LS_WARNING) << "Using default header extension map";
-            default_map_used = true;
-          }
+        case webrtc::ParsedRtcEventLog::RTP_EVENT: {
+          if (FLAG_rtp) {
+            size_t header_length;
+            size_t total_length;
+            uint8_t header[IP_PACKET_SIZE];
+            webrtc::PacketDirection direction;
+            webrtc::RtpHeaderExtensionMap* extension_map =
+                parsed_stream.GetRtpHeader(i, &direction, header,
+                                           &header_length, &total_length,
+                                           nullptr);
+
+            if (extension_map == nullptr) {
+              extension_map = &default_map;
+              if (!default_map_used)
+                LOG(LS_WARNING) << "Using default header extension map";
+              default_map_used = true;
+            }
 
-          // Parse header to get SSRC and RTP time.
-          webrtc::RtpUtility::RtpHeaderParser rtp_parser(header, header_length);
-          webrtc::RTPHeader parsed_header;
-          rtp_parser.Parse(&parsed_header, extension_map);
-          MediaType media_type =
-              parsed_stream.GetMediaType(parsed_header.ssrc, direction);
+            // Parse header to get SSRC and RTP time.
+            webrtc::RtpUtility::RtpHeaderParser rtp_parser(header,
+                                                           header_length);
+            webrtc::RTPHeader parsed_header;
+            rtp_parser.Parse(&parsed_header, extension_map);
+            MediaType media_type =
+                parsed_stream.GetMediaType(parsed_header.ssrc, direction);
 
-          if (ExcludePacket(direction, media_type, parsed_header.ssrc)) {
-            event_recognized = true;
-            break;
-          }
+            if (ExcludePacket(direction, media_type, parsed_header.ssrc)) {
+              event_recognized = true;
+              break;
+            }
 
-          std::cout << parsed_stream.GetTimestamp(i) << "\tRTP"
-                    << StreamInfo(direction, media_type)
-                    << "\tssrc=" << parsed_header.ssrc
-                    << "\ttimestamp=" << parsed_header.timestamp;
-          if (parsed_header.extension.hasAbsoluteSendTime) {
-            std::cout << "\tAbsSendTime="
-                      << parsed_header.extension.absoluteSendTime;
-          }
-          if (parsed_header.extension.hasVideoContentType) {
-            std::cout << "\tContentType="
-                      << static_cast<int>(
-                             parsed_header.extension.videoContentType);
-          }
-          if (parsed_header.extension.hasVideoRotation) {
-            std::cout << "\tRotation="
-                      << static_cast<int>(
-                             parsed_header.extension.videoRotation);
-          }
-          if (parsed_header.extension.hasTransportSequenceNumber) {
-            std::cout << "\tTransportSeq="
-                      << parsed_header.extension.transportSequenceNumber;
-          }
-          if (parsed_header.extension.hasTransmissionTimeOffset) {
-            std::cout << "\tTransmTimeOffset="
-                      << parsed_header.extension.transmissionTimeOffset;
-          }
-          if (parsed_header.extension.hasAudioLevel) {
-            std::cout << "\tAudioLevel=" << parsed_header.extension.audioLevel;
+            std::cout << parsed_stream.GetTimestamp(i) << "\tRTP"
+                      << StreamInfo(direction, media_type)
+                      << "\tssrc=" << parsed_header.ssrc
+                      << "\ttimestamp=" << parsed_header.timestamp;
+            if (parsed_header.extension.hasAbsoluteSendTime) {
+              std::cout << "\tAbsSendTime="
+                        << parsed_header.extension.absoluteSendTime;
+            }
+            if (parsed_header.extension.hasVideoContentType) {
+              std::cout << "\tContentType="
+                        << static_cast<int>(
+                               parsed_header.extension.videoContentType);
+            }
+            if (parsed_header.extension.hasVideoRotation) {
+              std::cout << "\tRotation="
+                        << static_cast<int>(
+                               parsed_header.extension.videoRotation);
+            }
+            if (parsed_header.extension.hasTransportSequenceNumber) {
+              std::cout << "\tTransportSeq="
+                        << parsed_header.extension.transportSequenceNumber;
+            }
+            if (parsed_header.extension.hasTransmissionTimeOffset) {
+              std::cout << "\tTransmTimeOffset="
+                        << parsed_header.extension.transmissionTimeOffset;
+            }
+            if (parsed_header.extension.hasAudioLevel) {
+              std::cout << "\tAudioLevel="
+                        << parsed_header.extension.audioLevel;
+            }
+            std::cout << std::endl;
           }
-          std::cout << std::endl;
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::RTCP_EVENT: {
-        if (FLAG_rtcp) {
-          size_t length;
-          uint8_t packet[IP_PACKET_SIZE];
-          webrtc::PacketDirection direction;
-          parsed_stream.GetRtcpPacket(i, &direction, packet, &length);
-
-          webrtc::rtcp::CommonHeader rtcp_block;
-          const uint8_t* packet_end = packet + length;
-          for (const uint8_t* next_block = packet; next_block != packet_end;
-               next_block = rtcp_block.NextPacket()) {
-            ptrdiff_t remaining_blocks_size = packet_end - next_block;
-            RTC_DCHECK_GT(remaining_blocks_size, 0);
-            if (!rtcp_block.Parse(next_block, remaining_blocks_size)) {
-              break;
-            }
-
-            uint64_t log_timestamp = parsed_stream.GetTimestamp(i);
-            switch (rtcp_block.type()) {
-              case webrtc::rtcp::SenderReport::kPacketType:
-                PrintSenderReport(parsed_stream, rtcp_block, log_timestamp,
-                                  direction);
+        case webrtc::ParsedRtcEventLog::RTCP_EVENT: {
+          if (FLAG_rtcp) {
+            size_t length;
+            uint8_t packet[IP_PACKET_SIZE];
+            webrtc::PacketDirection direction;
+            parsed_stream.GetRtcpPacket(i, &direction, packet, &length);
+
+            webrtc::rtcp::CommonHeader rtcp_block;
+            const uint8_t* packet_end = packet + length;
+            for (const uint8_t* next_block = packet; next_block != packet_end;
+                 next_block = rtcp_block.NextPacket()) {
+              ptrdiff_t remaining_blocks_size = packet_end - next_block;
+              RTC_DCHECK_GT(remaining_blocks_size, 0);
+              if (!rtcp_block.Parse(next_block, remaining_blocks_size)) {
                 break;
-              case webrtc::rtcp::ReceiverReport::kPacketType:
-                PrintReceiverReport(parsed_stream, rtcp_block, log_timestamp,
+              }
+
+              uint64_t log_timestamp = parsed_stream.GetTimestamp(i);
+              switch (rtcp_block.type()) {
+                case webrtc::rtcp::SenderReport::kPacketType:
+                  PrintSenderReport(parsed_stream, rtcp_block, log_timestamp,
                                     direction);
-                break;
-              case webrtc::rtcp::Sdes::kPacketType:
-                PrintSdes(rtcp_block, log_timestamp, direction);
-                break;
-              case webrtc::rtcp::ExtendedReports::kPacketType:
-                PrintXr(parsed_stream, rtcp_block, log_timestamp, direction);
-                break;
-              case webrtc::rtcp::Bye::kPacketType:
-                PrintBye(parsed_stream, rtcp_block, log_timestamp, direction);
-                break;
-              case webrtc::rtcp::Rtpfb::kPacketType:
-                PrintRtpFeedback(parsed_stream, rtcp_block, log_timestamp,
-                                 direction);
-                break;
-              case webrtc::rtcp::Psfb::kPacketType:
-                PrintPsFeedback(parsed_stream, rtcp_block, log_timestamp,
-                                direction);
-                break;
-              default:
-                break;
+                  break;
+                case webrtc::rtcp::ReceiverReport::kPacketType:
+                  PrintReceiverReport(parsed_stream, rtcp_block, log_timestamp,
+                                      direction);
+                  break;
+                case webrtc::rtcp::Sdes::kPacketType:
+                  PrintSdes(rtcp_block, log_timestamp, direction);
+                  break;
+                case webrtc::rtcp::ExtendedReports::kPacketType:
+                  PrintXr(parsed_stream, rtcp_block, log_timestamp, direction);
+                  break;
+                case webrtc::rtcp::Bye::kPacketType:
+                  PrintBye(parsed_stream, rtcp_block, log_timestamp, direction);
+                  break;
+                case webrtc::rtcp::Rtpfb::kPacketType:
+                  PrintRtpFeedback(parsed_stream, rtcp_block, log_timestamp,
+                                   direction);
+                  break;
+                case webrtc::rtcp::Psfb::kPacketType:
+                  PrintPsFeedback(parsed_stream, rtcp_block, log_timestamp,
+                                  direction);
+                  break;
+                default:
+                  break;
+              }
             }
           }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
-
-      case webrtc::ParsedRtcEventLog::AUDIO_PLAYOUT_EVENT: {
-        if (FLAG_playout) {
-          uint32_t ssrc;
-          parsed_stream.GetAudioPlayout(i, &ssrc);
-          std::cout << parsed_stream.GetTimestamp(i) << "\tAUDIO_PLAYOUT"
-                    << "\tssrc=" << ssrc << std::endl;
-        }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::LOSS_BASED_BWE_UPDATE: {
-        if (FLAG_bwe) {
-          int32_t bitrate_bps;
-          uint8_t fraction_loss;
-          int32_t total_packets;
-          parsed_stream.GetLossBasedBweUpdate(i, &bitrate_bps, &fraction_loss,
-                                              &total_packets);
-          std::cout << parsed_stream.GetTimestamp(i) << "\tBWE(LOSS_BASED)"
-                    << "\tbitrate_bps=" << bitrate_bps
-                    << "\tfraction_loss=" << fraction_loss
-                    << "\ttotal_packets=" << total_packets << std::endl;
+        case webrtc::ParsedRtcEventLog::AUDIO_PLAYOUT_EVENT: {
+          if (FLAG_playout) {
+            uint32_t ssrc;
+            parsed_stream.GetAudioPlayout(i, &ssrc);
+            std::cout << parsed_stream.GetTimestamp(i) << "\tAUDIO_PLAYOUT"
+                      << "\tssrc=" << ssrc << std::endl;
+          }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::DELAY_BASED_BWE_UPDATE: {
-        if (FLAG_bwe) {
-          auto bwe_update = parsed_stream.GetDelayBasedBweUpdate(i);
-          std::cout << parsed_stream.GetTimestamp(i) << "\tBWE(DELAY_BASED)"
-                    << "\tbitrate_bps=" << bwe_update.bitrate_bps
-                    << "\tdetector_state="
-                    << static_cast<int>(bwe_update.detector_state) << std::endl;
+        case webrtc::ParsedRtcEventLog::LOSS_BASED_BWE_UPDATE: {
+          if (FLAG_bwe) {
+            int32_t bitrate_bps;
+            uint8_t fraction_loss;
+            int32_t total_packets;
+            parsed_stream.GetLossBasedBweUpdate(i, &bitrate_bps, &fraction_loss,
+                                                &total_packets);
+            std::cout << parsed_stream.GetTimestamp(i) << "\tBWE(LOSS_BASED)"
+                      << "\tbitrate_bps=" << bitrate_bps
+                      << "\tfraction_loss=" << fraction_loss
+                      << "\ttotal_packets=" << total_packets << std::endl;
+          }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::VIDEO_RECEIVER_CONFIG_EVENT: {
-        if (FLAG_config && FLAG_video && FLAG_incoming) {
-          webrtc::rtclog::StreamConfig config =
-              parsed_stream.GetVideoReceiveConfig(i);
-          std::cout << parsed_stream.GetTimestamp(i) << "\tVIDEO_RECV_CONFIG"
-                    << "\tssrc=" << config.remote_ssrc
-                    << "\tfeedback_ssrc=" << config.local_ssrc;
-          std::cout << "\textensions={";
-          for (const auto& extension : config.rtp_extensions) {
-            std::cout << extension.ToString() << ",";
-          }
-          std::cout << "}";
-          std::cout << "\tcodecs={";
-          for (const auto& codec : config.codecs) {
-            std::cout << "{name: " << codec.payload_name
-                      << ", payload_type: " << codec.payload_type
-                      << ", rtx_payload_type: " << codec.rtx_payload_type
-                      << "}";
+        case webrtc::ParsedRtcEventLog::DELAY_BASED_BWE_UPDATE: {
+          if (FLAG_bwe) {
+            auto bwe_update = parsed_stream.GetDelayBasedBweUpdate(i);
+            std::cout << parsed_stream.GetTimestamp(i) << "\tBWE(DELAY_BASED)"
+                      << "\tbitrate_bps=" << bwe_update.bitrate_bps
+                      << "\tdetector_state="
+                      << static_cast<int>(bwe_update.detector_state)
+                      << std::endl;
           }
-          std::cout << "}" << std::endl;
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::VIDEO_SENDER_CONFIG_EVENT: {
-        if (FLAG_config && FLAG_video && FLAG_outgoing) {
-          std::vector<webrtc::rtclog::StreamConfig> configs =
-              parsed_stream.GetVideoSendConfig(i);
-          for (const auto& config : configs) {
-            std::cout << parsed_stream.GetTimestamp(i) << "\tVIDEO_SEND_CONFIG";
-            std::cout << "\tssrcs=" << config.local_ssrc;
-            std::cout << "\trtx_ssrcs=" << config.rtx_ssrc;
+        case webrtc::ParsedRtcEventLog::VIDEO_RECEIVER_CONFIG_EVENT: {
+          if (FLAG_config && FLAG_video && FLAG_incoming) {
+            webrtc::rtclog::StreamConfig config =
+                parsed_stream.GetVideoReceiveConfig(i);
+            std::cout << parsed_stream.GetTimestamp(i) << "\tVIDEO_RECV_CONFIG"
+                      << "\tssrc=" << config.remote_ssrc
+                      << "\tfeedback_ssrc=" << config.local_ssrc;
             std::cout << "\textensions={";
             for (const auto& extension : config.rtp_extensions) {
               std::cout << extension.ToString() << ",";
@@ -628,131 +610,163 @@ int main(int argc, char* argv[]) {
             }
             std::cout << "}" << std::endl;
           }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::AUDIO_RECEIVER_CONFIG_EVENT: {
-        if (FLAG_config && FLAG_audio && FLAG_incoming) {
-          webrtc::rtclog::StreamConfig config =
-              parsed_stream.GetAudioReceiveConfig(i);
-          std::cout << parsed_stream.GetTimestamp(i) << "\tAUDIO_RECV_CONFIG"
-                    << "\tssrc=" << config.remote_ssrc
-                    << "\tfeedback_ssrc=" << config.local_ssrc;
-          std::cout << "\textensions={";
-          for (const auto& extension : config.rtp_extensions) {
-            std::cout << extension.ToString() << ",";
-          }
-          std::cout << "}";
-          std::cout << "\tcodecs={";
-          for (const auto& codec : config.codecs) {
-            std::cout << "{name: " << codec.payload_name
-                      << ", payload_type: " << codec.payload_type
-                      << ", rtx_payload_type: " << codec.rtx_payload_type
-                      << "}";
+        case webrtc::ParsedRtcEventLog::VIDEO_SENDER_CONFIG_EVENT: {
+          if (FLAG_config && FLAG_video && FLAG_outgoing) {
+            std::vector<webrtc::rtclog::StreamConfig> configs =
+                parsed_stream.GetVideoSendConfig(i);
+            for (const auto& config : configs) {
+              std::cout << parsed_stream.GetTimestamp(i)
+                        << "\tVIDEO_SEND_CONFIG";
+              std::cout << "\tssrcs=" << config.local_ssrc;
+              std::cout << "\trtx_ssrcs=" << config.rtx_ssrc;
+              std::cout << "\textensions={";
+              for (const auto& extension : config.rtp_extensions) {
+                std::cout << extension.ToString() << ",";
+              }
+              std::cout << "}";
+              std::cout << "\tcodecs={";
+              for (const auto& codec : config.codecs) {
+                std::cout << "{name: " << codec.payload_name
+                          << ", payload_type: " << codec.payload_type
+                          << ", rtx_payload_type: " << codec.rtx_payload_type
+                          << "}";
+              }
+              std::cout << "}" << std::endl;
+            }
           }
-          std::cout << "}" << std::endl;
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::AUDIO_SENDER_CONFIG_EVENT: {
-        if (FLAG_config && FLAG_audio && FLAG_outgoing) {
-          webrtc::rtclog::StreamConfig config =
-              parsed_stream.GetAudioSendConfig(i);
-          std::cout << parsed_stream.GetTimestamp(i) << "\tAUDIO_SEND_CONFIG"
-                    << "\tssrc=" << config.local_ssrc;
-          std::cout << "\textensions={";
-          for (const auto& extension : config.rtp_extensions) {
-            std::cout << extension.ToString() << ",";
-          }
-          std::cout << "}";
-          std::cout << "\tcodecs={";
-          for (const auto& codec : config.codecs) {
-            std::cout << "{name: " << codec.payload_name
-                      << ", payload_type: " << codec.payload_type
-                      << ", rtx_payload_type: " << codec.rtx_payload_type
-                      << "}";
+        case webrtc::ParsedRtcEventLog::AUDIO_RECEIVER_CONFIG_EVENT: {
+          if (FLAG_config && FLAG_audio && FLAG_incoming) {
+            webrtc::rtclog::StreamConfig config =
+                parsed_stream.GetAudioReceiveConfig(i);
+            std::cout << parsed_stream.GetTimestamp(i) << "\tAUDIO_RECV_CONFIG"
+                      << "\tssrc=" << config.remote_ssrc
+                      << "\tfeedback_ssrc=" << config.local_ssrc;
+            std::cout << "\textensions={";
+            for (const auto& extension : config.rtp_extensions) {
+              std::cout << extension.ToString() << ",";
+            }
+            std::cout << "}";
+            std::cout << "\tcodecs={";
+            for (const auto& codec : config.codecs) {
+              std::cout << "{name: " << codec.payload_name
+                        << ", payload_type: " << codec.payload_type
+                        << ", rtx_payload_type: " << codec.rtx_payload_type
+                        << "}";
+            }
+            std::cout << "}" << std::endl;
           }
-          std::cout << "}" << std::endl;
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::AUDIO_NETWORK_ADAPTATION_EVENT: {
-        if (FLAG_ana) {
-          webrtc::AudioEncoderRuntimeConfig ana_config;
-          parsed_stream.GetAudioNetworkAdaptation(i, &ana_config);
-          std::stringstream ss;
-          ss << parsed_stream.GetTimestamp(i) << "\tANA_UPDATE";
-          if (ana_config.bitrate_bps) {
-            ss << "\tbitrate_bps=" << *ana_config.bitrate_bps;
-          }
-          if (ana_config.frame_length_ms) {
-            ss << "\tframe_length_ms=" << *ana_config.frame_length_ms;
-          }
-          if (ana_config.uplink_packet_loss_fraction) {
-            ss << "\tuplink_packet_loss_fraction="
-               << *ana_config.uplink_packet_loss_fraction;
-          }
-          if (ana_config.enable_fec) {
-            ss << "\tenable_fec=" << *ana_config.enable_fec;
-          }
-          if (ana_config.enable_dtx) {
-            ss << "\tenable_dtx=" << *ana_config.enable_dtx;
+        case webrtc::ParsedRtcEventLog::AUDIO_SENDER_CONFIG_EVENT: {
+          if (FLAG_config && FLAG_audio && FLAG_outgoing) {
+            webrtc::rtclog::StreamConfig config =
+                parsed_stream.GetAudioSendConfig(i);
+            std::cout << parsed_stream.GetTimestamp(i) << "\tAUDIO_SEND_CONFIG"
+                      << "\tssrc=" << config.local_ssrc;
+            std::cout << "\textensions={";
+            for (const auto& extension : config.rtp_extensions) {
+              std::cout << extension.ToString() << ",";
+            }
+            std::cout << "}";
+            std::cout << "\tcodecs={";
+            for (const auto& codec : config.codecs) {
+              std::cout << "{name: " << codec.payload_name
+                        << ", payload_type: " << codec.payload_type
+                        << ", rtx_payload_type: " << codec.rtx_payload_type
+                        << "}";
+            }
+            std::cout << "}" << std::endl;
           }
-          if (ana_config.num_channels) {
-            ss << "\tnum_channels=" << *ana_config.num_channels;
+          event_recognized = true;
+          break;
+        }
+
+        case webrtc::ParsedRtcEventLog::AUDIO_NETWORK_ADAPTATION_EVENT: {
+          if (FLAG_ana) {
+            webrtc::AudioEncoderRuntimeConfig ana_config;
+            parsed_stream.GetAudioNetworkAdaptation(i, &ana_config);
+            std::stringstream ss;
+            ss << parsed_stream.GetTimestamp(i) << "\tANA_UPDATE";
+            if (ana_config.bitrate_bps) {
+              ss << "\tbitrate_bps=" << *ana_config.bitrate_bps;
+            }
+            if (ana_config.frame_length_ms) {
+              ss << "\tframe_length_ms=" << *ana_config.frame_length_ms;
+            }
+            if (ana_config.uplink_packet_loss_fraction) {
+              ss << "\tuplink_packet_loss_fraction="
+                 << *ana_config.uplink_packet_loss_fraction;
+            }
+            if (ana_config.enable_fec) {
+              ss << "\tenable_fec=" << *ana_config.enable_fec;
+            }
+            if (ana_config.enable_dtx) {
+              ss << "\tenable_dtx=" << *ana_config.enable_dtx;
+            }
+            if (ana_config.num_channels) {
+              ss << "\tnum_channels=" << *ana_config.num_channels;
+            }
+            std::cout << ss.str() << std::endl;
           }
-          std::cout << ss.str() << std::endl;
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::BWE_PROBE_CLUSTER_CREATED_EVENT: {
-        if (FLAG_probe) {
-          webrtc::ParsedRtcEventLog::BweProbeClusterCreatedEvent probe_event =
-              parsed_stream.GetBweProbeClusterCreated(i);
-          std::cout << parsed_stream.GetTimestamp(i) << "\tPROBE_CREATED("
-                    << probe_event.id << ")"
-                    << "\tbitrate_bps=" << probe_event.bitrate_bps
-                    << "\tmin_packets=" << probe_event.min_packets
-                    << "\tmin_bytes=" << probe_event.min_bytes << std::endl;
+        case webrtc::ParsedRtcEventLog::BWE_PROBE_CLUSTER_CREATED_EVENT: {
+          if (FLAG_probe) {
+            webrtc::ParsedRtcEventLog::BweProbeClusterCreatedEvent probe_event =
+                parsed_stream.GetBweProbeClusterCreated(i);
+            std::cout << parsed_stream.GetTimestamp(i) << "\tPROBE_CREATED("
+                      << probe_event.id << ")"
+                      << "\tbitrate_bps=" << probe_event.bitrate_bps
+                      << "\tmin_packets=" << probe_event.min_packets
+                      << "\tmin_bytes=" << probe_event.min_bytes << std::endl;
+          }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
-      }
 
-      case webrtc::ParsedRtcEventLog::BWE_PROBE_RESULT_EVENT: {
-        if (FLAG_probe) {
-          webrtc::ParsedRtcEventLog::BweProbeResultEvent probe_result =
-              parsed_stream.GetBweProbeResult(i);
-          if (probe_result.failure_reason) {
-            std::cout << parsed_stream.GetTimestamp(i) << "\tPROBE_SUCCESS("
-                      << probe_result.id << ")"
-                      << "\tfailure_reason="
-                      << static_cast<int>(*probe_result.failure_reason)
-                      << std::endl;
-          } else {
-            std::cout << parsed_stream.GetTimestamp(i) << "\tPROBE_SUCCESS("
-                      << probe_result.id << ")"
-                      << "\tbitrate_bps=" << *probe_result.bitrate_bps
-                      << std::endl;
+        case webrtc::ParsedRtcEventLog::BWE_PROBE_RESULT_EVENT: {
+          if (FLAG_probe) {
+            webrtc::ParsedRtcEventLog::BweProbeResultEvent probe_result =
+                parsed_stream.GetBweProbeResult(i);
+            if (probe_result.failure_reason) {
+              std::cout << parsed_stream.GetTimestamp(i) << "\tPROBE_SUCCESS("
+                        << probe_result.id << ")"
+                        << "\tfailure_reason="
+                        << static_cast<int>(*probe_result.failure_reason)
+                        << std::endl;
+            } else {
+              std::cout << parsed_stream.GetTimestamp(i) << "\tPROBE_SUCCESS("
+                        << probe_result.id << ")"
+                        << "\tbitrate_bps=" << *probe_result.bitrate_bps
+                        << std::endl;
+            }
           }
+          event_recognized = true;
+          break;
         }
-        event_recognized = true;
-        break;
       }
-    }
 
-    if (!event_recognized) {
-      std::cout << "Unrecognized event (" << parsed_stream.GetEventType(i)
-                << ")" << std::endl;
+      if (!event_recognized) {
+        std::cout << "Unrecognized event (" << parsed_stream.GetEventType(i)
+                  << ")" << std::endl;
+      }
     }
   }
+  if (parsed_stream.StreamingFailed()) {
+    std::cerr << "Error while parsing input file: " << input_file << std::endl;
+    return -1;
+  }
   return 0;
 }
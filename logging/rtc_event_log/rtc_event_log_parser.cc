@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <fstream>
 #include <istream>
+#include <limits>
 #include <map>
 #include <utility>
 
@@ -23,6 +24,7 @@
 #include "modules/audio_coding/audio_network_adaptor/include/audio_network_adaptor.h"
 #include "modules/remote_bitrate_estimator/include/bwe_defines.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/protobuf_utils.h"
@@ -113,6 +115,249 @@ std::pair<uint64_t, bool> ParseVarInt(std::istream& stream) {
   return std::make_pair(varint, false);
 }
 
+// Decodes a delta-encoded column of |size| values into |values|.
+bool DecodeColumn(const google::protobuf::RepeatedField<int64_t>& column,
+                  size_t size,
+                  std::vector<int64_t>* values) {
+  values->clear();
+  if (column.empty()) {
+    values->resize(size, 0);
+    return true;
+  }
+  if (static_cast<size_t>(column.size()) != size)
+    return false;
+  values->reserve(size);
+  int64_t value = 0;
+  for (int64_t delta : column) {
+    value += delta;
+    values->push_back(value);
+  }
+  return true;
+}
+
+bool InRange(const std::vector<int64_t>& values, int64_t min, int64_t max) {
+  return std::all_of(values.begin(), values.end(), [=](int64_t value) {
+    return value >= min && value <= max;
+  });
+}
+
+// The decoded columns of an rtclog::RtpPacketBatch.
+struct RtpPacketColumns {
+  bool Decode(const rtclog::RtpPacketBatch& rtp_packets) {
+    const size_t size = rtp_packets.number_of_packets();
+    if (!DecodeColumn(rtp_packets.timestamp_us(), size, &timestamp_us) ||
+        !DecodeColumn(rtp_packets.sequence_number(), size, &sequence_number) ||
+        !DecodeColumn(rtp_packets.rtp_timestamp(), size, &rtp_timestamp) ||
+        !DecodeColumn(rtp_packets.header_flags(), size, &header_flags) ||
+        !DecodeColumn(rtp_packets.packet_length(), size, &packet_length) ||
+        !DecodeColumn(rtp_packets.header_tail_length(), size,
+                      &header_tail_length) ||
+        !DecodeColumn(rtp_packets.probe_cluster_id(), size,
+                      &probe_cluster_id)) {
+      return false;
+    }
+    const int64_t kMaxUint16 = std::numeric_limits<uint16_t>::max();
+    const int64_t kMaxUint32 = std::numeric_limits<uint32_t>::max();
+    if (!InRange(sequence_number, 0, kMaxUint16) ||
+        !InRange(rtp_timestamp, 0, kMaxUint32) ||
+        !InRange(header_flags, 0, kMaxUint16) ||
+        !InRange(packet_length, 0, kMaxUint32) ||
+        !InRange(header_tail_length, 0, kMaxUint32) ||
+        !InRange(probe_cluster_id, 0, kMaxUint32 + 1)) {
+      return false;
+    }
+    if (!rtp_packets.ssrcs().empty() &&
+        static_cast<size_t>(rtp_packets.ssrcs_size()) != size) {
+      return false;
+    }
+    uint64_t total_tail_length = 0;
+    for (int64_t length : header_tail_length)
+      total_tail_length += length;
+    return total_tail_length == rtp_packets.header_tails().size();
+  }
+
+  std::vector<int64_t> timestamp_us;
+  std::vector<int64_t> sequence_number;
+  std::vector<int64_t> rtp_timestamp;
+  std::vector<int64_t> header_flags;
+  std::vector<int64_t> packet_length;
+  std::vector<int64_t> header_tail_length;
+  std::vector<int64_t> probe_cluster_id;
+  // The index of the next packet, and where its header tail starts.
+  size_t next_packet = 0;
+  size_t next_header_tail = 0;
+};
+
+// Appends the events of |batch| to |events| in the order they were logged, as
+// the legacy format would have stored them.
+bool ExpandEventBatch(const rtclog::EventBatch& batch,
+                      std::vector<rtclog::Event>* events) {
+  const size_t kFixedRtpHeaderSize = 12;
+  std::vector<RtpPacketColumns> rtp_columns(batch.rtp_packets_size());
+  for (int i = 0; i < batch.rtp_packets_size(); ++i) {
+    if (!rtp_columns[i].Decode(batch.rtp_packets(i)))
+      return false;
+  }
+  std::vector<std::vector<int64_t>> playout_timestamps_us(
+      batch.audio_playouts_size());
+  std::vector<size_t> next_playout(batch.audio_playouts_size(), 0);
+  for (int i = 0; i < batch.audio_playouts_size(); ++i) {
+    const rtclog::AudioPlayoutBatch& audio_playouts = batch.audio_playouts(i);
+    if (!DecodeColumn(audio_playouts.timestamp_us(),
+                      audio_playouts.number_of_events(),
+                      &playout_timestamps_us[i])) {
+      return false;
+    }
+    if (!audio_playouts.local_ssrcs().empty() &&
+        static_cast<size_t>(audio_playouts.local_ssrcs_size()) !=
+            audio_playouts.number_of_events()) {
+      return false;
+    }
+  }
+
+  const size_t first_playout_location = 1 + batch.rtp_packets_size();
+  int next_event = 0;
+  for (uint32_t location : batch.order()) {
+    if (location == 0) {
+      if (next_event == batch.events_size())
+        return false;
+      events->push_back(batch.events(next_event++));
+    } else if (location < first_playout_location) {
+      const rtclog::RtpPacketBatch& rtp_packets =
+          batch.rtp_packets(location - 1);
+      RtpPacketColumns& columns = rtp_columns[location - 1];
+      const size_t i = columns.next_packet++;
+      if (i == columns.timestamp_us.size())
+        return false;
+      uint8_t header[kFixedRtpHeaderSize];
+      ByteWriter<uint16_t>::WriteBigEndian(&header[0],
+                                           columns.header_flags[i]);
+      ByteWriter<uint16_t>::WriteBigEndian(&header[2],
+                                           columns.sequence_number[i]);
+      ByteWriter<uint32_t>::WriteBigEndian(&header[4],
+                                           columns.rtp_timestamp[i]);
+      ByteWriter<uint32_t>::WriteBigEndian(
+          &header[8], rtp_packets.ssrcs().empty() ? rtp_packets.ssrc()
+                                                  : rtp_packets.ssrcs(i));
+      const size_t header_tail_length = columns.header_tail_length[i];
+      std::string header_bytes(reinterpret_cast<const char*>(header),
+                               kFixedRtpHeaderSize);
+      header_bytes.append(rtp_packets.header_tails(),
+                          columns.next_header_tail, header_tail_length);
+      columns.next_header_tail += header_tail_length;
+
+      events->emplace_back();
+      rtclog::Event& event = events->back();
+      event.set_timestamp_us(columns.timestamp_us[i]);
+      event.set_type(rtclog::Event::RTP_EVENT);
+      rtclog::RtpPacket* rtp_packet = event.mutable_rtp_packet();
+      rtp_packet->set_incoming(rtp_packets.incoming());
+      rtp_packet->set_packet_length(columns.packet_length[i]);
+      rtp_packet->set_header(std::move(header_bytes));
+      if (columns.probe_cluster_id[i] != 0)
+        rtp_packet->set_probe_cluster_id(columns.probe_cluster_id[i] - 1);
+    } else if (location - first_playout_location <
+               playout_timestamps_us.size()) {
+      const size_t stream = location - first_playout_location;
+      const size_t i = next_playout[stream]++;
+      if (i == playout_timestamps_us[stream].size())
+        return false;
+      events->emplace_back();
+      rtclog::Event& event = events->back();
+      event.set_timestamp_us(playout_timestamps_us[stream][i]);
+      event.set_type(rtclog::Event::AUDIO_PLAYOUT_EVENT);
+      const rtclog::AudioPlayoutBatch& audio_playouts =
+          batch.audio_playouts(stream);
+      event.mutable_audio_playout_event()->set_local_ssrc(
+          audio_playouts.local_ssrcs().empty() ? audio_playouts.local_ssrc()
+                                               : audio_playouts.local_ssrcs(i));
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+enum class ReadResult { kEvent, kEndOfLog, kError };
+
+// Reads the next event of |stream|, or all events of the next batch, and
+// appends them to |events|, using |buffer| for their serialized form. Nothing
+// is appended on error.
+ReadResult ReadEvents(std::istream& stream,
+                      std::vector<char>* buffer,
+                      std::vector<rtclog::Event>* events) {
+  const size_t kMaxEventSize = (1u << 16) - 1;
+  // Room for a thousand events of the maximal size.
+  const size_t kMaxEventBatchSize = 1u << 26;
+  uint64_t tag;
+  uint64_t message_length;
+  bool success;
+
+  // Check whether we have reached end of file.
+  stream.peek();
+  if (stream.eof())
+    return ReadResult::kEndOfLog;
+
+  // Read the next message tag. The tag number is defined as
+  // (fieldnumber << 3) | wire_type. In our case, the field number is
+  // supposed to be 1 for a single event or 2 for a batch, and the wire type
+  // for an length-delimited field is 2.
+  const uint64_t kEventTag = (1 << 3) | 2;
+  const uint64_t kEventBatchTag = (2 << 3) | 2;
+  std::tie(tag, success) = ParseVarInt(stream);
+  if (!success) {
+    LOG(LS_WARNING) << "Missing field tag from beginning of protobuf event.";
+    return ReadResult::kError;
+  } else if (tag != kEventTag && tag != kEventBatchTag) {
+    LOG(LS_WARNING) << "Unexpected field tag at beginning of protobuf event.";
+    return ReadResult::kError;
+  }
+
+  // Read the length field.
+  std::tie(message_length, success) = ParseVarInt(stream);
+  if (!success) {
+    LOG(LS_WARNING) << "Missing message length after protobuf field tag.";
+    return ReadResult::kError;
+  } else if (message_length >
+             (tag == kEventTag ? kMaxEventSize : kMaxEventBatchSize)) {
+    LOG(LS_WARNING) << "Protobuf message length is too large.";
+    return ReadResult::kError;
+  }
+
+  // Read the next protobuf event to a temporary char buffer.
+  if (buffer->size() < message_length)
+    buffer->resize(std::max<size_t>(message_length, kMaxEventSize));
+  stream.read(buffer->data(), message_length);
+  if (stream.gcount() != static_cast<int>(message_length)) {
+    LOG(LS_WARNING) << "Failed to read protobuf message from file.";
+    return ReadResult::kError;
+  }
+
+  // Parse the protobuf event from the buffer.
+  if (tag == kEventTag) {
+    rtclog::Event event;
+    if (!event.ParseFromArray(buffer->data(), message_length)) {
+      LOG(LS_WARNING) << "Failed to parse protobuf message.";
+      return ReadResult::kError;
+    }
+    events->push_back(std::move(event));
+    return ReadResult::kEvent;
+  }
+
+  rtclog::EventBatch batch;
+  if (!batch.ParseFromArray(buffer->data(), message_length)) {
+    LOG(LS_WARNING) << "Failed to parse protobuf message.";
+    return ReadResult::kError;
+  }
+  const size_t previous_size = events->size();
+  if (!ExpandEventBatch(batch, events)) {
+    LOG(LS_WARNING) << "Inconsistent event batch.";
+    events->resize(previous_size);
+    return ReadResult::kError;
+  }
+  return ReadResult::kEvent;
+}
+
 void GetHeaderExtensions(
     std::vector<RtpExtension>* header_extensions,
     const RepeatedPtrField<rtclog::RtpHeaderExtension>&
@@ -146,112 +391,132 @@ bool ParsedRtcEventLog::ParseString(const std::string& s) {
 
 bool ParsedRtcEventLog::ParseStream(std::istream& stream) {
   events_.clear();
-  const size_t kMaxEventSize = (1u << 16) - 1;
-  std::vector<char> tmp_buffer(kMaxEventSize);
-  uint64_t tag;
-  uint64_t message_length;
-  bool success;
+  std::vector<char> tmp_buffer;
 
   RTC_DCHECK(stream.good());
 
   while (1) {
-    // Check whether we have reached end of file.
-    stream.peek();
-    if (stream.eof()) {
-      // Process all extensions maps for faster look-up later.
-      for (auto& event_stream : streams_) {
-        rtp_extensions_maps_[StreamId(event_stream.ssrc,
-                                      event_stream.direction)] =
-            &event_stream.rtp_extensions_map;
-      }
-      return true;
+    const size_t first_new_event = events_.size();
+    switch (ReadEvents(stream, &tmp_buffer, &events_)) {
+      case ReadResult::kEvent:
+        break;
+      case ReadResult::kEndOfLog:
+        // Process all extensions maps for faster look-up later.
+        UpdateRtpExtensionsMaps();
+        return true;
+      case ReadResult::kError:
+        return false;
     }
+    for (size_t i = first_new_event; i < events_.size(); ++i)
+      AddStreams(events_[i]);
+  }
+}
 
-    // Read the next message tag. The tag number is defined as
-    // (fieldnumber << 3) | wire_type. In our case, the field number is
-    // supposed to be 1 and the wire type for an
-    // length-delimited field is 2.
-    const uint64_t kExpectedTag = (1 << 3) | 2;
-    std::tie(tag, success) = ParseVarInt(stream);
-    if (!success) {
-      LOG(LS_WARNING) << "Missing field tag from beginning of protobuf event.";
-      return false;
-    } else if (tag != kExpectedTag) {
-      LOG(LS_WARNING) << "Unexpected field tag at beginning of protobuf event.";
-      return false;
-    }
+bool ParsedRtcEventLog::StartStreamingFile(const std::string& filename) {
+  events_.clear();
+  streams_.clear();
+  rtp_extensions_maps_.clear();
+  streaming_failed_ = false;
+
+  // Read the file in large blocks rather than through the small default
+  // buffer of the stream.
+  const size_t kFileBufferSize = 1 << 20;
+  streaming_file_buffer_.resize(kFileBufferSize);
+  streaming_file_.reset(new std::ifstream());
+  streaming_file_->rdbuf()->pubsetbuf(streaming_file_buffer_.data(),
+                                      streaming_file_buffer_.size());
+  streaming_file_->open(filename, std::ios_base::in | std::ios_base::binary);
+  if (!streaming_file_->good() || !streaming_file_->is_open()) {
+    LOG(LS_WARNING) << "Could not open file for reading.";
+    streaming_file_.reset();
+    streaming_failed_ = true;
+    return false;
+  }
+  return true;
+}
 
-    // Read the length field.
-    std::tie(message_length, success) = ParseVarInt(stream);
-    if (!success) {
-      LOG(LS_WARNING) << "Missing message length after protobuf field tag.";
-      return false;
-    } else if (message_length > kMaxEventSize) {
-      LOG(LS_WARNING) << "Protobuf message length is too large.";
-      return false;
-    }
+bool ParsedRtcEventLog::ParseNextEvents(size_t max_events) {
+  RTC_DCHECK_GT(max_events, 0);
+  events_.clear();
+  if (!streaming_file_)
+    return false;
 
-    // Read the next protobuf event to a temporary char buffer.
-    stream.read(tmp_buffer.data(), message_length);
-    if (stream.gcount() != static_cast<int>(message_length)) {
-      LOG(LS_WARNING) << "Failed to read protobuf message from file.";
-      return false;
+  while (events_.size() < max_events) {
+    const size_t first_new_event = events_.size();
+    ReadResult result =
+        ReadEvents(*streaming_file_, &streaming_event_buffer_, &events_);
+    if (result != ReadResult::kEvent) {
+      streaming_failed_ = result == ReadResult::kError;
+      streaming_file_.reset();
+      break;
     }
-
-    // Parse the protobuf event from the buffer.
-    rtclog::Event event;
-    if (!event.ParseFromArray(tmp_buffer.data(), message_length)) {
-      LOG(LS_WARNING) << "Failed to parse protobuf message.";
-      return false;
+    // Packets logged after a config need its extension maps.
+    for (size_t i = first_new_event; i < events_.size(); ++i) {
+      if (AddStreams(events_[i]))
+        UpdateRtpExtensionsMaps();
     }
+  }
+  return !events_.empty();
+}
 
-    EventType type = GetRuntimeEventType(event.type());
-    switch (type) {
-      case VIDEO_RECEIVER_CONFIG_EVENT: {
-        rtclog::StreamConfig config = GetVideoReceiveConfig(event);
-        streams_.emplace_back(config.remote_ssrc, MediaType::VIDEO,
-                              kIncomingPacket,
-                              RtpHeaderExtensionMap(config.rtp_extensions));
-        streams_.emplace_back(config.local_ssrc, MediaType::VIDEO,
-                              kOutgoingPacket,
-                              RtpHeaderExtensionMap(config.rtp_extensions));
-        break;
-      }
-      case VIDEO_SENDER_CONFIG_EVENT: {
-        std::vector<rtclog::StreamConfig> configs = GetVideoSendConfig(event);
-        for (size_t i = 0; i < configs.size(); i++) {
-          streams_.emplace_back(
-              configs[i].local_ssrc, MediaType::VIDEO, kOutgoingPacket,
-              RtpHeaderExtensionMap(configs[i].rtp_extensions));
-
-          streams_.emplace_back(
-              configs[i].rtx_ssrc, MediaType::VIDEO, kOutgoingPacket,
-              RtpHeaderExtensionMap(configs[i].rtp_extensions));
-        }
-        break;
-      }
-      case AUDIO_RECEIVER_CONFIG_EVENT: {
-        rtclog::StreamConfig config = GetAudioReceiveConfig(event);
-        streams_.emplace_back(config.remote_ssrc, MediaType::AUDIO,
-                              kIncomingPacket,
-                              RtpHeaderExtensionMap(config.rtp_extensions));
-        streams_.emplace_back(config.local_ssrc, MediaType::AUDIO,
-                              kOutgoingPacket,
-                              RtpHeaderExtensionMap(config.rtp_extensions));
-        break;
-      }
-      case AUDIO_SENDER_CONFIG_EVENT: {
-        rtclog::StreamConfig config = GetAudioSendConfig(event);
-        streams_.emplace_back(config.local_ssrc, MediaType::AUDIO,
-                              kOutgoingPacket,
-                              RtpHeaderExtensionMap(config.rtp_extensions));
-        break;
+bool ParsedRtcEventLog::StreamingFailed() const {
+  return streaming_failed_;
+}
+
+bool ParsedRtcEventLog::AddStreams(const rtclog::Event& event) {
+  EventType type = GetRuntimeEventType(event.type());
+  switch (type) {
+    case VIDEO_RECEIVER_CONFIG_EVENT: {
+      rtclog::StreamConfig config = GetVideoReceiveConfig(event);
+      streams_.emplace_back(config.remote_ssrc, MediaType::VIDEO,
+                            kIncomingPacket,
+                            RtpHeaderExtensionMap(config.rtp_extensions));
+      streams_.emplace_back(config.local_ssrc, MediaType::VIDEO,
+                            kOutgoingPacket,
+                            RtpHeaderExtensionMap(config.rtp_extensions));
+      return true;
+    }
+    case VIDEO_SENDER_CONFIG_EVENT: {
+      std::vector<rtclog::StreamConfig> configs = GetVideoSendConfig(event);
+      for (size_t i = 0; i < configs.size(); i++) {
+        streams_.emplace_back(
+            configs[i].local_ssrc, MediaType::VIDEO, kOutgoingPacket,
+            RtpHeaderExtensionMap(configs[i].rtp_extensions));
+
+        streams_.emplace_back(
+            configs[i].rtx_ssrc, MediaType::VIDEO, kOutgoingPacket,
+            RtpHeaderExtensionMap(configs[i].rtp_extensions));
       }
-      default:
-        break;
+      return true;
+    }
+    case AUDIO_RECEIVER_CONFIG_EVENT: {
+      rtclog::StreamConfig config = GetAudioReceiveConfig(event);
+      streams_.emplace_back(config.remote_ssrc, MediaType::AUDIO,
+                            kIncomingPacket,
+                            RtpHeaderExtensionMap(config.rtp_extensions));
+      streams_.emplace_back(config.local_ssrc, MediaType::AUDIO,
+                            kOutgoingPacket,
+                            RtpHeaderExtensionMap(config.rtp_extensions));
+      return true;
+    }
+    case AUDIO_SENDER_CONFIG_EVENT: {
+      rtclog::StreamConfig config = GetAudioSendConfig(event);
+      streams_.emplace_back(config.local_ssrc, MediaType::AUDIO,
+                            kOutgoingPacket,
+                            RtpHeaderExtensionMap(config.rtp_extensions));
+      return true;
     }
+    default:
+      return false;
+  }
+}
 
-    events_.push_back(event);
+void ParsedRtcEventLog::UpdateRtpExtensionsMaps() {
+  // |streams_| may have been reallocated, so start over.
+  rtp_extensions_maps_.clear();
+  for (auto& event_stream : streams_) {
+    rtp_extensions_maps_[StreamId(event_stream.ssrc, event_stream.direction)] =
+        &event_stream.rtp_extensions_map;
   }
 }
 
@@ -10,7 +10,9 @@
 #ifndef LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_PARSER_H_
 #define LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_PARSER_H_
 
+#include <fstream>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>  // pair
 #include <vector>
@@ -94,6 +96,21 @@ class ParsedRtcEventLog {
   // Reads an RtcEventLog from an istream and returns true if successful.
   bool ParseStream(std::istream& stream);
 
+  // Streaming alternative to ParseFile() for logs too large to hold in memory.
+  // After StartStreamingFile(), each ParseNextEvents() call replaces the
+  // parsed events with the next |max_events| events of the file, and the
+  // accessors below index into those. Stream configs are kept between calls,
+  // but unlike ParseFile() only the configs logged before a packet are used to
+  // look up its header extensions. Events that were encoded together in a
+  // batch are parsed together, so a call may parse up to a batch more than
+  // |max_events| events.
+  bool StartStreamingFile(const std::string& file_name);
+  // Returns false, with no events parsed, once the file has been read to the
+  // end or the rest of it can't be parsed. In the latter case StreamingFailed()
+  // returns true.
+  bool ParseNextEvents(size_t max_events);
+  bool StreamingFailed() const;
+
   // Returns the number of events in an EventStream.
   size_t GetNumberOfEvents() const;
 
@@ -187,8 +204,19 @@ class ParsedRtcEventLog {
   rtclog::StreamConfig GetAudioReceiveConfig(const rtclog::Event& event) const;
   rtclog::StreamConfig GetAudioSendConfig(const rtclog::Event& event) const;
 
+  // Adds the streams configured by |event|, if any. Returns true if it did.
+  bool AddStreams(const rtclog::Event& event);
+  // Rebuilds |rtp_extensions_maps_| from |streams_|.
+  void UpdateRtpExtensionsMaps();
+
   std::vector<rtclog::Event> events_;
 
+  // Used by ParseNextEvents().
+  std::unique_ptr<std::ifstream> streaming_file_;
+  std::vector<char> streaming_file_buffer_;
+  std::vector<char> streaming_event_buffer_;
+  bool streaming_failed_ = false;
+
   struct Stream {
     Stream(uint32_t ssrc,
            MediaType media_type,
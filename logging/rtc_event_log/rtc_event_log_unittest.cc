@@ -8,6 +8,12 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
 #include <ostream>
@@ -16,6 +22,8 @@
 #include <vector>
 
 #include "call/call.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_network_adaptation.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_receive_stream_config.h"
@@ -49,8 +57,10 @@
 #include "rtc_base/buffer.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/fakeclock.h"
+#include "rtc_base/logging.h"
 #include "rtc_base/ptr_util.h"
 #include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
 #include "test/gtest.h"
 #include "test/testsupport/fileutils.h"
 
@@ -302,7 +312,11 @@ void GenerateAudioNetworkAdaptation(const RtpHeaderExtensionMap& extensions,
 class RtcEventLogSessionDescription {
  public:
   explicit RtcEventLogSessionDescription(unsigned int random_seed)
-      : prng(random_seed) {}
+      : RtcEventLogSessionDescription(random_seed,
+                                      RtcEventLog::EncodingType::Legacy) {}
+  RtcEventLogSessionDescription(unsigned int random_seed,
+                                RtcEventLog::EncodingType encoding_type)
+      : encoding_type(encoding_type), prng(random_seed) {}
   void GenerateSessionDescription(size_t incoming_rtp_count,
                                   size_t outgoing_rtp_count,
                                   size_t incoming_rtcp_count,
@@ -312,6 +326,10 @@ class RtcEventLogSessionDescription {
                                   size_t bwe_delay_count,
                                   const RtpHeaderExtensionMap& extensions,
                                   uint32_t csrcs_count);
+  // Creates the events of the session in the order they are logged,
+  // advancing |fake_clock| before each of them.
+  std::vector<std::unique_ptr<RtcEvent>> CreateEvents(
+      rtc::ScopedFakeClock* fake_clock);
   void WriteSession();
   void ReadAndVerifySession();
   void PrintExpectedEvents(std::ostream& stream);
@@ -327,6 +345,7 @@ class RtcEventLogSessionDescription {
   std::vector<rtclog::StreamConfig> receiver_configs;
   std::vector<rtclog::StreamConfig> sender_configs;
   std::vector<EventType> event_types;
+  const RtcEventLog::EncodingType encoding_type;
   Random prng;
 };
 
@@ -403,90 +422,76 @@ void RtcEventLogSessionDescription::GenerateSessionDescription(
   }
 }
 
-void RtcEventLogSessionDescription::WriteSession() {
-  // Find the name of the current test, in order to use it as a temporary
-  // filename.
-  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
-  const std::string temp_filename =
-      test::OutputPath() + test_info->test_case_name() + test_info->name();
-
-  rtc::ScopedFakeClock fake_clock;
-  fake_clock.SetTimeMicros(prng.Rand<uint32_t>());
-
-  // When log_dumper goes out of scope, it causes the log file to be flushed
-  // to disk.
-  std::unique_ptr<RtcEventLog> log_dumper(
-      RtcEventLog::Create(RtcEventLog::EncodingType::Legacy));
-
-  size_t incoming_rtp_written = 0;
-  size_t outgoing_rtp_written = 0;
-  size_t incoming_rtcp_written = 0;
-  size_t outgoing_rtcp_written = 0;
-  size_t playouts_written = 0;
-  size_t bwe_loss_written = 0;
-  size_t bwe_delay_written = 0;
-  size_t recv_configs_written = 0;
-  size_t send_configs_written = 0;
-
+std::vector<std::unique_ptr<RtcEvent>>
+RtcEventLogSessionDescription::CreateEvents(rtc::ScopedFakeClock* fake_clock) {
+  size_t incoming_rtp_created = 0;
+  size_t outgoing_rtp_created = 0;
+  size_t incoming_rtcp_created = 0;
+  size_t outgoing_rtcp_created = 0;
+  size_t playouts_created = 0;
+  size_t bwe_loss_created = 0;
+  size_t bwe_delay_created = 0;
+  size_t recv_configs_created = 0;
+  size_t send_configs_created = 0;
+
+  std::vector<std::unique_ptr<RtcEvent>> events;
+  events.reserve(event_types.size());
   for (size_t i = 0; i < event_types.size(); i++) {
-    fake_clock.AdvanceTimeMicros(prng.Rand(1, 1000));
-    if (i == event_types.size() / 2)
-      log_dumper->StartLogging(
-          rtc::MakeUnique<RtcEventLogOutputFile>(temp_filename, 10000000));
+    fake_clock->AdvanceTimeMicros(prng.Rand(1, 1000));
     switch (event_types[i]) {
       case EventType::kIncomingRtp:
-        RTC_CHECK(incoming_rtp_written < incoming_rtp_packets.size());
-        log_dumper->Log(rtc::MakeUnique<RtcEventRtpPacketIncoming>(
-            incoming_rtp_packets[incoming_rtp_written++]));
+        RTC_CHECK(incoming_rtp_created < incoming_rtp_packets.size());
+        events.push_back(rtc::MakeUnique<RtcEventRtpPacketIncoming>(
+            incoming_rtp_packets[incoming_rtp_created++]));
         break;
       case EventType::kOutgoingRtp: {
-        RTC_CHECK(outgoing_rtp_written < outgoing_rtp_packets.size());
+        RTC_CHECK(outgoing_rtp_created < outgoing_rtp_packets.size());
         constexpr int kNotAProbe = PacedPacketInfo::kNotAProbe;  // Compiler...
-        log_dumper->Log(rtc::MakeUnique<RtcEventRtpPacketOutgoing>(
-            outgoing_rtp_packets[outgoing_rtp_written++], kNotAProbe));
+        events.push_back(rtc::MakeUnique<RtcEventRtpPacketOutgoing>(
+            outgoing_rtp_packets[outgoing_rtp_created++], kNotAProbe));
         break;
       }
       case EventType::kIncomingRtcp:
-        RTC_CHECK(incoming_rtcp_written < incoming_rtcp_packets.size());
-        log_dumper->Log(rtc::MakeUnique<RtcEventRtcpPacketIncoming>(
-            incoming_rtcp_packets[incoming_rtcp_written++]));
+        RTC_CHECK(incoming_rtcp_created < incoming_rtcp_packets.size());
+        events.push_back(rtc::MakeUnique<RtcEventRtcpPacketIncoming>(
+            incoming_rtcp_packets[incoming_rtcp_created++]));
         break;
       case EventType::kOutgoingRtcp:
-        RTC_CHECK(outgoing_rtcp_written < outgoing_rtcp_packets.size());
-        log_dumper->Log(rtc::MakeUnique<RtcEventRtcpPacketOutgoing>(
-            outgoing_rtcp_packets[outgoing_rtcp_written++]));
+        RTC_CHECK(outgoing_rtcp_created < outgoing_rtcp_packets.size());
+        events.push_back(rtc::MakeUnique<RtcEventRtcpPacketOutgoing>(
+            outgoing_rtcp_packets[outgoing_rtcp_created++]));
         break;
       case EventType::kAudioPlayout:
-        RTC_CHECK(playouts_written < playout_ssrcs.size());
-        log_dumper->Log(rtc::MakeUnique<RtcEventAudioPlayout>(
-            playout_ssrcs[playouts_written++]));
+        RTC_CHECK(playouts_created < playout_ssrcs.size());
+        events.push_back(rtc::MakeUnique<RtcEventAudioPlayout>(
+            playout_ssrcs[playouts_created++]));
         break;
       case EventType::kBweLossUpdate:
-        RTC_CHECK(bwe_loss_written < bwe_loss_updates.size());
-        log_dumper->Log(rtc::MakeUnique<RtcEventBweUpdateLossBased>(
-            bwe_loss_updates[bwe_loss_written].bitrate_bps,
-            bwe_loss_updates[bwe_loss_written].fraction_loss,
-            bwe_loss_updates[bwe_loss_written].total_packets));
-        bwe_loss_written++;
+        RTC_CHECK(bwe_loss_created < bwe_loss_updates.size());
+        events.push_back(rtc::MakeUnique<RtcEventBweUpdateLossBased>(
+            bwe_loss_updates[bwe_loss_created].bitrate_bps,
+            bwe_loss_updates[bwe_loss_created].fraction_loss,
+            bwe_loss_updates[bwe_loss_created].total_packets));
+        bwe_loss_created++;
         break;
       case EventType::kBweDelayUpdate:
-        RTC_CHECK(bwe_delay_written < bwe_delay_updates.size());
-        log_dumper->Log(rtc::MakeUnique<RtcEventBweUpdateDelayBased>(
-            bwe_delay_updates[bwe_delay_written].first,
-            bwe_delay_updates[bwe_delay_written].second));
-        bwe_delay_written++;
+        RTC_CHECK(bwe_delay_created < bwe_delay_updates.size());
+        events.push_back(rtc::MakeUnique<RtcEventBweUpdateDelayBased>(
+            bwe_delay_updates[bwe_delay_created].first,
+            bwe_delay_updates[bwe_delay_created].second));
+        bwe_delay_created++;
         break;
       case EventType::kVideoRecvConfig:
-        RTC_CHECK(recv_configs_written < receiver_configs.size());
-        log_dumper->Log(rtc::MakeUnique<RtcEventVideoReceiveStreamConfig>(
+        RTC_CHECK(recv_configs_created < receiver_configs.size());
+        events.push_back(rtc::MakeUnique<RtcEventVideoReceiveStreamConfig>(
             rtc::MakeUnique<rtclog::StreamConfig>(
-                receiver_configs[recv_configs_written++])));
+                receiver_configs[recv_configs_created++])));
         break;
       case EventType::kVideoSendConfig:
-        RTC_CHECK(send_configs_written < sender_configs.size());
-        log_dumper->Log(rtc::MakeUnique<RtcEventVideoSendStreamConfig>(
+        RTC_CHECK(send_configs_created < sender_configs.size());
+        events.push_back(rtc::MakeUnique<RtcEventVideoSendStreamConfig>(
             rtc::MakeUnique<rtclog::StreamConfig>(
-                sender_configs[send_configs_written++])));
+                sender_configs[send_configs_created++])));
         break;
       case EventType::kAudioRecvConfig:
         // Not implemented
@@ -511,6 +516,31 @@ void RtcEventLogSessionDescription::WriteSession() {
     }
   }
 
+  return events;
+}
+
+void RtcEventLogSessionDescription::WriteSession() {
+  // Find the name of the current test, in order to use it as a temporary
+  // filename.
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename =
+      test::OutputPath() + test_info->test_case_name() + test_info->name();
+
+  rtc::ScopedFakeClock fake_clock;
+  fake_clock.SetTimeMicros(prng.Rand<uint32_t>());
+  std::vector<std::unique_ptr<RtcEvent>> events = CreateEvents(&fake_clock);
+
+  // When log_dumper goes out of scope, it causes the log file to be flushed
+  // to disk.
+  std::unique_ptr<RtcEventLog> log_dumper(RtcEventLog::Create(encoding_type));
+
+  for (size_t i = 0; i < events.size(); i++) {
+    if (i == events.size() / 2)
+      log_dumper->StartLogging(
+          rtc::MakeUnique<RtcEventLogOutputFile>(temp_filename, 10000000));
+    log_dumper->Log(std::move(events[i]));
+  }
+
   log_dumper->StopLogging();
 }
 
@@ -688,6 +718,168 @@ TEST(RtcEventLogTest, LogSessionAndReadBackWithAllExtensions) {
   session.ReadAndVerifySession();
 }
 
+TEST(RtcEventLogTest, LogSessionAndReadBackWithNewFormat) {
+  RtpHeaderExtensionMap extensions;
+  for (uint32_t i = 0; i < kNumExtensions; i++) {
+    extensions.Register(kExtensionTypes[i], kExtensionIds[i]);
+  }
+  RtcEventLogSessionDescription session(1414213562u /*Random seed*/,
+                                        RtcEventLog::EncodingType::NewFormat);
+  session.GenerateSessionDescription(350, 350, 20, 20, 100, 20, 20,
+                                     extensions, 2);
+  session.WriteSession();
+  session.ReadAndVerifySession();
+}
+
+// Measures the output size and the time to log a session with each encoding
+// type, and the time spent in the encoder alone. The session's packets have
+// random SSRCs, sequence numbers and timestamps, so almost every stream has a
+// single packet, which is the worst case for the new format's delta encoding.
+TEST(RtcEventLogTest, DISABLED_SessionSizeAndLoggingTime) {
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename =
+      test::OutputPath() + test_info->test_case_name() + test_info->name();
+  const int kNumRuns = 10;
+
+  RtpHeaderExtensionMap extensions;
+  for (uint32_t i = 0; i < kNumExtensions; i++) {
+    extensions.Register(kExtensionTypes[i], kExtensionIds[i]);
+  }
+  for (RtcEventLog::EncodingType encoding_type :
+       {RtcEventLog::EncodingType::Legacy,
+        RtcEventLog::EncodingType::NewFormat}) {
+    const bool new_format =
+        encoding_type == RtcEventLog::EncodingType::NewFormat;
+    // Half of the session is logged before logging starts, and that half has
+    // to fit in the history kept in memory.
+    RtcEventLogSessionDescription session(1414213562u /*Random seed*/,
+                                          encoding_type);
+    session.GenerateSessionDescription(6000, 6000, 600, 600, 3000, 300, 300,
+                                       extensions, 2);
+    int64_t logging_ns = std::numeric_limits<int64_t>::max();
+    for (int run = 0; run < kNumRuns; ++run) {
+      int64_t start_ns = rtc::TimeNanos();
+      session.WriteSession();
+      logging_ns = std::min(logging_ns, rtc::TimeNanos() - start_ns);
+    }
+
+    // The encoder is given the events the way RtcEventLog gives them to it;
+    // one at a time for the legacy format, and all at once for the new one.
+    std::vector<std::unique_ptr<RtcEvent>> events;
+    {
+      rtc::ScopedFakeClock fake_clock;
+      events = session.CreateEvents(&fake_clock);
+    }
+    std::vector<const RtcEvent*> event_pointers;
+    for (const auto& event : events)
+      event_pointers.push_back(event.get());
+    std::unique_ptr<RtcEventLogEncoder> encoder;
+    if (new_format)
+      encoder = rtc::MakeUnique<RtcEventLogEncoderNewFormat>();
+    else
+      encoder = rtc::MakeUnique<RtcEventLogEncoderLegacy>();
+    int64_t encoding_ns = std::numeric_limits<int64_t>::max();
+    for (int run = 0; run < kNumRuns; ++run) {
+      std::string output;
+      int64_t start_ns = rtc::TimeNanos();
+      if (new_format) {
+        output = encoder->EncodeBatch(event_pointers);
+      } else {
+        for (const RtcEvent* event : event_pointers)
+          output += encoder->Encode(*event);
+      }
+      encoding_ns = std::min(encoding_ns, rtc::TimeNanos() - start_ns);
+    }
+
+    ParsedRtcEventLog parsed_log;
+    ASSERT_TRUE(parsed_log.ParseFile(temp_filename));
+    std::ifstream file(temp_filename, std::ios_base::in |
+                                          std::ios_base::binary |
+                                          std::ios_base::ate);
+    const size_t num_events = parsed_log.GetNumberOfEvents();
+    LOG(LS_INFO) << (new_format ? "New format" : "Legacy") << ": "
+                 << num_events << " events, "
+                 << static_cast<size_t>(file.tellg()) / num_events
+                 << " bytes, " << logging_ns / num_events
+                 << " ns to log and " << encoding_ns / events.size()
+                 << " ns to encode per event.";
+  }
+
+  // Clean up temporary file - can be pretty slow.
+  remove(temp_filename.c_str());
+}
+
+// Logs |config| before logging is started, and then |packets|, with the new
+// format to an output of at most |max_size_bytes|. Returns the file size.
+size_t LogWithNewFormat(const std::string& filename,
+                        size_t max_size_bytes,
+                        const rtclog::StreamConfig& config,
+                        const std::vector<RtpPacketToSend>& packets) {
+  rtc::ScopedFakeClock fake_clock;
+  fake_clock.SetTimeMicros(1000000);
+  std::unique_ptr<RtcEventLog> log_dumper(
+      RtcEventLog::Create(RtcEventLog::EncodingType::NewFormat));
+  log_dumper->Log(rtc::MakeUnique<RtcEventAudioReceiveStreamConfig>(
+      rtc::MakeUnique<rtclog::StreamConfig>(config)));
+  log_dumper->StartLogging(
+      rtc::MakeUnique<RtcEventLogOutputFile>(filename, max_size_bytes));
+  for (const RtpPacketToSend& packet : packets) {
+    fake_clock.AdvanceTimeMicros(1000);
+    log_dumper->Log(rtc::MakeUnique<RtcEventRtpPacketOutgoing>(
+        packet, PacedPacketInfo::kNotAProbe));
+  }
+  log_dumper->StopLogging();
+  std::ifstream file(filename, std::ios_base::in | std::ios_base::binary |
+                                   std::ios_base::ate);
+  return static_cast<size_t>(file.tellg());
+}
+
+TEST(RtcEventLogTest, NewFormatWritesTheBatchesThatFitInTheOutput) {
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename =
+      test::OutputPath() + test_info->test_case_name() + test_info->name();
+
+  RtpHeaderExtensionMap extensions;
+  for (uint32_t i = 0; i < kNumExtensions; i++) {
+    extensions.Register(kExtensionTypes[i], kExtensionIds[i]);
+  }
+  Random prng(2236067977u);
+  rtclog::StreamConfig config;
+  GenerateAudioReceiveConfig(extensions, &config, &prng);
+  const size_t kNumPackets = 3000;
+  std::vector<RtpPacketToSend> packets;
+  for (size_t i = 0; i < kNumPackets; i++) {
+    packets.push_back(GenerateOutgoingRtpPacket(&extensions, 0,
+                                                prng.Rand(50, 1000), &prng));
+  }
+
+  // Pending events are written 1000 at a time, so with half the space the
+  // whole log needs, the output has room for the config and some, but not
+  // all, of the batches of packets.
+  const size_t full_size = LogWithNewFormat(
+      temp_filename, RtcEventLog::kUnlimitedOutput, config, packets);
+  const size_t max_size = full_size / 2;
+  EXPECT_LE(LogWithNewFormat(temp_filename, max_size, config, packets),
+            max_size);
+
+  ParsedRtcEventLog parsed_log;
+  ASSERT_TRUE(parsed_log.ParseFile(temp_filename));
+  ASSERT_GE(parsed_log.GetNumberOfEvents(), 2u);
+  RtcEventLogTestHelper::VerifyLogStartEvent(parsed_log, 0);
+  RtcEventLogTestHelper::VerifyAudioReceiveStreamConfig(parsed_log, 1, config);
+  size_t rtp_events = 0;
+  for (size_t i = 2; i < parsed_log.GetNumberOfEvents(); i++) {
+    ASSERT_EQ(ParsedRtcEventLog::RTP_EVENT, parsed_log.GetEventType(i));
+    ++rtp_events;
+  }
+  EXPECT_GT(rtp_events, 0u);
+  EXPECT_LT(rtp_events, kNumPackets);
+  EXPECT_EQ(0u, rtp_events % 1000);
+
+  // Clean up temporary file - can be pretty slow.
+  remove(temp_filename.c_str());
+}
+
 TEST(RtcEventLogTest, LogSessionAndReadBackAllCombinations) {
   // Try all combinations of header extensions and up to 2 CSRCS.
   for (uint32_t extension_selection = 0;
@@ -717,6 +909,172 @@ TEST(RtcEventLogTest, LogSessionAndReadBackAllCombinations) {
   }
 }
 
+// Streams |filename| in chunks of |events_per_chunk| events and verifies that
+// each event is read back the same as when the whole file is parsed.
+void VerifyStreamedLog(const std::string& filename, size_t events_per_chunk) {
+  ParsedRtcEventLog parsed_log;
+  ASSERT_TRUE(parsed_log.ParseFile(filename));
+
+  ParsedRtcEventLog streamed_log;
+  ASSERT_TRUE(streamed_log.StartStreamingFile(filename));
+  size_t index = 0;
+  while (streamed_log.ParseNextEvents(events_per_chunk)) {
+    EXPECT_GE(events_per_chunk, streamed_log.GetNumberOfEvents());
+    for (size_t i = 0; i < streamed_log.GetNumberOfEvents(); ++i, ++index) {
+      ASSERT_LT(index, parsed_log.GetNumberOfEvents());
+      ASSERT_EQ(parsed_log.GetEventType(index), streamed_log.GetEventType(i));
+      EXPECT_EQ(parsed_log.GetTimestamp(index), streamed_log.GetTimestamp(i));
+      if (parsed_log.GetEventType(index) == ParsedRtcEventLog::RTP_EVENT) {
+        PacketDirection direction;
+        PacketDirection streamed_direction;
+        uint8_t header[IP_PACKET_SIZE];
+        uint8_t streamed_header[IP_PACKET_SIZE];
+        size_t header_length;
+        size_t streamed_header_length;
+        size_t total_length;
+        size_t streamed_total_length;
+        RtpHeaderExtensionMap* extension_map = parsed_log.GetRtpHeader(
+            index, &direction, header, &header_length, &total_length, nullptr);
+        RtpHeaderExtensionMap* streamed_extension_map =
+            streamed_log.GetRtpHeader(i, &streamed_direction, streamed_header,
+                                      &streamed_header_length,
+                                      &streamed_total_length, nullptr);
+        EXPECT_EQ(direction, streamed_direction);
+        ASSERT_EQ(header_length, streamed_header_length);
+        EXPECT_EQ(0, memcmp(header, streamed_header, header_length));
+        EXPECT_EQ(total_length, streamed_total_length);
+        ASSERT_EQ(extension_map == nullptr, streamed_extension_map == nullptr);
+        if (extension_map) {
+          for (int type = kRtpExtensionNone + 1;
+               type < kRtpExtensionNumberOfExtensions; ++type) {
+            EXPECT_EQ(
+                extension_map->GetId(static_cast<RTPExtensionType>(type)),
+                streamed_extension_map->GetId(
+                    static_cast<RTPExtensionType>(type)));
+          }
+        }
+      } else if (parsed_log.GetEventType(index) ==
+                 ParsedRtcEventLog::RTCP_EVENT) {
+        PacketDirection direction;
+        PacketDirection streamed_direction;
+        uint8_t packet[IP_PACKET_SIZE];
+        uint8_t streamed_packet[IP_PACKET_SIZE];
+        size_t length;
+        size_t streamed_length;
+        parsed_log.GetRtcpPacket(index, &direction, packet, &length);
+        streamed_log.GetRtcpPacket(i, &streamed_direction, streamed_packet,
+                                   &streamed_length);
+        EXPECT_EQ(direction, streamed_direction);
+        ASSERT_EQ(length, streamed_length);
+        EXPECT_EQ(0, memcmp(packet, streamed_packet, length));
+      }
+    }
+  }
+  EXPECT_FALSE(streamed_log.StreamingFailed());
+  EXPECT_EQ(parsed_log.GetNumberOfEvents(), index);
+}
+
+TEST(RtcEventLogTest, LogSessionAndStreamBack) {
+  RtpHeaderExtensionMap extensions;
+  for (uint32_t i = 0; i < kNumExtensions; i++) {
+    extensions.Register(kExtensionTypes[i], kExtensionIds[i]);
+  }
+  RtcEventLogSessionDescription session(1414213562u /*Random seed*/);
+  session.GenerateSessionDescription(20, 20, 5, 5, 3, 2, 2, extensions, 2);
+  session.WriteSession();
+
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename =
+      test::OutputPath() + test_info->test_case_name() + test_info->name();
+  for (size_t events_per_chunk : {1, 3, 1000})
+    VerifyStreamedLog(temp_filename, events_per_chunk);
+
+  session.ReadAndVerifySession();
+}
+
+TEST(RtcEventLogTest, StreamTruncatedLog) {
+  RtpHeaderExtensionMap extensions;
+  RtcEventLogSessionDescription session(1732050807u /*Random seed*/);
+  session.GenerateSessionDescription(5, 5, 1, 1, 0, 0, 0, extensions, 0);
+  session.WriteSession();
+
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename =
+      test::OutputPath() + test_info->test_case_name() + test_info->name();
+  std::string log;
+  {
+    std::ifstream file(temp_filename, std::ios_base::binary);
+    log.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  }
+  ASSERT_GT(log.size(), 5u);
+  {
+    std::ofstream file(temp_filename,
+                       std::ios_base::binary | std::ios_base::trunc);
+    file.write(log.data(), log.size() - 5);
+  }
+
+  ParsedRtcEventLog streamed_log;
+  ASSERT_TRUE(streamed_log.StartStreamingFile(temp_filename));
+  size_t num_events = 0;
+  while (streamed_log.ParseNextEvents(2))
+    num_events += streamed_log.GetNumberOfEvents();
+  EXPECT_TRUE(streamed_log.StreamingFailed());
+  EXPECT_GT(num_events, 0u);
+  EXPECT_FALSE(streamed_log.ParseNextEvents(2));
+
+  remove(temp_filename.c_str());
+}
+
+// Builds a 1 GB log by repeating a written session and streams it back.
+TEST(RtcEventLogTest, DISABLED_StreamSyntheticOneGigabyteLog) {
+  const size_t kLogSize = 1 << 30;
+  const size_t kEventsPerChunk = 10000;
+  RtpHeaderExtensionMap extensions;
+  for (uint32_t i = 0; i < kNumExtensions; i++) {
+    extensions.Register(kExtensionTypes[i], kExtensionIds[i]);
+  }
+  RtcEventLogSessionDescription session(2236067977u /*Random seed*/);
+  session.GenerateSessionDescription(400, 400, 50, 50, 20, 20, 20, extensions,
+                                     2);
+  session.WriteSession();
+
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename =
+      test::OutputPath() + test_info->test_case_name() + test_info->name();
+  ParsedRtcEventLog session_log;
+  ASSERT_TRUE(session_log.ParseFile(temp_filename));
+  std::string log;
+  {
+    std::ifstream file(temp_filename, std::ios_base::binary);
+    log.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  }
+  size_t copies = 0;
+  {
+    std::ofstream file(temp_filename,
+                       std::ios_base::binary | std::ios_base::trunc);
+    for (; copies * log.size() < kLogSize; ++copies)
+      file.write(log.data(), log.size());
+  }
+
+  int64_t start_ns = rtc::TimeNanos();
+  ParsedRtcEventLog streamed_log;
+  ASSERT_TRUE(streamed_log.StartStreamingFile(temp_filename));
+  size_t num_events = 0;
+  while (streamed_log.ParseNextEvents(kEventsPerChunk))
+    num_events += streamed_log.GetNumberOfEvents();
+  int64_t elapsed_ms = (rtc::TimeNanos() - start_ns) / 1000000;
+  EXPECT_FALSE(streamed_log.StreamingFailed());
+  EXPECT_EQ(copies * session_log.GetNumberOfEvents(), num_events);
+  LOG(LS_INFO) << "Streamed " << num_events << " events, "
+               << copies * log.size() / (1 << 20) << " MB, in " << elapsed_ms
+               << " ms, holding at most " << kEventsPerChunk
+               << " events in memory.";
+
+  remove(temp_filename.c_str());
+}
+
 TEST(RtcEventLogTest, LogEventAndReadBack) {
   Random prng(987654321);
 
@@ -30,11 +30,6 @@ static const unsigned char kReservedSpace[] = {
   0x00, 0x00, 0x00, 0x00
 };
 
-// Amount of overhead SRTP may take.  We need to leave room in the
-// buffer for it, otherwise SRTP will fail later.  If SRTP ever uses
-// more than this, we need to increase this number.
-static const size_t kMaxSrtpHmacOverhead = 16;
-
 RtpDataEngine::RtpDataEngine() {
   data_codecs_.push_back(
       DataCodec(kGoogleRtpDataCodecPlType, kGoogleRtpDataCodecName));
@@ -23,6 +23,11 @@ const size_t kMinRtpPacketLen = 12;
 const size_t kMaxRtpPacketLen = 2048;
 const size_t kMinRtcpPacketLen = 4;
 
+// Amount of overhead SRTP may take.  We need to leave room in the
+// buffer for it, otherwise SRTP will fail later.  If SRTP ever uses
+// more than this, we need to increase this number.
+const size_t kMaxSrtpHmacOverhead = 16;
+
 struct RtpHeader {
   int payload_type;
   int seq_num;
@@ -12,6 +12,7 @@
 
 #include <utility>
 
+#include "common_video/include/shared_i420_buffer_pool.h"
 #include "modules/video_coding/codecs/h264/include/h264.h"
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
 #include "modules/video_coding/codecs/vp9/include/vp9.h"
@@ -21,6 +22,9 @@ namespace cricket {
 
 namespace {
 
+// Memory kept in free decoder output buffers, about ten 1080p frames.
+const size_t kMaxPooledBytes = 32 * 1024 * 1024;
+
 // Video decoder class to be used for unknown codecs. Doesn't support decoding
 // but logs messages to LS_ERROR.
 class NullVideoDecoder : public webrtc::VideoDecoder {
@@ -54,7 +58,10 @@ class NullVideoDecoder : public webrtc::VideoDecoder {
 
 }  // anonymous namespace
 
-InternalDecoderFactory::InternalDecoderFactory() {}
+InternalDecoderFactory::InternalDecoderFactory()
+    // Zero-initialized for FFmpeg, see H264Decoder::Create().
+    : buffer_pool_(webrtc::SharedI420BufferPool::Create(kMaxPooledBytes,
+                                                        true)) {}
 
 InternalDecoderFactory::~InternalDecoderFactory() {}
 
@@ -64,7 +71,7 @@ webrtc::VideoDecoder* InternalDecoderFactory::CreateVideoDecoder(
   switch (type) {
     case webrtc::kVideoCodecH264:
       if (webrtc::H264Decoder::IsSupported())
-        return webrtc::H264Decoder::Create();
+        return webrtc::H264Decoder::Create(buffer_pool_);
       // This could happen in a software-fallback for a codec type only
       // supported externally (e.g. H.264 on iOS or Android) or in current usage
       // in WebRtcVideoEngine if the external decoder fails to be created.
@@ -72,7 +79,7 @@ webrtc::VideoDecoder* InternalDecoderFactory::CreateVideoDecoder(
                     << "Decoding of this stream will be broken.";
       return new NullVideoDecoder();
     case webrtc::kVideoCodecVP8:
-      return webrtc::VP8Decoder::Create();
+      return webrtc::VP8Decoder::Create(buffer_pool_);
     case webrtc::kVideoCodecVP9:
       RTC_DCHECK(webrtc::VP9Decoder::IsSupported());
       return webrtc::VP9Decoder::Create();
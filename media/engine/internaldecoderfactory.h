@@ -14,6 +14,11 @@
 #include <vector>
 
 #include "media/engine/webrtcvideodecoderfactory.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+namespace webrtc {
+class SharedI420BufferPool;
+}  // namespace webrtc
 
 namespace cricket {
 
@@ -27,6 +32,11 @@ class InternalDecoderFactory : public WebRtcVideoDecoderFactory {
       webrtc::VideoCodecType type) override;
 
   void DestroyVideoDecoder(webrtc::VideoDecoder* decoder) override;
+
+ private:
+  // Output buffers of all VP8 and H.264 decoders created by this factory, so
+  // that the receive streams of a process reuse each other's frame memory.
+  const rtc::scoped_refptr<webrtc::SharedI420BufferPool> buffer_pool_;
 };
 
 }  // namespace cricket
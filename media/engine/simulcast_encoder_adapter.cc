@@ -28,6 +28,9 @@ const unsigned int kDefaultMinQp = 2;
 const unsigned int kDefaultMaxQp = 56;
 // Max qp for lowest spatial resolution when doing simulcast.
 const unsigned int kLowestResMaxQp = 45;
+// Memory kept in free scaled frames, a few frames of every stream scaled
+// down from 1080p.
+const size_t kMaxPooledScaledBytes = 8 * 1024 * 1024;
 
 uint32_t SumStreamMaxBitrate(int streams, const webrtc::VideoCodec& codec) {
   uint32_t bitrate_sum = 0;
@@ -139,7 +142,9 @@ SimulcastEncoderAdapter::SimulcastEncoderAdapter(
     : inited_(0),
       factory_(factory),
       encoded_complete_callback_(nullptr),
-      implementation_name_("SimulcastEncoderAdapter") {
+      implementation_name_("SimulcastEncoderAdapter"),
+      scaled_buffer_pool_(
+          SharedI420BufferPool::Create(kMaxPooledScaledBytes, false)) {
   // The adapter is typically created on the worker thread, but operated on
   // the encoder task queue.
   encoder_queue_.Detach();
@@ -167,6 +172,8 @@ int SimulcastEncoderAdapter::Release() {
     stored_encoders_.push(std::move(encoder));
   }
 
+  scaled_buffer_pool_->Trim();
+
   // It's legal to move the encoder to another queue now.
   encoder_queue_.Detach();
 
@@ -355,7 +362,7 @@ int SimulcastEncoderAdapter::Encode(
       }
     } else {
       rtc::scoped_refptr<I420Buffer> dst_buffer =
-          I420Buffer::Create(dst_width, dst_height);
+          scaled_buffer_pool_->CreateBuffer(dst_width, dst_height);
       rtc::scoped_refptr<I420BufferInterface> src_buffer =
           input_image.video_frame_buffer()->ToI420();
       libyuv::I420Scale(src_buffer->DataY(), src_buffer->StrideY(),
@@ -18,6 +18,7 @@
 #include <utility>
 #include <vector>
 
+#include "common_video/include/shared_i420_buffer_pool.h"
 #include "media/engine/webrtcvideoencoderfactory.h"
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
 #include "rtc_base/atomicops.h"
@@ -101,6 +102,8 @@ class SimulcastEncoderAdapter : public VP8Encoder {
   std::vector<StreamInfo> streaminfos_;
   EncodedImageCallback* encoded_complete_callback_;
   std::string implementation_name_;
+  // Buffers for the input frame scaled to each stream's resolution.
+  const rtc::scoped_refptr<SharedI420BufferPool> scaled_buffer_pool_;
 
   // Used for checking the single-threaded access of the encoder interface.
   rtc::SequencedTaskChecker encoder_queue_;
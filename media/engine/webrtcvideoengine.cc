@@ -1508,6 +1508,18 @@ bool WebRtcVideoChannel::SendRtp(const uint8_t* data,
   return MediaChannel::SendPacket(&packet, rtc_options);
 }
 
+bool WebRtcVideoChannel::SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                                       const webrtc::PacketOptions& options) {
+  // SRTP protects the packet in place; copy it only if there is no room for
+  // the authentication tag.
+  if (packet.capacity() < packet.size() + kMaxSrtpHmacOverhead)
+    packet = rtc::CopyOnWriteBuffer(packet.cdata(), packet.size(),
+                                    kMaxRtpPacketLen);
+  rtc::PacketOptions rtc_options;
+  rtc_options.packet_id = options.packet_id;
+  return MediaChannel::SendPacket(&packet, rtc_options);
+}
+
 bool WebRtcVideoChannel::SendRtcp(const uint8_t* data, size_t len) {
   rtc::CopyOnWriteBuffer packet(data, len, kMaxRtpPacketLen);
   return MediaChannel::SendRtcp(&packet, rtc::PacketOptions());
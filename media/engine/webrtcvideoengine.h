@@ -451,6 +451,8 @@ class WebRtcVideoChannel : public VideoMediaChannel, public webrtc::Transport {
   bool SendRtp(const uint8_t* data,
                size_t len,
                const webrtc::PacketOptions& options) override;
+  bool SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                     const webrtc::PacketOptions& options) override;
   bool SendRtcp(const uint8_t* data, size_t len) override;
 
   static std::vector<VideoCodecSettings> MapCodecs(
@@ -228,6 +228,18 @@ class WebRtcVoiceMediaChannel final : public VoiceMediaChannel,
     return VoiceMediaChannel::SendPacket(&packet, rtc_options);
   }
 
+  bool SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                     const webrtc::PacketOptions& options) override {
+    // SRTP protects the packet in place; copy it only if there is no room
+    // for the authentication tag.
+    if (packet.capacity() < packet.size() + kMaxSrtpHmacOverhead)
+      packet = rtc::CopyOnWriteBuffer(packet.cdata(), packet.size(),
+                                      kMaxRtpPacketLen);
+    rtc::PacketOptions rtc_options;
+    rtc_options.packet_id = options.packet_id;
+    return VoiceMediaChannel::SendPacket(&packet, rtc_options);
+  }
+
   bool SendRtcp(const uint8_t* data, size_t len) override {
     rtc::CopyOnWriteBuffer packet(data, len, kMaxRtpPacketLen);
     return VoiceMediaChannel::SendRtcp(&packet, rtc::PacketOptions());
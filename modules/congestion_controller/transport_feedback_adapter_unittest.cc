@@ -18,7 +18,9 @@
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
 #include "rtc_base/safe_conversions.h"
+#include "rtc_base/timeutils.h"
 #include "system_wrappers/include/clock.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
@@ -387,5 +389,60 @@ TEST_F(TransportFeedbackAdapterTest, TimestampDeltas) {
                                  adapter_->GetTransportFeedbackVector());
   }
 }
+// Sends packets at a high rate, keeping a window of packets in flight, and
+// processes transport feedback messages covering 128 packets each, of which
+// about 5% are reported lost.
+TEST_F(TransportFeedbackAdapterTest, DISABLED_FeedbackPerformance) {
+  const int kPacketsPerFeedback = 128;
+  const int kPacketsInFlight = 1000;
+  const int kNumFeedbacks = 5000;
+  const int64_t kPacketIntervalUs = 250;
+
+  uint16_t next_seq_num = 0;
+  auto send_packet = [&]() {
+    PacketFeedback packet(PacketFeedback::kNotReceived,
+                          clock_.TimeInMilliseconds(), next_seq_num++, 1200,
+                          kPacingInfo0);
+    OnSentPacket(packet);
+    clock_.AdvanceTimeMicroseconds(kPacketIntervalUs);
+  };
+  for (int i = 0; i < kPacketsInFlight; ++i)
+    send_packet();
+
+  uint16_t first_unacked_seq_num = 0;
+  int64_t arrival_time_us = 0;
+  size_t num_reported = 0;
+  int64_t send_ns = 0;
+  int64_t feedback_ns = 0;
+  for (int i = 0; i < kNumFeedbacks; ++i) {
+    int64_t start_ns = rtc::TimeNanos();
+    for (int j = 0; j < kPacketsPerFeedback; ++j)
+      send_packet();
+    send_ns += rtc::TimeNanos() - start_ns;
+
+    rtcp::TransportFeedback feedback;
+    feedback.SetBase(first_unacked_seq_num, arrival_time_us);
+    for (int j = 0; j < kPacketsPerFeedback; ++j) {
+      uint16_t seq_num = first_unacked_seq_num++;
+      arrival_time_us += kPacketIntervalUs;
+      if (seq_num % 20 != 7 || j == 0 || j == kPacketsPerFeedback - 1)
+        ASSERT_TRUE(feedback.AddReceivedPacket(seq_num, arrival_time_us));
+    }
+
+    start_ns = rtc::TimeNanos();
+    adapter_->OnTransportFeedback(feedback);
+    feedback_ns += rtc::TimeNanos() - start_ns;
+    num_reported += adapter_->GetTransportFeedbackVector().size();
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumFeedbacks * kPacketsPerFeedback),
+            num_reported);
+
+  const int64_t num_packets = kNumFeedbacks * kPacketsPerFeedback;
+  LOG(LS_INFO) << "AddPacket + OnSentPacket: " << send_ns / num_packets
+               << " ns per packet. OnTransportFeedback: "
+               << feedback_ns / kNumFeedbacks << " ns per feedback, "
+               << feedback_ns / num_packets << " ns per packet.";
+}
+
 }  // namespace test
 }  // namespace webrtc
@@ -0,0 +1,354 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/arena_packet_queue.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+constexpr size_t ArenaPacketQueue::kMaxLeadingBytes;
+constexpr size_t ArenaPacketQueue::kPacketsPerSlab;
+constexpr size_t ArenaPacketQueue::kNumPacketClasses;
+constexpr uint32_t ArenaPacketQueue::kInvalidIndex;
+
+ArenaPacketQueue::Node::Node()
+    : packet(RtpPacketSender::kNormalPriority, 0, 0, 0, 0, 0, false, 0),
+      enqueue_time_ms(0),
+      next_in_class(kInvalidIndex),
+      prev_in_queue(kInvalidIndex),
+      next_in_queue(kInvalidIndex) {}
+
+ArenaPacketQueue::Stream::Stream(uint32_t ssrc) : ssrc(ssrc) {}
+
+ArenaPacketQueue::ArenaPacketQueue(const Clock* clock)
+    : PacketQueue(clock),
+      clock_(clock),
+      time_last_updated_(clock_->TimeInMilliseconds()) {}
+
+ArenaPacketQueue::~ArenaPacketQueue() {}
+
+void ArenaPacketQueue::Push(const Packet& packet) {
+  RTC_DCHECK(newest_node_ == kInvalidIndex ||
+             GetNode(newest_node_).packet.enqueue_order < packet.enqueue_order);
+  RTC_DCHECK(newest_node_ == kInvalidIndex ||
+             GetNode(newest_node_).enqueue_time_ms <= packet.enqueue_time_ms);
+
+  uint32_t stream_index;
+  if (const uint32_t* index = stream_index_by_ssrc_.Find(packet.ssrc)) {
+    stream_index = *index;
+  } else {
+    stream_index = static_cast<uint32_t>(streams_.size());
+    streams_.emplace_back(packet.ssrc);
+    stream_index_by_ssrc_.Insert(packet.ssrc, stream_index);
+  }
+
+  Stream& stream = streams_[stream_index];
+  if (stream.heap_index == kInvalidIndex) {
+    Schedule(stream_index, packet.priority);
+  } else if (packet.priority < stream.priority) {
+    // Note that RtpPacketSender::Priority uses lower ordinal for higher
+    // priority.
+    Unschedule(stream_index);
+    Schedule(stream_index, packet.priority);
+  }
+
+  uint32_t node_index = AllocateNode();
+  Node& node = GetNode(node_index);
+  node.packet = packet;
+  node.enqueue_time_ms = packet.enqueue_time_ms;
+  // See PacketQueue2::Push() for how time spent paused is accounted for.
+  UpdateQueueTime(packet.enqueue_time_ms);
+  node.packet.enqueue_time_ms -= pause_time_sum_ms_;
+
+  PacketList& list = stream.packets[PacketClass(packet)];
+  node.next_in_class = kInvalidIndex;
+  if (list.tail == kInvalidIndex) {
+    list.head = node_index;
+  } else {
+    GetNode(list.tail).next_in_class = node_index;
+  }
+  list.tail = node_index;
+
+  node.prev_in_queue = newest_node_;
+  node.next_in_queue = kInvalidIndex;
+  if (newest_node_ == kInvalidIndex) {
+    oldest_node_ = node_index;
+  } else {
+    GetNode(newest_node_).next_in_queue = node_index;
+  }
+  newest_node_ = node_index;
+
+  size_packets_ += 1;
+  size_bytes_ += packet.bytes;
+}
+
+const ArenaPacketQueue::Packet& ArenaPacketQueue::BeginPop() {
+  RTC_CHECK(pop_node_ == kInvalidIndex);
+  RTC_CHECK(!stream_heap_.empty());
+
+  uint32_t stream_index = stream_heap_[0];
+  Stream& stream = streams_[stream_index];
+  size_t packet_class = FirstPacketClass(stream);
+  RTC_CHECK_LT(packet_class, kNumPacketClasses);
+  PacketList& list = stream.packets[packet_class];
+  pop_node_ = list.head;
+  pop_stream_ = stream_index;
+  list.head = GetNode(pop_node_).next_in_class;
+  if (list.head == kInvalidIndex)
+    list.tail = kInvalidIndex;
+
+  return GetNode(pop_node_).packet;
+}
+
+void ArenaPacketQueue::CancelPop(const Packet& packet) {
+  RTC_CHECK(pop_node_ != kInvalidIndex);
+  Node& node = GetNode(pop_node_);
+  // The packet was first in its class, so put it back there.
+  PacketList& list = streams_[pop_stream_].packets[PacketClass(node.packet)];
+  node.next_in_class = list.head;
+  list.head = pop_node_;
+  if (list.tail == kInvalidIndex)
+    list.tail = pop_node_;
+  pop_node_ = kInvalidIndex;
+  pop_stream_ = kInvalidIndex;
+}
+
+void ArenaPacketQueue::FinalizePop(const Packet& packet) {
+  RTC_CHECK(!paused_);
+  if (Empty())
+    return;
+  RTC_CHECK(pop_node_ != kInvalidIndex);
+  Stream& stream = streams_[pop_stream_];
+  Unschedule(pop_stream_);
+  Node& node = GetNode(pop_node_);
+  const Packet& popped = node.packet;
+
+  int64_t time_in_non_paused_state_ms =
+      time_last_updated_ - popped.enqueue_time_ms - pause_time_sum_ms_;
+  queue_time_sum_ms_ -= time_in_non_paused_state_ms;
+
+  if (node.prev_in_queue == kInvalidIndex) {
+    oldest_node_ = node.next_in_queue;
+  } else {
+    GetNode(node.prev_in_queue).next_in_queue = node.next_in_queue;
+  }
+  if (node.next_in_queue == kInvalidIndex) {
+    newest_node_ = node.prev_in_queue;
+  } else {
+    GetNode(node.next_in_queue).prev_in_queue = node.prev_in_queue;
+  }
+
+  // Same limit on how far a stream can lead as in PacketQueue2.
+  stream.bytes =
+      std::max(stream.bytes + popped.bytes, max_bytes_ - kMaxLeadingBytes);
+  max_bytes_ = std::max(max_bytes_, stream.bytes);
+
+  size_bytes_ -= popped.bytes;
+  size_packets_ -= 1;
+  RTC_CHECK(size_packets_ > 0 || queue_time_sum_ms_ == 0);
+
+  // If there are packets left to be sent, schedule the stream again.
+  size_t packet_class = FirstPacketClass(stream);
+  if (packet_class < kNumPacketClasses) {
+    Schedule(pop_stream_,
+             GetNode(stream.packets[packet_class].head).packet.priority);
+  }
+
+  FreeNode(pop_node_);
+  pop_node_ = kInvalidIndex;
+  pop_stream_ = kInvalidIndex;
+}
+
+bool ArenaPacketQueue::Empty() const {
+  RTC_DCHECK((!stream_heap_.empty() && size_packets_ > 0) ||
+             (stream_heap_.empty() && size_packets_ == 0));
+  return stream_heap_.empty();
+}
+
+size_t ArenaPacketQueue::SizeInPackets() const {
+  return size_packets_;
+}
+
+uint64_t ArenaPacketQueue::SizeInBytes() const {
+  return size_bytes_;
+}
+
+int64_t ArenaPacketQueue::OldestEnqueueTimeMs() const {
+  if (Empty())
+    return 0;
+  RTC_CHECK(oldest_node_ != kInvalidIndex);
+  return GetNode(oldest_node_).enqueue_time_ms;
+}
+
+void ArenaPacketQueue::UpdateQueueTime(int64_t timestamp_ms) {
+  RTC_CHECK_GE(timestamp_ms, time_last_updated_);
+  if (timestamp_ms == time_last_updated_)
+    return;
+
+  int64_t delta_ms = timestamp_ms - time_last_updated_;
+
+  if (paused_) {
+    pause_time_sum_ms_ += delta_ms;
+  } else {
+    queue_time_sum_ms_ += delta_ms * size_packets_;
+  }
+
+  time_last_updated_ = timestamp_ms;
+}
+
+void ArenaPacketQueue::SetPauseState(bool paused, int64_t timestamp_ms) {
+  if (paused_ == paused)
+    return;
+  UpdateQueueTime(timestamp_ms);
+  paused_ = paused;
+}
+
+int64_t ArenaPacketQueue::AverageQueueTimeMs() const {
+  if (Empty())
+    return 0;
+  return queue_time_sum_ms_ / size_packets_;
+}
+
+size_t ArenaPacketQueue::PacketCapacity() const {
+  return slabs_.size() * kPacketsPerSlab;
+}
+
+// static
+size_t ArenaPacketQueue::PacketClass(const Packet& packet) {
+  // Same order as PacketQueue::Packet::operator<.
+  size_t priority_rank;
+  switch (packet.priority) {
+    case RtpPacketSender::kHighPriority:
+      priority_rank = 0;
+      break;
+    case RtpPacketSender::kNormalPriority:
+      priority_rank = 1;
+      break;
+    default:
+      RTC_DCHECK_EQ(RtpPacketSender::kLowPriority, packet.priority);
+      priority_rank = 2;
+      break;
+  }
+  return 2 * priority_rank + (packet.retransmission ? 0 : 1);
+}
+
+ArenaPacketQueue::Node& ArenaPacketQueue::GetNode(uint32_t index) {
+  RTC_DCHECK_LT(index, PacketCapacity());
+  return slabs_[index / kPacketsPerSlab][index % kPacketsPerSlab];
+}
+
+const ArenaPacketQueue::Node& ArenaPacketQueue::GetNode(uint32_t index) const {
+  RTC_DCHECK_LT(index, PacketCapacity());
+  return slabs_[index / kPacketsPerSlab][index % kPacketsPerSlab];
+}
+
+uint32_t ArenaPacketQueue::AllocateNode() {
+  if (free_nodes_ == kInvalidIndex) {
+    uint32_t first = static_cast<uint32_t>(PacketCapacity());
+    slabs_.emplace_back(new Node[kPacketsPerSlab]);
+    for (uint32_t i = kPacketsPerSlab; i > 0; --i)
+      FreeNode(first + i - 1);
+  }
+  uint32_t index = free_nodes_;
+  free_nodes_ = GetNode(index).next_in_class;
+  return index;
+}
+
+void ArenaPacketQueue::FreeNode(uint32_t index) {
+  GetNode(index).next_in_class = free_nodes_;
+  free_nodes_ = index;
+}
+
+size_t ArenaPacketQueue::FirstPacketClass(const Stream& stream) const {
+  for (size_t i = 0; i < kNumPacketClasses; ++i) {
+    if (stream.packets[i].head != kInvalidIndex)
+      return i;
+  }
+  return kNumPacketClasses;
+}
+
+void ArenaPacketQueue::Schedule(uint32_t stream_index,
+                                RtpPacketSender::Priority priority) {
+  Stream& stream = streams_[stream_index];
+  RTC_DCHECK_EQ(kInvalidIndex, stream.heap_index);
+  stream.priority = priority;
+  stream.scheduled_bytes = stream.bytes;
+  stream.schedule_order = next_schedule_order_++;
+  stream.heap_index = static_cast<uint32_t>(stream_heap_.size());
+  stream_heap_.push_back(stream_index);
+  SiftUp(stream.heap_index);
+}
+
+void ArenaPacketQueue::Unschedule(uint32_t stream_index) {
+  uint32_t heap_index = streams_[stream_index].heap_index;
+  RTC_DCHECK_NE(kInvalidIndex, heap_index);
+  uint32_t last_index = static_cast<uint32_t>(stream_heap_.size() - 1);
+  if (heap_index != last_index)
+    SwapInHeap(heap_index, last_index);
+  stream_heap_.pop_back();
+  streams_[stream_index].heap_index = kInvalidIndex;
+  if (heap_index < stream_heap_.size()) {
+    SiftDown(heap_index);
+    SiftUp(heap_index);
+  }
+}
+
+bool ArenaPacketQueue::ComesBefore(uint32_t stream_a, uint32_t stream_b) const {
+  const Stream& a = streams_[stream_a];
+  const Stream& b = streams_[stream_b];
+  // Same order as PacketQueue2::StreamPrioKey.
+  if (a.priority != b.priority)
+    return a.priority < b.priority;
+  if (a.scheduled_bytes != b.scheduled_bytes)
+    return a.scheduled_bytes > b.scheduled_bytes;
+  return a.schedule_order < b.schedule_order;
+}
+
+void ArenaPacketQueue::SiftUp(uint32_t heap_index) {
+  while (heap_index > 0) {
+    uint32_t parent = (heap_index - 1) / 2;
+    if (!ComesBefore(stream_heap_[heap_index], stream_heap_[parent]))
+      return;
+    SwapInHeap(heap_index, parent);
+    heap_index = parent;
+  }
+}
+
+void ArenaPacketQueue::SiftDown(uint32_t heap_index) {
+  const size_t size = stream_heap_.size();
+  while (true) {
+    size_t first = 2 * heap_index + 1;
+    if (first >= size)
+      return;
+    size_t child = first;
+    if (first + 1 < size &&
+        ComesBefore(stream_heap_[first + 1], stream_heap_[first])) {
+      child = first + 1;
+    }
+    if (!ComesBefore(stream_heap_[child], stream_heap_[heap_index]))
+      return;
+    SwapInHeap(heap_index, static_cast<uint32_t>(child));
+    heap_index = static_cast<uint32_t>(child);
+  }
+}
+
+void ArenaPacketQueue::SwapInHeap(uint32_t heap_index_a,
+                                  uint32_t heap_index_b) {
+  std::swap(stream_heap_[heap_index_a], stream_heap_[heap_index_b]);
+  streams_[stream_heap_[heap_index_a]].heap_index = heap_index_a;
+  streams_[stream_heap_[heap_index_b]].heap_index = heap_index_b;
+}
+
+}  // namespace webrtc
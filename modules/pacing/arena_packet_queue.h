@@ -0,0 +1,144 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_PACING_ARENA_PACKET_QUEUE_H_
+#define MODULES_PACING_ARENA_PACKET_QUEUE_H_
+
+#include <memory>
+#include <vector>
+
+#include "modules/pacing/packet_queue.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "rtc_base/flat_hash_map.h"
+
+namespace webrtc {
+
+// Sends packets in the same order as PacketQueue2, round-robin between
+// streams, but without allocating memory per packet. Packets are stored in
+// slabs of fixed size that are reused once the packets have been sent, and
+// linked into one FIFO list per stream and packet class (priority and whether
+// it is a retransmission). Streams waiting to send are kept in a binary heap
+// that only grows with the number of streams.
+//
+// Packets must be pushed in order of increasing |enqueue_order| and
+// |enqueue_time_ms|, as PacedSender does.
+class ArenaPacketQueue : public PacketQueue {
+ public:
+  explicit ArenaPacketQueue(const Clock* clock);
+  ~ArenaPacketQueue() override;
+
+  using Packet = PacketQueue::Packet;
+
+  void Push(const Packet& packet) override;
+  const Packet& BeginPop() override;
+  void CancelPop(const Packet& packet) override;
+  void FinalizePop(const Packet& packet) override;
+
+  bool Empty() const override;
+  size_t SizeInPackets() const override;
+  uint64_t SizeInBytes() const override;
+
+  int64_t OldestEnqueueTimeMs() const override;
+  int64_t AverageQueueTimeMs() const override;
+  void UpdateQueueTime(int64_t timestamp_ms) override;
+  void SetPauseState(bool paused, int64_t timestamp_ms) override;
+
+  // Number of packets the slabs currently have room for.
+  size_t PacketCapacity() const;
+
+ private:
+  static constexpr size_t kMaxLeadingBytes = 1400;
+  static constexpr size_t kPacketsPerSlab = 256;
+  // High, normal and low priority, each with and without retransmissions.
+  static constexpr size_t kNumPacketClasses = 6;
+  static constexpr uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+  struct Node {
+    Node();
+
+    Packet packet;
+    // |packet.enqueue_time_ms| before the time spent paused was subtracted.
+    int64_t enqueue_time_ms;
+    // Next packet of the same stream and class, or next free node.
+    uint32_t next_in_class;
+    // Neighbours in the order packets were pushed, over all streams.
+    uint32_t prev_in_queue;
+    uint32_t next_in_queue;
+  };
+
+  struct PacketList {
+    uint32_t head = kInvalidIndex;
+    uint32_t tail = kInvalidIndex;
+  };
+
+  struct Stream {
+    explicit Stream(uint32_t ssrc);
+
+    uint32_t ssrc;
+    size_t bytes = 0;
+    PacketList packets[kNumPacketClasses];
+
+    // Position in |stream_heap_|, or kInvalidIndex if the stream has no
+    // packets to send. The other fields mirror PacketQueue2::StreamPrioKey,
+    // with |schedule_order| breaking ties in the order streams were scheduled.
+    uint32_t heap_index = kInvalidIndex;
+    RtpPacketSender::Priority priority = RtpPacketSender::kNormalPriority;
+    size_t scheduled_bytes = 0;
+    uint64_t schedule_order = 0;
+  };
+
+  static size_t PacketClass(const Packet& packet);
+
+  Node& GetNode(uint32_t index);
+  const Node& GetNode(uint32_t index) const;
+  uint32_t AllocateNode();
+  void FreeNode(uint32_t index);
+
+  // Returns the highest priority class of |stream| that has packets, or
+  // kNumPacketClasses if there is none.
+  size_t FirstPacketClass(const Stream& stream) const;
+
+  void Schedule(uint32_t stream_index, RtpPacketSender::Priority priority);
+  void Unschedule(uint32_t stream_index);
+  bool ComesBefore(uint32_t stream_a, uint32_t stream_b) const;
+  void SiftUp(uint32_t heap_index);
+  void SiftDown(uint32_t heap_index);
+  void SwapInHeap(uint32_t heap_index_a, uint32_t heap_index_b);
+
+  const Clock* const clock_;
+  int64_t time_last_updated_;
+
+  // The packet between BeginPop() and FinalizePop() or CancelPop().
+  uint32_t pop_node_ = kInvalidIndex;
+  uint32_t pop_stream_ = kInvalidIndex;
+
+  bool paused_ = false;
+  size_t size_packets_ = 0;
+  size_t size_bytes_ = 0;
+  size_t max_bytes_ = kMaxLeadingBytes;
+  int64_t queue_time_sum_ms_ = 0;
+  int64_t pause_time_sum_ms_ = 0;
+  uint64_t next_schedule_order_ = 0;
+
+  std::vector<std::unique_ptr<Node[]>> slabs_;
+  uint32_t free_nodes_ = kInvalidIndex;
+  // Oldest and newest packet in the queue.
+  uint32_t oldest_node_ = kInvalidIndex;
+  uint32_t newest_node_ = kInvalidIndex;
+
+  std::vector<Stream> streams_;
+  rtc::FlatHashMap<uint32_t, uint32_t> stream_index_by_ssrc_;
+  // Indices into |streams_|, ordered as PacketQueue2::stream_priorities_.
+  std::vector<uint32_t> stream_heap_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_PACING_ARENA_PACKET_QUEUE_H_
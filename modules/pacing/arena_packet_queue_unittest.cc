@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "modules/pacing/arena_packet_queue.h"
+#include "modules/pacing/packet_queue2.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr RtpPacketSender::Priority kPriorities[] = {
+    RtpPacketSender::kHighPriority, RtpPacketSender::kNormalPriority,
+    RtpPacketSender::kLowPriority};
+
+PacketQueue::Packet CreatePacket(RtpPacketSender::Priority priority,
+                                 uint32_t ssrc,
+                                 uint16_t sequence_number,
+                                 int64_t enqueue_time_ms,
+                                 size_t bytes,
+                                 bool retransmission,
+                                 uint64_t enqueue_order) {
+  return PacketQueue::Packet(priority, ssrc, sequence_number, enqueue_time_ms,
+                             enqueue_time_ms, bytes, retransmission,
+                             enqueue_order);
+}
+
+}  // namespace
+
+TEST(ArenaPacketQueueTest, HigherPriorityAndRetransmissionsFirst) {
+  SimulatedClock clock(1000);
+  ArenaPacketQueue queue(&clock);
+  const uint32_t kSsrc = 1234;
+  queue.Push(CreatePacket(RtpPacketSender::kLowPriority, kSsrc, 1, 1000, 100,
+                          false, 0));
+  queue.Push(CreatePacket(RtpPacketSender::kNormalPriority, kSsrc, 2, 1000,
+                          100, false, 1));
+  queue.Push(CreatePacket(RtpPacketSender::kNormalPriority, kSsrc, 3, 1000,
+                          100, true, 2));
+  queue.Push(CreatePacket(RtpPacketSender::kHighPriority, kSsrc, 4, 1000, 100,
+                          false, 3));
+  queue.Push(CreatePacket(RtpPacketSender::kNormalPriority, kSsrc, 5, 1000,
+                          100, false, 4));
+  EXPECT_EQ(5u, queue.SizeInPackets());
+  EXPECT_EQ(500u, queue.SizeInBytes());
+
+  for (uint16_t expected : {4, 3, 2, 5, 1}) {
+    ASSERT_FALSE(queue.Empty());
+    const PacketQueue::Packet& packet = queue.BeginPop();
+    EXPECT_EQ(expected, packet.sequence_number);
+    queue.FinalizePop(packet);
+  }
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(0u, queue.SizeInBytes());
+}
+
+TEST(ArenaPacketQueueTest, CancelPopPutsPacketBackFirst) {
+  SimulatedClock clock(1000);
+  ArenaPacketQueue queue(&clock);
+  queue.Push(CreatePacket(RtpPacketSender::kNormalPriority, 1, 1, 1000, 100,
+                          false, 0));
+  queue.Push(CreatePacket(RtpPacketSender::kNormalPriority, 1, 2, 1000, 100,
+                          false, 1));
+  const PacketQueue::Packet& packet = queue.BeginPop();
+  EXPECT_EQ(1, packet.sequence_number);
+  queue.CancelPop(packet);
+  EXPECT_EQ(2u, queue.SizeInPackets());
+  EXPECT_EQ(1, queue.BeginPop().sequence_number);
+}
+
+TEST(ArenaPacketQueueTest, ReusesPacketStorage) {
+  SimulatedClock clock(1000);
+  ArenaPacketQueue queue(&clock);
+  uint64_t enqueue_order = 0;
+  for (int i = 0; i < 10000; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      queue.Push(CreatePacket(RtpPacketSender::kNormalPriority, j, i,
+                              clock.TimeInMilliseconds(), 100, false,
+                              enqueue_order++));
+    }
+    while (!queue.Empty())
+      queue.FinalizePop(queue.BeginPop());
+    clock.AdvanceTimeMilliseconds(1);
+  }
+  EXPECT_EQ(256u, queue.PacketCapacity());
+}
+
+// Runs the same random operations on ArenaPacketQueue and PacketQueue2 and
+// expects the same result.
+TEST(ArenaPacketQueueTest, SameOrderAsPacketQueue2) {
+  const int kNumSsrcs = 20;
+  SimulatedClock clock(1000);
+  ArenaPacketQueue arena_queue(&clock);
+  PacketQueue2 queue2(&clock);
+  Random random(17);
+  uint64_t enqueue_order = 0;
+  bool paused = false;
+
+  uint16_t sequence_number = 0;
+  auto push_random_packet = [&] {
+    PacketQueue::Packet packet = CreatePacket(
+        kPriorities[random.Rand(2)], random.Rand(kNumSsrcs - 1),
+        sequence_number++, clock.TimeInMilliseconds(), 50 + random.Rand(1150),
+        random.Rand(3) == 0, enqueue_order++);
+    arena_queue.Push(packet);
+    queue2.Push(packet);
+  };
+
+  for (int i = 0; i < 20000; ++i) {
+    uint32_t operation = random.Rand(99);
+    if (operation < 50) {
+      push_random_packet();
+    } else if (operation < 95) {
+      if (paused || queue2.Empty())
+        continue;
+      const PacketQueue::Packet& arena_packet = arena_queue.BeginPop();
+      const PacketQueue::Packet& packet2 = queue2.BeginPop();
+      ASSERT_EQ(packet2.ssrc, arena_packet.ssrc);
+      ASSERT_EQ(packet2.sequence_number, arena_packet.sequence_number);
+      // PacedSender lets packets be pushed while it sends one.
+      if (random.Rand(3) == 0)
+        push_random_packet();
+      if (random.Rand(9) == 0) {
+        arena_queue.CancelPop(arena_packet);
+        queue2.CancelPop(packet2);
+      } else {
+        arena_queue.FinalizePop(arena_packet);
+        queue2.FinalizePop(packet2);
+      }
+    } else if (operation < 97) {
+      paused = !paused;
+      arena_queue.SetPauseState(paused, clock.TimeInMilliseconds());
+      queue2.SetPauseState(paused, clock.TimeInMilliseconds());
+    } else {
+      clock.AdvanceTimeMilliseconds(random.Rand(10));
+      arena_queue.UpdateQueueTime(clock.TimeInMilliseconds());
+      queue2.UpdateQueueTime(clock.TimeInMilliseconds());
+    }
+    ASSERT_EQ(queue2.Empty(), arena_queue.Empty());
+    ASSERT_EQ(queue2.SizeInPackets(), arena_queue.SizeInPackets());
+    ASSERT_EQ(queue2.SizeInBytes(), arena_queue.SizeInBytes());
+    ASSERT_EQ(queue2.OldestEnqueueTimeMs(), arena_queue.OldestEnqueueTimeMs());
+    ASSERT_EQ(queue2.AverageQueueTimeMs(), arena_queue.AverageQueueTimeMs());
+  }
+}
+
+TEST(ArenaPacketQueueTest, DISABLED_Performance) {
+  const int kNumSsrcs = 200;
+  const int kNumPackets = 1000000;
+  const size_t kQueueSize = 2000;
+  SimulatedClock clock(1000);
+  std::unique_ptr<PacketQueue> queues[] = {
+      std::unique_ptr<PacketQueue>(new PacketQueue2(&clock)),
+      std::unique_ptr<PacketQueue>(new ArenaPacketQueue(&clock))};
+  const char* names[] = {"PacketQueue2", "ArenaPacketQueue"};
+
+  Random random(42);
+  std::vector<PacketQueue::Packet> packets;
+  packets.reserve(kNumPackets);
+  for (int i = 0; i < kNumPackets; ++i) {
+    packets.push_back(CreatePacket(
+        random.Rand(9) == 0 ? RtpPacketSender::kHighPriority
+                            : RtpPacketSender::kNormalPriority,
+        random.Rand(kNumSsrcs - 1), i, clock.TimeInMilliseconds(), 1200,
+        random.Rand(19) == 0, i));
+  }
+
+  for (size_t q = 0; q < 2; ++q) {
+    PacketQueue* queue = queues[q].get();
+    int64_t start_ns = rtc::TimeNanos();
+    for (const PacketQueue::Packet& packet : packets) {
+      queue->Push(packet);
+      if (queue->SizeInPackets() > kQueueSize)
+        queue->FinalizePop(queue->BeginPop());
+    }
+    while (!queue->Empty())
+      queue->FinalizePop(queue->BeginPop());
+    int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+    LOG(LS_INFO) << names[q] << ": " << kNumPackets << " packets on "
+                 << kNumSsrcs << " SSRCs pushed and popped in "
+                 << elapsed_ns / rtc::kNumNanosecsPerMillisec << " ms, "
+                 << elapsed_ns / (2 * kNumPackets) << " ns per operation.";
+  }
+  // PacketQueue2 allocates tree nodes for every packet and every time a
+  // stream is scheduled; ArenaPacketQueue only when the queue outgrows its
+  // slabs.
+  const ArenaPacketQueue* arena_queue =
+      static_cast<const ArenaPacketQueue*>(queues[1].get());
+  LOG(LS_INFO) << "ArenaPacketQueue allocated room for "
+               << arena_queue->PacketCapacity() << " packets.";
+}
+
+}  // namespace webrtc
@@ -23,7 +23,9 @@ IntervalBudget::IntervalBudget(int initial_target_rate_kbps)
 
 IntervalBudget::IntervalBudget(int initial_target_rate_kbps,
                                bool can_build_up_underuse)
-    : bytes_remaining_(0), can_build_up_underuse_(can_build_up_underuse) {
+    : bytes_remaining_(0),
+      millibits_remainder_(0),
+      can_build_up_underuse_(can_build_up_underuse) {
   set_target_rate_kbps(initial_target_rate_kbps);
 }
 
@@ -46,6 +48,19 @@ void IntervalBudget::IncreaseBudget(int64_t delta_time_ms) {
   }
 }
 
+void IntervalBudget::IncreaseBudgetUs(int64_t delta_time_us) {
+  RTC_DCHECK_LT(delta_time_us, kDeltaTimeMs * 1000);
+  // kbps * us = 1/1000 bits.
+  int64_t millibits = target_rate_kbps_ * delta_time_us + millibits_remainder_;
+  int bytes = static_cast<int>(millibits / 8000);
+  millibits_remainder_ = millibits % 8000;
+  if (bytes_remaining_ < 0 || can_build_up_underuse_) {
+    bytes_remaining_ = std::min(bytes_remaining_ + bytes, max_bytes_in_budget_);
+  } else {
+    bytes_remaining_ = std::min(bytes, max_bytes_in_budget_);
+  }
+}
+
 void IntervalBudget::UseBudget(size_t bytes) {
   bytes_remaining_ = std::max(bytes_remaining_ - static_cast<int>(bytes),
                               -max_bytes_in_budget_);
@@ -55,6 +70,17 @@ size_t IntervalBudget::bytes_remaining() const {
   return static_cast<size_t>(std::max(0, bytes_remaining_));
 }
 
+int64_t IntervalBudget::TimeUntilBudgetUs() const {
+  if (bytes_remaining_ > 0)
+    return 0;
+  if (target_rate_kbps_ <= 0)
+    return -1;
+  int64_t millibits_needed =
+      (1 - static_cast<int64_t>(bytes_remaining_)) * 8000 -
+      millibits_remainder_;
+  return (millibits_needed + target_rate_kbps_ - 1) / target_rate_kbps_;
+}
+
 int IntervalBudget::budget_level_percent() const {
   return bytes_remaining_ * 100 / max_bytes_in_budget_;
 }
@@ -25,8 +25,15 @@ class IntervalBudget {
 
   // TODO(tschumim): Unify IncreaseBudget and UseBudget to one function.
   void IncreaseBudget(int64_t delta_time_ms);
+  // Same as IncreaseBudget(), but fractions of a byte carry over to the next
+  // call so that frequent small increments add up to the target rate.
+  void IncreaseBudgetUs(int64_t delta_time_us);
   void UseBudget(size_t bytes);
 
+  // Returns the time in microseconds until bytes_remaining() becomes non-zero
+  // at the current target rate, or -1 if the target rate is zero.
+  int64_t TimeUntilBudgetUs() const;
+
   size_t bytes_remaining() const;
   int budget_level_percent() const;
   int target_rate_kbps() const;
@@ -35,6 +42,8 @@ class IntervalBudget {
   int target_rate_kbps_;
   int max_bytes_in_budget_;
   int bytes_remaining_;
+  // Budget not yet added to |bytes_remaining_|, in 1/1000 bits.
+  int64_t millibits_remainder_;
   bool can_build_up_underuse_;
 };
 
@@ -116,4 +116,31 @@ TEST(IntervalBudgetTest, CanNotBuildUpUnderuseWhenConfigured) {
             TimeToBytes(kBitrateKbps, delta_time_ms));
 }
 
+TEST(IntervalBudgetTest, MicrosecondIncrementsAddUp) {
+  IntervalBudget interval_budget(kBitrateKbps, kCanBuildUpUnderuse);
+  // Each increment is worth 1/8 byte.
+  for (int i = 0; i < 1000; ++i)
+    interval_budget.IncreaseBudgetUs(10);
+  EXPECT_EQ(interval_budget.bytes_remaining(), TimeToBytes(kBitrateKbps, 10));
+}
+
+TEST(IntervalBudgetTest, TimeUntilBudget) {
+  IntervalBudget interval_budget(kBitrateKbps);
+  interval_budget.IncreaseBudgetUs(8000);
+  EXPECT_EQ(interval_budget.TimeUntilBudgetUs(), 0);
+
+  interval_budget.UseBudget(TimeToBytes(kBitrateKbps, 8) + 99);
+  // 100 bytes at 100 kbps.
+  EXPECT_EQ(interval_budget.TimeUntilBudgetUs(), 8000);
+  interval_budget.IncreaseBudgetUs(7999);
+  EXPECT_EQ(interval_budget.bytes_remaining(), 0u);
+  EXPECT_EQ(interval_budget.TimeUntilBudgetUs(), 1);
+  interval_budget.IncreaseBudgetUs(1);
+  EXPECT_EQ(interval_budget.bytes_remaining(), 1u);
+
+  interval_budget.set_target_rate_kbps(0);
+  interval_budget.UseBudget(1);
+  EXPECT_EQ(interval_budget.TimeUntilBudgetUs(), -1);
+}
+
 }  // namespace webrtc
@@ -11,9 +11,11 @@
 #include "modules/pacing/paced_sender.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <map>
 #include <queue>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "modules/include/module_common_types.h"
@@ -45,6 +47,17 @@ const float PacedSender::kDefaultPaceMultiplier = 2.5f;
 PacedSender::PacedSender(const Clock* clock,
                          PacketSender* packet_sender,
                          RtcEventLog* event_log)
+    : PacedSender(clock,
+                  packet_sender,
+                  event_log,
+                  webrtc::field_trial::IsEnabled("WebRTC-RoundRobinPacing")
+                      ? std::unique_ptr<PacketQueue>(new PacketQueue2(clock))
+                      : std::unique_ptr<PacketQueue>(new PacketQueue(clock))) {}
+
+PacedSender::PacedSender(const Clock* clock,
+                         PacketSender* packet_sender,
+                         RtcEventLog* event_log,
+                         std::unique_ptr<PacketQueue> packets)
     : clock_(clock),
       packet_sender_(packet_sender),
       alr_detector_(new AlrDetector()),
@@ -59,12 +72,19 @@ PacedSender::PacedSender(const Clock* clock,
       pacing_bitrate_kbps_(0),
       time_last_update_us_(clock->TimeInMicroseconds()),
       first_sent_packet_ms_(-1),
-      packets_(webrtc::field_trial::IsEnabled("WebRTC-RoundRobinPacing")
-                   ? new PacketQueue2(clock)
-                   : new PacketQueue(clock)),
+      packets_(std::move(packets)),
       packet_counter_(0),
       pacing_factor_(kDefaultPaceMultiplier),
-      queue_time_limit(kMaxQueueLengthMs) {
+      queue_time_limit(kMaxQueueLengthMs),
+      burst_window_us_(0),
+      alr_elapsed_remainder_us_(0),
+      next_process_time_us_(-1),
+      num_wakeups_(0),
+      first_wakeup_time_us_(-1),
+      last_wakeup_time_us_(-1),
+      num_pacing_error_samples_(0),
+      sum_pacing_error_us_(0),
+      max_pacing_error_us_(0) {
   UpdateBudgetWithElapsedTime(kMinPacketLimitMs);
 }
 
@@ -196,26 +216,71 @@ int64_t PacedSender::AverageQueueTimeMs() {
 
 int64_t PacedSender::TimeUntilNextProcess() {
   rtc::CritScope cs(&critsect_);
-  int64_t elapsed_time_us = clock_->TimeInMicroseconds() - time_last_update_us_;
+  int64_t now_us = clock_->TimeInMicroseconds();
+  int64_t elapsed_time_us = now_us - time_last_update_us_;
   int64_t elapsed_time_ms = (elapsed_time_us + 500) / 1000;
+  int64_t time_until_process_ms;
   // When paused we wake up every 500 ms to send a padding packet to ensure
   // we won't get stuck in the paused state due to no feedback being received.
-  if (paused_)
-    return std::max<int64_t>(kPausedPacketIntervalMs - elapsed_time_ms, 0);
+  if (paused_) {
+    time_until_process_ms =
+        std::max<int64_t>(kPausedPacketIntervalMs - elapsed_time_ms, 0);
+  } else {
+    time_until_process_ms = -1;
+    if (prober_->IsProbing()) {
+      int64_t ret = prober_->TimeUntilNextProbe(clock_->TimeInMilliseconds());
+      if (ret > 0 || (ret == 0 && !probing_send_failure_))
+        time_until_process_ms = ret;
+    }
+    if (time_until_process_ms < 0 && burst_window_us_ > 0) {
+      next_process_time_us_ = NextBurstTimeUs();
+      return std::max<int64_t>((next_process_time_us_ - now_us + 500) / 1000,
+                               0);
+    }
+    if (time_until_process_ms < 0) {
+      time_until_process_ms =
+          std::max<int64_t>(kMinPacketLimitMs - elapsed_time_ms, 0);
+    }
+  }
+  next_process_time_us_ = now_us + time_until_process_ms * 1000;
+  return time_until_process_ms;
+}
 
-  if (prober_->IsProbing()) {
-    int64_t ret = prober_->TimeUntilNextProbe(clock_->TimeInMilliseconds());
-    if (ret > 0 || (ret == 0 && !probing_send_failure_))
-      return ret;
+int64_t PacedSender::NextBurstTimeUs() const {
+  if (packets_->Empty()) {
+    // Nothing to send but padding, which doesn't need more wakeups than
+    // normal pacing.
+    return time_last_update_us_ +
+           std::max(burst_window_us_, kMinPacketLimitMs * 1000);
   }
-  return std::max<int64_t>(kMinPacketLimitMs - elapsed_time_ms, 0);
+  // Wait until the budget allows sending again, but at least for the burst
+  // window so that packets are sent in batches. Budget for time beyond
+  // kMaxIntervalTimeMs is lost, so don't sleep longer than that. Before the
+  // first Process() the budget has no rate, and -1 means one burst window.
+  int64_t wait_us = media_budget_->TimeUntilBudgetUs();
+  return time_last_update_us_ +
+         std::min(std::max(wait_us, burst_window_us_),
+                  kMaxIntervalTimeMs * 1000);
 }
 
 void PacedSender::Process() {
   int64_t now_us = clock_->TimeInMicroseconds();
   rtc::CritScope cs(&critsect_);
-  int64_t elapsed_time_ms = std::min(
-      kMaxIntervalTimeMs, (now_us - time_last_update_us_ + 500) / 1000);
+  UpdatePacingStats(now_us);
+  const bool burst_pacing = burst_window_us_ > 0;
+  int64_t elapsed_time_us =
+      std::min(kMaxIntervalTimeMs * 1000, now_us - time_last_update_us_);
+  int64_t elapsed_time_ms;
+  if (burst_pacing) {
+    // Time is accounted for in microseconds; hand whole milliseconds to the
+    // ALR detector and keep the rest for the next call.
+    elapsed_time_ms = (elapsed_time_us + alr_elapsed_remainder_us_) / 1000;
+    alr_elapsed_remainder_us_ =
+        (elapsed_time_us + alr_elapsed_remainder_us_) % 1000;
+  } else {
+    elapsed_time_ms = std::min(kMaxIntervalTimeMs,
+                               (now_us - time_last_update_us_ + 500) / 1000);
+  }
   int target_bitrate_kbps = pacing_bitrate_kbps_;
 
   if (paused_) {
@@ -230,7 +295,7 @@ void PacedSender::Process() {
     return;
   }
 
-  if (elapsed_time_ms > 0) {
+  if (burst_pacing ? elapsed_time_us > 0 : elapsed_time_ms > 0) {
     size_t queue_size_bytes = packets_->SizeInBytes();
     if (queue_size_bytes > 0) {
       // Assuming equal size packets and input/output rate, the average packet
@@ -246,7 +311,11 @@ void PacedSender::Process() {
     }
 
     media_budget_->set_target_rate_kbps(target_bitrate_kbps);
-    UpdateBudgetWithElapsedTime(elapsed_time_ms);
+    if (burst_pacing) {
+      UpdateBudgetWithElapsedTimeUs(elapsed_time_us);
+    } else {
+      UpdateBudgetWithElapsedTime(elapsed_time_ms);
+    }
   }
 
   time_last_update_us_ = now_us;
@@ -353,6 +422,11 @@ void PacedSender::UpdateBudgetWithElapsedTime(int64_t delta_time_ms) {
   padding_budget_->IncreaseBudget(delta_time_ms);
 }
 
+void PacedSender::UpdateBudgetWithElapsedTimeUs(int64_t delta_time_us) {
+  media_budget_->IncreaseBudgetUs(delta_time_us);
+  padding_budget_->IncreaseBudgetUs(delta_time_us);
+}
+
 void PacedSender::UpdateBudgetWithBytesSent(size_t bytes_sent) {
   media_budget_->UseBudget(bytes_sent);
   padding_budget_->UseBudget(bytes_sent);
@@ -373,4 +447,48 @@ void PacedSender::SetQueueTimeLimit(int limit_ms) {
   queue_time_limit = limit_ms;
 }
 
+void PacedSender::SetBurstWindow(int64_t burst_window_us) {
+  {
+    rtc::CritScope cs(&critsect_);
+    burst_window_us_ = std::min(std::max<int64_t>(burst_window_us, 0),
+                                kMaxIntervalTimeMs * 1000);
+    alr_elapsed_remainder_us_ = 0;
+  }
+  if (process_thread_)
+    process_thread_->WakeUp(this);
+}
+
+PacedSender::PacingStats PacedSender::GetPacingStats() const {
+  rtc::CritScope cs(&critsect_);
+  PacingStats stats;
+  stats.wakeups = num_wakeups_;
+  if (last_wakeup_time_us_ > first_wakeup_time_us_) {
+    stats.wakeups_per_second = static_cast<int>(
+        (num_wakeups_ - 1) * 1000000 /
+        (last_wakeup_time_us_ - first_wakeup_time_us_));
+  }
+  if (num_pacing_error_samples_ > 0) {
+    stats.avg_pacing_error_us =
+        sum_pacing_error_us_ / static_cast<int64_t>(num_pacing_error_samples_);
+  }
+  stats.max_pacing_error_us = max_pacing_error_us_;
+  return stats;
+}
+
+void PacedSender::UpdatePacingStats(int64_t now_us) {
+  ++num_wakeups_;
+  if (first_wakeup_time_us_ < 0)
+    first_wakeup_time_us_ = now_us;
+  last_wakeup_time_us_ = now_us;
+  // Process() may be called without asking TimeUntilNextProcess() first, in
+  // which case there is nothing to compare against.
+  if (next_process_time_us_ < 0)
+    return;
+  int64_t error_us = std::abs(now_us - next_process_time_us_);
+  ++num_pacing_error_samples_;
+  sum_pacing_error_us_ += error_us;
+  max_pacing_error_us_ = std::max(max_pacing_error_us_, error_us);
+  next_process_time_us_ = -1;
+}
+
 }  // namespace webrtc
@@ -50,6 +50,17 @@ class PacedSender : public Pacer {
     virtual ~PacketSender() {}
   };
 
+  struct PacingStats {
+    // Number of Process() calls.
+    uint64_t wakeups = 0;
+    // Process() calls per second, averaged since the first one.
+    int wakeups_per_second = 0;
+    // Average and largest difference between when Process() was called and
+    // when the preceding TimeUntilNextProcess() asked for it to be called.
+    int64_t avg_pacing_error_us = 0;
+    int64_t max_pacing_error_us = 0;
+  };
+
   // Expected max pacer delay in ms. If ExpectedQueueTimeMs() is higher than
   // this value, the packet producers should wait (eg drop frames rather than
   // encoding them). Bitrate sent may temporarily exceed target set by
@@ -65,6 +76,12 @@ class PacedSender : public Pacer {
   PacedSender(const Clock* clock,
               PacketSender* packet_sender,
               RtcEventLog* event_log);
+  // Uses |packets| to queue packets instead of the PacketQueue or
+  // PacketQueue2 picked by the WebRTC-RoundRobinPacing field trial.
+  PacedSender(const Clock* clock,
+              PacketSender* packet_sender,
+              RtcEventLog* event_log,
+              std::unique_ptr<PacketQueue> packets);
 
   ~PacedSender() override;
 
@@ -146,12 +163,28 @@ class PacedSender : public Pacer {
   float GetPacingFactor() const;
   void SetQueueTimeLimit(int limit_ms);
 
+  // Enables burst pacing if |burst_window_us| is positive. Instead of being
+  // processed every 5 ms, the pacer then sleeps for at least the burst window
+  // and on waking sends a batch of the packets that the pacing rate allows
+  // for the time it slept. The budget is kept with microsecond precision, so
+  // the sent rate does not depend on how precisely the process thread wakes
+  // up. Larger windows mean fewer wakeups at high bitrates, at the cost of
+  // up to one window of extra queueing delay. Capped at 30 ms.
+  void SetBurstWindow(int64_t burst_window_us);
+
+  PacingStats GetPacingStats() const;
+
  private:
   // Updates the number of bytes that can be sent for the next time interval.
   void UpdateBudgetWithElapsedTime(int64_t delta_time_in_ms)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  void UpdateBudgetWithElapsedTimeUs(int64_t delta_time_us)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
   void UpdateBudgetWithBytesSent(size_t bytes)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  // Returns when burst pacing wants Process() to be called next.
+  int64_t NextBurstTimeUs() const RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  void UpdatePacingStats(int64_t now_us) RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
 
   bool SendPacket(const PacketQueue::Packet& packet,
                   const PacedPacketInfo& cluster_info)
@@ -191,6 +224,21 @@ class PacedSender : public Pacer {
 
   float pacing_factor_ RTC_GUARDED_BY(critsect_);
   int64_t queue_time_limit RTC_GUARDED_BY(critsect_);
+
+  // Zero unless burst pacing is enabled.
+  int64_t burst_window_us_ RTC_GUARDED_BY(critsect_);
+  // Elapsed time not yet reported to |alr_detector_| in burst pacing mode.
+  int64_t alr_elapsed_remainder_us_ RTC_GUARDED_BY(critsect_);
+
+  // When TimeUntilNextProcess() last asked for Process() to be called, or -1
+  // if Process() has been called since.
+  int64_t next_process_time_us_ RTC_GUARDED_BY(critsect_);
+  uint64_t num_wakeups_ RTC_GUARDED_BY(critsect_);
+  int64_t first_wakeup_time_us_ RTC_GUARDED_BY(critsect_);
+  int64_t last_wakeup_time_us_ RTC_GUARDED_BY(critsect_);
+  uint64_t num_pacing_error_samples_ RTC_GUARDED_BY(critsect_);
+  int64_t sum_pacing_error_us_ RTC_GUARDED_BY(critsect_);
+  int64_t max_pacing_error_us_ RTC_GUARDED_BY(critsect_);
 };
 }  // namespace webrtc
 #endif  // MODULES_PACING_PACED_SENDER_H_
@@ -1133,6 +1133,69 @@ TEST_P(PacedSenderTest, QueueTimePausedDuringPush) {
   EXPECT_EQ(150, send_bucket_->AverageQueueTimeMs());
 }
 
+TEST_P(PacedSenderTest, BurstPacingSendsAtPacingRate) {
+  const int kBitrateBps = 20000000;
+  const size_t kPacketSize = 1200;
+  const int64_t kBurstWindowUs = 7500;
+  const uint32_t kSsrc = 12345;
+  uint16_t sequence_number = 1234;
+  PacedSenderProbing callback;
+  PacedSender pacer(&clock_, &callback, nullptr);
+  pacer.SetProbingEnabled(false);
+  pacer.SetEstimatedBitrate(kBitrateBps);
+  pacer.SetBurstWindow(kBurstWindowUs);
+
+  const int64_t start_time_ms = clock_.TimeInMilliseconds();
+  while (clock_.TimeInMilliseconds() - start_time_ms < 1000) {
+    while (pacer.QueueSizePackets() < 200) {
+      pacer.InsertPacket(PacedSender::kNormalPriority, kSsrc,
+                         sequence_number++, clock_.TimeInMilliseconds(),
+                         kPacketSize, false);
+    }
+    // The burst window is rounded to whole milliseconds, but the time is
+    // accounted for precisely.
+    EXPECT_EQ(8, pacer.TimeUntilNextProcess());
+    clock_.AdvanceTimeMilliseconds(pacer.TimeUntilNextProcess());
+    pacer.Process();
+  }
+
+  const int64_t elapsed_ms = clock_.TimeInMilliseconds() - start_time_ms;
+  const int64_t pacing_rate_kbps =
+      kBitrateBps / 1000 * PacedSender::kDefaultPaceMultiplier;
+  EXPECT_NEAR(pacing_rate_kbps * elapsed_ms / (8 * kPacketSize),
+              callback.packets_sent(), 1);
+  EXPECT_EQ(0, callback.padding_sent());
+
+  PacedSender::PacingStats stats = pacer.GetPacingStats();
+  EXPECT_EQ(static_cast<uint64_t>(elapsed_ms / 8), stats.wakeups);
+  EXPECT_EQ(125, stats.wakeups_per_second);
+  EXPECT_EQ(500, stats.avg_pacing_error_us);
+  EXPECT_EQ(500, stats.max_pacing_error_us);
+}
+
+TEST_P(PacedSenderTest, PacingStats) {
+  PacedSender::PacingStats stats = send_bucket_->GetPacingStats();
+  EXPECT_EQ(0u, stats.wakeups);
+  EXPECT_EQ(0, stats.wakeups_per_second);
+
+  for (int i = 0; i < 100; ++i) {
+    clock_.AdvanceTimeMilliseconds(send_bucket_->TimeUntilNextProcess());
+    send_bucket_->Process();
+  }
+  // Woken up late once.
+  send_bucket_->TimeUntilNextProcess();
+  clock_.AdvanceTimeMilliseconds(7);
+  send_bucket_->Process();
+  // Not asked for; doesn't count as a pacing error.
+  send_bucket_->Process();
+
+  stats = send_bucket_->GetPacingStats();
+  EXPECT_EQ(102u, stats.wakeups);
+  EXPECT_EQ(101 * 1000 / 502, stats.wakeups_per_second);
+  EXPECT_EQ(2000 / 101, stats.avg_pacing_error_us);
+  EXPECT_EQ(2000, stats.max_pacing_error_us);
+}
+
 // TODO(sprang): Extract PacketQueue from PacedSender so that we can test
 // removing elements while paused. (This is possible, but only because of semi-
 // racy condition so can't easily be tested).
@@ -19,16 +19,25 @@
 #include "rtc_base/atomicops.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/timeutils.h"
+#include "system_wrappers/include/sleep.h"
 
 namespace webrtc {
 namespace {
 
 constexpr int kRembSendIntervalMs = 200;
 
+bool IsSendingOnSsrc(RtpRtcp* rtp_module, uint32_t ssrc) {
+  return rtp_module->SendingMedia() &&
+         (ssrc == rtp_module->SSRC() || ssrc == rtp_module->FlexfecSsrc());
+}
+
 }  // namespace
 
 PacketRouter::PacketRouter()
-    : last_remb_time_ms_(rtc::TimeMillis()),
+    : send_modules_version_(1),
+      pacer_call_version_(0),
+      pacer_send_modules_version_(0),
+      last_remb_time_ms_(rtc::TimeMillis()),
       last_send_bitrate_bps_(0),
       bitrate_bps_(0),
       max_bitrate_bps_(std::numeric_limits<decltype(max_bitrate_bps_)>::max()),
@@ -41,6 +50,7 @@ PacketRouter::~PacketRouter() {
   RTC_DCHECK(sender_remb_candidates_.empty());
   RTC_DCHECK(receiver_remb_candidates_.empty());
   RTC_DCHECK(active_remb_module_ == nullptr);
+  RTC_DCHECK_EQ(0, pacer_call_version_.load());
 }
 
 void PacketRouter::AddSendRtpModule(RtpRtcp* rtp_module, bool remb_candidate) {
@@ -54,6 +64,7 @@ void PacketRouter::AddSendRtpModule(RtpRtcp* rtp_module, bool remb_candidate) {
   } else {
     rtp_send_modules_.push_back(rtp_module);
   }
+  BumpSendModulesVersion();
 
   if (remb_candidate) {
     AddRembModuleCandidate(rtp_module, true);
@@ -61,12 +72,18 @@ void PacketRouter::AddSendRtpModule(RtpRtcp* rtp_module, bool remb_candidate) {
 }
 
 void PacketRouter::RemoveSendRtpModule(RtpRtcp* rtp_module) {
-  rtc::CritScope cs(&modules_crit_);
-  MaybeRemoveRembModuleCandidate(rtp_module, /* sender = */ true);
-  auto it =
-      std::find(rtp_send_modules_.begin(), rtp_send_modules_.end(), rtp_module);
-  RTC_DCHECK(it != rtp_send_modules_.end());
-  rtp_send_modules_.erase(it);
+  int64_t version;
+  {
+    rtc::CritScope cs(&modules_crit_);
+    MaybeRemoveRembModuleCandidate(rtp_module, /* sender = */ true);
+    auto it = std::find(rtp_send_modules_.begin(), rtp_send_modules_.end(),
+                        rtp_module);
+    RTC_DCHECK(it != rtp_send_modules_.end());
+    rtp_send_modules_.erase(it);
+    version = BumpSendModulesVersion();
+  }
+  // The caller may destroy the module once we return.
+  WaitForPacerCalls(version);
 }
 
 void PacketRouter::AddReceiveRtpModule(RtpRtcp* rtp_module,
@@ -97,26 +114,25 @@ bool PacketRouter::TimeToSendPacket(uint32_t ssrc,
                                     bool retransmission,
                                     const PacedPacketInfo& pacing_info) {
   RTC_DCHECK_RUNS_SERIALIZED(&pacer_race_);
-  rtc::CritScope cs(&modules_crit_);
-  for (auto* rtp_module : rtp_send_modules_) {
-    if (!rtp_module->SendingMedia())
-      continue;
-    if (ssrc == rtp_module->SSRC() || ssrc == rtp_module->FlexfecSsrc()) {
-      return rtp_module->TimeToSendPacket(ssrc, sequence_number,
+  StartPacerCall();
+  bool result = true;
+  RtpRtcp* rtp_module = FindSendModule(ssrc);
+  if (rtp_module) {
+    result = rtp_module->TimeToSendPacket(ssrc, sequence_number,
                                           capture_timestamp, retransmission,
                                           pacing_info);
-    }
   }
-  return true;
+  EndPacerCall();
+  return result;
 }
 
 size_t PacketRouter::TimeToSendPadding(size_t bytes_to_send,
                                        const PacedPacketInfo& pacing_info) {
   RTC_DCHECK_RUNS_SERIALIZED(&pacer_race_);
+  StartPacerCall();
   size_t total_bytes_sent = 0;
-  rtc::CritScope cs(&modules_crit_);
   // Rtp modules are ordered by which stream can most benefit from padding.
-  for (RtpRtcp* module : rtp_send_modules_) {
+  for (RtpRtcp* module : pacer_send_modules_) {
     if (module->SendingMedia() && module->HasBweExtensions()) {
       size_t bytes_sent = module->TimeToSendPadding(
           bytes_to_send - total_bytes_sent, pacing_info);
@@ -125,9 +141,69 @@ size_t PacketRouter::TimeToSendPadding(size_t bytes_to_send,
         break;
     }
   }
+  EndPacerCall();
   return total_bytes_sent;
 }
 
+int64_t PacketRouter::BumpSendModulesVersion() {
+  return ++send_modules_version_;
+}
+
+void PacketRouter::WaitForPacerCalls(int64_t version) {
+  // Pacer calls are short, and only module removal has to wait for them.
+  while (true) {
+    int64_t call_version = pacer_call_version_.load();
+    if (call_version == 0 || call_version >= version)
+      return;
+    SleepMs(0);
+  }
+}
+
+void PacketRouter::StartPacerCall() {
+  // Announce the version before checking that it is still current, so that a
+  // concurrent WaitForPacerCalls either sees this call or this call sees the
+  // new version. Both use sequentially consistent atomics.
+  int64_t version = send_modules_version_.load();
+  while (true) {
+    pacer_call_version_.store(version);
+    int64_t current_version = send_modules_version_.load();
+    if (current_version == version)
+      break;
+    version = current_version;
+  }
+  if (version == pacer_send_modules_version_)
+    return;
+  // Only taken after the send modules have changed.
+  rtc::CritScope cs(&modules_crit_);
+  pacer_send_modules_.assign(rtp_send_modules_.begin(),
+                             rtp_send_modules_.end());
+  pacer_send_module_by_ssrc_.clear();
+  pacer_send_modules_version_ = version;
+}
+
+void PacketRouter::EndPacerCall() {
+  pacer_call_version_.store(0);
+}
+
+RtpRtcp* PacketRouter::FindSendModule(uint32_t ssrc) {
+  // Modules may change SSRC or stop sending after they are added, so entries
+  // are verified on use and looked up again on mismatch.
+  RtpRtcp** cached = pacer_send_module_by_ssrc_.Find(ssrc);
+  RtpRtcp* rejected = nullptr;
+  if (cached) {
+    if (IsSendingOnSsrc(*cached, ssrc))
+      return *cached;
+    rejected = *cached;
+  }
+  for (RtpRtcp* candidate : pacer_send_modules_) {
+    if (candidate != rejected && IsSendingOnSsrc(candidate, ssrc)) {
+      pacer_send_module_by_ssrc_[ssrc] = candidate;
+      return candidate;
+    }
+  }
+  return nullptr;
+}
+
 void PacketRouter::SetTransportWideSequenceNumber(uint16_t sequence_number) {
   rtc::AtomicOps::ReleaseStore(&transport_seq_, sequence_number);
 }
@@ -11,6 +11,7 @@
 #ifndef MODULES_PACING_PACKET_ROUTER_H_
 #define MODULES_PACING_PACKET_ROUTER_H_
 
+#include <atomic>
 #include <list>
 #include <vector>
 
@@ -20,6 +21,7 @@
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/constructormagic.h"
 #include "rtc_base/criticalsection.h"
+#include "rtc_base/flat_hash_map.h"
 #include "rtc_base/race_checker.h"
 #include "rtc_base/thread_annotations.h"
 
@@ -35,6 +37,13 @@ class TransportFeedback;
 // module if possible (sender report), otherwise on receive module
 // (receiver report). For the latter case, we also keep track of the
 // receive modules.
+//
+// The pacer callbacks, TimeToSendPacket and TimeToSendPadding, do not take
+// |modules_crit_|. They work on the pacer's own copy of the send module list,
+// refreshed at the start of a call when the list has changed, and route
+// packets through an index from SSRC to module that is filled on first use.
+// RemoveSendRtpModule waits for a pacer call that may still use the removed
+// module to return, so it must not be called from within those callbacks.
 class PacketRouter : public PacedSender::PacketSender,
                      public TransportSequenceNumberAllocator,
                      public RemoteBitrateObserver,
@@ -103,11 +112,32 @@ class PacketRouter : public PacedSender::PacketSender,
   void UnsetActiveRembModule() RTC_EXCLUSIVE_LOCKS_REQUIRED(modules_crit_);
   void DetermineActiveRembModule() RTC_EXCLUSIVE_LOCKS_REQUIRED(modules_crit_);
 
+  // Publishes a change to |rtp_send_modules_| to the pacer and returns the
+  // new value of |send_modules_version_|.
+  int64_t BumpSendModulesVersion() RTC_EXCLUSIVE_LOCKS_REQUIRED(modules_crit_);
+  // Blocks until no pacer call that started before |version| is in progress.
+  void WaitForPacerCalls(int64_t version);
+
+  // Bracket the pacer callbacks.
+  void StartPacerCall();
+  void EndPacerCall();
+  // Returns the send module that should send packets for |ssrc|, or null.
+  RtpRtcp* FindSendModule(uint32_t ssrc);
+
   rtc::RaceChecker pacer_race_;
   rtc::CriticalSection modules_crit_;
   std::list<RtpRtcp*> rtp_send_modules_ RTC_GUARDED_BY(modules_crit_);
   std::vector<RtpRtcp*> rtp_receive_modules_ RTC_GUARDED_BY(modules_crit_);
 
+  // Incremented whenever |rtp_send_modules_| changes.
+  std::atomic<int64_t> send_modules_version_;
+  // The version seen by the pacer call in progress, or zero between calls.
+  std::atomic<int64_t> pacer_call_version_;
+  int64_t pacer_send_modules_version_ RTC_GUARDED_BY(pacer_race_);
+  std::vector<RtpRtcp*> pacer_send_modules_ RTC_GUARDED_BY(pacer_race_);
+  rtc::FlatHashMap<uint32_t, RtpRtcp*> pacer_send_module_by_ssrc_
+      RTC_GUARDED_BY(pacer_race_);
+
   // TODO(eladalon): remb_crit_ only ever held from one function, and it's not
   // clear if that function can actually be called from more than one thread.
   rtc::CriticalSection remb_crit_;
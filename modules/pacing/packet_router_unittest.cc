@@ -10,13 +10,19 @@
 
 #include <list>
 #include <memory>
+#include <vector>
 
 #include "modules/pacing/packet_router.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp.h"
 #include "modules/rtp_rtcp/mocks/mock_rtp_rtcp.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "rtc_base/atomicops.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/fakeclock.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
@@ -304,6 +310,157 @@ TEST(PacketRouterTest, SenderOnlyFunctionsRespectSendingMedia) {
   packet_router.RemoveSendRtpModule(&rtp);
 }
 
+TEST(PacketRouterTest, TimeToSendPacketFollowsSsrcChange) {
+  PacketRouter packet_router;
+  NiceMock<MockRtpRtcp> rtp_1;
+  NiceMock<MockRtpRtcp> rtp_2;
+  uint32_t ssrc_1 = 1234;
+  const uint32_t kSsrc2 = 4567;
+  ON_CALL(rtp_1, SSRC()).WillByDefault(ReturnPointee(&ssrc_1));
+  ON_CALL(rtp_1, SendingMedia()).WillByDefault(Return(true));
+  ON_CALL(rtp_2, SSRC()).WillByDefault(Return(kSsrc2));
+  ON_CALL(rtp_2, SendingMedia()).WillByDefault(Return(true));
+  ON_CALL(rtp_1, TimeToSendPacket(_, _, _, _, _)).WillByDefault(Return(true));
+  ON_CALL(rtp_2, TimeToSendPacket(_, _, _, _, _)).WillByDefault(Return(true));
+  packet_router.AddSendRtpModule(&rtp_1, false);
+  packet_router.AddSendRtpModule(&rtp_2, false);
+  const PacedPacketInfo kPacingInfo;
+
+  EXPECT_CALL(rtp_1, TimeToSendPacket(1234, _, _, _, _)).Times(2);
+  EXPECT_TRUE(packet_router.TimeToSendPacket(1234, 1, 1, false, kPacingInfo));
+  EXPECT_TRUE(packet_router.TimeToSendPacket(1234, 2, 1, false, kPacingInfo));
+
+  // The module is found under its new SSRC, and not under the old one.
+  ssrc_1 = 2345;
+  EXPECT_CALL(rtp_1, TimeToSendPacket(1234, _, _, _, _)).Times(0);
+  EXPECT_CALL(rtp_1, TimeToSendPacket(2345, _, _, _, _)).Times(1);
+  EXPECT_TRUE(packet_router.TimeToSendPacket(1234, 3, 1, false, kPacingInfo));
+  EXPECT_TRUE(packet_router.TimeToSendPacket(2345, 4, 1, false, kPacingInfo));
+
+  EXPECT_CALL(rtp_2, TimeToSendPacket(kSsrc2, _, _, _, _)).Times(1);
+  EXPECT_TRUE(packet_router.TimeToSendPacket(kSsrc2, 5, 1, false, kPacingInfo));
+
+  packet_router.RemoveSendRtpModule(&rtp_1);
+  packet_router.RemoveSendRtpModule(&rtp_2);
+}
+
+TEST(PacketRouterTest, RemovedModuleIsNotUsedByPacer) {
+  PacketRouter packet_router;
+  NiceMock<MockRtpRtcp> rtp_1;
+  NiceMock<MockRtpRtcp> rtp_2;
+  const uint32_t kSsrc = 1234;
+  ON_CALL(rtp_1, SSRC()).WillByDefault(Return(kSsrc));
+  ON_CALL(rtp_1, SendingMedia()).WillByDefault(Return(true));
+  ON_CALL(rtp_2, SSRC()).WillByDefault(Return(kSsrc));
+  ON_CALL(rtp_2, SendingMedia()).WillByDefault(Return(true));
+  ON_CALL(rtp_1, TimeToSendPacket(_, _, _, _, _)).WillByDefault(Return(true));
+  ON_CALL(rtp_2, TimeToSendPacket(_, _, _, _, _)).WillByDefault(Return(true));
+  const PacedPacketInfo kPacingInfo;
+
+  packet_router.AddSendRtpModule(&rtp_1, false);
+  EXPECT_CALL(rtp_1, TimeToSendPacket(kSsrc, _, _, _, _)).Times(1);
+  EXPECT_TRUE(packet_router.TimeToSendPacket(kSsrc, 1, 1, false, kPacingInfo));
+
+  // A new module takes over the SSRC once the old one is removed.
+  packet_router.AddSendRtpModule(&rtp_2, false);
+  packet_router.RemoveSendRtpModule(&rtp_1);
+  EXPECT_CALL(rtp_1, SendingMedia()).Times(0);
+  EXPECT_CALL(rtp_2, TimeToSendPacket(kSsrc, _, _, _, _)).Times(1);
+  EXPECT_TRUE(packet_router.TimeToSendPacket(kSsrc, 2, 1, false, kPacingInfo));
+
+  packet_router.RemoveSendRtpModule(&rtp_2);
+}
+
+namespace {
+
+struct PacerLoopState {
+  PacketRouter* packet_router;
+  uint32_t num_ssrcs;
+  volatile int stop;
+  int packets;
+};
+
+bool PacerLoop(void* obj) {
+  PacerLoopState* state = static_cast<PacerLoopState*>(obj);
+  const PacedPacketInfo kPacingInfo;
+  for (uint32_t ssrc = 0; ssrc < state->num_ssrcs; ++ssrc) {
+    state->packet_router->TimeToSendPacket(ssrc, 1, 1, false, kPacingInfo);
+    ++state->packets;
+  }
+  state->packet_router->TimeToSendPadding(100, kPacingInfo);
+  return !rtc::AtomicOps::AcquireLoad(&state->stop);
+}
+
+}  // namespace
+
+// Modules are destroyed right after removal while the pacer keeps sending;
+// run under a sanitizer to catch accesses to removed modules.
+TEST(PacketRouterTest, ModulesCanBeRemovedWhilePacerIsSending) {
+  const int kNumModules = 10;
+  PacketRouter packet_router;
+  PacerLoopState state = {&packet_router, kNumModules, 0, 0};
+  rtc::PlatformThread pacer_thread(&PacerLoop, &state, "Pacer");
+  pacer_thread.Start();
+
+  std::vector<std::unique_ptr<NiceMock<MockRtpRtcp>>> modules(kNumModules);
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < kNumModules; ++i) {
+      if (modules[i]) {
+        packet_router.RemoveSendRtpModule(modules[i].get());
+        modules[i].reset();
+      }
+      if ((round + i) % 3 == 0)
+        continue;
+      modules[i].reset(new NiceMock<MockRtpRtcp>());
+      ON_CALL(*modules[i], SSRC()).WillByDefault(Return(i));
+      ON_CALL(*modules[i], SendingMedia()).WillByDefault(Return(true));
+      ON_CALL(*modules[i], HasBweExtensions()).WillByDefault(Return(true));
+      packet_router.AddSendRtpModule(modules[i].get(), false);
+    }
+  }
+  rtc::AtomicOps::ReleaseStore(&state.stop, 1);
+  pacer_thread.Stop();
+  EXPECT_GT(state.packets, 0);
+
+  for (auto& module : modules) {
+    if (module)
+      packet_router.RemoveSendRtpModule(module.get());
+  }
+}
+
+// Routes paced packets among many send modules, as on a server that relays
+// many streams over one transport.
+TEST(PacketRouterTest, DISABLED_TimeToSendPacketPerformance) {
+  const int kNumModules = 500;
+  const int kNumPackets = 100000;
+  PacketRouter packet_router;
+  std::vector<std::unique_ptr<NiceMock<MockRtpRtcp>>> modules;
+  for (int i = 0; i < kNumModules; ++i) {
+    modules.emplace_back(new NiceMock<MockRtpRtcp>());
+    ON_CALL(*modules.back(), SSRC()).WillByDefault(Return(1000 + i));
+    ON_CALL(*modules.back(), SendingMedia()).WillByDefault(Return(true));
+    ON_CALL(*modules.back(), TimeToSendPacket(_, _, _, _, _))
+        .WillByDefault(Return(true));
+    packet_router.AddSendRtpModule(modules.back().get(), false);
+  }
+  Random random(42);
+  std::vector<uint32_t> ssrcs(kNumPackets);
+  for (uint32_t& ssrc : ssrcs)
+    ssrc = 1000 + random.Rand(kNumModules - 1);
+
+  const PacedPacketInfo kPacingInfo;
+  int64_t start_ns = rtc::TimeNanos();
+  for (uint32_t ssrc : ssrcs)
+    packet_router.TimeToSendPacket(ssrc, 1, 1, false, kPacingInfo);
+  int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+  LOG(LS_INFO) << kNumPackets << " packets routed among " << kNumModules
+               << " modules in " << elapsed_ns / rtc::kNumNanosecsPerMillisec
+               << " ms, " << elapsed_ns / kNumPackets << " ns per packet.";
+
+  for (auto& module : modules)
+    packet_router.RemoveSendRtpModule(module.get());
+}
+
 TEST(PacketRouterTest, AllocateSequenceNumbers) {
   PacketRouter packet_router;
 
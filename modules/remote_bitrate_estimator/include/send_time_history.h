@@ -11,16 +11,22 @@
 #ifndef MODULES_REMOTE_BITRATE_ESTIMATOR_INCLUDE_SEND_TIME_HISTORY_H_
 #define MODULES_REMOTE_BITRATE_ESTIMATOR_INCLUDE_SEND_TIME_HISTORY_H_
 
-#include <map>
+#include <vector>
 
+#include "api/optional.h"
 #include "modules/include/module_common_types.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/basictypes.h"
 #include "rtc_base/constructormagic.h"
 
 namespace webrtc {
 class Clock;
-struct PacketFeedback;
 
+// Keeps sent packets until they are acknowledged by transport feedback or are
+// older than |packet_age_limit_ms|. Packets are stored in a ring indexed by
+// unwrapped transport sequence number, so adding and looking up a packet takes
+// constant time and old packets are expired from the front of the ring. The
+// ring spans at most 2^15 sequence numbers; older packets are expired early.
 class SendTimeHistory {
  public:
   SendTimeHistory(const Clock* clock, int64_t packet_age_limit_ms);
@@ -41,11 +47,29 @@ class SendTimeHistory {
   size_t GetOutstandingBytes(uint16_t local_net_id,
                              uint16_t remote_net_id) const;
 
+  // Number of slots currently allocated for the ring.
+  size_t capacity_for_testing() const { return history_.size(); }
+
  private:
+  // Returns the packet with |unwrapped_seq_num|, or null if there is none.
+  rtc::Optional<PacketFeedback>* Find(int64_t unwrapped_seq_num);
+  // Makes room for at least |num_slots| consecutive sequence numbers.
+  void Reserve(size_t num_slots);
+  // Removes empty slots and packets older than the age limit from the front.
+  void RemoveOld(int64_t now_ms);
+  // Removes the first slot, and shrinks the ring if that empties it.
+  void RemoveFirst();
+
   const Clock* const clock_;
   const int64_t packet_age_limit_ms_;
   SequenceNumberUnwrapper seq_num_unwrapper_;
-  std::map<int64_t, PacketFeedback> history_;
+  // The packet with unwrapped sequence number n is in slot
+  // |history_[n & (history_.size() - 1)]|, where the size is a power of two.
+  // The ring covers the |num_slots_| sequence numbers from |first_seq_num_|;
+  // all slots outside of that range are empty.
+  std::vector<rtc::Optional<PacketFeedback>> history_;
+  int64_t first_seq_num_ = 0;
+  size_t num_slots_ = 0;
   rtc::Optional<int64_t> latest_acked_seq_num_;
 
   RTC_DISALLOW_IMPLICIT_CONSTRUCTORS(SendTimeHistory);
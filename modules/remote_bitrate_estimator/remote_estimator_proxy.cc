@@ -12,6 +12,7 @@
 
 #include <limits>
 #include <algorithm>
+#include <utility>
 
 #include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
 #include "rtc_base/checks.h"
@@ -32,15 +33,24 @@ const int RemoteEstimatorProxy::kDefaultSendIntervalMs = 100;
 static constexpr int64_t kMaxTimeMs =
     std::numeric_limits<int64_t>::max() / 1000;
 
+// Number of arrivals IncomingPacket() can queue between two Process() calls
+// before it has to take the lock.
+static constexpr size_t kArrivalQueueSize = 1024;
+// Initial number of slots in the arrival time ring. Grows by doubling.
+static constexpr size_t kMinArrivalRingSize = 256;
+
 RemoteEstimatorProxy::RemoteEstimatorProxy(
     const Clock* clock,
     TransportFeedbackSenderInterface* feedback_sender)
     : clock_(clock),
       feedback_sender_(feedback_sender),
       last_process_time_ms_(-1),
+      arrival_queue_(kArrivalQueueSize),
       media_ssrc_(0),
       feedback_sequence_(0),
       window_start_seq_(-1),
+      first_seq_(0),
+      num_slots_(0),
       send_interval_ms_(kDefaultSendIntervalMs) {}
 
 RemoteEstimatorProxy::~RemoteEstimatorProxy() {}
@@ -53,9 +63,19 @@ void RemoteEstimatorProxy::IncomingPacket(int64_t arrival_time_ms,
                        "is missing the transport sequence number extension!";
     return;
   }
+  RTC_DCHECK_RUNS_SERIALIZED(&network_race_);
+  PacketArrival arrival;
+  arrival.ssrc = header.ssrc;
+  arrival.sequence_number = header.extension.transportSequenceNumber;
+  arrival.arrival_time_ms = arrival_time_ms;
+  if (arrival_queue_.TryPush(std::move(arrival)))
+    return;
+
+  // Process() has fallen behind; record the queued arrivals from here, in
+  // order, before this one.
   rtc::CritScope cs(&lock_);
+  RecordQueuedArrivals();
   media_ssrc_ = header.ssrc;
-
   OnPacketArrival(header.extension.transportSequenceNumber, arrival_time_ms);
 }
 
@@ -77,6 +97,10 @@ int64_t RemoteEstimatorProxy::TimeUntilNextProcess() {
 
 void RemoteEstimatorProxy::Process() {
   last_process_time_ms_ = clock_->TimeInMilliseconds();
+  {
+    rtc::CritScope cs(&lock_);
+    RecordQueuedArrivals();
+  }
 
   bool more_to_build = true;
   while (more_to_build) {
@@ -109,6 +133,14 @@ void RemoteEstimatorProxy::OnBitrateChanged(int bitrate_bps) {
                 rtc::SafeClamp(0.05 * bitrate_bps, kMinTwccRate, kMaxTwccRate));
 }
 
+void RemoteEstimatorProxy::RecordQueuedArrivals() {
+  PacketArrival arrival;
+  while (arrival_queue_.TryPop(&arrival)) {
+    media_ssrc_ = arrival.ssrc;
+    OnPacketArrival(arrival.sequence_number, arrival.arrival_time_ms);
+  }
+}
+
 void RemoteEstimatorProxy::OnPacketArrival(uint16_t sequence_number,
                                            int64_t arrival_time) {
   if (arrival_time < 0 || arrival_time > kMaxTimeMs) {
@@ -129,15 +161,16 @@ void RemoteEstimatorProxy::OnPacketArrival(uint16_t sequence_number,
     return;
   }
 
-  if (packet_arrival_times_.lower_bound(window_start_seq_) ==
-      packet_arrival_times_.end()) {
+  const size_t mask = arrival_times_ms_.size() - 1;
+  if (window_start_seq_ >= first_seq_ + static_cast<int64_t>(num_slots_)) {
     // Start new feedback packet, cull old packets.
-    for (auto it = packet_arrival_times_.begin();
-         it != packet_arrival_times_.end() && it->first < seq &&
-         arrival_time - it->second >= kBackWindowMs;) {
-      auto delete_it = it;
-      ++it;
-      packet_arrival_times_.erase(delete_it);
+    while (num_slots_ > 0 && first_seq_ < seq) {
+      int64_t& slot = arrival_times_ms_[first_seq_ & mask];
+      if (slot >= 0 && arrival_time - slot < kBackWindowMs)
+        break;
+      slot = -1;
+      ++first_seq_;
+      --num_slots_;
     }
   }
 
@@ -147,11 +180,41 @@ void RemoteEstimatorProxy::OnPacketArrival(uint16_t sequence_number,
     window_start_seq_ = seq;
   }
 
+  ExtendTo(seq);
+  int64_t& slot = arrival_times_ms_[seq & (arrival_times_ms_.size() - 1)];
   // We are only interested in the first time a packet is received.
-  if (packet_arrival_times_.find(seq) != packet_arrival_times_.end())
+  if (slot < 0)
+    slot = arrival_time;
+}
+
+void RemoteEstimatorProxy::ExtendTo(int64_t seq) {
+  int64_t first_seq = first_seq_;
+  int64_t end_seq = first_seq_ + num_slots_;
+  if (num_slots_ == 0) {
+    first_seq = seq;
+    end_seq = seq + 1;
+  } else if (seq < first_seq_) {
+    first_seq = seq;
+  } else if (seq >= end_seq) {
+    end_seq = seq + 1;
+  } else {
     return;
+  }
 
-  packet_arrival_times_[seq] = arrival_time;
+  const size_t num_slots = static_cast<size_t>(end_seq - first_seq);
+  if (num_slots > arrival_times_ms_.size()) {
+    size_t size = std::max(arrival_times_ms_.size(), kMinArrivalRingSize);
+    while (size < num_slots)
+      size *= 2;
+    std::vector<int64_t> arrival_times_ms(size, -1);
+    for (int64_t s = first_seq_; s < first_seq_ + num_slots_; ++s) {
+      arrival_times_ms[s & (size - 1)] =
+          arrival_times_ms_[s & (arrival_times_ms_.size() - 1)];
+    }
+    arrival_times_ms_.swap(arrival_times_ms);
+  }
+  first_seq_ = first_seq;
+  num_slots_ = num_slots;
 }
 
 bool RemoteEstimatorProxy::BuildFeedbackPacket(
@@ -160,38 +223,47 @@ bool RemoteEstimatorProxy::BuildFeedbackPacket(
   // feedback packet. Some older may still be in the map, in case a reordering
   // happens and we need to retransmit them.
   rtc::CritScope cs(&lock_);
-  auto it = packet_arrival_times_.lower_bound(window_start_seq_);
-  if (it == packet_arrival_times_.end()) {
+  const size_t mask = arrival_times_ms_.size() - 1;
+  const int64_t end_seq = first_seq_ + num_slots_;
+  int64_t seq = std::max(window_start_seq_, first_seq_);
+  while (seq < end_seq && arrival_times_ms_[seq & mask] < 0)
+    ++seq;
+  if (seq >= end_seq) {
     // Feedback for all packets already sent.
     return false;
   }
 
   // TODO(sprang): Measure receive times in microseconds and remove the
   // conversions below.
-  const int64_t first_sequence = it->first;
+  const int64_t first_sequence = seq;
   feedback_packet->SetMediaSsrc(media_ssrc_);
   // Base sequence is the expected next (window_start_seq_). This is known, but
   // we might not have actually received it, so the base time shall be the time
   // of the first received packet in the feedback.
   feedback_packet->SetBase(static_cast<uint16_t>(window_start_seq_ & 0xFFFF),
-                           it->second * 1000);
+                           arrival_times_ms_[seq & mask] * 1000);
   feedback_packet->SetFeedbackSequenceNumber(feedback_sequence_++);
-  for (; it != packet_arrival_times_.end(); ++it) {
+  // The feedback packet encodes its status chunks as packets are added, so
+  // this is a single pass over the ring.
+  for (; seq < end_seq; ++seq) {
+    const int64_t arrival_time_ms = arrival_times_ms_[seq & mask];
+    if (arrival_time_ms < 0)
+      continue;
     if (!feedback_packet->AddReceivedPacket(
-            static_cast<uint16_t>(it->first & 0xFFFF), it->second * 1000)) {
+            static_cast<uint16_t>(seq & 0xFFFF), arrival_time_ms * 1000)) {
       // If we can't even add the first seq to the feedback packet, we won't be
       // able to build it at all.
-      RTC_CHECK_NE(first_sequence, it->first);
+      RTC_CHECK_NE(first_sequence, seq);
 
       // Could not add timestamp, feedback packet might be full. Return and
       // try again with a fresh packet.
       break;
     }
 
-    // Note: Don't erase items from packet_arrival_times_ after sending, in case
+    // Note: Don't erase items from arrival_times_ms_ after sending, in case
     // they need to be re-sent after a reordering. Removal will be handled
     // by OnPacketArrival once packets are too old.
-    window_start_seq_ = it->first + 1;
+    window_start_seq_ = seq + 1;
   }
 
   return true;
@@ -11,12 +11,13 @@
 #ifndef MODULES_REMOTE_BITRATE_ESTIMATOR_REMOTE_ESTIMATOR_PROXY_H_
 #define MODULES_REMOTE_BITRATE_ESTIMATOR_REMOTE_ESTIMATOR_PROXY_H_
 
-#include <map>
 #include <vector>
 
 #include "modules/include/module_common_types.h"
 #include "modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
 #include "rtc_base/criticalsection.h"
+#include "rtc_base/race_checker.h"
+#include "rtc_base/spsc_queue.h"
 
 namespace webrtc {
 
@@ -29,6 +30,11 @@ class TransportFeedback;
 // Class used when send-side BWE is enabled: This proxy is instantiated on the
 // receive side. It buffers a number of receive timestamps and then sends
 // transport feedback messages back too the send side.
+//
+// IncomingPacket() only queues the arrival, without taking a lock, so it must
+// not be called concurrently from several threads. Queued arrivals are
+// recorded by Process(), in a ring of arrival times indexed by unwrapped
+// transport sequence number, from which the feedback packets are built.
 
 class RemoteEstimatorProxy : public RemoteBitrateEstimator {
  public:
@@ -54,22 +60,43 @@ class RemoteEstimatorProxy : public RemoteBitrateEstimator {
   static const int kBackWindowMs;
 
  private:
+  struct PacketArrival {
+    uint32_t ssrc = 0;
+    uint16_t sequence_number = 0;
+    int64_t arrival_time_ms = 0;
+  };
+
+  // Records the arrivals queued by IncomingPacket().
+  void RecordQueuedArrivals() RTC_EXCLUSIVE_LOCKS_REQUIRED(&lock_);
   void OnPacketArrival(uint16_t sequence_number, int64_t arrival_time)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(&lock_);
   bool BuildFeedbackPacket(rtcp::TransportFeedback* feedback_packet);
 
+  // Extends the ring to cover |seq|, growing it if needed.
+  void ExtendTo(int64_t seq) RTC_EXCLUSIVE_LOCKS_REQUIRED(&lock_);
+
   const Clock* const clock_;
   TransportFeedbackSenderInterface* const feedback_sender_;
   int64_t last_process_time_ms_;
 
+  rtc::RaceChecker network_race_;
+  // Written by IncomingPacket(), read by Process().
+  rtc::SpscQueue<PacketArrival> arrival_queue_;
+
   rtc::CriticalSection lock_;
 
   uint32_t media_ssrc_ RTC_GUARDED_BY(&lock_);
   uint8_t feedback_sequence_ RTC_GUARDED_BY(&lock_);
   SequenceNumberUnwrapper unwrapper_ RTC_GUARDED_BY(&lock_);
   int64_t window_start_seq_ RTC_GUARDED_BY(&lock_);
-  // Map unwrapped seq -> time.
-  std::map<int64_t, int64_t> packet_arrival_times_ RTC_GUARDED_BY(&lock_);
+  // Arrival time of unwrapped sequence number n is in
+  // |arrival_times_ms_[n & (arrival_times_ms_.size() - 1)]|, or -1 if the
+  // packet has not been received. The size is a power of two. The ring covers
+  // the |num_slots_| sequence numbers from |first_seq_|; the last of them is
+  // the highest sequence number received. Slots outside of it are all -1.
+  std::vector<int64_t> arrival_times_ms_ RTC_GUARDED_BY(&lock_);
+  int64_t first_seq_ RTC_GUARDED_BY(&lock_);
+  size_t num_slots_ RTC_GUARDED_BY(&lock_);
   int64_t send_interval_ms_ RTC_GUARDED_BY(&lock_);
 };
 
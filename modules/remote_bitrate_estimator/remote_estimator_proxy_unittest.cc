@@ -11,6 +11,8 @@
 #include "modules/pacing/packet_router.h"
 #include "modules/remote_bitrate_estimator/remote_estimator_proxy.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/timeutils.h"
 #include "system_wrappers/include/clock.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
@@ -293,6 +295,43 @@ TEST_F(RemoteEstimatorProxyTest, RemovesTimestampsOutOfScope) {
   Process();
 }
 
+TEST_F(RemoteEstimatorProxyTest, RecordsAllArrivalsBetweenProcessCalls) {
+  // More than IncomingPacket() can queue before Process() runs, and spanning
+  // several growths of the arrival time ring.
+  const int kNumPackets = 3000;
+  for (int i = 0; i < kNumPackets; ++i) {
+    // Every tenth packet lost, every pair swapped.
+    if (i % 10 == 3)
+      continue;
+    const int seq = i ^ 1;
+    IncomingPacket(kBaseSeq + seq, kBaseTimeMs + seq);
+  }
+
+  std::vector<uint16_t> sequence_numbers;
+  std::vector<int64_t> timestamps_ms;
+  EXPECT_CALL(router_, SendTransportFeedback(_))
+      .WillRepeatedly(Invoke([&](rtcp::TransportFeedback* feedback_packet) {
+        for (uint16_t seq : SequenceNumbers(*feedback_packet))
+          sequence_numbers.push_back(seq);
+        for (int64_t timestamp_ms : TimestampsMs(*feedback_packet))
+          timestamps_ms.push_back(timestamp_ms);
+        return true;
+      }));
+
+  Process();
+
+  ASSERT_EQ(static_cast<size_t>(kNumPackets - kNumPackets / 10),
+            sequence_numbers.size());
+  ASSERT_EQ(sequence_numbers.size(), timestamps_ms.size());
+  for (size_t i = 0; i < sequence_numbers.size(); ++i) {
+    const int seq = sequence_numbers[i] - kBaseSeq;
+    EXPECT_NE(3, (seq ^ 1) % 10);
+    EXPECT_EQ(kBaseTimeMs + seq, timestamps_ms[i]);
+    if (i > 0)
+      EXPECT_LT(sequence_numbers[i - 1], sequence_numbers[i]);
+  }
+}
+
 TEST_F(RemoteEstimatorProxyTest, TimeUntilNextProcessIsZeroBeforeFirstProcess) {
   EXPECT_EQ(0, proxy_.TimeUntilNextProcess());
 }
@@ -334,5 +373,27 @@ TEST_F(RemoteEstimatorProxyTest, TwccReportsUse5PercentOfAvailableBandwidth) {
   EXPECT_EQ(136, proxy_.TimeUntilNextProcess());
 }
 
+// Receives a 5 Mbps stream of 1200 byte packets, with some loss and
+// reordering, and sends feedback every 100 ms.
+TEST_F(RemoteEstimatorProxyTest, DISABLED_FeedbackPerformance) {
+  const int kNumPackets = 500000;
+  const int kPacketsPerProcess = 50;
+  EXPECT_CALL(router_, SendTransportFeedback(_)).WillRepeatedly(Return(true));
+
+  int64_t start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumPackets; ++i) {
+    if (i % 50 == 7)
+      continue;
+    const int seq = i % 20 == 10 ? i + 1 : (i % 20 == 11 ? i - 1 : i);
+    IncomingPacket(static_cast<uint16_t>(seq), kBaseTimeMs + seq * 2);
+    if (i % kPacketsPerProcess == kPacketsPerProcess - 1)
+      Process();
+  }
+  int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+  LOG(LS_INFO) << "Transport feedback: "
+               << elapsed_ns / (kNumPackets / 1000) / 1000
+               << " us per 1000 packets received.";
+}
+
 }  // namespace
 }  // namespace webrtc
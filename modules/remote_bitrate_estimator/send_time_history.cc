@@ -10,12 +10,24 @@
 
 #include "modules/remote_bitrate_estimator/include/send_time_history.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/checks.h"
 #include "system_wrappers/include/clock.h"
 
 namespace webrtc {
 
+namespace {
+// Initial number of slots in the ring. Grows by doubling.
+constexpr size_t kMinHistorySize = 256;
+// Feedback for a packet more than half the 16-bit sequence number range
+// behind the newest one unwraps to a newer sequence number, so such packets
+// can't be looked up and are expired instead of growing the ring further.
+constexpr size_t kMaxHistorySize = 1 << 15;
+}  // namespace
+
 SendTimeHistory::SendTimeHistory(const Clock* clock,
                                  int64_t packet_age_limit_ms)
     : clock_(clock), packet_age_limit_ms_(packet_age_limit_ms) {}
@@ -23,27 +35,48 @@ SendTimeHistory::SendTimeHistory(const Clock* clock,
 SendTimeHistory::~SendTimeHistory() {}
 
 void SendTimeHistory::AddAndRemoveOld(const PacketFeedback& packet) {
-  int64_t now_ms = clock_->TimeInMilliseconds();
-  // Remove old.
-  while (!history_.empty() &&
-         now_ms - history_.begin()->second.creation_time_ms >
-             packet_age_limit_ms_) {
-    // TODO(sprang): Warn if erasing (too many) old items?
-    history_.erase(history_.begin());
-  }
+  RemoveOld(clock_->TimeInMilliseconds());
 
-  // Add new.
   int64_t unwrapped_seq_num = seq_num_unwrapper_.Unwrap(packet.sequence_number);
-  history_.insert(std::make_pair(unwrapped_seq_num, packet));
+  while (num_slots_ > 0 && unwrapped_seq_num - first_seq_num_ >=
+                               static_cast<int64_t>(kMaxHistorySize)) {
+    RemoveFirst();
+  }
+  if (num_slots_ == 0) {
+    Reserve(1);
+    first_seq_num_ = unwrapped_seq_num;
+    num_slots_ = 1;
+  } else if (unwrapped_seq_num < first_seq_num_) {
+    // Reordered past the oldest packet; extend the ring backwards.
+    size_t num_slots = static_cast<size_t>(first_seq_num_ + num_slots_ -
+                                           unwrapped_seq_num);
+    if (num_slots > kMaxHistorySize)
+      return;
+    Reserve(num_slots);
+    first_seq_num_ = unwrapped_seq_num;
+    num_slots_ = num_slots;
+  } else if (unwrapped_seq_num >= first_seq_num_ + static_cast<int64_t>(
+                                                      num_slots_)) {
+    size_t num_slots =
+        static_cast<size_t>(unwrapped_seq_num - first_seq_num_ + 1);
+    Reserve(num_slots);
+    num_slots_ = num_slots;
+  }
+
+  rtc::Optional<PacketFeedback>& slot =
+      history_[unwrapped_seq_num & (history_.size() - 1)];
+  // Keep the first packet added with a sequence number.
+  if (!slot)
+    slot.emplace(packet);
 }
 
 bool SendTimeHistory::OnSentPacket(uint16_t sequence_number,
                                    int64_t send_time_ms) {
   int64_t unwrapped_seq_num = seq_num_unwrapper_.Unwrap(sequence_number);
-  auto it = history_.find(unwrapped_seq_num);
-  if (it == history_.end())
+  rtc::Optional<PacketFeedback>* slot = Find(unwrapped_seq_num);
+  if (!slot)
     return false;
-  it->second.send_time_ms = send_time_ms;
+  (*slot)->send_time_ms = send_time_ms;
   return true;
 }
 
@@ -55,35 +88,93 @@ bool SendTimeHistory::GetFeedback(PacketFeedback* packet_feedback,
   latest_acked_seq_num_.emplace(
       std::max(unwrapped_seq_num, latest_acked_seq_num_.value_or(0)));
   RTC_DCHECK_GE(*latest_acked_seq_num_, 0);
-  auto it = history_.find(unwrapped_seq_num);
-  if (it == history_.end())
+  rtc::Optional<PacketFeedback>* slot = Find(unwrapped_seq_num);
+  if (!slot)
     return false;
 
   // Save arrival_time not to overwrite it.
   int64_t arrival_time_ms = packet_feedback->arrival_time_ms;
-  *packet_feedback = it->second;
+  *packet_feedback = **slot;
   packet_feedback->arrival_time_ms = arrival_time_ms;
 
-  if (remove)
-    history_.erase(it);
+  if (remove) {
+    slot->reset();
+    // Acknowledged packets mostly leave the front of the ring, so this
+    // expires them in bulk without looking at their age.
+    while (num_slots_ > 0 &&
+           !history_[first_seq_num_ & (history_.size() - 1)]) {
+      RemoveFirst();
+    }
+  }
   return true;
 }
 
 size_t SendTimeHistory::GetOutstandingBytes(uint16_t local_net_id,
                                             uint16_t remote_net_id) const {
   size_t outstanding_bytes = 0;
-  auto unacked_it = history_.begin();
-  if (latest_acked_seq_num_) {
-    unacked_it = history_.lower_bound(*latest_acked_seq_num_);
-  }
-  for (; unacked_it != history_.end(); ++unacked_it) {
-    if (unacked_it->second.local_net_id == local_net_id &&
-        unacked_it->second.remote_net_id == remote_net_id &&
-        unacked_it->second.send_time_ms >= 0) {
-      outstanding_bytes += unacked_it->second.payload_size;
+  const int64_t end_seq_num = first_seq_num_ + num_slots_;
+  int64_t seq_num = first_seq_num_;
+  if (latest_acked_seq_num_)
+    seq_num = std::max(seq_num, *latest_acked_seq_num_);
+  for (; seq_num < end_seq_num; ++seq_num) {
+    const rtc::Optional<PacketFeedback>& packet =
+        history_[seq_num & (history_.size() - 1)];
+    if (packet && packet->local_net_id == local_net_id &&
+        packet->remote_net_id == remote_net_id && packet->send_time_ms >= 0) {
+      outstanding_bytes += packet->payload_size;
     }
   }
   return outstanding_bytes;
 }
 
+rtc::Optional<PacketFeedback>* SendTimeHistory::Find(
+    int64_t unwrapped_seq_num) {
+  if (unwrapped_seq_num < first_seq_num_ ||
+      unwrapped_seq_num >= first_seq_num_ + static_cast<int64_t>(num_slots_)) {
+    return nullptr;
+  }
+  rtc::Optional<PacketFeedback>& slot =
+      history_[unwrapped_seq_num & (history_.size() - 1)];
+  return slot ? &slot : nullptr;
+}
+
+void SendTimeHistory::Reserve(size_t num_slots) {
+  if (num_slots <= history_.size())
+    return;
+  size_t size = std::max(history_.size(), kMinHistorySize);
+  while (size < num_slots)
+    size *= 2;
+  std::vector<rtc::Optional<PacketFeedback>> history(size);
+  for (size_t i = 0; i < num_slots_; ++i) {
+    int64_t seq_num = first_seq_num_ + i;
+    rtc::Optional<PacketFeedback>& slot =
+        history_[seq_num & (history_.size() - 1)];
+    if (slot)
+      history[seq_num & (size - 1)] = std::move(slot);
+  }
+  history_.swap(history);
+}
+
+void SendTimeHistory::RemoveOld(int64_t now_ms) {
+  while (num_slots_ > 0) {
+    const rtc::Optional<PacketFeedback>& slot =
+        history_[first_seq_num_ & (history_.size() - 1)];
+    // TODO(sprang): Warn if erasing (too many) old items?
+    if (slot && now_ms - slot->creation_time_ms <= packet_age_limit_ms_)
+      break;
+    RemoveFirst();
+  }
+}
+
+void SendTimeHistory::RemoveFirst() {
+  RTC_DCHECK_GT(num_slots_, 0);
+  history_[first_seq_num_ & (history_.size() - 1)].reset();
+  ++first_seq_num_;
+  if (--num_slots_ == 0 && history_.size() > kMinHistorySize) {
+    // Give back the memory of a ring that grew during a loss burst.
+    std::vector<rtc::Optional<PacketFeedback>>(kMinHistorySize)
+        .swap(history_);
+  }
+}
+
 }  // namespace webrtc
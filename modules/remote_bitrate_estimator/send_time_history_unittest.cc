@@ -231,5 +231,87 @@ TEST_F(SendTimeHistoryTest, InterlievedGetAndRemove) {
   EXPECT_TRUE(history_.GetFeedback(&packet3, true));
   EXPECT_EQ(packets[2], packet3);
 }
+
+TEST_F(SendTimeHistoryTest, KeepsPacketsWhenGrowing) {
+  // More packets in flight than the initial size of the history, wrapping the
+  // sequence number.
+  const int kNumPackets = 3000;
+  const uint16_t kFirstSeqNo = 65000;
+  for (int i = 0; i < kNumPackets; ++i) {
+    AddPacketWithSendTime(static_cast<uint16_t>(kFirstSeqNo + i), i, i,
+                          PacedPacketInfo());
+  }
+  for (int i = 0; i < kNumPackets; i += 2) {
+    PacketFeedback packet(0, static_cast<uint16_t>(kFirstSeqNo + i));
+    EXPECT_TRUE(history_.GetFeedback(&packet, true));
+    EXPECT_EQ(i, packet.send_time_ms);
+  }
+  for (int i = 0; i < kNumPackets; ++i) {
+    PacketFeedback packet(0, static_cast<uint16_t>(kFirstSeqNo + i));
+    EXPECT_EQ(i % 2 == 1, history_.GetFeedback(&packet, false));
+  }
+}
+
+TEST_F(SendTimeHistoryTest, AddsPacketOlderThanOldest) {
+  const uint16_t kSeqNo = 10;
+  AddPacketWithSendTime(kSeqNo, 100, 1, PacedPacketInfo());
+  AddPacketWithSendTime(kSeqNo + 5, 200, 2, PacedPacketInfo());
+  AddPacketWithSendTime(kSeqNo - 5, 300, 3, PacedPacketInfo());
+
+  PacketFeedback packet(0, kSeqNo - 5);
+  EXPECT_TRUE(history_.GetFeedback(&packet, true));
+  EXPECT_EQ(300u, packet.payload_size);
+  PacketFeedback packet2(0, kSeqNo);
+  EXPECT_TRUE(history_.GetFeedback(&packet2, true));
+  EXPECT_EQ(100u, packet2.payload_size);
+  PacketFeedback packet3(0, kSeqNo + 1);
+  EXPECT_FALSE(history_.GetFeedback(&packet3, true));
+  PacketFeedback packet4(0, kSeqNo + 5);
+  EXPECT_TRUE(history_.GetFeedback(&packet4, true));
+  EXPECT_EQ(200u, packet4.payload_size);
+}
+
+TEST_F(SendTimeHistoryTest, OutstandingBytesAfterLatestAcked) {
+  for (uint16_t seq_no = 0; seq_no < 10; ++seq_no)
+    AddPacketWithSendTime(seq_no, 100, seq_no, PacedPacketInfo());
+  EXPECT_EQ(1000u, history_.GetOutstandingBytes(0, 0));
+
+  // Packets before the latest acknowledged one are not outstanding, even if
+  // they have not been acknowledged themselves.
+  PacketFeedback packet(0, 4);
+  EXPECT_TRUE(history_.GetFeedback(&packet, true));
+  EXPECT_EQ(500u, history_.GetOutstandingBytes(0, 0));
+  EXPECT_EQ(0u, history_.GetOutstandingBytes(1, 0));
+}
+
+TEST_F(SendTimeHistoryTest, SteadyLossKeepsFootprintBounded) {
+  // 2000 packets per second for two minutes with a 60 s history and 1% loss.
+  // Lost packets are looked up without being removed, as
+  // TransportFeedbackAdapter does, and pin the front of the ring.
+  SendTimeHistory history(&clock_, 60000);
+  const int kNumPackets = 240000;
+  const int kFeedbackInterval = 100;
+  for (int i = 0; i < kNumPackets; ++i) {
+    clock_.AdvanceTimeMicroseconds(500);
+    uint16_t seq_no = static_cast<uint16_t>(i);
+    history.AddAndRemoveOld(PacketFeedback(clock_.TimeInMilliseconds(), seq_no,
+                                           1200, 0, 0, PacedPacketInfo()));
+    if (i % kFeedbackInterval != kFeedbackInterval - 1)
+      continue;
+    for (int j = i - kFeedbackInterval + 1; j <= i; ++j) {
+      PacketFeedback packet(0, static_cast<uint16_t>(j));
+      EXPECT_TRUE(history.GetFeedback(&packet, j % 100 != 0));
+    }
+  }
+  EXPECT_LE(history.capacity_for_testing(), 1u << 15);
+
+  // Once everything has expired, the ring gives its memory back.
+  clock_.AdvanceTimeMilliseconds(60001);
+  history.AddAndRemoveOld(PacketFeedback(clock_.TimeInMilliseconds(), 0, 1200,
+                                         0, 0, PacedPacketInfo()));
+  PacketFeedback packet(0, 0);
+  EXPECT_TRUE(history.GetFeedback(&packet, true));
+  EXPECT_LE(history.capacity_for_testing(), 256u);
+}
 }  // namespace test
 }  // namespace webrtc
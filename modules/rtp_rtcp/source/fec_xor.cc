@@ -0,0 +1,47 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/fec_xor.h"
+
+#include "system_wrappers/include/cpu_features_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+typedef void (*XorBytesFunction)(const uint8_t* src,
+                                 size_t length,
+                                 uint8_t* dst);
+
+XorBytesFunction SelectXorBytesFunction() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kAVX2) != 0)
+    return &XorBytes_AVX2;
+  if (WebRtc_GetCPUInfo(kSSE2) != 0)
+    return &XorBytes_SSE2;
+#elif defined(WEBRTC_HAS_NEON)
+  return &XorBytes_NEON;
+#endif
+  return &XorBytes_C;
+}
+
+}  // namespace
+
+void XorBytes(const uint8_t* src, size_t length, uint8_t* dst) {
+  static const XorBytesFunction xor_bytes = SelectXorBytesFunction();
+  xor_bytes(src, length, dst);
+}
+
+void XorBytes_C(const uint8_t* src, size_t length, uint8_t* dst) {
+  for (size_t i = 0; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+}  // namespace webrtc
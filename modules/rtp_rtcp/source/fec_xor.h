@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+#define MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "typedefs.h"  // NOLINT(build/include)
+
+namespace webrtc {
+
+// XORs |length| bytes of |src| into |dst|, i.e. dst[i] ^= src[i]. The buffers
+// may have any alignment but must not overlap. Uses the widest vector
+// instructions the CPU supports; the result is the same on every path.
+void XorBytes(const uint8_t* src, size_t length, uint8_t* dst);
+
+// Reference implementation, and the fallback on other CPUs.
+void XorBytes_C(const uint8_t* src, size_t length, uint8_t* dst);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void XorBytes_SSE2(const uint8_t* src, size_t length, uint8_t* dst);
+void XorBytes_AVX2(const uint8_t* src, size_t length, uint8_t* dst);
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+void XorBytes_NEON(const uint8_t* src, size_t length, uint8_t* dst);
+#endif
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
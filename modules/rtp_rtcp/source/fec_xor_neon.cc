@@ -0,0 +1,37 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/fec_xor.h"
+
+#include <arm_neon.h>
+
+namespace webrtc {
+
+void XorBytes_NEON(const uint8_t* src, size_t length, uint8_t* dst) {
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    uint8x16_t s0 = vld1q_u8(src + i);
+    uint8x16_t s1 = vld1q_u8(src + i + 16);
+    uint8x16_t s2 = vld1q_u8(src + i + 32);
+    uint8x16_t s3 = vld1q_u8(src + i + 48);
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), s0));
+    vst1q_u8(dst + i + 16, veorq_u8(vld1q_u8(dst + i + 16), s1));
+    vst1q_u8(dst + i + 32, veorq_u8(vld1q_u8(dst + i + 32), s2));
+    vst1q_u8(dst + i + 48, veorq_u8(vld1q_u8(dst + i + 48), s3));
+  }
+  for (; i + 16 <= length; i += 16) {
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/fec_xor.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+
+void XorBytes_SSE2(const uint8_t* src, size_t length, uint8_t* dst) {
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i s1 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+    __m128i s2 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+    __m128i s3 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+    _mm_storeu_si128(d, _mm_xor_si128(_mm_loadu_si128(d), s0));
+    _mm_storeu_si128(d + 1, _mm_xor_si128(_mm_loadu_si128(d + 1), s1));
+    _mm_storeu_si128(d + 2, _mm_xor_si128(_mm_loadu_si128(d + 2), s2));
+    _mm_storeu_si128(d + 3, _mm_xor_si128(_mm_loadu_si128(d + 3), s3));
+  }
+  for (; i + 16 <= length; i += 16) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+    _mm_storeu_si128(d, _mm_xor_si128(_mm_loadu_si128(d), s));
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "modules/rtp_rtcp/source/fec_test_helper.h"
+#include "modules/rtp_rtcp/source/fec_xor.h"
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+typedef void (*XorBytesFunction)(const uint8_t* src,
+                                 size_t length,
+                                 uint8_t* dst);
+
+struct XorKernel {
+  const char* name;
+  XorBytesFunction function;
+};
+
+// The kernels that can run on this CPU.
+std::vector<XorKernel> AvailableKernels() {
+  std::vector<XorKernel> kernels;
+  kernels.push_back({"C", &XorBytes_C});
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2) != 0)
+    kernels.push_back({"SSE2", &XorBytes_SSE2});
+  if (WebRtc_GetCPUInfo(kAVX2) != 0)
+    kernels.push_back({"AVX2", &XorBytes_AVX2});
+#endif
+#if defined(WEBRTC_HAS_NEON)
+  kernels.push_back({"NEON", &XorBytes_NEON});
+#endif
+  kernels.push_back({"Dispatched", &XorBytes});
+  return kernels;
+}
+
+constexpr size_t kMaxLength = 1500;
+constexpr size_t kMaxOffset = 33;
+constexpr uint32_t kMediaSsrc = 83542;
+
+}  // namespace
+
+TEST(FecXorTest, KernelsAreBitExact) {
+  Random random(0x1234);
+  std::vector<uint8_t> src(kMaxLength + kMaxOffset);
+  std::vector<uint8_t> dst(kMaxLength + kMaxOffset);
+  for (uint8_t& byte : src)
+    byte = random.Rand<uint8_t>();
+  for (uint8_t& byte : dst)
+    byte = random.Rand<uint8_t>();
+
+  for (const XorKernel& kernel : AvailableKernels()) {
+    SCOPED_TRACE(kernel.name);
+    for (size_t length = 0; length <= kMaxLength;
+         length += (length < 300 ? 1 : 97)) {
+      // Misalign the buffers differently to exercise the unaligned loads.
+      size_t src_offset = random.Rand(kMaxOffset);
+      size_t dst_offset = random.Rand(kMaxOffset);
+      std::vector<uint8_t> expected = dst;
+      std::vector<uint8_t> actual = dst;
+      XorBytes_C(&src[src_offset], length, &expected[dst_offset]);
+      kernel.function(&src[src_offset], length, &actual[dst_offset]);
+      // Also checks that no byte outside the range was touched.
+      ASSERT_EQ(expected, actual) << "length " << length;
+    }
+  }
+}
+
+TEST(FecXorTest, XorTwiceRestoresInput) {
+  Random random(0x5678);
+  std::vector<uint8_t> src(kMaxLength);
+  std::vector<uint8_t> dst(kMaxLength);
+  for (uint8_t& byte : src)
+    byte = random.Rand<uint8_t>();
+  for (uint8_t& byte : dst)
+    byte = random.Rand<uint8_t>();
+  const std::vector<uint8_t> original = dst;
+
+  XorBytes(src.data(), src.size(), dst.data());
+  EXPECT_NE(original, dst);
+  XorBytes(src.data(), src.size(), dst.data());
+  EXPECT_EQ(original, dst);
+}
+
+TEST(FecXorTest, DISABLED_KernelPerformance) {
+  const size_t kLength = 1200;
+  const int kIterations = 1000000;
+  std::vector<uint8_t> src(kLength, 0x5a);
+  std::vector<uint8_t> dst(kLength, 0xa5);
+
+  for (const XorKernel& kernel : AvailableKernels()) {
+    int64_t start_ns = rtc::TimeNanos();
+    for (int i = 0; i < kIterations; ++i)
+      kernel.function(src.data(), kLength, dst.data());
+    int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+    LOG(LS_INFO) << kernel.name << ": " << elapsed_ns / kIterations
+                 << " ns per " << kLength << " byte payload, "
+                 << (kLength * kIterations * 1000) / elapsed_ns
+                 << " MB/s. Check byte: " << static_cast<int>(dst[0]);
+  }
+}
+
+// Generates FEC for frames of 48 packets of about 1200 bytes, as sent for a
+// high bitrate key frame, with 100% protection.
+TEST(FecXorTest, DISABLED_EncodeFecPerformance) {
+  const int kNumMediaPackets = 48;
+  const int kNumFrames = 2000;
+  const uint8_t kProtectionFactor = 255;
+  Random random(0xabcdef);
+  test::fec::MediaPacketGenerator generator(1100, 1300, kMediaSsrc, &random);
+  ForwardErrorCorrection::PacketList media_packets =
+      generator.ConstructMediaPackets(kNumMediaPackets);
+
+  std::unique_ptr<ForwardErrorCorrection> fecs[] = {
+      ForwardErrorCorrection::CreateUlpfec(kMediaSsrc),
+      ForwardErrorCorrection::CreateFlexfec(kMediaSsrc + 1, kMediaSsrc)};
+  const char* names[] = {"ULPFEC", "FlexFEC"};
+
+  for (size_t f = 0; f < 2; ++f) {
+    size_t num_fec_packets = 0;
+    int64_t start_ns = rtc::TimeNanos();
+    for (int i = 0; i < kNumFrames; ++i) {
+      std::list<ForwardErrorCorrection::Packet*> fec_packets;
+      ASSERT_EQ(0, fecs[f]->EncodeFec(media_packets, kProtectionFactor, 0,
+                                      false, kFecMaskRandom, &fec_packets));
+      num_fec_packets = fec_packets.size();
+    }
+    int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+    LOG(LS_INFO) << names[f] << ": " << num_fec_packets << " FEC packets for "
+                 << kNumMediaPackets << " media packets in "
+                 << elapsed_ns / kNumFrames / rtc::kNumNanosecsPerMicrosec
+                 << " us per frame.";
+  }
+}
+
+}  // namespace webrtc
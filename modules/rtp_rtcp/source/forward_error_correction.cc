@@ -18,6 +18,7 @@
 
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/fec_xor.h"
 #include "modules/rtp_rtcp/source/flexfec_header_reader_writer.h"
 #include "modules/rtp_rtcp/source/forward_error_correction_internal.h"
 #include "modules/rtp_rtcp/source/ulpfec_header_reader_writer.h"
@@ -153,12 +154,12 @@ int ForwardErrorCorrection::EncodeFec(const PacketList& media_packets,
     fec_packets->push_back(&generated_fec_packets_[i]);
   }
 
-  const internal::PacketMaskTable mask_table(fec_mask_type, num_media_packets);
   packet_mask_size_ = internal::PacketMaskSize(num_media_packets);
-  memset(packet_masks_, 0, num_fec_packets * packet_mask_size_);
-  internal::GeneratePacketMasks(num_media_packets, num_fec_packets,
-                                num_important_packets, use_unequal_protection,
-                                mask_table, packet_masks_);
+  memcpy(packet_masks_,
+         internal::LookUpPacketMasks(num_media_packets, num_fec_packets,
+                                     num_important_packets,
+                                     use_unequal_protection, fec_mask_type),
+         num_fec_packets * packet_mask_size_);
 
   // Adapt packet masks to missing media packets.
   int num_mask_bits = InsertZerosInPacketMasks(media_packets, num_fec_packets);
@@ -606,9 +607,7 @@ void ForwardErrorCorrection::XorPayloads(const Packet& src,
   // XOR the payload.
   RTC_DCHECK_LE(kRtpHeaderSize + payload_length, sizeof(src.data));
   RTC_DCHECK_LE(dst_offset + payload_length, sizeof(dst->data));
-  for (size_t i = 0; i < payload_length; ++i) {
-    dst->data[dst_offset + i] ^= src.data[kRtpHeaderSize + i];
-  }
+  XorBytes(&src.data[kRtpHeaderSize], payload_length, &dst->data[dst_offset]);
 }
 
 bool ForwardErrorCorrection::RecoverPacket(const ReceivedFecPacket& fec_packet,
@@ -14,6 +14,8 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 
 #include "modules/rtp_rtcp/source/fec_private_tables_bursty.h"
 #include "modules/rtp_rtcp/source/fec_private_tables_random.h"
@@ -23,6 +25,23 @@ namespace {
 using webrtc::fec_private_tables::kPacketMaskBurstyTbl;
 using webrtc::fec_private_tables::kPacketMaskRandomTbl;
 
+constexpr size_t kCacheLineSize = 64;
+
+// Unequal protection masks for one mask type and number of media and FEC
+// packets, for every number of important packets. The masks for each number
+// of important packets start on a cache line of their own.
+struct UepPacketMasks {
+  std::unique_ptr<uint8_t[]> storage;
+  const uint8_t* masks;
+  size_t stride;
+};
+
+// Indexed by effective mask type, number of media packets - 1 and number of
+// FEC packets - 1. Entries are created on first use and never freed.
+std::atomic<UepPacketMasks*>
+    uep_packet_masks[2][webrtc::kUlpfecMaxMediaPackets]
+                    [webrtc::kUlpfecMaxMediaPackets];
+
 // Allow for different modes of protection for packets in UEP case.
 enum ProtectionMode {
   kModeNoOverlap,
@@ -389,6 +408,56 @@ void GeneratePacketMasks(int num_media_packets,
   }  // End of UEP modification
 }  // End of GetPacketMasks
 
+const uint8_t* LookUpPacketMasks(int num_media_packets,
+                                 int num_fec_packets,
+                                 int num_imp_packets,
+                                 bool use_unequal_protection,
+                                 FecMaskType fec_mask_type) {
+  RTC_DCHECK_GT(num_media_packets, 0);
+  RTC_DCHECK_LE(num_media_packets, kUlpfecMaxMediaPackets);
+  RTC_DCHECK_GT(num_fec_packets, 0);
+  RTC_DCHECK_LE(num_fec_packets, num_media_packets);
+  RTC_DCHECK_GE(num_imp_packets, 0);
+  RTC_DCHECK_LE(num_imp_packets, num_media_packets);
+
+  const PacketMaskTable mask_table(fec_mask_type, num_media_packets);
+  if (!use_unequal_protection || num_imp_packets == 0) {
+    return mask_table.fec_packet_mask_table()[num_media_packets -
+                                              1][num_fec_packets - 1];
+  }
+
+  std::atomic<UepPacketMasks*>& entry =
+      uep_packet_masks[mask_table.fec_mask_type()][num_media_packets - 1]
+                      [num_fec_packets - 1];
+  UepPacketMasks* uep_masks = entry.load(std::memory_order_acquire);
+  if (!uep_masks) {
+    const size_t mask_bytes =
+        num_fec_packets * PacketMaskSize(num_media_packets);
+    std::unique_ptr<UepPacketMasks> new_masks(new UepPacketMasks());
+    new_masks->stride =
+        (mask_bytes + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+    const size_t storage_size =
+        num_media_packets * new_masks->stride + kCacheLineSize - 1;
+    new_masks->storage.reset(new uint8_t[storage_size]);
+    // UnequalProtectionMask() expects zeroed masks.
+    memset(new_masks->storage.get(), 0, storage_size);
+    uint8_t* masks = new_masks->storage.get();
+    masks += (kCacheLineSize - reinterpret_cast<uintptr_t>(masks) %
+                                   kCacheLineSize) % kCacheLineSize;
+    new_masks->masks = masks;
+    for (int num_imp = 1; num_imp <= num_media_packets; ++num_imp) {
+      GeneratePacketMasks(num_media_packets, num_fec_packets, num_imp, true,
+                          mask_table, masks + (num_imp - 1) * new_masks->stride);
+    }
+    // If another thread created the same masks meanwhile, use those.
+    if (entry.compare_exchange_strong(uep_masks, new_masks.get(),
+                                      std::memory_order_acq_rel)) {
+      uep_masks = new_masks.release();
+    }
+  }
+  return uep_masks->masks + (num_imp_packets - 1) * uep_masks->stride;
+}
+
 size_t PacketMaskSize(size_t num_sequence_numbers) {
   RTC_DCHECK_LE(num_sequence_numbers, 8 * kUlpfecPacketMaskSizeLBitSet);
   if (num_sequence_numbers > 8 * kUlpfecPacketMaskSizeLBitClear) {
@@ -72,6 +72,17 @@ void GeneratePacketMasks(int num_media_packets, int num_fec_packets,
                          const PacketMaskTable& mask_table,
                          uint8_t* packet_mask);
 
+// Returns the same packet masks as GeneratePacketMasks(), as |num_fec_packets|
+// rows of PacketMaskSize(|num_media_packets|) bytes. Equal protection masks
+// point into the static tables; unequal protection masks are generated the
+// first time they are asked for and then shared by all callers in the process.
+// The returned pointer stays valid for the lifetime of the process.
+const uint8_t* LookUpPacketMasks(int num_media_packets,
+                                 int num_fec_packets,
+                                 int num_imp_packets,
+                                 bool use_unequal_protection,
+                                 FecMaskType fec_mask_type);
+
 // Returns the required packet mask size, given the number of sequence numbers
 // that will be covered.
 size_t PacketMaskSize(size_t num_sequence_numbers);
@@ -16,6 +16,7 @@
 #include "modules/rtp_rtcp/source/fec_test_helper.h"
 #include "modules/rtp_rtcp/source/flexfec_header_reader_writer.h"
 #include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "modules/rtp_rtcp/source/forward_error_correction_internal.h"
 #include "modules/rtp_rtcp/source/ulpfec_header_reader_writer.h"
 #include "rtc_base/basictypes.h"
 #include "rtc_base/random.h"
@@ -1113,4 +1114,40 @@ TYPED_TEST(RtpFecTest, FecRecoveryNonConsecutivePacketsWrap) {
   EXPECT_FALSE(this->IsRecoveryComplete());
 }
 
+TEST(PacketMaskLookUpTest, SameMasksAsGeneratePacketMasks) {
+  uint8_t expected[kUlpfecMaxMediaPackets * kUlpfecMaxPacketMaskSize];
+  for (FecMaskType fec_mask_type : {kFecMaskRandom, kFecMaskBursty}) {
+    for (int num_media = 1; num_media <= 48; ++num_media) {
+      const internal::PacketMaskTable mask_table(fec_mask_type, num_media);
+      const size_t mask_size = internal::PacketMaskSize(num_media);
+      for (int num_fec = 1; num_fec <= num_media; ++num_fec) {
+        for (int num_imp = 0; num_imp <= num_media; ++num_imp) {
+          for (bool use_uep : {false, true}) {
+            memset(expected, 0, sizeof(expected));
+            internal::GeneratePacketMasks(num_media, num_fec, num_imp,
+                                          use_uep, mask_table, expected);
+            const uint8_t* masks = internal::LookUpPacketMasks(
+                num_media, num_fec, num_imp, use_uep, fec_mask_type);
+            ASSERT_EQ(0, memcmp(expected, masks, num_fec * mask_size))
+                << "media " << num_media << ", FEC " << num_fec
+                << ", important " << num_imp << ", UEP " << use_uep;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(PacketMaskLookUpTest, UnequalProtectionMasksAreGeneratedOnce) {
+  const uint8_t* masks =
+      internal::LookUpPacketMasks(20, 10, 3, true, kFecMaskRandom);
+  EXPECT_EQ(masks,
+            internal::LookUpPacketMasks(20, 10, 3, true, kFecMaskRandom));
+  EXPECT_NE(masks,
+            internal::LookUpPacketMasks(20, 10, 4, true, kFecMaskRandom));
+  // Bursty masks are only defined up to 12 media packets.
+  EXPECT_EQ(internal::LookUpPacketMasks(20, 10, 3, true, kFecMaskBursty),
+            masks);
+}
+
 }  // namespace webrtc
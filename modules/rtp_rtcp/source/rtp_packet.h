@@ -97,6 +97,10 @@ class RtpPacket {
   template <typename Extension, typename... Values>
   bool GetExtension(Values...) const;
 
+  // Returns the unparsed extension, or an empty view if it is not present.
+  template <typename Extension>
+  rtc::ArrayView<const uint8_t> GetRawExtension() const;
+
   template <typename Extension, typename... Values>
   bool SetExtension(Values...);
 
@@ -174,6 +178,11 @@ bool RtpPacket::GetExtension(Values... values) const {
   return Extension::Parse(raw, values...);
 }
 
+template <typename Extension>
+rtc::ArrayView<const uint8_t> RtpPacket::GetRawExtension() const {
+  return FindExtension(Extension::kId);
+}
+
 template <typename Extension, typename... Values>
 bool RtpPacket::SetExtension(Values... values) {
   const size_t value_size = Extension::ValueSize(values...);
@@ -14,6 +14,7 @@
 #include <limits>
 #include <utility>
 
+#include "modules/include/module_common_types.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
@@ -26,7 +27,11 @@ constexpr size_t kMinPacketRequestBytes = 50;
 constexpr size_t RtpPacketHistory::kMaxCapacity;
 
 RtpPacketHistory::RtpPacketHistory(Clock* clock)
-    : clock_(clock), store_(false), prev_index_(0) {}
+    : clock_(clock),
+      store_(false),
+      first_index_(0),
+      first_sequence_number_(0),
+      num_sequence_numbers_(0) {}
 
 RtpPacketHistory::~RtpPacketHistory() {}
 
@@ -48,8 +53,17 @@ void RtpPacketHistory::SetStorePacketsStatus(bool enable,
 void RtpPacketHistory::Allocate(size_t number_to_store) {
   RTC_DCHECK_GT(number_to_store, 0);
   RTC_DCHECK_LE(number_to_store, kMaxCapacity);
+  RTC_DCHECK_GE(number_to_store, num_sequence_numbers_);
+  // Packets already stored are moved to the start of the new buffer, keeping
+  // their order.
+  std::vector<StoredPacket> stored_packets(number_to_store);
+  for (size_t i = 0; i < num_sequence_numbers_; ++i) {
+    stored_packets[i] = std::move(
+        stored_packets_[(first_index_ + i) % stored_packets_.size()]);
+  }
+  stored_packets_.swap(stored_packets);
+  first_index_ = 0;
   store_ = true;
-  stored_packets_.resize(number_to_store);
 }
 
 void RtpPacketHistory::Free() {
@@ -60,7 +74,8 @@ void RtpPacketHistory::Free() {
   stored_packets_.clear();
 
   store_ = false;
-  prev_index_ = 0;
+  first_index_ = 0;
+  num_sequence_numbers_ = 0;
 }
 
 bool RtpPacketHistory::StorePackets() const {
@@ -77,36 +92,78 @@ void RtpPacketHistory::PutRtpPacket(std::unique_ptr<RtpPacketToSend> packet,
     return;
   }
 
-  // If index we're about to overwrite contains a packet that has not
-  // yet been sent (probably pending in paced sender), we need to expand
-  // the buffer.
-  if (stored_packets_[prev_index_].packet &&
-      stored_packets_[prev_index_].send_time == 0) {
-    size_t current_size = static_cast<uint16_t>(stored_packets_.size());
-    if (current_size < kMaxCapacity) {
-      size_t expanded_size = std::max(current_size * 3 / 2, current_size + 1);
-      expanded_size = std::min(expanded_size, kMaxCapacity);
-      Allocate(expanded_size);
-      // Causes discontinuity, but that's OK-ish. FindSeqNum() will still work,
-      // but may be slower - at least until buffer has wrapped around once.
-      prev_index_ = current_size;
-    }
-  }
+  size_t index = Insert(packet->SequenceNumber());
 
   // Store packet.
   if (packet->capture_time_ms() <= 0)
     packet->set_capture_time_ms(clock_->TimeInMilliseconds());
-  stored_packets_[prev_index_].sequence_number = packet->SequenceNumber();
-  stored_packets_[prev_index_].send_time =
-      (sent ? clock_->TimeInMilliseconds() : 0);
-  stored_packets_[prev_index_].storage_type = type;
-  stored_packets_[prev_index_].has_been_retransmitted = false;
-  stored_packets_[prev_index_].packet = std::move(packet);
-
-  ++prev_index_;
-  if (prev_index_ >= stored_packets_.size()) {
-    prev_index_ = 0;
+  StoredPacket& stored = stored_packets_[index];
+  stored.sequence_number = packet->SequenceNumber();
+  stored.send_time = (sent ? clock_->TimeInMilliseconds() : 0);
+  stored.storage_type = type;
+  stored.has_been_retransmitted = false;
+  stored.packet = std::move(packet);
+}
+
+size_t RtpPacketHistory::Insert(uint16_t sequence_number) {
+  if (num_sequence_numbers_ == 0)
+    first_sequence_number_ = sequence_number;
+
+  uint16_t offset = sequence_number - first_sequence_number_;
+  if (IsNewerSequenceNumber(first_sequence_number_, sequence_number)) {
+    // Older than any stored packet. Extend the window backwards if it fits,
+    // slots outside the window are always empty.
+    size_t num_older = static_cast<uint16_t>(-offset);
+    if (num_sequence_numbers_ + num_older > stored_packets_.size()) {
+      // The sequence numbers jumped backwards, e.g. through
+      // RTPSender::SetSequenceNumber(). Start over from |sequence_number|
+      // rather than refusing to store anything until the new sequence
+      // numbers catch up with the window.
+      while (num_sequence_numbers_ > 0)
+        RemoveOldest();
+      first_sequence_number_ = sequence_number;
+      num_sequence_numbers_ = 1;
+      return first_index_;
+    }
+    first_index_ =
+        (first_index_ + stored_packets_.size() - num_older) %
+        stored_packets_.size();
+    first_sequence_number_ = sequence_number;
+    num_sequence_numbers_ += num_older;
+    return first_index_;
+  }
+
+  while (offset >= stored_packets_.size()) {
+    // If the oldest packet has not yet been sent (probably pending in paced
+    // sender), expand the buffer rather than dropping it.
+    const StoredPacket& oldest = stored_packets_[first_index_];
+    size_t current_size = stored_packets_.size();
+    if (oldest.packet && oldest.send_time == 0 &&
+        current_size < kMaxCapacity) {
+      size_t expanded_size = std::max(current_size * 3 / 2, current_size + 1);
+      Allocate(std::min(expanded_size, kMaxCapacity));
+      continue;
+    }
+    RemoveOldest();
+    if (num_sequence_numbers_ == 0)
+      first_sequence_number_ = sequence_number;
+    offset = sequence_number - first_sequence_number_;
   }
+
+  num_sequence_numbers_ = std::max<size_t>(num_sequence_numbers_, offset + 1);
+  size_t index = first_index_ + offset;
+  if (index >= stored_packets_.size())
+    index -= stored_packets_.size();
+  return index;
+}
+
+void RtpPacketHistory::RemoveOldest() {
+  RTC_DCHECK_GT(num_sequence_numbers_, 0);
+  stored_packets_[first_index_] = StoredPacket();
+  if (++first_index_ == stored_packets_.size())
+    first_index_ = 0;
+  ++first_sequence_number_;
+  --num_sequence_numbers_;
 }
 
 bool RtpPacketHistory::HasRtpPacket(uint16_t sequence_number) const {
@@ -173,31 +230,14 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetBestFittingPacket(
 }
 
 bool RtpPacketHistory::FindSeqNum(uint16_t sequence_number, int* index) const {
-  if (prev_index_ > 0) {
-    *index = prev_index_ - 1;
-  } else {
-    *index = stored_packets_.size() - 1;  // Wrap.
-  }
-  uint16_t temp_sequence_number = stored_packets_[*index].sequence_number;
-
-  int idx = *index - (temp_sequence_number - sequence_number);
-  if (idx >= 0 && idx < static_cast<int>(stored_packets_.size())) {
-    *index = idx;
-    temp_sequence_number = stored_packets_[*index].sequence_number;
-  }
-
-  if (temp_sequence_number != sequence_number) {
-    // We did not found a match, search all.
-    for (uint16_t m = 0; m < stored_packets_.size(); m++) {
-      if (stored_packets_[m].sequence_number == sequence_number) {
-        *index = m;
-        temp_sequence_number = stored_packets_[*index].sequence_number;
-        break;
-      }
-    }
-  }
-  return temp_sequence_number == sequence_number &&
-         stored_packets_[*index].packet;
+  uint16_t offset = sequence_number - first_sequence_number_;
+  if (offset >= num_sequence_numbers_)
+    return false;
+  size_t slot = first_index_ + offset;
+  if (slot >= stored_packets_.size())
+    slot -= stored_packets_.size();
+  *index = static_cast<int>(slot);
+  return stored_packets_[slot].packet != nullptr;
 }
 
 int RtpPacketHistory::FindBestFittingPacket(size_t size) const {
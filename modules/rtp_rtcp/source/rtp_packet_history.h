@@ -39,7 +39,9 @@ class RtpPacketHistory {
                     bool sent);
 
   // Gets stored RTP packet corresponding to the input |sequence number|.
-  // Returns nullptr if packet is not found.
+  // Returns nullptr if packet is not found. The returned packet shares its
+  // payload buffer with the stored packet; the buffer is only copied if the
+  // caller modifies the packet.
   // |min_elapsed_time_ms| is the minimum time that must have elapsed since
   // the last time the packet was resent (parameter is ignored if set to zero).
   // If the packet is found but the minimum time has not elapsed, returns
@@ -68,6 +70,12 @@ class RtpPacketHistory {
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
   void Allocate(size_t number_to_store) RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
   void Free() RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  // Makes room for |sequence_number| in the window of stored sequence numbers
+  // and returns its index. If |sequence_number| is too old to fit in the
+  // window, the stored packets are released and the window starts over.
+  size_t Insert(uint16_t sequence_number)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  void RemoveOldest() RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
   bool FindSeqNum(uint16_t sequence_number, int* index) const
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
   int FindBestFittingPacket(size_t size) const
@@ -76,8 +84,14 @@ class RtpPacketHistory {
   Clock* clock_;
   rtc::CriticalSection critsect_;
   bool store_ RTC_GUARDED_BY(critsect_);
-  uint32_t prev_index_ RTC_GUARDED_BY(critsect_);
+  // |stored_packets_| is a ring buffer indexed by sequence number: the packet
+  // with sequence number |first_sequence_number_| + n is stored at
+  // (|first_index_| + n) % size, for n < |num_sequence_numbers_|. Sequence
+  // numbers that were never stored leave an empty slot.
   std::vector<StoredPacket> stored_packets_ RTC_GUARDED_BY(critsect_);
+  size_t first_index_ RTC_GUARDED_BY(critsect_);
+  uint16_t first_sequence_number_ RTC_GUARDED_BY(critsect_);
+  size_t num_sequence_numbers_ RTC_GUARDED_BY(critsect_);
 
   RTC_DISALLOW_IMPLICIT_CONSTRUCTORS(RtpPacketHistory);
 };
@@ -17,6 +17,11 @@ namespace webrtc {
 // Class to hold rtp packet with metadata for sender side.
 class RtpPacketToSend : public RtpPacket {
  public:
+  // Capacity that senders allocate on top of the packet size, so that the
+  // transport can append the SRTP authentication tag, at most 16 bytes for
+  // AES-GCM, in place instead of reallocating the packet.
+  static constexpr size_t kSrtpTrailerCapacity = 16;
+
   explicit RtpPacketToSend(const ExtensionManager* extensions)
       : RtpPacket(extensions) {}
   RtpPacketToSend(const RtpPacketToSend& packet) = default;
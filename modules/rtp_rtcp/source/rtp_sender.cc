@@ -642,7 +642,8 @@ bool RTPSender::SendPacketToNetwork(const RtpPacketToSend& packet,
   int bytes_sent = -1;
   if (transport_) {
     UpdateRtpOverhead(packet);
-    bytes_sent = transport_->SendRtp(packet.data(), packet.size(), options)
+    // Shares the packet buffer with the transport instead of copying it.
+    bytes_sent = transport_->SendRtpBuffer(packet.Buffer(), options)
                      ? static_cast<int>(packet.size())
                      : -1;
     if (event_log_ && bytes_sent > 0) {
@@ -1021,8 +1022,9 @@ void RTPSender::GetDataCounters(StreamDataCounters* rtp_stats,
 
 std::unique_ptr<RtpPacketToSend> RTPSender::AllocatePacket() const {
   rtc::CritScope lock(&send_critsect_);
-  std::unique_ptr<RtpPacketToSend> packet(
-      new RtpPacketToSend(&rtp_header_extension_map_, max_packet_size_));
+  std::unique_ptr<RtpPacketToSend> packet(new RtpPacketToSend(
+      &rtp_header_extension_map_,
+      max_packet_size_ + RtpPacketToSend::kSrtpTrailerCapacity));
   RTC_DCHECK(ssrc_);
   packet->SetSsrc(*ssrc_);
   packet->SetCsrcs(csrcs_);
@@ -1171,10 +1173,10 @@ bool RTPSender::SetFecParameters(const FecProtectionParams& delta_params,
 
 std::unique_ptr<RtpPacketToSend> RTPSender::BuildRtxPacket(
     const RtpPacketToSend& packet) {
-  // TODO(danilchap): Create rtx packet with extra capacity for SRTP
-  // when transport interface would be updated to take buffer class.
-  std::unique_ptr<RtpPacketToSend> rtx_packet(new RtpPacketToSend(
-      &rtp_header_extension_map_, packet.size() + kRtxHeaderSize));
+  std::unique_ptr<RtpPacketToSend> rtx_packet(
+      new RtpPacketToSend(&rtp_header_extension_map_,
+                          packet.size() + kRtxHeaderSize +
+                              RtpPacketToSend::kSrtpTrailerCapacity));
   // Add original RTP header.
   rtx_packet->CopyHeaderFrom(packet);
   {
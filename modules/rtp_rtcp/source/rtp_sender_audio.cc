@@ -301,8 +301,9 @@ bool RTPSenderAudio::SendTelephoneEventPacket(bool ended,
     // Send DTMF data.
     constexpr RtpPacketToSend::ExtensionManager* kNoExtensions = nullptr;
     constexpr size_t kDtmfSize = 4;
-    std::unique_ptr<RtpPacketToSend> packet(
-        new RtpPacketToSend(kNoExtensions, kRtpHeaderSize + kDtmfSize));
+    std::unique_ptr<RtpPacketToSend> packet(new RtpPacketToSend(
+        kNoExtensions, kRtpHeaderSize + kDtmfSize +
+                           RtpPacketToSend::kSrtpTrailerCapacity));
     packet->SetPayloadType(dtmf_current_event_.payload_type);
     packet->SetMarker(marker_bit);
     packet->SetSsrc(rtp_sender_->SSRC());
@@ -70,7 +70,8 @@ uint64_t ConvertMsToAbsSendTime(int64_t time_ms) {
 
 class LoopbackTransportTest : public webrtc::Transport {
  public:
-  LoopbackTransportTest() : total_bytes_sent_(0), last_packet_id_(-1) {
+  LoopbackTransportTest()
+      : total_bytes_sent_(0), last_packet_id_(-1), last_packet_capacity_(0) {
     receivers_extensions_.Register(kRtpExtensionTransmissionTimeOffset,
                                    kTransmissionTimeOffsetExtensionId);
     receivers_extensions_.Register(kRtpExtensionAbsoluteSendTime,
@@ -94,12 +95,18 @@ class LoopbackTransportTest : public webrtc::Transport {
     EXPECT_TRUE(sent_packets_.back().Parse(data, len));
     return true;
   }
+  bool SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                     const PacketOptions& options) override {
+    last_packet_capacity_ = packet.capacity();
+    return SendRtp(packet.cdata(), packet.size(), options);
+  }
   bool SendRtcp(const uint8_t* data, size_t len) override { return false; }
   const RtpPacketReceived& last_sent_packet() { return sent_packets_.back(); }
   int packets_sent() { return sent_packets_.size(); }
 
   size_t total_bytes_sent_;
   int last_packet_id_;
+  size_t last_packet_capacity_;
   std::vector<RtpPacketReceived> sent_packets_;
 
  private:
@@ -1568,6 +1575,28 @@ TEST_P(RtpSenderTestWithoutPacer, RespectsNackBitrateLimit) {
   EXPECT_EQ(kNumPackets * 2, transport_.packets_sent());
 }
 
+TEST_P(RtpSenderTestWithoutPacer, SendsPacketsWithRoomForSrtp) {
+  // Enough to fit the SRTP authentication tag.
+  const size_t kSrtpOverhead = 16;
+  rtp_sender_->SetStorePacketsStatus(true, 10);
+  SendPacket(fake_clock_.TimeInMilliseconds(),
+             rtp_sender_->MaxRtpPacketSize() - kRtpHeaderSize);
+  ASSERT_EQ(1, transport_.packets_sent());
+  EXPECT_EQ(rtp_sender_->MaxRtpPacketSize(),
+            transport_.last_sent_packet().size());
+  EXPECT_GE(transport_.last_packet_capacity_,
+            transport_.last_sent_packet().size() + kSrtpOverhead);
+
+  rtp_sender_->SetRtxStatus(kRtxRetransmitted);
+  rtp_sender_->SetRtxSsrc(4321);
+  rtp_sender_->SetRtxPayloadType(kRtxPayload, kPayload);
+  EXPECT_GT(rtp_sender_->ReSendPacket(kSeqNum, 0), 0);
+  ASSERT_EQ(2, transport_.packets_sent());
+  EXPECT_EQ(4321u, transport_.last_sent_packet().Ssrc());
+  EXPECT_GE(transport_.last_packet_capacity_,
+            transport_.last_sent_packet().size() + kSrtpOverhead);
+}
+
 TEST_P(RtpSenderVideoTest, KeyFrameHasCVO) {
   uint8_t kFrame[kMaxPacketLength];
   EXPECT_EQ(0, rtp_sender_->RegisterRtpHeaderExtension(
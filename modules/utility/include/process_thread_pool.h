@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_UTILITY_INCLUDE_PROCESS_THREAD_POOL_H_
+#define MODULES_UTILITY_INCLUDE_PROCESS_THREAD_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "modules/utility/include/process_thread.h"
+
+namespace webrtc {
+
+// Runs the modules and tasks of many ProcessThreads on a fixed number of
+// worker threads, so that e.g. one pacer per call does not cost one thread per
+// call. A ProcessThread created by the pool behaves like one created by
+// ProcessThread::Create(): its modules and tasks never run concurrently with
+// each other, and none run after Stop() returns. Different ProcessThreads run
+// in parallel on different workers.
+//
+// Each worker keeps a queue of ProcessThreads that are due. Idle workers steal
+// from the queues of busy ones, so a ProcessThread may move between workers
+// from one run to the next.
+class ProcessThreadPool {
+ public:
+  struct Stats {
+    // Number of times a ProcessThread was run.
+    uint64_t runs = 0;
+    // Number of those runs that a worker took from another worker's queue.
+    uint64_t steals = 0;
+  };
+
+  virtual ~ProcessThreadPool();
+
+  // Starts |num_threads| workers. The pool must outlive all ProcessThreads
+  // created from it.
+  static std::unique_ptr<ProcessThreadPool> Create(size_t num_threads,
+                                                   const char* thread_name);
+
+  // Returns a ProcessThread that runs on the workers of this pool. Start(),
+  // Stop(), RegisterModule() and DeRegisterModule() must be called on the
+  // thread that creates it, as for ProcessThread::Create().
+  virtual std::unique_ptr<ProcessThread> CreateProcessThread(
+      const char* thread_name) = 0;
+
+  virtual Stats GetStats() const = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_UTILITY_INCLUDE_PROCESS_THREAD_POOL_H_
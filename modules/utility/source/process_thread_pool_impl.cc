@@ -0,0 +1,515 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/utility/source/process_thread_pool_impl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <queue>
+#include <string>
+
+#include "modules/include/module.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "rtc_base/location.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_checker.h"
+#include "rtc_base/timer_wheel.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/trace_event.h"
+
+namespace webrtc {
+namespace {
+
+// Same meaning as in ProcessThreadImpl.
+const int64_t kCallProcessImmediately = -1;
+const int64_t kMaxWaitMs = 1000 * 60;
+
+int64_t GetNextCallbackTime(Module* module, int64_t time_now) {
+  int64_t interval = module->TimeUntilNextProcess();
+  if (interval < 0) {
+    // Falling behind, we should call the callback now.
+    return time_now;
+  }
+  return time_now + interval;
+}
+
+}  // namespace
+
+ProcessThreadPool::~ProcessThreadPool() {}
+
+// static
+std::unique_ptr<ProcessThreadPool> ProcessThreadPool::Create(
+    size_t num_threads,
+    const char* thread_name) {
+  return std::unique_ptr<ProcessThreadPool>(
+      new ProcessThreadPoolImpl(num_threads, thread_name));
+}
+
+struct ProcessThreadPoolImpl::Worker {
+  Worker(ProcessThreadPoolImpl* pool, size_t index, const std::string& name)
+      : pool(pool),
+        index(index),
+        name(name),
+        timers(rtc::TimeMillis()),
+        wake_up(false, false),
+        busy(false),
+        thread(&ProcessThreadPoolImpl::RunWorker, this, this->name.c_str()) {}
+
+  ProcessThreadPoolImpl* const pool;
+  const size_t index;
+  const std::string name;
+  rtc::CriticalSection lock;
+  // Contexts that are due, run in order. Other workers steal from the back.
+  std::deque<rtc::scoped_refptr<Context>> ready RTC_GUARDED_BY(lock);
+  // Contexts waiting for their modules' next callback time.
+  rtc::TimerWheel<rtc::scoped_refptr<Context>> timers RTC_GUARDED_BY(lock);
+  rtc::Event wake_up;
+  // True while the worker runs a context and cannot start another one.
+  std::atomic<bool> busy;
+  rtc::PlatformThread thread;
+};
+
+class ProcessThreadPoolImpl::Context : public rtc::RefCountInterface {
+ public:
+  enum class State { kStopped, kReady, kRunning, kStopping, kSleeping };
+
+  Context(ProcessThreadPoolImpl* pool,
+          ProcessThread* process_thread,
+          const char* thread_name)
+      : stopped_(false, false),
+        pool_(pool),
+        process_thread_(process_thread),
+        thread_name_(thread_name) {}
+
+  void Start() {
+    RTC_DCHECK(thread_checker_.CalledOnValidThread());
+    RTC_DCHECK(!started_);
+    if (started_)
+      return;
+    started_ = true;
+    for (ModuleCallback& m : modules_)
+      m.module->ProcessThreadAttached(process_thread_);
+    pool_->StartContext(this);
+  }
+
+  void Stop() {
+    RTC_DCHECK(thread_checker_.CalledOnValidThread());
+    if (!started_)
+      return;
+    if (pool_->StopContext(this))
+      stopped_.Wait(rtc::Event::kForever);
+    started_ = false;
+    for (ModuleCallback& m : modules_)
+      m.module->ProcessThreadAttached(nullptr);
+  }
+
+  void WakeUp(Module* module) {
+    // Allowed to be called on any thread.
+    {
+      rtc::CritScope lock(&lock_);
+      for (ModuleCallback& m : modules_) {
+        if (m.module == module)
+          m.next_callback = kCallProcessImmediately;
+      }
+    }
+    pool_->ScheduleContext(this);
+  }
+
+  void PostTask(std::unique_ptr<rtc::QueuedTask> task) {
+    // Allowed to be called on any thread.
+    {
+      rtc::CritScope lock(&lock_);
+      queue_.push(task.release());
+    }
+    pool_->ScheduleContext(this);
+  }
+
+  void RegisterModule(Module* module, const rtc::Location& from) {
+    RTC_DCHECK(thread_checker_.CalledOnValidThread());
+    RTC_DCHECK(module) << from.ToString();
+#if RTC_DCHECK_IS_ON
+    {
+      rtc::CritScope lock(&lock_);
+      for (const ModuleCallback& mc : modules_) {
+        RTC_DCHECK(mc.module != module)
+            << "Already registered here: " << mc.location.ToString() << "\n"
+            << "Now attempting from here: " << from.ToString();
+      }
+    }
+#endif
+    if (started_)
+      module->ProcessThreadAttached(process_thread_);
+    {
+      rtc::CritScope lock(&lock_);
+      modules_.push_back(ModuleCallback(module, from));
+    }
+    // The new module may want a callback sooner than the others.
+    pool_->ScheduleContext(this);
+  }
+
+  void DeRegisterModule(Module* module) {
+    RTC_DCHECK(thread_checker_.CalledOnValidThread());
+    RTC_DCHECK(module);
+    {
+      // Blocks while the modules are being processed.
+      rtc::CritScope lock(&lock_);
+      modules_.remove_if(
+          [&module](const ModuleCallback& m) { return m.module == module; });
+    }
+    module->ProcessThreadAttached(nullptr);
+  }
+
+  void DeleteQueuedTasks() {
+    RTC_DCHECK(thread_checker_.CalledOnValidThread());
+    RTC_DCHECK(!started_);
+    rtc::CritScope lock(&lock_);
+    while (!queue_.empty()) {
+      delete queue_.front();
+      queue_.pop();
+    }
+  }
+
+  // Runs due modules and all queued tasks, like one iteration of
+  // ProcessThreadImpl::Process(). Returns when the next module is due.
+  int64_t Process() {
+    TRACE_EVENT1("webrtc", "ProcessThreadPool", "name", thread_name_);
+    int64_t now = rtc::TimeMillis();
+    int64_t next_checkpoint = now + kMaxWaitMs;
+
+    rtc::CritScope lock(&lock_);
+    for (ModuleCallback& m : modules_) {
+      if (m.next_callback == 0)
+        m.next_callback = GetNextCallbackTime(m.module, now);
+
+      if (m.next_callback <= now ||
+          m.next_callback == kCallProcessImmediately) {
+        {
+          TRACE_EVENT2("webrtc", "ModuleProcess", "function",
+                       m.location.function_name(), "file",
+                       m.location.file_and_line());
+          m.module->Process();
+        }
+        int64_t new_now = rtc::TimeMillis();
+        m.next_callback = GetNextCallbackTime(m.module, new_now);
+      }
+
+      if (m.next_callback < next_checkpoint)
+        next_checkpoint = m.next_callback;
+    }
+
+    while (!queue_.empty()) {
+      rtc::QueuedTask* task = queue_.front();
+      queue_.pop();
+      lock_.Leave();
+      task->Run();
+      delete task;
+      lock_.Enter();
+    }
+    return next_checkpoint;
+  }
+
+  // Scheduling state, owned by the pool.
+  rtc::CriticalSection schedule_lock_;
+  State state_ RTC_GUARDED_BY(schedule_lock_) = State::kStopped;
+  // Set if the context was woken up while running.
+  bool wake_pending_ RTC_GUARDED_BY(schedule_lock_) = false;
+  // The worker whose |timers| hold the context while it is sleeping.
+  Worker* owner_ RTC_GUARDED_BY(schedule_lock_) = nullptr;
+  rtc::TimerWheel<rtc::scoped_refptr<Context>>::TimerId timer_id_
+      RTC_GUARDED_BY(schedule_lock_) = 0;
+  // Signaled when a run that Stop() waits for has finished.
+  rtc::Event stopped_;
+
+ protected:
+  ~Context() override {
+    RTC_DCHECK(queue_.empty());
+  }
+
+ private:
+  struct ModuleCallback {
+    ModuleCallback(Module* module, const rtc::Location& location)
+        : module(module), location(location) {}
+
+    Module* const module;
+    int64_t next_callback = 0;  // Absolute timestamp.
+    const rtc::Location location;
+  };
+
+  ProcessThreadPoolImpl* const pool_;
+  ProcessThread* const process_thread_;
+  const char* const thread_name_;
+  rtc::ThreadChecker thread_checker_;
+  bool started_ = false;
+
+  rtc::CriticalSection lock_;  // Used to guard modules_ and queue_.
+  std::list<ModuleCallback> modules_;
+  std::queue<rtc::QueuedTask*> queue_;
+};
+
+class ProcessThreadPoolImpl::PooledProcessThread : public ProcessThread {
+ public:
+  PooledProcessThread(ProcessThreadPoolImpl* pool, const char* thread_name)
+      : pool_(pool),
+        context_(new rtc::RefCountedObject<Context>(pool, this, thread_name)) {
+    ++pool_->num_process_threads_;
+  }
+
+  ~PooledProcessThread() override {
+    context_->Stop();
+    context_->DeleteQueuedTasks();
+    --pool_->num_process_threads_;
+  }
+
+  void Start() override { context_->Start(); }
+  void Stop() override { context_->Stop(); }
+  void WakeUp(Module* module) override { context_->WakeUp(module); }
+  void PostTask(std::unique_ptr<rtc::QueuedTask> task) override {
+    context_->PostTask(std::move(task));
+  }
+  void RegisterModule(Module* module, const rtc::Location& from) override {
+    context_->RegisterModule(module, from);
+  }
+  void DeRegisterModule(Module* module) override {
+    context_->DeRegisterModule(module);
+  }
+
+ private:
+  ProcessThreadPoolImpl* const pool_;
+  const rtc::scoped_refptr<Context> context_;
+};
+
+ProcessThreadPoolImpl::ProcessThreadPoolImpl(size_t num_threads,
+                                             const char* thread_name)
+    : stop_(false),
+      next_worker_(0),
+      num_process_threads_(0),
+      runs_(0),
+      steals_(0) {
+  RTC_DCHECK_GT(num_threads, 0);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(
+        new Worker(this, i, std::string(thread_name) + rtc::ToString(i)));
+  }
+  for (auto& worker : workers_)
+    worker->thread.Start();
+}
+
+ProcessThreadPoolImpl::~ProcessThreadPoolImpl() {
+  RTC_DCHECK_EQ(0, num_process_threads_.load());
+  stop_ = true;
+  for (auto& worker : workers_)
+    worker->wake_up.Set();
+  for (auto& worker : workers_)
+    worker->thread.Stop();
+}
+
+std::unique_ptr<ProcessThread> ProcessThreadPoolImpl::CreateProcessThread(
+    const char* thread_name) {
+  return std::unique_ptr<ProcessThread>(
+      new PooledProcessThread(this, thread_name));
+}
+
+ProcessThreadPool::Stats ProcessThreadPoolImpl::GetStats() const {
+  Stats stats;
+  stats.runs = runs_.load();
+  stats.steals = steals_.load();
+  return stats;
+}
+
+// static
+bool ProcessThreadPoolImpl::RunWorker(void* obj) {
+  Worker* worker = static_cast<Worker*>(obj);
+  return worker->pool->ProcessWorker(worker);
+}
+
+bool ProcessThreadPoolImpl::ProcessWorker(Worker* worker) {
+  if (stop_)
+    return false;
+
+  std::vector<rtc::scoped_refptr<Context>> expired;
+  {
+    rtc::CritScope lock(&worker->lock);
+    worker->timers.Advance(rtc::TimeMillis(), &expired);
+  }
+  for (const rtc::scoped_refptr<Context>& context : expired) {
+    rtc::CritScope lock(&context->schedule_lock_);
+    // A context that was stopped, or restarted elsewhere, is not ours to run.
+    if (context->state_ == Context::State::kSleeping &&
+        context->owner_ == worker) {
+      context->state_ = Context::State::kReady;
+      Enqueue(worker, context);
+    }
+  }
+
+  rtc::scoped_refptr<Context> context = TakeReady(worker);
+  if (context) {
+    RunContext(worker, context);
+    return true;
+  }
+
+  int64_t wait_ms = kMaxWaitMs;
+  {
+    rtc::CritScope lock(&worker->lock);
+    int64_t deadline_ms;
+    if (worker->timers.NextDeadline(&deadline_ms)) {
+      wait_ms = std::min(std::max<int64_t>(deadline_ms - rtc::TimeMillis(), 0),
+                         kMaxWaitMs);
+    }
+  }
+  if (wait_ms > 0)
+    worker->wake_up.Wait(static_cast<int>(wait_ms));
+  return true;
+}
+
+rtc::scoped_refptr<ProcessThreadPoolImpl::Context>
+ProcessThreadPoolImpl::TakeReady(Worker* worker) {
+  rtc::scoped_refptr<Context> context;
+  {
+    rtc::CritScope lock(&worker->lock);
+    if (!worker->ready.empty()) {
+      context = std::move(worker->ready.front());
+      worker->ready.pop_front();
+      return context;
+    }
+  }
+  // Nothing of our own to do; take the most recently queued context of the
+  // next worker that has a backlog.
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker* victim = workers_[(worker->index + i) % workers_.size()].get();
+    rtc::CritScope lock(&victim->lock);
+    if (!victim->ready.empty()) {
+      context = std::move(victim->ready.back());
+      victim->ready.pop_back();
+      ++steals_;
+      return context;
+    }
+  }
+  return nullptr;
+}
+
+void ProcessThreadPoolImpl::RunContext(
+    Worker* worker,
+    const rtc::scoped_refptr<Context>& context) {
+  {
+    rtc::CritScope lock(&context->schedule_lock_);
+    // Queue entries are left behind when a context is stopped, or scheduled
+    // again after a restart.
+    if (context->state_ != Context::State::kReady)
+      return;
+    context->state_ = Context::State::kRunning;
+    context->wake_pending_ = false;
+  }
+  ++runs_;
+  worker->busy = true;
+  int64_t next_checkpoint = context->Process();
+  worker->busy = false;
+
+  rtc::CritScope lock(&context->schedule_lock_);
+  if (context->state_ == Context::State::kStopping) {
+    context->state_ = Context::State::kStopped;
+    context->stopped_.Set();
+    return;
+  }
+  RTC_DCHECK(context->state_ == Context::State::kRunning);
+  if (context->wake_pending_ || next_checkpoint <= rtc::TimeMillis()) {
+    context->state_ = Context::State::kReady;
+    Enqueue(worker, context);
+    return;
+  }
+  context->state_ = Context::State::kSleeping;
+  context->owner_ = worker;
+  rtc::CritScope worker_lock(&worker->lock);
+  context->timer_id_ = worker->timers.Insert(next_checkpoint, context);
+}
+
+void ProcessThreadPoolImpl::Enqueue(Worker* worker,
+                                    const rtc::scoped_refptr<Context>& context) {
+  size_t backlog;
+  {
+    rtc::CritScope lock(&worker->lock);
+    worker->ready.push_back(context);
+    backlog = worker->ready.size();
+  }
+  worker->wake_up.Set();
+  // The worker can't start this context right away; let another one steal it.
+  if ((backlog > 1 || worker->busy) && workers_.size() > 1) {
+    size_t offset = 1 + next_worker_++ % (workers_.size() - 1);
+    workers_[(worker->index + offset) % workers_.size()]->wake_up.Set();
+  }
+}
+
+void ProcessThreadPoolImpl::StartContext(Context* context) {
+  rtc::scoped_refptr<Context> ref(context);
+  rtc::CritScope lock(&context->schedule_lock_);
+  RTC_DCHECK(context->state_ == Context::State::kStopped);
+  context->state_ = Context::State::kReady;
+  Enqueue(workers_[next_worker_++ % workers_.size()].get(), ref);
+}
+
+bool ProcessThreadPoolImpl::StopContext(Context* context) {
+  rtc::CritScope lock(&context->schedule_lock_);
+  switch (context->state_) {
+    case Context::State::kRunning:
+      context->state_ = Context::State::kStopping;
+      return true;
+    case Context::State::kSleeping: {
+      rtc::CritScope worker_lock(&context->owner_->lock);
+      // May fail if the timer is expiring right now; the worker then finds
+      // the context stopped.
+      context->owner_->timers.Cancel(context->timer_id_);
+      break;
+    }
+    case Context::State::kReady:
+    case Context::State::kStopped:
+      break;
+    case Context::State::kStopping:
+      RTC_NOTREACHED();
+      break;
+  }
+  context->state_ = Context::State::kStopped;
+  return false;
+}
+
+void ProcessThreadPoolImpl::ScheduleContext(Context* context) {
+  rtc::scoped_refptr<Context> ref(context);
+  rtc::CritScope lock(&context->schedule_lock_);
+  switch (context->state_) {
+    case Context::State::kStopped:
+    case Context::State::kStopping:
+    case Context::State::kReady:
+      return;
+    case Context::State::kRunning:
+      context->wake_pending_ = true;
+      return;
+    case Context::State::kSleeping: {
+      Worker* owner = context->owner_;
+      {
+        rtc::CritScope worker_lock(&owner->lock);
+        // If the timer is expiring right now, the owner is about to run the
+        // context anyway.
+        if (!owner->timers.Cancel(context->timer_id_))
+          return;
+      }
+      context->state_ = Context::State::kReady;
+      Enqueue(owner, ref);
+      return;
+    }
+  }
+}
+
+}  // namespace webrtc
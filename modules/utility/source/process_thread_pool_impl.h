@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_UTILITY_SOURCE_PROCESS_THREAD_POOL_IMPL_H_
+#define MODULES_UTILITY_SOURCE_PROCESS_THREAD_POOL_IMPL_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "modules/utility/include/process_thread_pool.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+namespace webrtc {
+
+class ProcessThreadPoolImpl : public ProcessThreadPool {
+ public:
+  ProcessThreadPoolImpl(size_t num_threads, const char* thread_name);
+  ~ProcessThreadPoolImpl() override;
+
+  std::unique_ptr<ProcessThread> CreateProcessThread(
+      const char* thread_name) override;
+
+  Stats GetStats() const override;
+
+ private:
+  // The modules and tasks of one ProcessThread, and where it is scheduled.
+  class Context;
+  // The ProcessThread handed out by CreateProcessThread(). Holds a reference
+  // to its Context, as do the worker queues it is scheduled in.
+  class PooledProcessThread;
+  struct Worker;
+
+  static bool RunWorker(void* obj);
+  bool ProcessWorker(Worker* worker);
+
+  // Takes the next due context from |worker|'s queue, or steals one from
+  // another worker. Returns null if there is none.
+  rtc::scoped_refptr<Context> TakeReady(Worker* worker);
+  void RunContext(Worker* worker, const rtc::scoped_refptr<Context>& context);
+
+  // Appends |context| to |worker|'s queue. Context::schedule_lock_ must be
+  // held, and the context must just have become ready.
+  void Enqueue(Worker* worker, const rtc::scoped_refptr<Context>& context);
+
+  // Called by Context on its construction thread.
+  void StartContext(Context* context);
+  // Returns true if the context is running and the caller must wait for the
+  // run to finish.
+  bool StopContext(Context* context);
+  // Runs |context| as soon as possible, e.g. after WakeUp() or PostTask().
+  // Can be called on any thread.
+  void ScheduleContext(Context* context);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<bool> stop_;
+  std::atomic<size_t> next_worker_;
+  std::atomic<int> num_process_threads_;
+  std::atomic<uint64_t> runs_;
+  std::atomic<uint64_t> steals_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(ProcessThreadPoolImpl);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_UTILITY_SOURCE_PROCESS_THREAD_POOL_IMPL_H_
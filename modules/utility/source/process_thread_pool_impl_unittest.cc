@@ -0,0 +1,236 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "modules/include/module.h"
+#include "modules/utility/source/process_thread_pool_impl.h"
+#include "rtc_base/event.h"
+#include "rtc_base/location.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/timeutils.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+// The length of time, in milliseconds, to wait for an event to become signaled.
+const int kEventWaitTimeout = 500;
+
+class MockModule : public Module {
+ public:
+  MOCK_METHOD0(TimeUntilNextProcess, int64_t());
+  MOCK_METHOD0(Process, void());
+  MOCK_METHOD1(ProcessThreadAttached, void(ProcessThread*));
+};
+
+// Asks to be processed every |interval_ms| and counts how often it was.
+class PeriodicModule : public Module {
+ public:
+  explicit PeriodicModule(int64_t interval_ms) : interval_ms_(interval_ms) {}
+
+  int64_t TimeUntilNextProcess() override {
+    return last_process_ms_ + interval_ms_ - rtc::TimeMillis();
+  }
+  void Process() override {
+    last_process_ms_ = rtc::TimeMillis();
+    ++count_;
+  }
+  int count() const { return count_; }
+
+ private:
+  const int64_t interval_ms_;
+  int64_t last_process_ms_ = 0;
+  std::atomic<int> count_{0};
+};
+
+class RaiseEventTask : public rtc::QueuedTask {
+ public:
+  explicit RaiseEventTask(rtc::Event* event) : event_(event) {}
+  bool Run() override {
+    event_->Set();
+    return true;
+  }
+
+ private:
+  rtc::Event* event_;
+};
+
+ACTION_P(SetEvent, event) {
+  event->Set();
+}
+
+}  // namespace
+
+TEST(ProcessThreadPoolImplTest, StartStop) {
+  ProcessThreadPoolImpl pool(2, "Pool");
+  std::unique_ptr<ProcessThread> thread = pool.CreateProcessThread("Thread");
+  for (int i = 0; i < 5; ++i) {
+    thread->Start();
+    thread->Stop();
+  }
+}
+
+TEST(ProcessThreadPoolImplTest, ProcessCallAfterStart) {
+  ProcessThreadPoolImpl pool(2, "Pool");
+  std::unique_ptr<ProcessThread> thread = pool.CreateProcessThread("Thread");
+  MockModule module;
+  rtc::Event called(false, false);
+
+  EXPECT_CALL(module, TimeUntilNextProcess())
+      .WillOnce(Return(0))
+      .WillRepeatedly(Return(1000));
+  EXPECT_CALL(module, Process())
+      .WillOnce(DoAll(SetEvent(&called), Return()))
+      .WillRepeatedly(Return());
+  EXPECT_CALL(module, ProcessThreadAttached(thread.get())).Times(1);
+  thread->RegisterModule(&module, RTC_FROM_HERE);
+  thread->Start();
+  EXPECT_TRUE(called.Wait(kEventWaitTimeout));
+  EXPECT_CALL(module, ProcessThreadAttached(nullptr)).Times(1);
+  thread->Stop();
+  testing::Mock::VerifyAndClearExpectations(&module);
+  EXPECT_CALL(module, ProcessThreadAttached(nullptr)).Times(1);
+  thread->DeRegisterModule(&module);
+}
+
+TEST(ProcessThreadPoolImplTest, WakeUpRunsSleepingModule) {
+  ProcessThreadPoolImpl pool(2, "Pool");
+  std::unique_ptr<ProcessThread> thread = pool.CreateProcessThread("Thread");
+  NiceMock<MockModule> module;
+  rtc::Event first(false, false);
+  rtc::Event second(false, false);
+
+  EXPECT_CALL(module, TimeUntilNextProcess())
+      .WillOnce(Return(0))
+      .WillRepeatedly(Return(100000));
+  EXPECT_CALL(module, Process())
+      .WillOnce(DoAll(SetEvent(&first), Return()))
+      .WillOnce(DoAll(SetEvent(&second), Return()))
+      .WillRepeatedly(Return());
+
+  thread->RegisterModule(&module, RTC_FROM_HERE);
+  thread->Start();
+  ASSERT_TRUE(first.Wait(kEventWaitTimeout));
+  EXPECT_FALSE(second.Wait(50));
+  thread->WakeUp(&module);
+  EXPECT_TRUE(second.Wait(kEventWaitTimeout));
+  thread->Stop();
+  thread->DeRegisterModule(&module);
+}
+
+TEST(ProcessThreadPoolImplTest, PostTask) {
+  ProcessThreadPoolImpl pool(2, "Pool");
+  std::unique_ptr<ProcessThread> thread = pool.CreateProcessThread("Thread");
+  rtc::Event task_ran(false, false);
+  // Posted before Start(), runs once started.
+  thread->PostTask(
+      std::unique_ptr<rtc::QueuedTask>(new RaiseEventTask(&task_ran)));
+  EXPECT_FALSE(task_ran.Wait(20));
+  thread->Start();
+  EXPECT_TRUE(task_ran.Wait(kEventWaitTimeout));
+  thread->PostTask(
+      std::unique_ptr<rtc::QueuedTask>(new RaiseEventTask(&task_ran)));
+  EXPECT_TRUE(task_ran.Wait(kEventWaitTimeout));
+  thread->Stop();
+}
+
+TEST(ProcessThreadPoolImplTest, NoProcessAfterStop) {
+  ProcessThreadPoolImpl pool(2, "Pool");
+  std::unique_ptr<ProcessThread> thread = pool.CreateProcessThread("Thread");
+  PeriodicModule module(1);
+  thread->RegisterModule(&module, RTC_FROM_HERE);
+  thread->Start();
+  rtc::Event event(false, false);
+  event.Wait(30);
+  thread->Stop();
+  int count = module.count();
+  EXPECT_GT(count, 0);
+  event.Wait(30);
+  EXPECT_EQ(count, module.count());
+  thread->DeRegisterModule(&module);
+}
+
+// A worker that is stuck in one ProcessThread does not hold up the others
+// that are queued on it.
+TEST(ProcessThreadPoolImplTest, IdleWorkerStealsFromBusyWorker) {
+  ProcessThreadPoolImpl pool(2, "Pool");
+  // Started ProcessThreads are assigned to the workers in turn.
+  std::unique_ptr<ProcessThread> blocked = pool.CreateProcessThread("Blocked");
+  std::unique_ptr<ProcessThread> idle = pool.CreateProcessThread("Idle");
+  std::unique_ptr<ProcessThread> stolen = pool.CreateProcessThread("Stolen");
+
+  rtc::Event blocked_running(false, false);
+  rtc::Event unblock(false, false);
+  NiceMock<MockModule> module;
+  EXPECT_CALL(module, TimeUntilNextProcess())
+      .WillOnce(Return(0))
+      .WillRepeatedly(Return(100000));
+  EXPECT_CALL(module, Process()).WillOnce(Invoke([&] {
+    blocked_running.Set();
+    unblock.Wait(rtc::Event::kForever);
+  }));
+  blocked->RegisterModule(&module, RTC_FROM_HERE);
+  blocked->Start();
+  ASSERT_TRUE(blocked_running.Wait(kEventWaitTimeout));
+  // Has nothing to do, leaving the second worker idle.
+  idle->Start();
+
+  // Queued behind |blocked| on the first worker.
+  rtc::Event task_ran(false, false);
+  stolen->PostTask(
+      std::unique_ptr<rtc::QueuedTask>(new RaiseEventTask(&task_ran)));
+  stolen->Start();
+  EXPECT_TRUE(task_ran.Wait(kEventWaitTimeout));
+  EXPECT_GE(pool.GetStats().steals, 1u);
+
+  unblock.Set();
+  blocked->Stop();
+  idle->Stop();
+  stolen->Stop();
+  blocked->DeRegisterModule(&module);
+}
+
+TEST(ProcessThreadPoolImplTest, ManyProcessThreadsOnFewWorkers) {
+  const int kNumThreads = 200;
+  const int kIntervalMs = 5;
+  ProcessThreadPoolImpl pool(4, "Pool");
+  std::vector<std::unique_ptr<ProcessThread>> threads;
+  std::vector<std::unique_ptr<PeriodicModule>> modules;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(pool.CreateProcessThread("Thread"));
+    modules.emplace_back(new PeriodicModule(kIntervalMs));
+    threads.back()->RegisterModule(modules.back().get(), RTC_FROM_HERE);
+    threads.back()->Start();
+  }
+  rtc::Event event(false, false);
+  event.Wait(200);
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads[i]->Stop();
+    threads[i]->DeRegisterModule(modules[i].get());
+    // Allow for slow bots; most modules run about 40 times.
+    EXPECT_GE(modules[i]->count(), 5);
+  }
+  ProcessThreadPool::Stats stats = pool.GetStats();
+  LOG(LS_INFO) << stats.runs << " runs, " << stats.steals << " stolen.";
+}
+
+}  // namespace webrtc
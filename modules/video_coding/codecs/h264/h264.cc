@@ -11,7 +11,10 @@
 
 #include "modules/video_coding/codecs/h264/include/h264.h"
 
+#include <utility>
+
 #include "api/video_codecs/sdp_video_format.h"
+#include "common_video/include/shared_i420_buffer_pool.h"
 #include "media/base/h264_profile_level_id.h"
 
 #if defined(WEBRTC_USE_H264)
@@ -88,11 +91,16 @@ bool H264Encoder::IsSupported() {
 }
 
 H264Decoder* H264Decoder::Create() {
+  return Create(nullptr);
+}
+
+H264Decoder* H264Decoder::Create(
+    rtc::scoped_refptr<SharedI420BufferPool> buffer_pool) {
   RTC_DCHECK(H264Decoder::IsSupported());
 #if defined(WEBRTC_USE_H264)
   RTC_CHECK(g_rtc_use_h264);
   LOG(LS_INFO) << "Creating H264DecoderImpl.";
-  return new H264DecoderImpl();
+  return new H264DecoderImpl(std::move(buffer_pool));
 #else
   RTC_NOTREACHED();
   return nullptr;
@@ -34,7 +34,9 @@ struct AVFrameDeleter {
 
 class H264DecoderImpl : public H264Decoder {
  public:
-  H264DecoderImpl();
+  // If |buffer_pool| is null, the decoder uses a pool of its own.
+  explicit H264DecoderImpl(
+      rtc::scoped_refptr<SharedI420BufferPool> buffer_pool);
   ~H264DecoderImpl() override;
 
   // If |codec_settings| is NULL it is ignored. If it is not NULL,
@@ -16,9 +16,11 @@
 
 #include "media/base/codec.h"
 #include "modules/video_coding/include/video_codec_interface.h"
+#include "rtc_base/scoped_ref_ptr.h"
 
 namespace webrtc {
 
+class SharedI420BufferPool;
 struct SdpVideoFormat;
 
 // Set to disable the H.264 encoder/decoder implementations that are provided if
@@ -43,6 +45,11 @@ class H264Encoder : public VideoEncoder {
 class H264Decoder : public VideoDecoder {
  public:
   static H264Decoder* Create();
+  // Creates a decoder that takes its output buffers from |buffer_pool|, which
+  // may be shared with other decoders. FFmpeg requires |buffer_pool| to
+  // zero-initialize new buffers.
+  static H264Decoder* Create(
+      rtc::scoped_refptr<SharedI420BufferPool> buffer_pool);
   static bool IsSupported();
 
   ~H264Decoder() override {}
@@ -14,9 +14,12 @@
 #define MODULES_VIDEO_CODING_CODECS_VP8_INCLUDE_VP8_H_
 
 #include "modules/video_coding/include/video_codec_interface.h"
+#include "rtc_base/scoped_ref_ptr.h"
 
 namespace webrtc {
 
+class SharedI420BufferPool;
+
 class VP8Encoder : public VideoEncoder {
  public:
   static VP8Encoder* Create();
@@ -27,6 +30,10 @@ class VP8Encoder : public VideoEncoder {
 class VP8Decoder : public VideoDecoder {
  public:
   static VP8Decoder* Create();
+  // Creates a decoder that takes its output buffers from |buffer_pool|, which
+  // may be shared with other decoders.
+  static VP8Decoder* Create(
+      rtc::scoped_refptr<SharedI420BufferPool> buffer_pool);
 
   virtual ~VP8Decoder() {}
 };  // end of VP8Decoder class
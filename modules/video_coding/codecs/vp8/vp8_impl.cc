@@ -15,6 +15,7 @@
 #include <time.h>
 #include <algorithm>
 #include <string>
+#include <utility>
 
 // NOTE(ajm): Path provided by gyp.
 #include "libyuv/convert.h"  // NOLINT
@@ -182,6 +183,11 @@ VP8Decoder* VP8Decoder::Create() {
   return new VP8DecoderImpl();
 }
 
+VP8Decoder* VP8Decoder::Create(
+    rtc::scoped_refptr<SharedI420BufferPool> buffer_pool) {
+  return new VP8DecoderImpl(std::move(buffer_pool));
+}
+
 vpx_enc_frame_flags_t VP8EncoderImpl::EncodeFlags(
     const TemporalLayers::FrameConfig& references) {
   RTC_DCHECK(!references.drop_frame);
@@ -1021,10 +1027,15 @@ class VP8DecoderImpl::QpSmoother {
   rtc::ExpFilter smoother_;
 };
 
-VP8DecoderImpl::VP8DecoderImpl()
+VP8DecoderImpl::VP8DecoderImpl() : VP8DecoderImpl(nullptr) {}
+
+VP8DecoderImpl::VP8DecoderImpl(
+    rtc::scoped_refptr<SharedI420BufferPool> buffer_pool)
     : use_postproc_arm_(
           webrtc::field_trial::IsEnabled(kVp8PostProcArmFieldTrial)),
-      buffer_pool_(false, 300 /* max_number_of_buffers*/),
+      buffer_pool_(buffer_pool
+                       ? I420BufferPool(std::move(buffer_pool))
+                       : I420BufferPool(false, 300 /* max_number_of_buffers*/)),
       decode_complete_callback_(NULL),
       inited_(false),
       decoder_(NULL),
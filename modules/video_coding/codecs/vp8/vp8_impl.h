@@ -121,6 +121,9 @@ class VP8EncoderImpl : public VP8Encoder {
 class VP8DecoderImpl : public VP8Decoder {
  public:
   VP8DecoderImpl();
+  // If |buffer_pool| is null, the decoder uses a pool of its own.
+  explicit VP8DecoderImpl(
+      rtc::scoped_refptr<SharedI420BufferPool> buffer_pool);
 
   virtual ~VP8DecoderImpl();
 
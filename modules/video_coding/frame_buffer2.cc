@@ -42,7 +42,7 @@ FrameBuffer::FrameBuffer(Clock* clock,
                          VCMTiming* timing,
                          VCMReceiveStatisticsCallback* stats_callback)
     : clock_(clock),
-      new_continuous_frame_event_(false, false),
+      new_decodable_frame_event_(false, false),
       jitter_estimator_(jitter_estimator),
       timing_(timing),
       inter_frame_delay_(clock_->TimeInMilliseconds()),
@@ -54,7 +54,9 @@ FrameBuffer::FrameBuffer(Clock* clock,
       stopped_(false),
       protection_mode_(kProtectionNack),
       stats_callback_(stats_callback),
-      last_log_non_decoded_ms_(-kLogNonDecodedIntervalMs) {}
+      last_log_non_decoded_ms_(-kLogNonDecodedIntervalMs) {
+  decodable_frames_.reserve(kMaxFramesBuffered);
+}
 
 FrameBuffer::~FrameBuffer() {}
 
@@ -72,7 +74,7 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
     now_ms = clock_->TimeInMilliseconds();
     {
       rtc::CritScope lock(&crit_);
-      new_continuous_frame_event_.Reset();
+      new_decodable_frame_event_.Reset();
       if (stopped_)
         return kStopped;
 
@@ -83,29 +85,9 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
       // acquire the lock unnecesserily.
       next_frame_it_ = frames_.end();
 
-      // |frame_it| points to the first frame after the
-      // |last_decoded_frame_it_|.
-      auto frame_it = frames_.end();
-      if (last_decoded_frame_it_ == frames_.end()) {
-        frame_it = frames_.begin();
-      } else {
-        frame_it = last_decoded_frame_it_;
-        ++frame_it;
-      }
-
-      // |continuous_end_it| points to the first frame after the
-      // |last_continuous_frame_it_|.
-      auto continuous_end_it = last_continuous_frame_it_;
-      if (continuous_end_it != frames_.end())
-        ++continuous_end_it;
-
-      for (; frame_it != continuous_end_it && frame_it != frames_.end();
-           ++frame_it) {
-        if (!frame_it->second.continuous ||
-            frame_it->second.num_missing_decodable > 0) {
-          continue;
-        }
-
+      // Only the frames that can be decoded right away are considered, in
+      // order, starting with the first frame after the last decoded frame.
+      for (FrameMap::iterator frame_it : decodable_frames_) {
         FrameObject* frame = frame_it->second.frame.get();
 
         if (keyframe_required && !frame->is_keyframe())
@@ -128,7 +110,7 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
 
     wait_ms = std::min<int64_t>(wait_ms, latest_return_time_ms - now_ms);
     wait_ms = std::max<int64_t>(wait_ms, 0);
-  } while (new_continuous_frame_event_.Wait(wait_ms));
+  } while (new_decodable_frame_event_.Wait(wait_ms));
 
   {
     rtc::CritScope lock(&crit_);
@@ -248,7 +230,7 @@ void FrameBuffer::Stop() {
   TRACE_EVENT0("webrtc", "FrameBuffer::Stop");
   rtc::CritScope lock(&crit_);
   stopped_ = true;
-  new_continuous_frame_event_.Set();
+  new_decodable_frame_event_.Set();
 }
 
 void FrameBuffer::UpdateRtt(int64_t rtt_ms) {
@@ -256,6 +238,21 @@ void FrameBuffer::UpdateRtt(int64_t rtt_ms) {
   jitter_estimator_->UpdateRtt(rtt_ms);
 }
 
+void FrameBuffer::AddDecodableFrame(FrameMap::iterator frame) {
+  RTC_DCHECK(frame->second.frame);
+  auto it = std::upper_bound(
+      decodable_frames_.begin(), decodable_frames_.end(), frame,
+      [](FrameMap::iterator a, FrameMap::iterator b) {
+        return a->first < b->first;
+      });
+  decodable_frames_.insert(it, frame);
+
+  // Since we now have a new decodable frame there might be a better frame
+  // to return from NextFrame. Signal that thread so that it again can choose
+  // which frame to return.
+  new_decodable_frame_event_.Set();
+}
+
 bool FrameBuffer::ValidReferences(const FrameObject& frame) const {
   if (frame.picture_id < 0)
     return false;
@@ -371,11 +368,6 @@ int FrameBuffer::InsertFrame(std::unique_ptr<FrameObject> frame) {
     info->second.continuous = true;
     PropagateContinuity(info);
     last_continuous_picture_id = last_continuous_frame_it_->first.picture_id;
-
-    // Since we now have new continuous frames there might be a better frame
-    // to return from NextFrame. Signal that thread so that it again can choose
-    // which frame to return.
-    new_continuous_frame_event_.Set();
   }
 
   return last_continuous_picture_id;
@@ -398,6 +390,9 @@ void FrameBuffer::PropagateContinuity(FrameMap::iterator start) {
     if (last_continuous_frame_it_->first < frame->first)
       last_continuous_frame_it_ = frame;
 
+    if (frame->second.num_missing_decodable == 0)
+      AddDecodableFrame(frame);
+
     // Loop through all dependent frames, and if that frame no longer has
     // any unfulfilled dependencies then that frame is continuous as well.
     for (size_t d = 0; d < frame->second.num_dependent_frames; ++d) {
@@ -426,6 +421,10 @@ void FrameBuffer::PropagateDecodability(const FrameInfo& info) {
     if (ref_info != frames_.end()) {
       RTC_DCHECK_GT(ref_info->second.num_missing_decodable, 0U);
       --ref_info->second.num_missing_decodable;
+      if (ref_info->second.num_missing_decodable == 0 &&
+          ref_info->second.continuous) {
+        AddDecodableFrame(ref_info);
+      }
     }
   }
 }
@@ -453,6 +452,14 @@ void FrameBuffer::AdvanceLastDecodedFrame(FrameMap::iterator decoded) {
     frames_.erase(frames_.begin());
     --num_frames_history_;
   }
+
+  // The deleted frames and |decoded| are the first decodable frames.
+  auto decodable_end = std::upper_bound(
+      decodable_frames_.begin(), decodable_frames_.end(), decoded->first,
+      [](const FrameKey& key, FrameMap::iterator frame) {
+        return key < frame->first;
+      });
+  decodable_frames_.erase(decodable_frames_.begin(), decodable_end);
 }
 
 bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const FrameObject& frame,
@@ -571,6 +578,7 @@ void FrameBuffer::UpdateTimingFrameInfo() {
 void FrameBuffer::ClearFramesAndHistory() {
   TRACE_EVENT0("webrtc", "FrameBuffer::ClearFramesAndHistory");
   frames_.clear();
+  decodable_frames_.clear();
   last_decoded_frame_it_ = frames_.end();
   last_continuous_frame_it_ = frames_.end();
   next_frame_it_ = frames_.end();
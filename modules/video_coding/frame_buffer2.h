@@ -15,6 +15,7 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "modules/video_coding/frame_object.h"
 #include "modules/video_coding/include/video_coding_defines.h"
@@ -126,6 +127,10 @@ class FrameBuffer {
 
   using FrameMap = std::map<FrameKey, FrameInfo>;
 
+  // Adds |frame| to |decodable_frames_| and wakes up NextFrame.
+  void AddDecodableFrame(FrameMap::iterator frame)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // Check that the references of |frame| are valid.
   bool ValidReferences(const FrameObject& frame) const;
 
@@ -165,10 +170,14 @@ class FrameBuffer {
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   FrameMap frames_ RTC_GUARDED_BY(crit_);
+  // Frames that are continuous and have all their references decoded, ordered
+  // by FrameKey. These are the only candidates for NextFrame, which therefore
+  // doesn't have to scan |frames_|.
+  std::vector<FrameMap::iterator> decodable_frames_ RTC_GUARDED_BY(crit_);
 
   rtc::CriticalSection crit_;
   Clock* const clock_;
-  rtc::Event new_continuous_frame_event_;
+  rtc::Event new_decodable_frame_event_;
   VCMJitterEstimator* const jitter_estimator_ RTC_GUARDED_BY(crit_);
   VCMTiming* const timing_ RTC_GUARDED_BY(crit_);
   VCMInterFrameDelay inter_frame_delay_ RTC_GUARDED_BY(crit_);
@@ -19,6 +19,8 @@
 #include "modules/video_coding/jitter_estimator.h"
 #include "modules/video_coding/sequence_number_util.h"
 #include "modules/video_coding/timing.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/logging.h"
 #include "rtc_base/platform_thread.h"
 #include "rtc_base/random.h"
 #include "system_wrappers/include/clock.h"
@@ -559,5 +561,106 @@ TEST_F(TestFrameBuffer2, KeyframeRequired) {
   CheckNoFrame(2);
 }
 
+TEST_F(TestFrameBuffer2, FarJumpKeepsBufferedFrames) {
+  EXPECT_EQ(0, InsertFrame(0, 0, 1000, false));
+  EXPECT_EQ(1, InsertFrame(1, 0, 2000, false, 0));
+  // Picture id 2048 is far ahead of the buffered frames.
+  EXPECT_EQ(1, InsertFrame(2049, 0, 4000, false, 2048));
+  EXPECT_EQ(2049, InsertFrame(2048, 0, 3000, false, 1));
+  ExtractFrame();
+  ExtractFrame();
+  ExtractFrame();
+  ExtractFrame();
+  ExtractFrame();
+
+  CheckFrame(0, 0, 0);
+  CheckFrame(1, 1, 0);
+  CheckFrame(2, 2048, 0);
+  CheckFrame(3, 2049, 0);
+  CheckNoFrame(4);
+}
+
+TEST_F(TestFrameBuffer2, SequenceNumberPictureIdsWithGaps) {
+  // H264 and generic frames use unwrapped sequence numbers as picture ids, so
+  // with several packets per frame consecutive frames have gaps between ids.
+  const int kNumFrames = 100;
+  const uint16_t kPacketsPerFrame = 8;
+  EXPECT_EQ(0, InsertFrame(0, 0, 0, false));
+  for (int i = 1; i < kNumFrames; ++i) {
+    uint16_t pid = i * kPacketsPerFrame;
+    EXPECT_EQ(pid, InsertFrame(pid, 0, i * 33, false, pid - kPacketsPerFrame));
+  }
+
+  for (int i = 0; i < kNumFrames; ++i)
+    ExtractFrame();
+  for (int i = 0; i < kNumFrames; ++i)
+    CheckFrame(i, i * kPacketsPerFrame, 0);
+}
+
+TEST_F(TestFrameBuffer2, FarJumpAfterDecodedFrames) {
+  EXPECT_EQ(0, InsertFrame(0, 0, 1000, false));
+  ExtractFrame();
+  EXPECT_EQ(1, InsertFrame(1, 0, 2000, false, 0));
+  ExtractFrame();
+  // Picture id 2048 is far ahead of the decoded frames.
+  EXPECT_EQ(2048, InsertFrame(2048, 0, 3000, false, 1));
+  ExtractFrame();
+
+  CheckFrame(0, 0, 0);
+  CheckFrame(1, 1, 0);
+  CheckFrame(2, 2048, 0);
+}
+
+// Streams 30 fps video with two temporal layers to a decoder that has fallen
+// |lag| frames behind, so that every buffered frame is late when it is decoded.
+// Reports CPU time, since NextFrame() also sleeps in rtc::Event::Wait().
+TEST(FrameBufferPerformanceTest, DISABLED_ExtractFromLaggingBuffer) {
+  const int kNumFrames = 100000;
+  const int kFrameIntervalMs = 33;
+
+  for (int lag : {1, 30, 300}) {
+    SimulatedClock clock(0);
+    VCMTimingFake timing(&clock);
+    VCMJitterEstimator jitter_estimator(&clock);
+    FrameBuffer buffer(&clock, &jitter_estimator, &timing, nullptr);
+
+    int64_t picture_id = 0;
+    auto insert_frame = [&] {
+      std::unique_ptr<FrameObjectFake> frame(new FrameObjectFake());
+      frame->picture_id = picture_id;
+      frame->spatial_layer = 0;
+      frame->timestamp = picture_id * kFrameIntervalMs * 90;
+      frame->inter_layer_predicted = false;
+      // Even frames form the base layer, odd frames reference the preceding
+      // base layer frame.
+      frame->num_references = picture_id == 0 ? 0 : 1;
+      frame->references[0] = picture_id - (picture_id % 2 == 0 ? 2 : 1);
+      if (picture_id == 1)
+        frame->references[0] = 0;
+      buffer.InsertFrame(std::move(frame));
+      ++picture_id;
+    };
+
+    for (int i = 0; i < lag; ++i) {
+      insert_frame();
+      clock.AdvanceTimeMilliseconds(kFrameIntervalMs);
+    }
+
+    int num_decoded = 0;
+    int64_t start_ns = rtc::GetProcessCpuTimeNanos();
+    for (int i = 0; i < kNumFrames; ++i) {
+      insert_frame();
+      std::unique_ptr<FrameObject> frame;
+      if (buffer.NextFrame(0, &frame) == FrameBuffer::kFrameFound)
+        ++num_decoded;
+      clock.AdvanceTimeMilliseconds(kFrameIntervalMs);
+    }
+    int64_t elapsed_ns = rtc::GetProcessCpuTimeNanos() - start_ns;
+    LOG(LS_INFO) << "Lag of " << lag << " frames: " << num_decoded << " of "
+                 << kNumFrames << " frames decoded, "
+                 << elapsed_ns / kNumFrames << " ns CPU time per frame.";
+  }
+}
+
 }  // namespace video_coding
 }  // namespace webrtc
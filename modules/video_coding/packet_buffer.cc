@@ -10,8 +10,12 @@
 
 #include "modules/video_coding/packet_buffer.h"
 
+#include <stddef.h>
+#include <string.h>
+
 #include <algorithm>
 #include <limits>
+#include <type_traits>
 #include <utility>
 
 #include "common_video/h264/h264_common.h"
@@ -23,6 +27,38 @@
 
 namespace webrtc {
 namespace video_coding {
+namespace {
+
+// Copies |packet| to |slot|. Most of a VCMPacket is the VP9 member of the
+// codec header union, so for VP8 and H264 only the member in use is copied.
+void CopyPacket(const VCMPacket& packet, VCMPacket* slot) {
+  static_assert(std::is_trivially_copyable<VCMPacket>::value &&
+                    std::is_standard_layout<VCMPacket>::value,
+                "VCMPacket must be copyable with memcpy.");
+  size_t codec_header_size;
+  switch (packet.codec) {
+    case kVideoCodecVP8:
+      codec_header_size = sizeof(RTPVideoHeaderVP8);
+      break;
+    case kVideoCodecH264:
+      codec_header_size = sizeof(RTPVideoHeaderH264);
+      break;
+    default:
+      *slot = packet;
+      return;
+  }
+  constexpr size_t kCodecHeaderBegin =
+      offsetof(VCMPacket, video_header) + offsetof(RTPVideoHeader, codecHeader);
+  constexpr size_t kCodecHeaderEnd =
+      kCodecHeaderBegin + sizeof(RTPVideoTypeHeader);
+  const uint8_t* src = reinterpret_cast<const uint8_t*>(&packet);
+  uint8_t* dst = reinterpret_cast<uint8_t*>(slot);
+  memcpy(dst, src, kCodecHeaderBegin + codec_header_size);
+  memcpy(dst + kCodecHeaderEnd, src + kCodecHeaderEnd,
+         sizeof(VCMPacket) - kCodecHeaderEnd);
+}
+
+}  // namespace
 
 rtc::scoped_refptr<PacketBuffer> PacketBuffer::Create(
     Clock* clock,
@@ -81,7 +117,7 @@ bool PacketBuffer::InsertPacket(VCMPacket* packet) {
 
     if (sequence_buffer_[index].used) {
       // Duplicate packet, just delete the payload.
-      if (data_buffer_[index].seqNum == packet->seqNum) {
+      if (data_buffer_[index]->seqNum == packet->seqNum) {
         delete[] packet->dataPtr;
         packet->dataPtr = nullptr;
         return true;
@@ -106,10 +142,16 @@ bool PacketBuffer::InsertPacket(VCMPacket* packet) {
     sequence_buffer_[index].continuous = false;
     sequence_buffer_[index].frame_created = false;
     sequence_buffer_[index].used = true;
-    data_buffer_[index] = *packet;
+    if (free_packets_.empty()) {
+      data_buffer_[index].reset(new VCMPacket());
+    } else {
+      data_buffer_[index] = std::move(free_packets_.back());
+      free_packets_.pop_back();
+    }
+    CopyPacket(*packet, data_buffer_[index].get());
     packet->dataPtr = nullptr;
 
-    UpdateMissingPackets(packet->seqNum);
+    missing_packets_.Update(packet->seqNum);
 
     int64_t now_ms = clock_->TimeInMilliseconds();
     last_received_packet_ms_ = rtc::Optional<int64_t>(now_ms);
@@ -144,11 +186,11 @@ void PacketBuffer::ClearTo(uint16_t seq_num) {
   size_t iterations = std::min(diff, size_);
   for (size_t i = 0; i < iterations; ++i) {
     size_t index = first_seq_num_ % size_;
-    RTC_DCHECK_EQ(data_buffer_[index].seqNum, sequence_buffer_[index].seq_num);
-    if (AheadOf<uint16_t>(seq_num, sequence_buffer_[index].seq_num)) {
-      delete[] data_buffer_[index].dataPtr;
-      data_buffer_[index].dataPtr = nullptr;
-      sequence_buffer_[index].used = false;
+    if (sequence_buffer_[index].used &&
+        AheadOf<uint16_t>(seq_num, sequence_buffer_[index].seq_num)) {
+      RTC_DCHECK_EQ(data_buffer_[index]->seqNum,
+                    sequence_buffer_[index].seq_num);
+      ReleasePacket(index);
     }
     ++first_seq_num_;
   }
@@ -158,31 +200,28 @@ void PacketBuffer::ClearTo(uint16_t seq_num) {
   first_seq_num_ = seq_num;
 
   is_cleared_to_first_seq_num_ = true;
-  missing_packets_.erase(missing_packets_.begin(),
-                         missing_packets_.upper_bound(seq_num));
+  missing_packets_.ClearTo(seq_num);
 }
 
 void PacketBuffer::Clear() {
   rtc::CritScope lock(&crit_);
   for (size_t i = 0; i < size_; ++i) {
-    delete[] data_buffer_[i].dataPtr;
-    data_buffer_[i].dataPtr = nullptr;
-    sequence_buffer_[i].used = false;
+    if (sequence_buffer_[i].used)
+      ReleasePacket(i);
   }
 
   first_packet_received_ = false;
   is_cleared_to_first_seq_num_ = false;
   last_received_packet_ms_.reset();
   last_received_keyframe_packet_ms_.reset();
-  newest_inserted_seq_num_.reset();
-  missing_packets_.clear();
+  missing_packets_.Clear();
 }
 
 void PacketBuffer::PaddingReceived(uint16_t seq_num) {
   std::vector<std::unique_ptr<RtpFrameObject>> found_frames;
   {
     rtc::CritScope lock(&crit_);
-    UpdateMissingPackets(seq_num);
+    missing_packets_.Update(seq_num);
     found_frames = FindFrames(static_cast<uint16_t>(seq_num + 1));
   }
 
@@ -209,13 +248,13 @@ bool PacketBuffer::ExpandBufferSize() {
   }
 
   size_t new_size = std::min(max_size_, 2 * size_);
-  std::vector<VCMPacket> new_data_buffer(new_size);
+  std::vector<std::unique_ptr<VCMPacket>> new_data_buffer(new_size);
   std::vector<ContinuityInfo> new_sequence_buffer(new_size);
   for (size_t i = 0; i < size_; ++i) {
     if (sequence_buffer_[i].used) {
       size_t index = sequence_buffer_[i].seq_num % new_size;
       new_sequence_buffer[index] = sequence_buffer_[i];
-      new_data_buffer[index] = data_buffer_[i];
+      new_data_buffer[index] = std::move(data_buffer_[i]);
     }
   }
   size_ = new_size;
@@ -270,15 +309,15 @@ std::vector<std::unique_ptr<RtpFrameObject>> PacketBuffer::FindFrames(
       int start_index = index;
       size_t tested_packets = 0;
 
-      bool is_h264 = data_buffer_[start_index].codec == kVideoCodecH264;
+      bool is_h264 = data_buffer_[start_index]->codec == kVideoCodecH264;
       bool is_h264_keyframe = false;
-      int64_t frame_timestamp = data_buffer_[start_index].timestamp;
+      int64_t frame_timestamp = data_buffer_[start_index]->timestamp;
 
       while (true) {
         ++tested_packets;
-        frame_size += data_buffer_[start_index].sizeBytes;
+        frame_size += data_buffer_[start_index]->sizeBytes;
         max_nack_count =
-            std::max(max_nack_count, data_buffer_[start_index].timesNacked);
+            std::max(max_nack_count, data_buffer_[start_index]->timesNacked);
         sequence_buffer_[start_index].frame_created = true;
 
         if (!is_h264 && sequence_buffer_[start_index].frame_begin)
@@ -286,7 +325,7 @@ std::vector<std::unique_ptr<RtpFrameObject>> PacketBuffer::FindFrames(
 
         if (is_h264 && !is_h264_keyframe) {
           const RTPVideoHeaderH264& header =
-              data_buffer_[start_index].video_header.codecHeader.H264;
+              data_buffer_[start_index]->video_header.codecHeader.H264;
           for (size_t i = 0; i < header.nalus_length; ++i) {
             if (header.nalus[i].type == H264::NaluType::kIdr) {
               is_h264_keyframe = true;
@@ -308,7 +347,7 @@ std::vector<std::unique_ptr<RtpFrameObject>> PacketBuffer::FindFrames(
         // See: https://bugs.chromium.org/p/webrtc/issues/detail?id=7106
         if (is_h264 &&
             (!sequence_buffer_[start_index].used ||
-             data_buffer_[start_index].timestamp != frame_timestamp)) {
+             data_buffer_[start_index]->timestamp != frame_timestamp)) {
           break;
         }
 
@@ -318,8 +357,7 @@ std::vector<std::unique_ptr<RtpFrameObject>> PacketBuffer::FindFrames(
       // If this is H264 but not a keyframe, make sure there are no gaps in the
       // packet sequence numbers up until this point.
       if (is_h264 && !is_h264_keyframe &&
-          missing_packets_.upper_bound(start_seq_num) !=
-              missing_packets_.begin()) {
+          missing_packets_.AnyUpTo(start_seq_num)) {
         uint16_t stop_index = (index + 1) % size_;
         while (start_index != stop_index) {
           sequence_buffer_[start_index].frame_created = false;
@@ -329,8 +367,7 @@ std::vector<std::unique_ptr<RtpFrameObject>> PacketBuffer::FindFrames(
         return found_frames;
       }
 
-      missing_packets_.erase(missing_packets_.begin(),
-                             missing_packets_.upper_bound(seq_num));
+      missing_packets_.ClearTo(seq_num);
 
       found_frames.emplace_back(
           new RtpFrameObject(this, start_seq_num, seq_num, frame_size,
@@ -347,10 +384,9 @@ void PacketBuffer::ReturnFrame(RtpFrameObject* frame) {
   size_t end = (frame->last_seq_num() + 1) % size_;
   uint16_t seq_num = frame->first_seq_num();
   while (index != end) {
-    if (sequence_buffer_[index].seq_num == seq_num) {
-      delete[] data_buffer_[index].dataPtr;
-      data_buffer_[index].dataPtr = nullptr;
-      sequence_buffer_[index].used = false;
+    if (sequence_buffer_[index].used &&
+        sequence_buffer_[index].seq_num == seq_num) {
+      ReleasePacket(index);
     }
 
     index = (index + 1) % size_;
@@ -373,8 +409,9 @@ bool PacketBuffer::GetBitstream(const RtpFrameObject& frame,
       return false;
     }
 
-    RTC_DCHECK_EQ(data_buffer_[index].seqNum, sequence_buffer_[index].seq_num);
-    size_t length = data_buffer_[index].sizeBytes;
+    RTC_DCHECK_EQ(data_buffer_[index]->seqNum,
+                  sequence_buffer_[index].seq_num);
+    size_t length = data_buffer_[index]->sizeBytes;
     if (destination + length > destination_end) {
       LOG(LS_WARNING) << "Frame (" << frame.picture_id << ":"
                       << static_cast<int>(frame.spatial_layer) << ")"
@@ -382,7 +419,7 @@ bool PacketBuffer::GetBitstream(const RtpFrameObject& frame,
       return false;
     }
 
-    const uint8_t* source = data_buffer_[index].dataPtr;
+    const uint8_t* source = data_buffer_[index]->dataPtr;
     memcpy(destination, source, length);
     destination += length;
     index = (index + 1) % size_;
@@ -398,7 +435,7 @@ VCMPacket* PacketBuffer::GetPacket(uint16_t seq_num) {
       seq_num != sequence_buffer_[index].seq_num) {
     return nullptr;
   }
-  return &data_buffer_[index];
+  return data_buffer_[index].get();
 }
 
 int PacketBuffer::AddRef() const {
@@ -413,30 +450,108 @@ int PacketBuffer::Release() const {
   return count;
 }
 
-void PacketBuffer::UpdateMissingPackets(uint16_t seq_num) {
+void PacketBuffer::ReleasePacket(size_t index) {
+  RTC_DCHECK(sequence_buffer_[index].used);
+  delete[] data_buffer_[index]->dataPtr;
+  data_buffer_[index]->dataPtr = nullptr;
+  free_packets_.push_back(std::move(data_buffer_[index]));
+  sequence_buffer_[index].used = false;
+}
+
+constexpr int PacketBuffer::MissingPackets::kMaxPaddingAge;
+constexpr int PacketBuffer::MissingPackets::kNumWords;
+
+PacketBuffer::MissingPackets::MissingPackets() {
+  Clear();
+}
+
+void PacketBuffer::MissingPackets::Update(uint16_t seq_num) {
   if (!newest_inserted_seq_num_)
     newest_inserted_seq_num_ = rtc::Optional<uint16_t>(seq_num);
 
-  const int kMaxPaddingAge = 1000;
-  if (AheadOf(seq_num, *newest_inserted_seq_num_)) {
+  uint16_t& newest = *newest_inserted_seq_num_;
+  if (AheadOf(seq_num, newest)) {
+    // Forget the sequence numbers that are now too old, and guard against
+    // marking a large amount of packets missing if there is a jump in the
+    // sequence number.
     uint16_t old_seq_num = seq_num - kMaxPaddingAge;
-    auto erase_to = missing_packets_.lower_bound(old_seq_num);
-    missing_packets_.erase(missing_packets_.begin(), erase_to);
-
-    // Guard against inserting a large amount of missing packets if there is a
-    // jump in the sequence number.
-    if (AheadOf(old_seq_num, *newest_inserted_seq_num_))
-      *newest_inserted_seq_num_ = old_seq_num;
-
-    ++*newest_inserted_seq_num_;
-    while (AheadOf(seq_num, *newest_inserted_seq_num_)) {
-      missing_packets_.insert(*newest_inserted_seq_num_);
-      ++*newest_inserted_seq_num_;
+    int num_too_old = ForwardDiff<uint16_t>(newest, seq_num);
+    SetBits(newest - kMaxPaddingAge, std::min(num_too_old, kMaxPaddingAge),
+            false);
+    if (AheadOf(old_seq_num, newest))
+      newest = old_seq_num;
+
+    ++newest;
+    SetBits(newest, ForwardDiff<uint16_t>(newest, seq_num), true);
+    newest = seq_num;
+  } else if (ForwardDiff<uint16_t>(newest - kMaxPaddingAge, seq_num) <
+             kMaxPaddingAge) {
+    SetBits(seq_num, 1, false);
+  }
+}
+
+void PacketBuffer::MissingPackets::ClearTo(uint16_t seq_num) {
+  if (newest_inserted_seq_num_)
+    SetBits(*newest_inserted_seq_num_ - kMaxPaddingAge, CountUpTo(seq_num),
+            false);
+}
+
+bool PacketBuffer::MissingPackets::AnyUpTo(uint16_t seq_num) const {
+  return newest_inserted_seq_num_ &&
+         AnyBitSet(*newest_inserted_seq_num_ - kMaxPaddingAge,
+                   CountUpTo(seq_num));
+}
+
+void PacketBuffer::MissingPackets::Clear() {
+  newest_inserted_seq_num_.reset();
+  std::fill(bits_, bits_ + kNumWords, 0);
+}
+
+int PacketBuffer::MissingPackets::CountUpTo(uint16_t seq_num) const {
+  if (!newest_inserted_seq_num_)
+    return 0;
+  // The tracked sequence numbers are the |kMaxPaddingAge| before the newest.
+  uint16_t oldest = *newest_inserted_seq_num_ - kMaxPaddingAge;
+  int diff = ForwardDiff<uint16_t>(oldest, seq_num);
+  if (diff < kMaxPaddingAge)
+    return diff + 1;
+  return AheadOf(seq_num, oldest) ? kMaxPaddingAge : 0;
+}
+
+void PacketBuffer::MissingPackets::SetBits(uint16_t seq_num,
+                                           int count,
+                                           bool value) {
+  int bit = seq_num % (kNumWords * 64);
+  while (count > 0) {
+    int bits_in_word = std::min(count, 64 - bit % 64);
+    uint64_t mask = (bits_in_word == 64 ? ~uint64_t{0}
+                                        : (uint64_t{1} << bits_in_word) - 1)
+                    << (bit % 64);
+    if (value) {
+      bits_[bit / 64] |= mask;
+    } else {
+      bits_[bit / 64] &= ~mask;
     }
-  } else {
-    missing_packets_.erase(seq_num);
+    count -= bits_in_word;
+    bit = (bit + bits_in_word) % (kNumWords * 64);
   }
 }
 
+bool PacketBuffer::MissingPackets::AnyBitSet(uint16_t seq_num,
+                                             int count) const {
+  int bit = seq_num % (kNumWords * 64);
+  while (count > 0) {
+    int bits_in_word = std::min(count, 64 - bit % 64);
+    uint64_t mask = (bits_in_word == 64 ? ~uint64_t{0}
+                                        : (uint64_t{1} << bits_in_word) - 1)
+                    << (bit % 64);
+    if (bits_[bit / 64] & mask)
+      return true;
+    count -= bits_in_word;
+    bit = (bit + bits_in_word) % (kNumWords * 64);
+  }
+  return false;
+}
+
 }  // namespace video_coding
 }  // namespace webrtc
@@ -12,7 +12,6 @@
 #define MODULES_VIDEO_CODING_PACKET_BUFFER_H_
 
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "modules/include/module_common_types.h"
@@ -123,8 +122,42 @@ class PacketBuffer {
   // Virtual for testing.
   virtual void ReturnFrame(RtpFrameObject* frame);
 
-  void UpdateMissingPackets(uint16_t seq_num)
-      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Deletes the payload of the packet in slot |index| and marks the slot as
+  // not used.
+  void ReleasePacket(size_t index) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // The sequence numbers that have not been received among the
+  // |kMaxPaddingAge| before the newest one, as a ring of bits indexed by
+  // sequence number.
+  class MissingPackets {
+   public:
+    MissingPackets();
+
+    // Marks |seq_num| as received. If it is the newest sequence number so
+    // far, marks the ones skipped since the previous newest as missing.
+    void Update(uint16_t seq_num);
+    // Forgets the missing sequence numbers up to and including |seq_num|.
+    void ClearTo(uint16_t seq_num);
+    // Returns true if a sequence number up to and including |seq_num| is
+    // missing.
+    bool AnyUpTo(uint16_t seq_num) const;
+    void Clear();
+
+   private:
+    static constexpr int kMaxPaddingAge = 1000;
+    static constexpr int kNumWords = 16;
+    static_assert(kNumWords * 64 >= kMaxPaddingAge, "Ring is too small.");
+
+    // Returns the number of tracked sequence numbers up to and including
+    // |seq_num|.
+    int CountUpTo(uint16_t seq_num) const;
+    // Sets or clears the bits of |count| sequence numbers from |seq_num|.
+    void SetBits(uint16_t seq_num, int count, bool value);
+    bool AnyBitSet(uint16_t seq_num, int count) const;
+
+    rtc::Optional<uint16_t> newest_inserted_seq_num_;
+    uint64_t bits_[kNumWords];
+  };
 
   rtc::CriticalSection crit_;
 
@@ -141,8 +174,11 @@ class PacketBuffer {
   // If the buffer is cleared to |first_seq_num_|.
   bool is_cleared_to_first_seq_num_ RTC_GUARDED_BY(crit_);
 
-  // Buffer that holds the inserted packets.
-  std::vector<VCMPacket> data_buffer_ RTC_GUARDED_BY(crit_);
+  // Buffer that holds the inserted packets. Slots that are not used hold no
+  // packet, so memory is only used for the packets in the buffer; released
+  // packets are kept in |free_packets_| to be reused.
+  std::vector<std::unique_ptr<VCMPacket>> data_buffer_ RTC_GUARDED_BY(crit_);
+  std::vector<std::unique_ptr<VCMPacket>> free_packets_ RTC_GUARDED_BY(crit_);
 
   // Buffer that holds the information about which slot that is currently in use
   // and information needed to determine the continuity between packets.
@@ -156,9 +192,7 @@ class PacketBuffer {
   rtc::Optional<int64_t> last_received_keyframe_packet_ms_
       RTC_GUARDED_BY(crit_);
 
-  rtc::Optional<uint16_t> newest_inserted_seq_num_ RTC_GUARDED_BY(crit_);
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>> missing_packets_
-      RTC_GUARDED_BY(crit_);
+  MissingPackets missing_packets_ RTC_GUARDED_BY(crit_);
 
   mutable volatile int ref_count_ = 0;
 };
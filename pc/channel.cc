@@ -66,6 +66,10 @@ enum {
 // Value specified in RFC 5764.
 static const char kDtlsSrtpExporterLabel[] = "EXTRACTOR-dtls_srtp";
 
+// Number of received packets that can be queued for the worker thread without
+// taking a lock. Must be a power of two.
+static const size_t kReceivedPacketQueueSize = 1024;
+
 static const int kAgcMinus10db = -10;
 
 static void SafeSetError(const std::string& message, std::string* error_desc) {
@@ -152,6 +156,9 @@ BaseChannel::BaseChannel(rtc::Thread* worker_thread,
       content_name_(content_name),
       rtcp_mux_required_(rtcp_mux_required),
       srtp_required_(srtp_required),
+      received_packets_(kReceivedPacketQueueSize),
+      received_packets_drain_pending_(false),
+      received_packets_overflowed_(false),
       media_channel_(media_channel),
       selected_candidate_pair_(nullptr) {
   RTC_DCHECK(worker_thread_ == rtc::Thread::Current());
@@ -720,24 +727,55 @@ void BaseChannel::OnPacketReceived(bool rtcp,
     return;
   }
 
-  invoker_.AsyncInvoke<void>(
-      RTC_FROM_HERE, worker_thread_,
-      Bind(&BaseChannel::ProcessPacket, this, rtcp, *packet, packet_time));
+  ReceivedPacket received;
+  received.rtcp = rtcp;
+  // Shares the payload with |packet| (a reference count, not a memcpy).
+  received.packet = *packet;
+  received.packet_time = packet_time;
+  if (received_packets_overflowed_.load() ||
+      !received_packets_.TryPush(std::move(received))) {
+    // The worker thread is far behind; keep the packet rather than drop it.
+    rtc::CritScope cs(&received_packets_overflow_crit_);
+    received_packets_overflow_.push_back(std::move(received));
+    received_packets_overflowed_.store(true);
+  }
+  if (!received_packets_drain_pending_.exchange(true)) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, worker_thread_,
+        Bind(&BaseChannel::ProcessReceivedPackets_w, this));
+  }
 }
 
-void BaseChannel::ProcessPacket(bool rtcp,
-                                const rtc::CopyOnWriteBuffer& packet,
-                                const rtc::PacketTime& packet_time) {
+void BaseChannel::ProcessReceivedPackets_w() {
   RTC_DCHECK(worker_thread_->IsCurrent());
-
-  // Need to copy variable because OnRtcpReceived/OnPacketReceived
-  // requires non-const pointer to buffer. This doesn't memcpy the actual data.
-  rtc::CopyOnWriteBuffer data(packet);
-  if (rtcp) {
-    media_channel_->OnRtcpReceived(&data, packet_time);
-  } else {
-    media_channel_->OnPacketReceived(&data, packet_time);
-  }
+  // Clear the flag before draining, so a packet pushed after the last pop
+  // below always schedules another drain.
+  received_packets_drain_pending_.store(false);
+  auto deliver = [this](ReceivedPacket* received) {
+    if (received->rtcp) {
+      media_channel_->OnRtcpReceived(&received->packet, received->packet_time);
+    } else {
+      media_channel_->OnPacketReceived(&received->packet,
+                                       received->packet_time);
+    }
+  };
+  ReceivedPacket received;
+  while (received_packets_.TryPop(&received))
+    deliver(&received);
+
+  // Packets in the overflow queue are newer than any popped above. Once it is
+  // taken, the network thread goes back to |received_packets_|, whose packets
+  // are then newer than these and wait for the next drain.
+  if (!received_packets_overflowed_.load())
+    return;
+  std::deque<ReceivedPacket> overflow;
+  {
+    rtc::CritScope cs(&received_packets_overflow_crit_);
+    overflow.swap(received_packets_overflow_);
+    received_packets_overflowed_.store(false);
+  }
+  for (ReceivedPacket& packet : overflow)
+    deliver(&packet);
 }
 
 void BaseChannel::EnableMedia_w() {
@@ -11,6 +11,8 @@
 #ifndef PC_CHANNEL_H_
 #define PC_CHANNEL_H_
 
+#include <atomic>
+#include <deque>
 #include <map>
 #include <memory>
 #include <set>
@@ -39,6 +41,7 @@
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/network.h"
 #include "rtc_base/sigslot.h"
+#include "rtc_base/spsc_queue.h"
 #include "rtc_base/window.h"
 
 namespace webrtc {
@@ -263,9 +266,7 @@ class BaseChannel
   virtual void OnPacketReceived(bool rtcp,
                                 rtc::CopyOnWriteBuffer* packet,
                                 const rtc::PacketTime& packet_time);
-  void ProcessPacket(bool rtcp,
-                     const rtc::CopyOnWriteBuffer& packet,
-                     const rtc::PacketTime& packet_time);
+  void ProcessReceivedPackets_w();
 
   void EnableMedia_w();
   void DisableMedia_w();
@@ -398,6 +399,25 @@ class BaseChannel
   bool dtls_active_ = false;
   const bool srtp_required_ = true;
 
+  // Incoming packets are handed from the network thread (the only producer)
+  // to the worker thread (the only consumer) through |received_packets_|.
+  // A drain task is posted to the worker only when none is pending, so a
+  // burst of packets costs one task instead of one Message per packet.
+  struct ReceivedPacket {
+    bool rtcp = false;
+    rtc::CopyOnWriteBuffer packet;
+    rtc::PacketTime packet_time;
+  };
+  rtc::SpscQueue<ReceivedPacket> received_packets_;
+  std::atomic<bool> received_packets_drain_pending_;
+  // Packets that didn't fit in |received_packets_|. While any are queued
+  // here, newer packets are queued here too, so that the worker thread, which
+  // drains |received_packets_| first, sees them in order.
+  rtc::CriticalSection received_packets_overflow_crit_;
+  std::deque<ReceivedPacket> received_packets_overflow_
+      RTC_GUARDED_BY(received_packets_overflow_crit_);
+  std::atomic<bool> received_packets_overflowed_;
+
   // MediaChannel related members that should be accessed from the worker
   // thread.
   MediaChannel* const media_channel_;
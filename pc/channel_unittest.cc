@@ -8,6 +8,7 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <functional>
 #include <memory>
 
 #include "api/array_view.h"
@@ -20,6 +21,7 @@
 #include "p2p/base/fakepackettransport.h"
 #include "pc/channel.h"
 #include "rtc_base/buffer.h"
+#include "rtc_base/byteorder.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/fakeclock.h"
 #include "rtc_base/gunit.h"
@@ -2759,6 +2761,62 @@ TEST_F(VoiceChannelDoubleThreadTest, SendRtpToRtp) {
   Base::SendRtpToRtp();
 }
 
+// Runs |on_packet_received| each time the worker thread hands it an RTP
+// packet.
+class HookedVoiceMediaChannel : public FakeVoiceMediaChannel {
+ public:
+  HookedVoiceMediaChannel()
+      : FakeVoiceMediaChannel(nullptr, cricket::AudioOptions()) {}
+
+  void OnPacketReceived(rtc::CopyOnWriteBuffer* packet,
+                        const rtc::PacketTime& packet_time) override {
+    FakeVoiceMediaChannel::OnPacketReceived(packet, packet_time);
+    if (on_packet_received)
+      on_packet_received();
+  }
+
+  std::function<void()> on_packet_received;
+};
+
+TEST_F(VoiceChannelDoubleThreadTest, ReceivedPacketsStayInOrderUnderLoad) {
+  HookedVoiceMediaChannel* receiver = new HookedVoiceMediaChannel();
+  const int kFlags = RAW_PACKET_TRANSPORT | RTCP_MUX | RTCP_MUX_REQUIRED;
+  CreateChannels(new FakeVoiceMediaChannel(nullptr, cricket::AudioOptions()),
+                 receiver, kFlags, kFlags);
+  EXPECT_TRUE(SendInitiate());
+  EXPECT_TRUE(SendAccept());
+
+  const int kNumPackets = 3000;
+  int next_sequence_number = 0;
+  auto deliver = [this, &next_sequence_number] {
+    rtc::Buffer packet(rtp_packet_.data(), rtp_packet_.size());
+    rtc::SetBE16(packet.data() + 2,
+                 static_cast<uint16_t>(next_sequence_number++));
+    network_thread_->Invoke<void>(RTC_FROM_HERE, [this, &packet] {
+      fake_rtp_packet_transport2_->SignalReadPacket(
+          fake_rtp_packet_transport2_.get(), packet.data<char>(),
+          packet.size(), rtc::PacketTime(), 0);
+    });
+  };
+  // Overflow the receive queue while the worker thread is busy, then let the
+  // network thread deliver another packet each time the worker consumes one,
+  // so that it keeps pushing while the worker drains the queue.
+  for (int i = 0; i < 1100; ++i)
+    deliver();
+  receiver->on_packet_received = [&] {
+    if (next_sequence_number < kNumPackets)
+      deliver();
+  };
+  WaitForThreads();
+
+  const std::list<std::string>& packets = receiver->rtp_packets();
+  ASSERT_EQ(static_cast<size_t>(kNumPackets), packets.size());
+  int expected_sequence_number = 0;
+  for (const std::string& packet : packets)
+    EXPECT_EQ(expected_sequence_number++, rtc::GetBE16(packet.data() + 2));
+  receiver->on_packet_received = nullptr;
+}
+
 TEST_F(VoiceChannelDoubleThreadTest, SendRtcpToRtcp) {
   Base::SendRtcpToRtcp();
 }
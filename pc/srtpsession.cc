@@ -19,12 +19,22 @@
 
 namespace cricket {
 
+namespace {
+
+// Rates are averaged over 10 buckets of 100 ms.
+const int64_t kRateBucketMs = 100;
+const size_t kRateBucketCount = 10;
+
+}  // namespace
+
 bool SrtpSession::inited_ = false;
 
 // This lock protects SrtpSession::inited_.
 rtc::GlobalLockPod SrtpSession::lock_;
 
-SrtpSession::SrtpSession() {}
+SrtpSession::SrtpSession()
+    : protected_bytes_rate_(kRateBucketMs, kRateBucketCount),
+      unprotected_bytes_rate_(kRateBucketMs, kRateBucketCount) {}
 
 SrtpSession::~SrtpSession() {
   if (session_) {
@@ -74,6 +84,7 @@ bool SrtpSession::ProtectRtp(void* p, int in_len, int max_len, int* out_len) {
     return false;
   }
   last_send_seq_num_ = seq_num;
+  OnProtected(1, in_len);
   return true;
 }
 
@@ -108,6 +119,7 @@ bool SrtpSession::ProtectRtcp(void* p, int in_len, int max_len, int* out_len) {
     LOG(LS_WARNING) << "Failed to protect SRTCP packet, err=" << err;
     return false;
   }
+  OnProtected(1, in_len);
   return true;
 }
 
@@ -124,9 +136,101 @@ bool SrtpSession::UnprotectRtp(void* p, int in_len, int* out_len) {
     LOG(LS_WARNING) << "Failed to unprotect SRTP packet, err=" << err;
     return false;
   }
+  OnUnprotected(1, in_len);
   return true;
 }
 
+size_t SrtpSession::ProtectRtpBatch(std::vector<RtpPacketBuffer>* packets) {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  if (!session_) {
+    LOG(LS_WARNING) << "Failed to protect SRTP packets: no SRTP Session";
+    for (RtpPacketBuffer& packet : *packets)
+      packet.ok = false;
+    return 0;
+  }
+
+  // Failures are summarized in one log line per batch rather than one per
+  // packet, and only the last sequence number is recorded.
+  size_t num_protected = 0;
+  int64_t bytes_protected = 0;
+  int num_too_small = 0;
+  int first_err = srtp_err_status_ok;
+  int first_err_seq_num = -1;
+  for (RtpPacketBuffer& packet : *packets) {
+    packet.ok = false;
+    if (packet.max_len < packet.len + rtp_auth_tag_len_) {
+      ++num_too_small;
+      continue;
+    }
+    int out_len = packet.len;
+    int err = srtp_protect(session_, packet.data, &out_len);
+    int seq_num;
+    GetRtpSeqNum(packet.data, packet.len, &seq_num);
+    if (err != srtp_err_status_ok) {
+      if (first_err == srtp_err_status_ok) {
+        first_err = err;
+        first_err_seq_num = seq_num;
+      }
+      continue;
+    }
+    bytes_protected += packet.len;
+    packet.len = out_len;
+    packet.ok = true;
+    last_send_seq_num_ = seq_num;
+    ++num_protected;
+  }
+  OnProtected(static_cast<int>(num_protected), bytes_protected);
+
+  if (num_too_small > 0) {
+    LOG(LS_WARNING) << "Failed to protect " << num_too_small
+                    << " SRTP packets: buffer too small for auth tag of "
+                    << rtp_auth_tag_len_ << " bytes";
+  }
+  if (first_err != srtp_err_status_ok) {
+    LOG(LS_WARNING) << "Failed to protect "
+                    << packets->size() - num_protected - num_too_small
+                    << " SRTP packets, first seqnum=" << first_err_seq_num
+                    << ", err=" << first_err
+                    << ", last seqnum=" << last_send_seq_num_;
+  }
+  return num_protected;
+}
+
+size_t SrtpSession::UnprotectRtpBatch(std::vector<RtpPacketBuffer>* packets) {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  if (!session_) {
+    LOG(LS_WARNING) << "Failed to unprotect SRTP packets: no SRTP Session";
+    for (RtpPacketBuffer& packet : *packets)
+      packet.ok = false;
+    return 0;
+  }
+
+  size_t num_unprotected = 0;
+  int64_t bytes_unprotected = 0;
+  int first_err = srtp_err_status_ok;
+  for (RtpPacketBuffer& packet : *packets) {
+    int out_len = packet.len;
+    int err = srtp_unprotect(session_, packet.data, &out_len);
+    packet.ok = (err == srtp_err_status_ok);
+    if (!packet.ok) {
+      if (first_err == srtp_err_status_ok)
+        first_err = err;
+      continue;
+    }
+    bytes_unprotected += packet.len;
+    packet.len = out_len;
+    ++num_unprotected;
+  }
+  OnUnprotected(static_cast<int>(num_unprotected), bytes_unprotected);
+
+  if (first_err != srtp_err_status_ok) {
+    LOG(LS_WARNING) << "Failed to unprotect "
+                    << packets->size() - num_unprotected
+                    << " SRTP packets, first err=" << first_err;
+  }
+  return num_unprotected;
+}
+
 bool SrtpSession::UnprotectRtcp(void* p, int in_len, int* out_len) {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
   if (!session_) {
@@ -140,9 +244,18 @@ bool SrtpSession::UnprotectRtcp(void* p, int in_len, int* out_len) {
     LOG(LS_WARNING) << "Failed to unprotect SRTCP packet, err=" << err;
     return false;
   }
+  OnUnprotected(1, in_len);
   return true;
 }
 
+SrtpSession::Stats SrtpSession::GetStats() const {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  Stats stats = stats_;
+  stats.protected_bytes_per_second = protected_bytes_rate_.ComputeRate();
+  stats.unprotected_bytes_per_second = unprotected_bytes_rate_.ComputeRate();
+  return stats;
+}
+
 bool SrtpSession::GetRtpAuthParams(uint8_t** key, int* key_len, int* tag_len) {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
   RTC_DCHECK(IsExternalAuthActive());
@@ -204,6 +317,22 @@ bool SrtpSession::GetSendStreamPacketIndex(void* p,
   return true;
 }
 
+void SrtpSession::OnProtected(int num_packets, int64_t num_bytes) {
+  if (num_packets == 0)
+    return;
+  stats_.packets_protected += num_packets;
+  stats_.bytes_protected += num_bytes;
+  protected_bytes_rate_.AddSamples(static_cast<size_t>(num_bytes));
+}
+
+void SrtpSession::OnUnprotected(int num_packets, int64_t num_bytes) {
+  if (num_packets == 0)
+    return;
+  stats_.packets_unprotected += num_packets;
+  stats_.bytes_unprotected += num_bytes;
+  unprotected_bytes_rate_.AddSamples(static_cast<size_t>(num_bytes));
+}
+
 bool SrtpSession::DoSetKey(int type, int cs, const uint8_t* key, size_t len) {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
 
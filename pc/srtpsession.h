@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "rtc_base/basictypes.h"
+#include "rtc_base/ratetracker.h"
 #include "rtc_base/thread_checker.h"
 
 // Forward declaration to avoid pulling in libsrtp headers here
@@ -56,6 +57,37 @@ class SrtpSession {
   bool UnprotectRtp(void* data, int in_len, int* out_len);
   bool UnprotectRtcp(void* data, int in_len, int* out_len);
 
+  // An RTP packet to be encrypted or decrypted in-place by ProtectRtpBatch or
+  // UnprotectRtpBatch.
+  struct RtpPacketBuffer {
+    void* data = nullptr;
+    // Length of the packet, updated to the new length on success.
+    int len = 0;
+    // Size of the buffer at |data|. Only used by ProtectRtpBatch.
+    int max_len = 0;
+    // Set to whether the packet was successfully processed.
+    bool ok = false;
+  };
+  // Encrypts/decrypts a batch of RTP packets, as received from or to be sent
+  // with batched socket I/O, in a single call. Packets that fail are marked
+  // as such and do not stop the rest of the batch. Returns the number of
+  // packets successfully processed.
+  size_t ProtectRtpBatch(std::vector<RtpPacketBuffer>* packets);
+  size_t UnprotectRtpBatch(std::vector<RtpPacketBuffer>* packets);
+
+  struct Stats {
+    // Packets and bytes passed in to be encrypted or decrypted successfully,
+    // RTP and RTCP together.
+    int64_t packets_protected = 0;
+    int64_t bytes_protected = 0;
+    int64_t packets_unprotected = 0;
+    int64_t bytes_unprotected = 0;
+    // Averaged over the last second.
+    double protected_bytes_per_second = 0.0;
+    double unprotected_bytes_per_second = 0.0;
+  };
+  Stats GetStats() const;
+
   // Helper method to get authentication params.
   bool GetRtpAuthParams(uint8_t** key, int* key_len, int* tag_len);
 
@@ -87,6 +119,9 @@ class SrtpSession {
   // Returns send stream current packet index from srtp db.
   bool GetSendStreamPacketIndex(void* data, int in_len, int64_t* index);
 
+  void OnProtected(int num_packets, int64_t num_bytes);
+  void OnUnprotected(int num_packets, int64_t num_bytes);
+
   static bool Init();
   void HandleEvent(const srtp_event_data_t* ev);
   static void HandleEventThunk(srtp_event_data_t* ev);
@@ -101,6 +136,9 @@ class SrtpSession {
   bool external_auth_active_ = false;
   bool external_auth_enabled_ = false;
   std::vector<int> encrypted_header_extension_ids_;
+  Stats stats_;
+  rtc::RateTracker protected_bytes_rate_;
+  rtc::RateTracker unprotected_bytes_rate_;
   RTC_DISALLOW_COPY_AND_ASSIGN(SrtpSession);
 };
 
@@ -11,11 +11,14 @@
 #include "pc/srtpsession.h"
 
 #include <string>
+#include <vector>
 
 #include "media/base/fakertp.h"
 #include "pc/srtptestutil.h"
 #include "rtc_base/gunit.h"
+#include "rtc_base/logging.h"
 #include "rtc_base/sslstreamadapter.h"  // For rtc::SRTP_*
+#include "rtc_base/timeutils.h"
 
 namespace rtc {
 
@@ -201,4 +204,145 @@ TEST_F(SrtpSessionTest, TestReplay) {
       s1_.ProtectRtp(rtp_packet_, rtp_len_, sizeof(rtp_packet_), &out_len));
 }
 
+TEST_F(SrtpSessionTest, TestProtectUnprotectRtpBatch) {
+  static const int kNumPackets = 8;
+  EXPECT_TRUE(s1_.SetSend(SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen));
+  EXPECT_TRUE(s2_.SetRecv(SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen));
+
+  std::vector<std::vector<char>> buffers(kNumPackets);
+  std::vector<cricket::SrtpSession::RtpPacketBuffer> packets(kNumPackets);
+  for (int i = 0; i < kNumPackets; ++i) {
+    buffers[i].assign(kPcmuFrame, kPcmuFrame + rtp_len_);
+    buffers[i].resize(rtp_len_ + 10);
+    SetBE16(reinterpret_cast<uint8_t*>(buffers[i].data()) + 2, i);
+    packets[i].data = buffers[i].data();
+    packets[i].len = rtp_len_;
+    packets[i].max_len = static_cast<int>(buffers[i].size());
+  }
+  // One buffer has no room for the auth tag.
+  packets[3].max_len = rtp_len_;
+
+  EXPECT_EQ(static_cast<size_t>(kNumPackets - 1),
+            s1_.ProtectRtpBatch(&packets));
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(i != 3, packets[i].ok);
+    EXPECT_EQ(i != 3 ? rtp_len_ + 10 : rtp_len_, packets[i].len);
+  }
+
+  // Tamper with one packet; the rest of the batch is still decrypted.
+  buffers[5][rtp_len_ - 1] ^= 0x01;
+  EXPECT_EQ(static_cast<size_t>(kNumPackets - 2),
+            s2_.UnprotectRtpBatch(&packets));
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(i != 3 && i != 5, packets[i].ok);
+    if (packets[i].ok) {
+      EXPECT_EQ(rtp_len_, packets[i].len);
+      EXPECT_EQ(0, memcmp(buffers[i].data() + 4, kPcmuFrame + 4,
+                          rtp_len_ - 4));
+    }
+  }
+}
+
+TEST_F(SrtpSessionTest, TestStatsCountProtectedBytes) {
+  EXPECT_TRUE(s1_.SetSend(SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen));
+  EXPECT_TRUE(s2_.SetRecv(SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen));
+  TestProtectRtp(CS_AES_CM_128_HMAC_SHA1_80);
+  TestProtectRtcp(CS_AES_CM_128_HMAC_SHA1_80);
+  TestUnprotectRtp(CS_AES_CM_128_HMAC_SHA1_80);
+
+  cricket::SrtpSession::Stats stats = s1_.GetStats();
+  EXPECT_EQ(2, stats.packets_protected);
+  EXPECT_EQ(static_cast<int64_t>(sizeof(kPcmuFrame) + sizeof(kRtcpReport)),
+            stats.bytes_protected);
+  EXPECT_EQ(0, stats.packets_unprotected);
+  stats = s2_.GetStats();
+  EXPECT_EQ(0, stats.packets_protected);
+  EXPECT_EQ(1, stats.packets_unprotected);
+  EXPECT_EQ(rtp_len_, stats.bytes_unprotected);
+
+  // Failed packets are not counted.
+  rtp_packet_[0] = 0x12;
+  int out_len;
+  EXPECT_FALSE(s2_.UnprotectRtp(rtp_packet_, rtp_len_, &out_len));
+  EXPECT_EQ(1, s2_.GetStats().packets_unprotected);
+}
+
+// Protects and unprotects a stream of video sized packets, one packet per call
+// and in batches as sent and received with sendmmsg/recvmmsg.
+TEST_F(SrtpSessionTest, DISABLED_RtpBatchPerformance) {
+  static const int kPacketSize = 1200;
+  static const int kBatchSize = 32;
+  static const int kNumBatches = 5000;
+  static const uint8_t kTestKeyGcm128[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ12";
+  static const int kTestKeyGcm128Len = 28;
+  struct {
+    const char* name;
+    int cs;
+    const uint8_t* key;
+    int key_len;
+  } suites[] = {
+      {CS_AES_CM_128_HMAC_SHA1_80, SRTP_AES128_CM_SHA1_80, kTestKey1,
+       kTestKeyLen},
+      {CS_AEAD_AES_128_GCM, SRTP_AEAD_AES_128_GCM, kTestKeyGcm128,
+       kTestKeyGcm128Len},
+  };
+
+  for (const auto& suite : suites) {
+    for (bool batched : {false, true}) {
+      cricket::SrtpSession sender;
+      cricket::SrtpSession receiver;
+      ASSERT_TRUE(sender.SetSend(suite.cs, suite.key, suite.key_len));
+      ASSERT_TRUE(receiver.SetRecv(suite.cs, suite.key, suite.key_len));
+
+      std::vector<std::vector<char>> buffers(
+          kBatchSize, std::vector<char>(kPacketSize + 16));
+      std::vector<cricket::SrtpSession::RtpPacketBuffer> packets(kBatchSize);
+      uint16_t seq_num = 0;
+      int64_t protect_ns = 0;
+      int64_t unprotect_ns = 0;
+      for (int b = 0; b < kNumBatches; ++b) {
+        for (int i = 0; i < kBatchSize; ++i) {
+          memcpy(buffers[i].data(), kPcmuFrame, rtp_len_);
+          SetBE16(reinterpret_cast<uint8_t*>(buffers[i].data()) + 2,
+                  seq_num++);
+          packets[i].data = buffers[i].data();
+          packets[i].len = kPacketSize;
+          packets[i].max_len = static_cast<int>(buffers[i].size());
+        }
+
+        int64_t start_ns = rtc::TimeNanos();
+        if (batched) {
+          ASSERT_EQ(static_cast<size_t>(kBatchSize),
+                    sender.ProtectRtpBatch(&packets));
+        } else {
+          for (auto& packet : packets) {
+            ASSERT_TRUE(sender.ProtectRtp(packet.data, packet.len,
+                                          packet.max_len, &packet.len));
+          }
+        }
+        protect_ns += rtc::TimeNanos() - start_ns;
+
+        start_ns = rtc::TimeNanos();
+        if (batched) {
+          ASSERT_EQ(static_cast<size_t>(kBatchSize),
+                    receiver.UnprotectRtpBatch(&packets));
+        } else {
+          for (auto& packet : packets) {
+            ASSERT_TRUE(
+                receiver.UnprotectRtp(packet.data, packet.len, &packet.len));
+          }
+        }
+        unprotect_ns += rtc::TimeNanos() - start_ns;
+      }
+
+      const int64_t bytes =
+          static_cast<int64_t>(kPacketSize) * kBatchSize * kNumBatches;
+      LOG(LS_INFO) << suite.name << (batched ? " batched" : " per packet")
+                   << ": protect " << bytes * 1000 / protect_ns
+                   << " MB/s, unprotect " << bytes * 1000 / unprotect_ns
+                   << " MB/s.";
+    }
+  }
+}
+
 }  // namespace rtc
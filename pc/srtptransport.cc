@@ -66,7 +66,6 @@ bool SrtpTransport::SendPacket(bool rtcp,
   }
 
   rtc::PacketOptions updated_options = options;
-  rtc::CopyOnWriteBuffer cp = *packet;
   TRACE_EVENT0("webrtc", "SRTP Encode");
   bool res;
   uint8_t* data = packet->data();
@@ -355,6 +354,21 @@ bool SrtpTransport::GetSrtpOverhead(int* srtp_overhead) const {
   return true;
 }
 
+bool SrtpTransport::GetSrtpStats(
+    cricket::SrtpSession::Stats* send_stats,
+    cricket::SrtpSession::Stats* recv_stats) const {
+  if (!IsActive()) {
+    LOG(LS_WARNING) << "Failed to GetSrtpStats: SRTP not active";
+    return false;
+  }
+
+  RTC_CHECK(send_session_);
+  RTC_CHECK(recv_session_);
+  *send_stats = send_session_->GetStats();
+  *recv_stats = recv_session_->GetStats();
+  return true;
+}
+
 void SrtpTransport::EnableExternalAuth() {
   RTC_DCHECK(!IsActive());
   external_auth_enabled_ = true;
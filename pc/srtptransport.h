@@ -137,6 +137,11 @@ class SrtpTransport : public RtpTransportInternal {
   // Returns srtp overhead for rtp packets.
   bool GetSrtpOverhead(int* srtp_overhead) const;
 
+  // Returns the packet and byte counters of the send and receive SRTP
+  // sessions.
+  bool GetSrtpStats(cricket::SrtpSession::Stats* send_stats,
+                    cricket::SrtpSession::Stats* recv_stats) const;
+
   // Returns rtp auth params from srtp context.
   bool GetRtpAuthParams(uint8_t** key, int* key_len, int* tag_len);
 
@@ -11,6 +11,7 @@
 #include "pc/srtptransport.h"
 
 #include "media/base/fakertp.h"
+#include "media/base/rtputils.h"
 #include "p2p/base/dtlstransportinternal.h"
 #include "p2p/base/fakepackettransport.h"
 #include "pc/rtptransport.h"
@@ -419,4 +420,37 @@ TEST_F(SrtpTransportTest, TestSetParamsKeyTooShort) {
       rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen - 1));
 }
 
+// A packet with room for the auth tag is protected in place, and the bytes are
+// counted by the send and receive sessions.
+TEST_F(SrtpTransportTest, ProtectsRtpPacketInPlaceAndCountsBytes) {
+  EXPECT_TRUE(srtp_transport1_->SetRtpParams(
+      SRTP_AEAD_AES_128_GCM, kTestKeyGcm128_1, kTestKeyGcm128Len,
+      SRTP_AEAD_AES_128_GCM, kTestKeyGcm128_2, kTestKeyGcm128Len));
+  EXPECT_TRUE(srtp_transport2_->SetRtpParams(
+      SRTP_AEAD_AES_128_GCM, kTestKeyGcm128_2, kTestKeyGcm128Len,
+      SRTP_AEAD_AES_128_GCM, kTestKeyGcm128_1, kTestKeyGcm128Len));
+
+  const size_t rtp_len = sizeof(kPcmuFrame);
+  rtc::CopyOnWriteBuffer packet(kPcmuFrame, rtp_len,
+                                rtp_len + cricket::kMaxSrtpHmacOverhead);
+  const uint8_t* data = packet.cdata();
+  ASSERT_TRUE(srtp_transport1_->SendRtpPacket(&packet, rtc::PacketOptions(),
+                                              cricket::PF_SRTP_BYPASS));
+  EXPECT_EQ(data, packet.cdata());
+  EXPECT_EQ(rtp_len + rtc::rtp_auth_tag_len(rtc::CS_AEAD_AES_128_GCM),
+            packet.size());
+  ASSERT_EQ(rtp_len, last_recv_packet2_.size());
+
+  cricket::SrtpSession::Stats send_stats;
+  cricket::SrtpSession::Stats recv_stats;
+  ASSERT_TRUE(srtp_transport1_->GetSrtpStats(&send_stats, &recv_stats));
+  EXPECT_EQ(1, send_stats.packets_protected);
+  EXPECT_EQ(static_cast<int64_t>(rtp_len), send_stats.bytes_protected);
+  EXPECT_EQ(0, recv_stats.packets_unprotected);
+  ASSERT_TRUE(srtp_transport2_->GetSrtpStats(&send_stats, &recv_stats));
+  EXPECT_EQ(0, send_stats.packets_protected);
+  EXPECT_EQ(1, recv_stats.packets_unprotected);
+  EXPECT_EQ(static_cast<int64_t>(packet.size()), recv_stats.bytes_unprotected);
+}
+
 }  // namespace webrtc
@@ -12,6 +12,7 @@
 #define PC_WEBRTCSESSIONDESCRIPTIONFACTORY_H_
 
 #include <memory>
+#include <queue>
 
 #include "api/peerconnectioninterface.h"
 #include "p2p/base/transportdescriptionfactory.h"
@@ -19,6 +19,31 @@ AsyncSocket::AsyncSocket() {
 AsyncSocket::~AsyncSocket() {
 }
 
+int AsyncSocket::RecvFromBatch(ReceivedDatagram* datagrams, size_t count) {
+  size_t received = 0;
+  for (; received < count; ++received) {
+    ReceivedDatagram& datagram = datagrams[received];
+    int len = RecvFrom(datagram.data, datagram.capacity, &datagram.addr,
+                       &datagram.timestamp);
+    if (len < 0)
+      break;
+    datagram.length = static_cast<size_t>(len);
+    datagram.truncated = false;
+  }
+  return received > 0 ? static_cast<int>(received) : SOCKET_ERROR;
+}
+
+int AsyncSocket::SendToBatch(const OutgoingDatagram* datagrams,
+                             size_t count) {
+  size_t sent = 0;
+  for (; sent < count; ++sent) {
+    const OutgoingDatagram& datagram = datagrams[sent];
+    if (SendTo(datagram.data, datagram.length, datagram.addr) < 0)
+      break;
+  }
+  return sent > 0 ? static_cast<int>(sent) : SOCKET_ERROR;
+}
+
 AsyncSocketAdapter::AsyncSocketAdapter(AsyncSocket* socket) : socket_(nullptr) {
   Attach(socket);
 }
@@ -76,6 +101,16 @@ int AsyncSocketAdapter::RecvFrom(void* pv,
   return socket_->RecvFrom(pv, cb, paddr, timestamp);
 }
 
+int AsyncSocketAdapter::RecvFromBatch(ReceivedDatagram* datagrams,
+                                      size_t count) {
+  return socket_->RecvFromBatch(datagrams, count);
+}
+
+int AsyncSocketAdapter::SendToBatch(const OutgoingDatagram* datagrams,
+                                    size_t count) {
+  return socket_->SendToBatch(datagrams, count);
+}
+
 int AsyncSocketAdapter::Listen(int backlog) {
   return socket_->Listen(backlog);
 }
@@ -18,6 +18,26 @@ namespace rtc {
 
 // TODO: Remove Socket and rename AsyncSocket to Socket.
 
+// One datagram slot for AsyncSocket::RecvFromBatch. |data| and |capacity|
+// describe caller-owned storage; the remaining fields are filled in on return.
+struct ReceivedDatagram {
+  char* data = nullptr;
+  size_t capacity = 0;
+  size_t length = 0;
+  // True if the datagram did not fit in |capacity| bytes and was cut short.
+  bool truncated = false;
+  SocketAddress addr;
+  // Receive time in microseconds, or -1 if unknown.
+  int64_t timestamp = -1;
+};
+
+// One datagram for AsyncSocket::SendToBatch.
+struct OutgoingDatagram {
+  const char* data = nullptr;
+  size_t length = 0;
+  SocketAddress addr;
+};
+
 // Provides the ability to perform socket I/O asynchronously.
 class AsyncSocket : public Socket {
  public:
@@ -26,6 +46,18 @@ class AsyncSocket : public Socket {
 
   AsyncSocket* Accept(SocketAddress* paddr) override = 0;
 
+  // Receives up to |count| datagrams into |datagrams| using as few system
+  // calls as the implementation supports. Returns the number of datagrams
+  // received, or SOCKET_ERROR (with GetError() set) if none could be read.
+  // The default implementation calls RecvFrom() once per datagram.
+  virtual int RecvFromBatch(ReceivedDatagram* datagrams, size_t count);
+
+  // Sends |count| datagrams using as few system calls as the implementation
+  // supports. Returns the number of datagrams sent, which is always a prefix
+  // of |datagrams|, or SOCKET_ERROR (with GetError() set) if none were sent.
+  // The default implementation calls SendTo() once per datagram.
+  virtual int SendToBatch(const OutgoingDatagram* datagrams, size_t count);
+
   // SignalReadEvent and SignalWriteEvent use multi_threaded_local to allow
   // access concurrently from different thread.
   // For example SignalReadEvent::connect will be called in AsyncUDPSocket ctor
@@ -60,6 +92,8 @@ class AsyncSocketAdapter : public AsyncSocket, public sigslot::has_slots<> {
                size_t cb,
                SocketAddress* paddr,
                int64_t* timestamp) override;
+  int RecvFromBatch(ReceivedDatagram* datagrams, size_t count) override;
+  int SendToBatch(const OutgoingDatagram* datagrams, size_t count) override;
   int Listen(int backlog) override;
   AsyncSocket* Accept(SocketAddress* paddr) override;
   int Close() override;
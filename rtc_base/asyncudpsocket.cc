@@ -11,11 +11,16 @@
 #include "rtc_base/asyncudpsocket.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/thread.h"
 
 namespace rtc {
 
 static const int BUF_SIZE = 64 * 1024;
 
+enum { MSG_FLUSH_SEND_BATCH };
+
+const size_t AsyncUDPSocket::kDefaultBatchPacketSize;
+
 AsyncUDPSocket* AsyncUDPSocket::Create(
     AsyncSocket* socket,
     const SocketAddress& bind_address) {
@@ -47,9 +52,31 @@ AsyncUDPSocket::AsyncUDPSocket(AsyncSocket* socket)
 }
 
 AsyncUDPSocket::~AsyncUDPSocket() {
+  // Send what is queued, as Close() does.
+  FlushSendBatch();
+  if (deleted_while_reading_)
+    *deleted_while_reading_ = true;
   delete [] buf_;
 }
 
+void AsyncUDPSocket::SetReceiveBatchSize(size_t max_batch_size,
+                                         size_t max_packet_size) {
+  RTC_DCHECK_GT(max_batch_size, 0);
+  RTC_DCHECK_GT(max_packet_size, 0);
+  RTC_DCHECK(!deleted_while_reading_)
+      << "Can't resize the receive batch from SignalReadPacket.";
+  recv_batch_.clear();
+  recv_batch_buf_.reset();
+  if (max_batch_size <= 1)
+    return;
+  recv_batch_buf_.reset(new char[max_batch_size * max_packet_size]);
+  recv_batch_.resize(max_batch_size);
+  for (size_t i = 0; i < max_batch_size; ++i) {
+    recv_batch_[i].data = recv_batch_buf_.get() + i * max_packet_size;
+    recv_batch_[i].capacity = max_packet_size;
+  }
+}
+
 SocketAddress AsyncUDPSocket::GetLocalAddress() const {
   return socket_->GetLocalAddress();
 }
@@ -60,6 +87,8 @@ SocketAddress AsyncUDPSocket::GetRemoteAddress() const {
 
 int AsyncUDPSocket::Send(const void *pv, size_t cb,
                          const rtc::PacketOptions& options) {
+  // Keep packets in order with anything queued by SendTo().
+  FlushSendBatch();
   rtc::SentPacket sent_packet(options.packet_id, rtc::TimeMillis());
   int ret = socket_->Send(pv, cb);
   SignalSentPacket(this, sent_packet);
@@ -69,13 +98,70 @@ int AsyncUDPSocket::Send(const void *pv, size_t cb,
 int AsyncUDPSocket::SendTo(const void *pv, size_t cb,
                            const SocketAddress& addr,
                            const rtc::PacketOptions& options) {
+  if (send_batch_size_ > 1) {
+    if (num_queued_sends_ == 0) {
+      RTC_DCHECK(Thread::Current());
+      Thread::Current()->Post(RTC_FROM_HERE, this, MSG_FLUSH_SEND_BATCH);
+    }
+    Buffer& buffer = send_buffers_[num_queued_sends_];
+    buffer.SetData(static_cast<const uint8_t*>(pv), cb);
+    OutgoingDatagram& datagram = send_batch_[num_queued_sends_];
+    datagram.data = buffer.data<char>();
+    datagram.length = cb;
+    datagram.addr = addr;
+    send_packet_ids_[num_queued_sends_] = options.packet_id;
+    if (++num_queued_sends_ == send_batch_size_)
+      FlushSendBatch();
+    // Like an unbatched UDP send, a failure to flush is a silent drop.
+    return static_cast<int>(cb);
+  }
+
   rtc::SentPacket sent_packet(options.packet_id, rtc::TimeMillis());
   int ret = socket_->SendTo(pv, cb, addr);
   SignalSentPacket(this, sent_packet);
   return ret;
 }
 
+void AsyncUDPSocket::FlushSendBatch() {
+  if (num_queued_sends_ == 0)
+    return;
+
+  // Clear the queue before signaling, in case a handler sends again.
+  const size_t num_packets = num_queued_sends_;
+  num_queued_sends_ = 0;
+  int64_t send_time_ms = rtc::TimeMillis();
+  std::vector<int> sent_packet_ids;
+  sent_packet_ids.reserve(num_packets);
+  size_t next = 0;
+  while (next < num_packets) {
+    int ret = socket_->SendToBatch(&send_batch_[next], num_packets - next);
+    if (ret > 0) {
+      sent_packet_ids.insert(sent_packet_ids.end(),
+                             send_packet_ids_.begin() + next,
+                             send_packet_ids_.begin() + next + ret);
+      next += static_cast<size_t>(ret);
+      continue;
+    }
+    if (socket_->IsBlocking()) {
+      // The send buffer is full, so the rest would fail the same way.
+      LOG(LS_VERBOSE) << "Batched send dropped " << num_packets - next
+                      << " packets, error " << socket_->GetError();
+      break;
+    }
+    // Only the first datagram failed, e.g. because its destination is
+    // unreachable or it is too large. Skip it and send the rest.
+    LOG(LS_VERBOSE) << "Batched send dropped a packet to "
+                    << send_batch_[next].addr.ToSensitiveString()
+                    << ", error " << socket_->GetError();
+    ++next;
+  }
+  for (int packet_id : sent_packet_ids)
+    SignalSentPacket(this, SentPacket(packet_id, send_time_ms));
+}
+
 int AsyncUDPSocket::Close() {
+  FlushSendBatch();
+  closed_ = true;
   return socket_->Close();
 }
 
@@ -84,10 +170,24 @@ AsyncUDPSocket::State AsyncUDPSocket::GetState() const {
 }
 
 int AsyncUDPSocket::GetOption(Socket::Option opt, int* value) {
+  if (opt == Socket::OPT_SEND_BATCH_SIZE) {
+    *value = static_cast<int>(send_batch_size_);
+    return 0;
+  }
   return socket_->GetOption(opt, value);
 }
 
 int AsyncUDPSocket::SetOption(Socket::Option opt, int value) {
+  if (opt == Socket::OPT_SEND_BATCH_SIZE) {
+    if (value < 1)
+      return -1;
+    FlushSendBatch();
+    send_batch_size_ = static_cast<size_t>(value);
+    send_buffers_.resize(send_batch_size_);
+    send_batch_.resize(send_batch_size_);
+    send_packet_ids_.resize(send_batch_size_);
+    return 0;
+  }
   return socket_->SetOption(opt, value);
 }
 
@@ -102,10 +202,18 @@ void AsyncUDPSocket::SetError(int error) {
 void AsyncUDPSocket::OnReadEvent(AsyncSocket* socket) {
   RTC_DCHECK(socket_.get() == socket);
 
+  if (!recv_batch_.empty()) {
+    ReadBatch();
+    return;
+  }
+
   SocketAddress remote_addr;
   int64_t timestamp;
   int len = socket_->RecvFrom(buf_, size_, &remote_addr, &timestamp);
   if (len < 0) {
+    // With edge-triggered epoll the socket is read until it would block.
+    if (socket_->IsBlocking())
+      return;
     // An error here typically means we got an ICMP error in response to our
     // send datagram, indicating the remote address was unreachable.
     // When doing ICE, this kind of thing will often happen.
@@ -123,8 +231,53 @@ void AsyncUDPSocket::OnReadEvent(AsyncSocket* socket) {
       (timestamp > -1 ? PacketTime(timestamp, 0) : CreatePacketTime(0)));
 }
 
+void AsyncUDPSocket::ReadBatch() {
+  int count = socket_->RecvFromBatch(recv_batch_.data(), recv_batch_.size());
+  if (count < 0) {
+    if (socket_->IsBlocking())
+      return;
+    // See OnReadEvent; typically an ICMP error for an earlier send.
+    SocketAddress local_addr = socket_->GetLocalAddress();
+    LOG(LS_INFO) << "AsyncUDPSocket[" << local_addr.ToSensitiveString() << "] "
+                 << "batched receive failed with error "
+                 << socket_->GetError();
+    return;
+  }
+
+  // All datagrams of one batch share a single fallback receive time.
+  PacketTime fallback_time = CreatePacketTime(0);
+  bool deleted = false;
+  deleted_while_reading_ = &deleted;
+  for (int i = 0; i < count; ++i) {
+    const ReceivedDatagram& datagram = recv_batch_[i];
+    if (datagram.truncated) {
+      LOG(LS_WARNING) << "Dropping datagram from "
+                      << datagram.addr.ToSensitiveString()
+                      << " larger than the batch slot size of "
+                      << datagram.capacity << " bytes.";
+      continue;
+    }
+    SignalReadPacket(this, datagram.data, datagram.length, datagram.addr,
+                     (datagram.timestamp > -1
+                          ? PacketTime(datagram.timestamp, 0)
+                          : fallback_time));
+    // A handler may have deleted or closed the socket; the rest of the batch
+    // is then dropped, as the datagrams would have been after a single read.
+    if (deleted)
+      return;
+    if (closed_)
+      break;
+  }
+  deleted_while_reading_ = nullptr;
+}
+
 void AsyncUDPSocket::OnWriteEvent(AsyncSocket* socket) {
   SignalReadyToSend(this);
 }
 
+void AsyncUDPSocket::OnMessage(Message* msg) {
+  RTC_DCHECK_EQ(MSG_FLUSH_SEND_BATCH, msg->message_id);
+  FlushSendBatch();
+}
+
 }  // namespace rtc
@@ -12,15 +12,26 @@
 #define RTC_BASE_ASYNCUDPSOCKET_H_
 
 #include <memory>
+#include <vector>
 
 #include "rtc_base/asyncpacketsocket.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/messagehandler.h"
 #include "rtc_base/socketfactory.h"
 
 namespace rtc {
 
 // Provides the ability to receive packets asynchronously.  Sends are not
 // buffered since it is acceptable to drop packets under high load.
-class AsyncUDPSocket : public AsyncPacketSocket {
+//
+// Setting Socket::OPT_SEND_BATCH_SIZE to N > 1 enables send batching: SendTo()
+// copies packets into a queue that is flushed with AsyncSocket::SendToBatch()
+// once it holds N packets, or from a message posted to the current thread
+// when the first packet is queued. All packets the pacer hands over before
+// the network thread gets to that message therefore leave in one batch.
+// A packet that fails to send is skipped without affecting the rest of the
+// batch, and only packets that were sent are signaled through SignalSentPacket.
+class AsyncUDPSocket : public AsyncPacketSocket, public MessageHandler {
  public:
   // Binds |socket| and creates AsyncUDPSocket for it. Takes ownership
   // of |socket|. Returns null if bind() fails (|socket| is destroyed
@@ -34,6 +45,18 @@ class AsyncUDPSocket : public AsyncPacketSocket {
   explicit AsyncUDPSocket(AsyncSocket* socket);
   ~AsyncUDPSocket() override;
 
+  // Enables batched receive: every read event drains up to |max_batch_size|
+  // datagrams with a single AsyncSocket::RecvFromBatch() call into a reused
+  // buffer ring, and signals them back to back through SignalReadPacket.
+  // Datagrams larger than |max_packet_size| bytes are dropped. Passing a
+  // |max_batch_size| of 1 restores the default one-recv-per-event behavior.
+  // A SignalReadPacket handler may close the socket, which drops the rest of
+  // the batch, but must not call this.
+  void SetReceiveBatchSize(size_t max_batch_size,
+                           size_t max_packet_size = kDefaultBatchPacketSize);
+
+  static const size_t kDefaultBatchPacketSize = 2048;
+
   SocketAddress GetLocalAddress() const override;
   SocketAddress GetRemoteAddress() const override;
   int Send(const void* pv,
@@ -51,15 +74,38 @@ class AsyncUDPSocket : public AsyncPacketSocket {
   int GetError() const override;
   void SetError(int error) override;
 
+  // MessageHandler:
+  void OnMessage(Message* msg) override;
+
  private:
   // Called when the underlying socket is ready to be read from.
   void OnReadEvent(AsyncSocket* socket);
+  // Called from OnReadEvent when batched receive is enabled.
+  void ReadBatch();
   // Called when the underlying socket is ready to send.
   void OnWriteEvent(AsyncSocket* socket);
+  // Sends all queued packets when send batching is enabled.
+  void FlushSendBatch();
 
   std::unique_ptr<AsyncSocket> socket_;
   char* buf_;
   size_t size_;
+  // Buffer ring backing |recv_batch_| when batched receive is enabled.
+  std::unique_ptr<char[]> recv_batch_buf_;
+  std::vector<ReceivedDatagram> recv_batch_;
+  // Points to a flag on the stack of ReadBatch() while it signals packets, so
+  // that it can tell whether a handler deleted the socket.
+  bool* deleted_while_reading_ = nullptr;
+  // Set by Close(). The underlying socket can't be asked, since an unconnected
+  // UDP socket reports CS_CLOSED while bound.
+  bool closed_ = false;
+  // Send batching state. |send_buffers_| are reused across flushes so that
+  // steady state queuing does not allocate.
+  size_t send_batch_size_ = 1;
+  size_t num_queued_sends_ = 0;
+  std::vector<Buffer> send_buffers_;
+  std::vector<OutgoingDatagram> send_batch_;
+  std::vector<int> send_packet_ids_;
 };
 
 }  // namespace rtc
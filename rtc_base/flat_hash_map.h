@@ -0,0 +1,189 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_FLAT_HASH_MAP_H_
+#define RTC_BASE_FLAT_HASH_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+
+namespace rtc {
+
+// An open addressing hash map for integer keys, such as SSRCs, that is looked
+// up far more often than it is modified. Entries live in a single array and
+// collisions are resolved by linear probing, so a lookup usually touches one
+// cache line. The table is kept at most half full and erasing shifts later
+// entries back instead of leaving tombstones, so lookups of missing keys stay
+// short as well.
+//
+// Pointers returned by Find and Insert are invalidated by any later Insert or
+// Erase. Not thread safe.
+template <typename Key, typename Value>
+class FlatHashMap {
+  static_assert(std::is_integral<Key>::value, "Key must be an integer type");
+
+ public:
+  FlatHashMap() = default;
+  FlatHashMap(const FlatHashMap&) = default;
+  FlatHashMap(FlatHashMap&&) = default;
+  FlatHashMap& operator=(const FlatHashMap&) = default;
+  FlatHashMap& operator=(FlatHashMap&&) = default;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  void clear() {
+    slots_.clear();
+    shift_ = 64;
+    size_ = 0;
+  }
+
+  // Returns the value stored for |key|, or null if there is none.
+  Value* Find(Key key) {
+    if (slots_.empty())
+      return nullptr;
+    for (size_t i = Home(key);; i = Next(i)) {
+      Slot& slot = slots_[i];
+      if (!slot.used)
+        return nullptr;
+      if (slot.key == key)
+        return &slot.value;
+    }
+  }
+  const Value* Find(Key key) const {
+    return const_cast<FlatHashMap*>(this)->Find(key);
+  }
+
+  // Inserts |value| for |key| unless the key is already present. Returns the
+  // stored value and whether it was inserted, like std::map::emplace.
+  std::pair<Value*, bool> Insert(Key key, Value value) {
+    if (Value* existing = Find(key))
+      return std::make_pair(existing, false);
+    if (2 * (size_ + 1) > slots_.size())
+      Rehash(slots_.empty() ? kMinCapacity : 2 * slots_.size());
+    size_t i = Home(key);
+    while (slots_[i].used)
+      i = Next(i);
+    slots_[i].key = key;
+    slots_[i].used = true;
+    slots_[i].value = std::move(value);
+    ++size_;
+    return std::make_pair(&slots_[i].value, true);
+  }
+
+  // Returns the value for |key|, inserting a default constructed one if
+  // needed.
+  Value& operator[](Key key) { return *Insert(key, Value()).first; }
+
+  // Removes |key|. Returns false if it was not present.
+  bool Erase(Key key) {
+    if (slots_.empty())
+      return false;
+    size_t hole = Home(key);
+    while (slots_[hole].key != key || !slots_[hole].used) {
+      if (!slots_[hole].used)
+        return false;
+      hole = Next(hole);
+    }
+    // Move later entries of the probe sequence into the hole, unless that
+    // would place them before their home slot.
+    for (size_t i = Next(hole); slots_[i].used; i = Next(i)) {
+      const size_t home = Home(slots_[i].key);
+      const bool stays = hole < i ? (hole < home && home <= i)
+                                  : (hole < home || home <= i);
+      if (!stays) {
+        slots_[hole].key = slots_[i].key;
+        slots_[hole].value = std::move(slots_[i].value);
+        hole = i;
+      }
+    }
+    slots_[hole].used = false;
+    slots_[hole].value = Value();
+    --size_;
+    return true;
+  }
+
+  // Removes all entries for which |predicate(key, value)| returns true and
+  // returns how many were removed.
+  template <typename Predicate>
+  size_t EraseIf(Predicate predicate) {
+    std::vector<Key> keys;
+    for (const Slot& slot : slots_) {
+      if (slot.used && predicate(slot.key, slot.value))
+        keys.push_back(slot.key);
+    }
+    for (Key key : keys)
+      Erase(key);
+    return keys.size();
+  }
+
+  // Calls |function(key, value)| for every entry, in no particular order.
+  template <typename Function>
+  void ForEach(Function function) const {
+    for (const Slot& slot : slots_) {
+      if (slot.used)
+        function(slot.key, slot.value);
+    }
+  }
+
+ private:
+  static constexpr size_t kMinCapacity = 16;
+
+  struct Slot {
+    Key key = 0;
+    bool used = false;
+    Value value = Value();
+  };
+
+  // Fibonacci hashing: multiplying by 2^64 / phi spreads consecutive and
+  // otherwise structured keys over the whole table.
+  size_t Home(Key key) const {
+    return static_cast<size_t>(
+        (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> shift_);
+  }
+  size_t Next(size_t i) const { return (i + 1) & (slots_.size() - 1); }
+
+  void Rehash(size_t capacity) {
+    RTC_DCHECK_EQ(capacity & (capacity - 1), 0);
+    std::vector<Slot> old_slots(capacity);
+    old_slots.swap(slots_);
+    shift_ = 64;
+    for (size_t bits = capacity; bits > 1; bits >>= 1)
+      --shift_;
+    for (Slot& slot : old_slots) {
+      if (!slot.used)
+        continue;
+      size_t i = Home(slot.key);
+      while (slots_[i].used)
+        i = Next(i);
+      slots_[i].key = slot.key;
+      slots_[i].used = true;
+      slots_[i].value = std::move(slot.value);
+    }
+  }
+
+  std::vector<Slot> slots_;
+  // 64 - log2(capacity), so that Home() keeps the top bits of the product.
+  int shift_ = 64;
+  size_t size_ = 0;
+};
+
+template <typename Key, typename Value>
+constexpr size_t FlatHashMap<Key, Value>::kMinCapacity;
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_FLAT_HASH_MAP_H_
@@ -0,0 +1,124 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/flat_hash_map.h"
+
+#include <map>
+#include <memory>
+
+#include "rtc_base/gunit.h"
+#include "rtc_base/random.h"
+
+namespace rtc {
+
+TEST(FlatHashMapTest, InsertFindErase) {
+  FlatHashMap<uint32_t, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(nullptr, map.Find(1));
+  EXPECT_FALSE(map.Erase(1));
+
+  EXPECT_TRUE(map.Insert(1, 10).second);
+  EXPECT_TRUE(map.Insert(2, 20).second);
+  std::pair<int*, bool> result = map.Insert(1, 11);
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(10, *result.first);
+  EXPECT_EQ(2u, map.size());
+
+  ASSERT_NE(nullptr, map.Find(2));
+  EXPECT_EQ(20, *map.Find(2));
+  EXPECT_TRUE(map.Erase(2));
+  EXPECT_FALSE(map.Erase(2));
+  EXPECT_EQ(nullptr, map.Find(2));
+  EXPECT_EQ(1u, map.size());
+}
+
+TEST(FlatHashMapTest, SubscriptInsertsDefault) {
+  FlatHashMap<uint32_t, int> map;
+  EXPECT_EQ(0, map[7]);
+  map[7] = 3;
+  ++map[7];
+  EXPECT_EQ(4, *map.Find(7));
+  EXPECT_EQ(1u, map.size());
+}
+
+TEST(FlatHashMapTest, ZeroAndExtremeKeys) {
+  FlatHashMap<uint32_t, int> map;
+  map[0] = 1;
+  map[0xFFFFFFFF] = 2;
+  EXPECT_EQ(1, *map.Find(0));
+  EXPECT_EQ(2, *map.Find(0xFFFFFFFF));
+  EXPECT_TRUE(map.Erase(0));
+  EXPECT_EQ(nullptr, map.Find(0));
+  EXPECT_EQ(2, *map.Find(0xFFFFFFFF));
+}
+
+TEST(FlatHashMapTest, EraseIf) {
+  FlatHashMap<uint32_t, int> map;
+  for (uint32_t i = 0; i < 100; ++i)
+    map[i] = i;
+  EXPECT_EQ(50u, map.EraseIf([](uint32_t key, int) { return key % 2; }));
+  EXPECT_EQ(50u, map.size());
+  int sum = 0;
+  map.ForEach([&sum](uint32_t key, int value) {
+    EXPECT_EQ(0u, key % 2);
+    sum += value;
+  });
+  EXPECT_EQ(2450, sum);
+}
+
+TEST(FlatHashMapTest, ReleasesValues) {
+  std::shared_ptr<int> value(new int(1));
+  {
+    FlatHashMap<uint32_t, std::shared_ptr<int>> map;
+    map.Insert(1, value);
+    map.Insert(2, value);
+    EXPECT_EQ(3, value.use_count());
+    map.Erase(1);
+    EXPECT_EQ(2, value.use_count());
+  }
+  EXPECT_EQ(1, value.use_count());
+}
+
+TEST(FlatHashMapTest, MatchesStdMap) {
+  webrtc::Random random(12345);
+  FlatHashMap<uint32_t, uint32_t> map;
+  std::map<uint32_t, uint32_t> reference;
+  for (int i = 0; i < 100000; ++i) {
+    // A small key range makes collisions and erasures of present keys common.
+    uint32_t key = random.Rand(1000) * 0x10000;
+    switch (random.Rand(2)) {
+      case 0:
+        EXPECT_EQ(reference.emplace(key, i).second,
+                  map.Insert(key, i).second);
+        break;
+      case 1:
+        EXPECT_EQ(reference.erase(key) == 1, map.Erase(key));
+        break;
+      case 2: {
+        auto it = reference.find(key);
+        const uint32_t* value = map.Find(key);
+        if (it == reference.end()) {
+          EXPECT_EQ(nullptr, value);
+        } else {
+          ASSERT_NE(nullptr, value);
+          EXPECT_EQ(it->second, *value);
+        }
+        break;
+      }
+    }
+    ASSERT_EQ(reference.size(), map.size());
+  }
+  for (const auto& entry : reference) {
+    ASSERT_NE(nullptr, map.Find(entry.first));
+    EXPECT_EQ(entry.second, *map.Find(entry.first));
+  }
+}
+
+}  // namespace rtc
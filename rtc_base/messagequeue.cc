@@ -175,7 +175,7 @@ void MessageQueueManager::ProcessAllMessageQueuesInternal() {
 // MessageQueue
 MessageQueue::MessageQueue(SocketServer* ss, bool init_queue)
     : fPeekKeep_(false),
-      dmsgq_next_num_(0),
+      dmsgq_(TimeMillis()),
       fInitialized_(false),
       fDestroyed_(false),
       stop_(0),
@@ -298,13 +298,12 @@ bool MessageQueue::Get(Message *pmsg, int cmsWait, bool process_io) {
         // triggered and calculate the next trigger time.
         if (first_pass) {
           first_pass = false;
-          while (!dmsgq_.empty()) {
-            if (msCurrent < dmsgq_.top().msTrigger_) {
-              cmsDelayNext = TimeDiff(dmsgq_.top().msTrigger_, msCurrent);
-              break;
-            }
-            msgq_.push_back(dmsgq_.top().msg_);
-            dmsgq_.pop();
+          dmsgq_ready_.clear();
+          dmsgq_.Advance(msCurrent, &dmsgq_ready_);
+          msgq_.insert(msgq_.end(), dmsgq_ready_.begin(), dmsgq_ready_.end());
+          int64_t msNextTrigger;
+          if (dmsgq_.NextDeadline(&msNextTrigger)) {
+            cmsDelayNext = TimeDiff(msNextTrigger, msCurrent);
           }
         }
         // Pull a message off the message queue, if available.
@@ -435,7 +434,7 @@ void MessageQueue::DoDelayPost(const Location& posted_from,
   }
 
   // Keep thread safe
-  // Add to the priority queue. Gets sorted soonest first.
+  // Add to the timer wheel, keyed on the trigger time.
   // Signal for the multiplexer to return.
 
   {
@@ -445,13 +444,13 @@ void MessageQueue::DoDelayPost(const Location& posted_from,
     msg.phandler = phandler;
     msg.message_id = id;
     msg.pdata = pdata;
-    DelayedMessage dmsg(cmsDelay, tstamp, dmsgq_next_num_, msg);
-    dmsgq_.push(dmsg);
-    // If this message queue processes 1 message every millisecond for 50 days,
-    // we will wrap this number.  Even then, only messages with identical times
-    // will be misordered, and then only briefly.  This is probably ok.
-    ++dmsgq_next_num_;
-    RTC_DCHECK_NE(0, dmsgq_next_num_);
+    // The wheel places messages relative to the time it was last advanced to,
+    // so it must not be ahead of the clock (e.g. after installing a fake
+    // clock).
+    int64_t msCurrent = TimeMillis();
+    if (msCurrent < dmsgq_.current_time_ms())
+      dmsgq_.RewindTo(msCurrent);
+    dmsgq_.Insert(tstamp, msg);
   }
   WakeUpSocketServer();
 }
@@ -462,8 +461,9 @@ int MessageQueue::GetDelay() {
   if (!msgq_.empty())
     return 0;
 
-  if (!dmsgq_.empty()) {
-    int delay = TimeUntil(dmsgq_.top().msTrigger_);
+  int64_t msNextTrigger;
+  if (dmsgq_.NextDeadline(&msNextTrigger)) {
+    int delay = static_cast<int>(TimeUntil(msNextTrigger));
     if (delay < 0)
       delay = 0;
     return delay;
@@ -503,23 +503,18 @@ void MessageQueue::Clear(MessageHandler* phandler,
     }
   }
 
-  // Remove from priority queue. Not directly iterable, so use this approach
+  // Remove from the timer wheel
 
-  PriorityQueue::container_type::iterator new_end = dmsgq_.container().begin();
-  for (PriorityQueue::container_type::iterator it = new_end;
-       it != dmsgq_.container().end(); ++it) {
-    if (it->msg_.Match(phandler, id)) {
-      if (removed) {
-        removed->push_back(it->msg_);
-      } else {
-        delete it->msg_.pdata;
-      }
+  dmsgq_.RemoveIf([phandler, id, removed](Message* msg) {
+    if (!msg->Match(phandler, id))
+      return false;
+    if (removed) {
+      removed->push_back(*msg);
     } else {
-      *new_end++ = *it;
+      delete msg->pdata;
     }
-  }
-  dmsgq_.container().erase(new_end, dmsgq_.container().end());
-  dmsgq_.reheap();
+    return true;
+  });
 }
 
 void MessageQueue::Dispatch(Message *pmsg) {
@@ -16,7 +16,6 @@
 #include <algorithm>
 #include <list>
 #include <memory>
-#include <queue>
 #include <utility>
 #include <vector>
 
@@ -29,6 +28,7 @@
 #include "rtc_base/sigslot.h"
 #include "rtc_base/socketserver.h"
 #include "rtc_base/thread_annotations.h"
+#include "rtc_base/timer_wheel.h"
 #include "rtc_base/timeutils.h"
 
 namespace rtc {
@@ -170,28 +170,6 @@ struct Message {
 
 typedef std::list<Message> MessageList;
 
-// DelayedMessage goes into a priority queue, sorted by trigger time.  Messages
-// with the same trigger time are processed in num_ (FIFO) order.
-
-class DelayedMessage {
- public:
-  DelayedMessage(int64_t delay,
-                 int64_t trigger,
-                 uint32_t num,
-                 const Message& msg)
-      : cmsDelay_(delay), msTrigger_(trigger), num_(num), msg_(msg) {}
-
-  bool operator< (const DelayedMessage& dmsg) const {
-    return (dmsg.msTrigger_ < msTrigger_)
-           || ((dmsg.msTrigger_ == msTrigger_) && (dmsg.num_ < num_));
-  }
-
-  int64_t cmsDelay_;  // for debugging
-  int64_t msTrigger_;
-  uint32_t num_;
-  Message msg_;
-};
-
 class MessageQueue {
  public:
   static const int kForever = -1;
@@ -281,12 +259,6 @@ class MessageQueue {
   sigslot::signal0<> SignalQueueDestroyed;
 
  protected:
-  class PriorityQueue : public std::priority_queue<DelayedMessage> {
-   public:
-    container_type& container() { return c; }
-    void reheap() { make_heap(c.begin(), c.end(), comp); }
-  };
-
   void DoDelayPost(const Location& posted_from,
                    int64_t cmsDelay,
                    int64_t tstamp,
@@ -307,8 +279,11 @@ class MessageQueue {
   bool fPeekKeep_;
   Message msgPeek_;
   MessageList msgq_ RTC_GUARDED_BY(crit_);
-  PriorityQueue dmsgq_ RTC_GUARDED_BY(crit_);
-  uint32_t dmsgq_next_num_ RTC_GUARDED_BY(crit_);
+  // Delayed messages, keyed on trigger time. Messages with the same trigger
+  // time are processed in the order they were posted.
+  TimerWheel<Message> dmsgq_ RTC_GUARDED_BY(crit_);
+  // Scratch space for moving triggered messages out of |dmsgq_|.
+  std::vector<Message> dmsgq_ready_ RTC_GUARDED_BY(crit_);
   CriticalSection crit_;
   bool fInitialized_;
   bool fDestroyed_;
@@ -0,0 +1,70 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/networkthreadpool.h"
+
+#include <string>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/stringencode.h"
+
+namespace rtc {
+
+NetworkThreadPool::NetworkThreadPool(size_t num_shards) : next_shard_(0) {
+  RTC_DCHECK_GT(num_shards, 0);
+  for (size_t i = 0; i < num_shards; ++i) {
+    std::unique_ptr<Thread> shard = Thread::CreateWithSocketServer();
+    shard->SetName("NetworkShard" + ToString(i), nullptr);
+    shards_.push_back(std::move(shard));
+  }
+}
+
+NetworkThreadPool::~NetworkThreadPool() {
+  Stop();
+}
+
+void NetworkThreadPool::Start() {
+  for (const auto& shard : shards_)
+    RTC_CHECK(shard->Start());
+}
+
+void NetworkThreadPool::Stop() {
+  for (const auto& shard : shards_)
+    shard->Stop();
+}
+
+Thread* NetworkThreadPool::GetShardForAddress(
+    const SocketAddress& remote_address) const {
+  return shards_[remote_address.Hash() % shards_.size()].get();
+}
+
+Thread* NetworkThreadPool::GetNextShard() {
+  return shards_[next_shard_++ % shards_.size()].get();
+}
+
+// static
+AsyncUDPSocket* NetworkThreadPool::CreateReusePortUdpSocket(
+    SocketFactory* factory,
+    const SocketAddress& bind_address) {
+  AsyncSocket* socket =
+      factory->CreateAsyncSocket(bind_address.family(), SOCK_DGRAM);
+  if (!socket)
+    return nullptr;
+  if (socket->SetOption(Socket::OPT_REUSEPORT, 1) < 0) {
+    LOG(LS_ERROR) << "Failed to set SO_REUSEPORT, error "
+                  << socket->GetError();
+    delete socket;
+    return nullptr;
+  }
+  return AsyncUDPSocket::Create(socket, bind_address);
+}
+
+}  // namespace rtc
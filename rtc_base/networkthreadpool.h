@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_NETWORKTHREADPOOL_H_
+#define RTC_BASE_NETWORKTHREADPOOL_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "rtc_base/asyncudpsocket.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/thread.h"
+
+namespace rtc {
+
+// Spreads network I/O over several threads ("shards"), each running its own
+// PhysicalSocketServer. A socket belongs to the shard that created it and is
+// only ever serviced by that shard's thread, so no locking is added to the
+// packet path; throughput scales with the number of shards instead of being
+// capped by a single network thread.
+//
+// Affinity: GetShardForAddress() maps a remote address to the same shard for
+// the lifetime of the pool, so all sockets and state for one peer can be kept
+// together. For servers, CreateReusePortUdpSocket() lets every shard bind the
+// same listening address; the kernel then hashes each UDP flow to one of the
+// sockets, which keeps a given client on one shard.
+class NetworkThreadPool {
+ public:
+  explicit NetworkThreadPool(size_t num_shards);
+  ~NetworkThreadPool();
+
+  void Start();
+  void Stop();
+
+  size_t num_shards() const { return shards_.size(); }
+  Thread* shard(size_t index) const { return shards_[index].get(); }
+
+  // Returns the shard that owns traffic from |remote_address|.
+  Thread* GetShardForAddress(const SocketAddress& remote_address) const;
+
+  // Returns shards in round-robin order, for work without an affinity key.
+  // Thread safe.
+  Thread* GetNextShard();
+
+  // Synchronously runs |functor| on every shard thread, one after the other.
+  template <class FunctorT>
+  void InvokeOnAllShards(const Location& posted_from,
+                         const FunctorT& functor) {
+    for (const auto& shard : shards_)
+      shard->Invoke<void>(posted_from, functor);
+  }
+
+  // Creates a UDP socket bound to |bind_address| with SO_REUSEPORT set, so
+  // that each shard can bind the same address. Must be called on the thread
+  // that owns |factory|. Returns null on failure.
+  static AsyncUDPSocket* CreateReusePortUdpSocket(
+      SocketFactory* factory,
+      const SocketAddress& bind_address);
+
+ private:
+  std::vector<std::unique_ptr<Thread>> shards_;
+  std::atomic<size_t> next_shard_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(NetworkThreadPool);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_NETWORKTHREADPOOL_H_
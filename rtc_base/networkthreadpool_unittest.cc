@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/networkthreadpool.h"
+#include "rtc_base/physicalsocketserver.h"
+
+namespace rtc {
+namespace {
+
+const int kTimeoutMs = 5000;
+
+// Counts packets received by one shard's socket.
+class ShardReceiver : public sigslot::has_slots<> {
+ public:
+  ShardReceiver(AsyncUDPSocket* socket, Event* packet_event)
+      : socket_(socket), packet_event_(packet_event) {
+    socket_->SignalReadPacket.connect(this, &ShardReceiver::OnReadPacket);
+  }
+
+  SocketAddress local_address() const { return socket_->GetLocalAddress(); }
+
+  std::set<SocketAddress> remote_addresses() const {
+    CritScope cs(&crit_);
+    return remote_addresses_;
+  }
+
+ private:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const PacketTime& packet_time) {
+    {
+      CritScope cs(&crit_);
+      remote_addresses_.insert(remote_addr);
+    }
+    packet_event_->Set();
+  }
+
+  std::unique_ptr<AsyncUDPSocket> socket_;
+  Event* const packet_event_;
+  CriticalSection crit_;
+  std::set<SocketAddress> remote_addresses_;
+};
+
+}  // namespace
+
+TEST(NetworkThreadPoolTest, AddressAffinityIsStable) {
+  NetworkThreadPool pool(4);
+  SocketAddress remote("192.168.1.2", 5000);
+  Thread* shard = pool.GetShardForAddress(remote);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(shard, pool.GetShardForAddress(remote));
+}
+
+TEST(NetworkThreadPoolTest, GetNextShardVisitsAllShards) {
+  NetworkThreadPool pool(3);
+  std::set<Thread*> shards;
+  for (size_t i = 0; i < pool.num_shards(); ++i)
+    shards.insert(pool.GetNextShard());
+  EXPECT_EQ(pool.num_shards(), shards.size());
+}
+
+#if defined(WEBRTC_LINUX)
+// Every shard binds the same address; each sender must consistently reach
+// exactly one shard.
+TEST(NetworkThreadPoolTest, ReusePortSocketsShareAddressAndKeepAffinity) {
+  const size_t kNumShards = 2;
+  NetworkThreadPool pool(kNumShards);
+  pool.Start();
+
+  Event packet_event(false, false);
+  std::vector<std::unique_ptr<ShardReceiver>> receivers(kNumShards);
+  SocketAddress bind_address("127.0.0.1", 0);
+  for (size_t i = 0; i < kNumShards; ++i) {
+    Thread* shard = pool.shard(i);
+    shard->Invoke<void>(RTC_FROM_HERE, [&] {
+      AsyncUDPSocket* socket = NetworkThreadPool::CreateReusePortUdpSocket(
+          shard->socketserver(), bind_address);
+      ASSERT_TRUE(socket);
+      receivers[i].reset(new ShardReceiver(socket, &packet_event));
+      // The remaining shards bind the port picked for the first one.
+      bind_address = receivers[i]->local_address();
+    });
+  }
+  ASSERT_EQ(receivers[0]->local_address(), receivers[1]->local_address());
+
+  const int kNumSenders = 8;
+  const int kPacketsPerSender = 3;
+  PhysicalSocketServer sender_ss;
+  std::vector<std::unique_ptr<AsyncUDPSocket>> senders;
+  for (int i = 0; i < kNumSenders; ++i) {
+    senders.emplace_back(
+        AsyncUDPSocket::Create(&sender_ss, SocketAddress("127.0.0.1", 0)));
+  }
+  for (int round = 0; round < kPacketsPerSender; ++round) {
+    for (const auto& sender : senders) {
+      sender->SendTo("x", 1, bind_address, PacketOptions());
+      EXPECT_TRUE(packet_event.Wait(kTimeoutMs));
+    }
+  }
+
+  std::set<SocketAddress> seen;
+  for (const auto& receiver : receivers) {
+    for (const SocketAddress& remote : receiver->remote_addresses())
+      EXPECT_TRUE(seen.insert(remote).second) << "Flow split across shards";
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumSenders), seen.size());
+
+  for (size_t i = 0; i < kNumShards; ++i) {
+    pool.shard(i)->Invoke<void>(RTC_FROM_HERE,
+                                [&] { receivers[i].reset(); });
+  }
+}
+#endif
+
+}  // namespace rtc
@@ -287,6 +287,9 @@ int PhysicalSocket::DoConnect(const SocketAddress& connect_addr) {
   } else if (IsBlockingError(GetError())) {
     state_ = CS_CONNECTING;
     events |= DE_CONNECT;
+    // An unconnected TCP socket polls as writable and hung up; only the edge
+    // reported once the connection is established counts.
+    ClearEdgeReadyEvents(DE_WRITE | DE_CLOSE);
   } else {
     return SOCKET_ERROR;
   }
@@ -355,10 +358,13 @@ int PhysicalSocket::Send(const void* pv, size_t cb) {
   MaybeRemapSendError();
   // We have seen minidumps where this may be false.
   RTC_DCHECK(sent <= static_cast<int>(cb));
-  if ((sent > 0 && sent < static_cast<int>(cb)) ||
-      (sent < 0 && IsBlockingError(GetError()))) {
+  const bool blocked = sent < 0 && IsBlockingError(GetError());
+  if ((sent > 0 && sent < static_cast<int>(cb)) || blocked) {
     EnableEvents(DE_WRITE);
   }
+  if (blocked) {
+    ClearEdgeReadyEvents(DE_WRITE);
+  }
   return sent;
 }
 
@@ -380,10 +386,13 @@ int PhysicalSocket::SendTo(const void* buffer,
   MaybeRemapSendError();
   // We have seen minidumps where this may be false.
   RTC_DCHECK(sent <= static_cast<int>(length));
-  if ((sent > 0 && sent < static_cast<int>(length)) ||
-      (sent < 0 && IsBlockingError(GetError()))) {
+  const bool blocked = sent < 0 && IsBlockingError(GetError());
+  if ((sent > 0 && sent < static_cast<int>(length)) || blocked) {
     EnableEvents(DE_WRITE);
   }
+  if (blocked) {
+    ClearEdgeReadyEvents(DE_WRITE);
+  }
   return sent;
 }
 
@@ -410,6 +419,9 @@ int PhysicalSocket::Recv(void* buffer, size_t length, int64_t* timestamp) {
   if (udp_ || success) {
     EnableEvents(DE_READ);
   }
+  if (received < 0 && IsBlockingError(error)) {
+    ClearEdgeReadyEvents(DE_READ);
+  }
   if (!success) {
     LOG_F(LS_VERBOSE) << "Error = " << error;
   }
@@ -436,12 +448,91 @@ int PhysicalSocket::RecvFrom(void* buffer,
   if (udp_ || success) {
     EnableEvents(DE_READ);
   }
+  if (received < 0 && IsBlockingError(error)) {
+    ClearEdgeReadyEvents(DE_READ);
+  }
+  if (!success) {
+    LOG_F(LS_VERBOSE) << "Error = " << error;
+  }
+  return received;
+}
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+const size_t PhysicalSocket::kMaxRecvBatchSize;
+const size_t PhysicalSocket::kMaxSendBatchSize;
+
+int PhysicalSocket::RecvFromBatch(ReceivedDatagram* datagrams, size_t count) {
+  count = std::min(count, kMaxRecvBatchSize);
+  struct mmsghdr msgs[kMaxRecvBatchSize];
+  struct iovec iovs[kMaxRecvBatchSize];
+  sockaddr_storage addrs[kMaxRecvBatchSize];
+  memset(msgs, 0, sizeof(msgs[0]) * count);
+  for (size_t i = 0; i < count; ++i) {
+    iovs[i].iov_base = datagrams[i].data;
+    iovs[i].iov_len = datagrams[i].capacity;
+    msgs[i].msg_hdr.msg_name = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  int received =
+      ::recvmmsg(s_, msgs, static_cast<unsigned int>(count), 0, nullptr);
+  UpdateLastError();
+  for (int i = 0; i < received; ++i) {
+    ReceivedDatagram& datagram = datagrams[i];
+    datagram.length = msgs[i].msg_len;
+    datagram.truncated = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    datagram.timestamp = -1;
+    SocketAddressFromSockAddrStorage(addrs[i], &datagram.addr);
+  }
+  int error = GetError();
+  bool success = (received >= 0) || IsBlockingError(error);
+  if (udp_ || success) {
+    EnableEvents(DE_READ);
+  }
+  // recvmmsg() on a non-blocking socket stops early only once the queue is
+  // empty, so a short batch means the next read would block.
+  if ((received >= 0 && received < static_cast<int>(count)) ||
+      (received < 0 && IsBlockingError(error))) {
+    ClearEdgeReadyEvents(DE_READ);
+  }
   if (!success) {
     LOG_F(LS_VERBOSE) << "Error = " << error;
   }
   return received;
 }
 
+int PhysicalSocket::SendToBatch(const OutgoingDatagram* datagrams,
+                                size_t count) {
+  count = std::min(count, kMaxSendBatchSize);
+  struct mmsghdr msgs[kMaxSendBatchSize];
+  struct iovec iovs[kMaxSendBatchSize];
+  sockaddr_storage addrs[kMaxSendBatchSize];
+  memset(msgs, 0, sizeof(msgs[0]) * count);
+  for (size_t i = 0; i < count; ++i) {
+    iovs[i].iov_base = const_cast<char*>(datagrams[i].data);
+    iovs[i].iov_len = datagrams[i].length;
+    msgs[i].msg_hdr.msg_name = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen =
+        static_cast<socklen_t>(datagrams[i].addr.ToSockAddrStorage(&addrs[i]));
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  // Suppress SIGPIPE. See Send() for explanation.
+  int sent = ::sendmmsg(s_, msgs, static_cast<unsigned int>(count),
+                        MSG_NOSIGNAL);
+  UpdateLastError();
+  const bool blocked = sent < 0 && IsBlockingError(GetError());
+  if ((sent >= 0 && sent < static_cast<int>(count)) || blocked) {
+    EnableEvents(DE_WRITE);
+  }
+  if (blocked) {
+    ClearEdgeReadyEvents(DE_WRITE);
+  }
+  return sent;
+}
+#endif
+
 int PhysicalSocket::Listen(int backlog) {
   int err = ::listen(s_, backlog);
   UpdateLastError();
@@ -465,8 +556,11 @@ AsyncSocket* PhysicalSocket::Accept(SocketAddress* out_addr) {
   sockaddr* addr = reinterpret_cast<sockaddr*>(&addr_storage);
   SOCKET s = DoAccept(s_, addr, &addr_len);
   UpdateLastError();
-  if (s == INVALID_SOCKET)
+  if (s == INVALID_SOCKET) {
+    if (IsBlockingError(GetError()))
+      ClearEdgeReadyEvents(DE_READ);
     return nullptr;
+  }
   if (out_addr != nullptr)
     SocketAddressFromSockAddrStorage(addr_storage, out_addr);
   return ss_->WrapSocket(s);
@@ -541,6 +635,12 @@ void PhysicalSocket::MaybeRemapSendError() {
 #endif
 }
 
+void PhysicalSocket::ClearEdgeReadyEvents(uint8_t events) {
+#if defined(WEBRTC_USE_EPOLL)
+  edge_ready_events_ &= ~events;
+#endif
+}
+
 void PhysicalSocket::SetEnabledEvents(uint8_t events) {
   enabled_events_ = events;
 }
@@ -583,7 +683,17 @@ int PhysicalSocket::TranslateOption(Option opt, int* slevel, int* sopt) {
     case OPT_DSCP:
       LOG(LS_WARNING) << "Socket::OPT_DSCP not supported.";
       return -1;
+    case OPT_REUSEPORT:
+#if defined(SO_REUSEPORT)
+      *slevel = SOL_SOCKET;
+      *sopt = SO_REUSEPORT;
+      break;
+#else
+      LOG(LS_WARNING) << "Socket::OPT_REUSEPORT not supported.";
+      return -1;
+#endif
     case OPT_RTP_SENDTIME_EXTN_ID:
+    case OPT_SEND_BATCH_SIZE:
       return -1;  // No logging is necessary as this not a OS socket option.
     default:
       RTC_NOTREACHED();
@@ -839,6 +949,14 @@ static int GetEpollEvents(uint32_t ff) {
   return events;
 }
 
+bool SocketDispatcher::HasRequestedEdgeReadyEvents() {
+  uint32_t requested = GetRequestedEvents();
+  return ((edge_ready_events_ & DE_READ) &&
+          (requested & (DE_READ | DE_ACCEPT))) ||
+         ((edge_ready_events_ & DE_WRITE) &&
+          (requested & (DE_WRITE | DE_CONNECT)));
+}
+
 void SocketDispatcher::StartBatchedEventUpdates() {
   RTC_DCHECK_EQ(saved_enabled_events_, -1);
   saved_enabled_events_ = enabled_events();
@@ -1339,6 +1457,14 @@ void PhysicalSocketServer::Update(Dispatcher* pdispatcher) {
     return;
   }
 
+  SocketDispatcher* socket = pdispatcher->AsSocketDispatcher();
+  if (edge_triggered_ && socket) {
+    // The registration covers all events already; the socket only needs to
+    // be dispatched if it now requests something epoll reported earlier.
+    QueueEdgeReadySocket(socket);
+    return;
+  }
+
   UpdateEpoll(pdispatcher);
 #endif
 }
@@ -1575,8 +1701,15 @@ void PhysicalSocketServer::AddEpoll(Dispatcher* pdispatcher) {
     return;
   }
 
+  SocketDispatcher* socket = pdispatcher->AsSocketDispatcher();
+  if (socket) {
+    // Stale readiness of a previous descriptor (e.g. after Close() and
+    // Connect()) must not be carried over.
+    socket->set_edge_ready_events(0);
+  }
+
   struct epoll_event event = {0};
-  event.events = GetEpollEvents(pdispatcher->GetRequestedEvents());
+  event.events = GetEpollInterest(pdispatcher);
   event.data.ptr = pdispatcher;
   int err = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
   RTC_DCHECK_EQ(err, 0);
@@ -1587,6 +1720,13 @@ void PhysicalSocketServer::AddEpoll(Dispatcher* pdispatcher) {
 
 void PhysicalSocketServer::RemoveEpoll(Dispatcher* pdispatcher) {
   RTC_DCHECK(epoll_fd_ != INVALID_SOCKET);
+  SocketDispatcher* socket = pdispatcher->AsSocketDispatcher();
+  if (socket && socket->in_edge_ready_list()) {
+    std::replace(edge_ready_sockets_.begin(), edge_ready_sockets_.end(), socket,
+                 static_cast<SocketDispatcher*>(nullptr));
+    socket->set_in_edge_ready_list(false);
+  }
+
   int fd = pdispatcher->GetDescriptor();
   RTC_DCHECK(fd != INVALID_SOCKET);
   if (fd == INVALID_SOCKET) {
@@ -1615,8 +1755,9 @@ void PhysicalSocketServer::UpdateEpoll(Dispatcher* pdispatcher) {
   }
 
   struct epoll_event event = {0};
-  event.events = GetEpollEvents(pdispatcher->GetRequestedEvents());
+  event.events = GetEpollInterest(pdispatcher);
   event.data.ptr = pdispatcher;
+  ++epoll_stats_.interest_updates;
   int err = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
   RTC_DCHECK_EQ(err, 0);
   if (err == -1) {
@@ -1641,13 +1782,19 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
   fWait_ = true;
 
   while (fWait_) {
+    // Sockets that are still ready from an earlier edge must not wait.
+    bool edge_ready;
+    {
+      CritScope cr(&crit_);
+      edge_ready = !edge_ready_sockets_.empty();
+    }
     // Wait then call handlers as appropriate
     // < 0 means error
     // 0 means timeout
     // > 0 means count of descriptors ready
     int n = epoll_wait(epoll_fd_, &epoll_events_[0],
                        static_cast<int>(epoll_events_.size()),
-                       static_cast<int>(tvWait));
+                       edge_ready ? 0 : static_cast<int>(tvWait));
     if (n < 0) {
       if (errno != EINTR) {
         LOG_E(LS_ERROR, EN, errno) << "epoll";
@@ -1657,12 +1804,19 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
       // signals managed by this PhysicalSocketServer, the
       // PosixSignalDeliveryDispatcher will be in the signaled state in the next
       // iteration.
-    } else if (n == 0) {
+    } else if (n == 0 && !edge_ready) {
       // If timeout, return success
       return true;
     } else {
       // We have signaled descriptors
       CritScope cr(&crit_);
+      int64_t dispatch_start_us = TimeMicros();
+      if (n > 0) {
+        ++epoll_stats_.wakeups;
+        epoll_stats_.events += n;
+        epoll_stats_.max_events_per_wakeup = std::max(
+            epoll_stats_.max_events_per_wakeup, static_cast<uint64_t>(n));
+      }
       for (int i = 0; i < n; ++i) {
         const epoll_event& event = epoll_events_[i];
         Dispatcher* pdispatcher = static_cast<Dispatcher*>(event.data.ptr);
@@ -1675,8 +1829,23 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
         bool writable = (event.events & EPOLLOUT);
         bool check_error = (event.events & (EPOLLRDHUP | EPOLLERR | EPOLLHUP));
 
+        SocketDispatcher* socket = pdispatcher->AsSocketDispatcher();
+        if (edge_triggered_ && socket) {
+          // Only record the edge here; the socket is dispatched below, once
+          // all events of this wakeup are known.
+          socket->set_edge_ready_events(
+              socket->edge_ready_events() | (readable ? DE_READ : 0) |
+              (writable ? DE_WRITE : 0) | (check_error ? DE_CLOSE : 0));
+          QueueEdgeReadySocket(socket);
+          continue;
+        }
+
         ProcessEvents(pdispatcher, readable, writable, check_error);
       }
+      if (edge_triggered_) {
+        DispatchEdgeReadySockets();
+      }
+      epoll_stats_.dispatch_time_us += TimeMicros() - dispatch_start_us;
     }
 
     if (static_cast<size_t>(n) == epoll_events_.size() &&
@@ -1698,6 +1867,92 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
   return true;
 }
 
+bool PhysicalSocketServer::SetEdgeTriggeredEpoll(bool enable) {
+  if (epoll_fd_ == INVALID_SOCKET) {
+    return false;
+  }
+
+  CritScope cs(&crit_);
+  if (edge_triggered_ == enable) {
+    return true;
+  }
+
+  edge_triggered_ = enable;
+  for (Dispatcher* pdispatcher : dispatchers_) {
+    SocketDispatcher* socket = pdispatcher->AsSocketDispatcher();
+    if (!socket) {
+      continue;
+    }
+    // Modifying the registration makes epoll report the current state of the
+    // descriptor, so no readiness is lost when switching to edge-triggered.
+    socket->set_edge_ready_events(0);
+    UpdateEpoll(pdispatcher);
+  }
+  for (SocketDispatcher* socket : edge_ready_sockets_) {
+    if (socket) {
+      socket->set_in_edge_ready_list(false);
+    }
+  }
+  edge_ready_sockets_.clear();
+  return true;
+}
+
+PhysicalSocketServer::EpollStats PhysicalSocketServer::GetEpollStats() {
+  CritScope cs(&crit_);
+  return epoll_stats_;
+}
+
+uint32_t PhysicalSocketServer::GetEpollInterest(Dispatcher* pdispatcher) {
+  if (edge_triggered_ && pdispatcher->AsSocketDispatcher()) {
+    return EPOLLIN | EPOLLOUT | EPOLLET;
+  }
+  return GetEpollEvents(pdispatcher->GetRequestedEvents());
+}
+
+void PhysicalSocketServer::QueueEdgeReadySocket(SocketDispatcher* socket) {
+  if (!socket->in_edge_ready_list() && socket->HasRequestedEdgeReadyEvents()) {
+    socket->set_in_edge_ready_list(true);
+    edge_ready_sockets_.push_back(socket);
+  }
+}
+
+void PhysicalSocketServer::DispatchEdgeReadySockets() {
+  // Handlers may queue more sockets; those are dispatched on the next pass.
+  const size_t count = edge_ready_sockets_.size();
+  for (size_t i = 0; i < count; ++i) {
+    SocketDispatcher* socket = edge_ready_sockets_[i];
+    if (!socket) {
+      // Removed by the handler of an earlier socket.
+      continue;
+    }
+    uint8_t ready = socket->edge_ready_events();
+    uint32_t requested = socket->GetRequestedEvents();
+    bool readable = (ready & DE_READ) && (requested & (DE_READ | DE_ACCEPT));
+    bool writable =
+        (ready & DE_WRITE) && (requested & (DE_WRITE | DE_CONNECT));
+    bool check_error = (ready & DE_CLOSE) && (readable || writable);
+    if (check_error) {
+      socket->set_edge_ready_events(ready & ~DE_CLOSE);
+    }
+    ProcessEvents(socket, readable, writable, check_error);
+  }
+
+  // Keep the sockets that still request events they are ready for, e.g.
+  // because a handler read only some of the queued datagrams.
+  size_t kept = 0;
+  for (SocketDispatcher* socket : edge_ready_sockets_) {
+    if (!socket) {
+      continue;
+    }
+    if (socket->HasRequestedEdgeReadyEvents()) {
+      edge_ready_sockets_[kept++] = socket;
+    } else {
+      socket->set_in_edge_ready_list(false);
+    }
+  }
+  edge_ready_sockets_.resize(kept);
+}
+
 bool PhysicalSocketServer::WaitPoll(int cmsWait, Dispatcher* dispatcher) {
   RTC_DCHECK(dispatcher);
   int64_t tvWait = -1;
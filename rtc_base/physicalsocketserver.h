@@ -40,6 +40,7 @@ enum DispatcherEvent {
 };
 
 class Signaler;
+class SocketDispatcher;
 #if defined(WEBRTC_POSIX)
 class PosixSignalDispatcher;
 #endif
@@ -58,6 +59,11 @@ class Dispatcher {
   virtual int GetDescriptor() = 0;
   virtual bool IsDescriptorClosed() = 0;
 #endif
+#if defined(WEBRTC_USE_EPOLL)
+  // Returns this dispatcher if it is a SocketDispatcher, whose readiness can
+  // be tracked in edge-triggered epoll mode, or null otherwise.
+  virtual SocketDispatcher* AsSocketDispatcher() { return nullptr; }
+#endif
 };
 
 // A socket server that provides the real sockets of the underlying OS.
@@ -84,6 +90,32 @@ class PhysicalSocketServer : public SocketServer {
   void Remove(Dispatcher* dispatcher);
   void Update(Dispatcher* dispatcher);
 
+#if defined(WEBRTC_USE_EPOLL)
+  struct EpollStats {
+    // Number of epoll_wait calls that returned at least one event.
+    uint64_t wakeups = 0;
+    // Number of events returned by those calls; divide by |wakeups| for the
+    // average number of events per wakeup.
+    uint64_t events = 0;
+    // Largest number of events returned by a single epoll_wait call.
+    uint64_t max_events_per_wakeup = 0;
+    // Number of EPOLL_CTL_MOD calls made because a dispatcher changed the
+    // events it is interested in.
+    uint64_t interest_updates = 0;
+    // Time spent dispatching the events returned by epoll_wait.
+    int64_t dispatch_time_us = 0;
+  };
+
+  // Registers sockets with EPOLLET for both reading and writing once, instead
+  // of modifying the epoll registration whenever the events requested by a
+  // socket change. Readiness reported by epoll is remembered per socket until
+  // a read or write would block, and all ready sockets are dispatched in one
+  // pass per wakeup. Can be toggled at any time. Returns false if epoll isn't
+  // available.
+  bool SetEdgeTriggeredEpoll(bool enable);
+  EpollStats GetEpollStats();
+#endif
+
 #if defined(WEBRTC_POSIX)
   // Sets the function to be executed in response to the specified POSIX signal.
   // The function is executed from inside Wait() using the "self-pipe trick"--
@@ -118,9 +150,18 @@ class PhysicalSocketServer : public SocketServer {
   void UpdateEpoll(Dispatcher* dispatcher);
   bool WaitEpoll(int cms);
   bool WaitPoll(int cms, Dispatcher* dispatcher);
+  uint32_t GetEpollInterest(Dispatcher* dispatcher);
+  void QueueEdgeReadySocket(SocketDispatcher* socket);
+  void DispatchEdgeReadySockets();
 
   int epoll_fd_ = INVALID_SOCKET;
   std::vector<struct epoll_event> epoll_events_;
+  bool edge_triggered_ = false;
+  // Sockets that epoll reported ready for events they currently request, in
+  // edge-triggered mode. Entries of sockets removed while dispatching are set
+  // to null.
+  std::vector<SocketDispatcher*> edge_ready_sockets_;
+  EpollStats epoll_stats_;
 #endif  // WEBRTC_USE_EPOLL
   DispatcherSet dispatchers_;
   DispatcherSet pending_add_dispatchers_;
@@ -166,6 +207,18 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
                size_t length,
                SocketAddress* out_addr,
                int64_t* timestamp) override;
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  // Uses recvmmsg() to read the whole batch with one system call. At most
+  // kMaxRecvBatchSize datagrams are read per call. Receive timestamps are
+  // not available in this mode and are reported as -1.
+  int RecvFromBatch(ReceivedDatagram* datagrams, size_t count) override;
+  // Uses sendmmsg() to send the whole batch with one system call. At most
+  // kMaxSendBatchSize datagrams are sent per call.
+  int SendToBatch(const OutgoingDatagram* datagrams, size_t count) override;
+
+  static const size_t kMaxRecvBatchSize = 64;
+  static const size_t kMaxSendBatchSize = 64;
+#endif
 
   int Listen(int backlog) override;
   AsyncSocket* Accept(SocketAddress* out_addr) override;
@@ -191,6 +244,10 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
 
   void UpdateLastError();
   void MaybeRemapSendError();
+  // Forgets readiness reported by edge-triggered epoll for |events| (DE_READ
+  // or DE_WRITE) after a read or write would block; epoll reports the next
+  // change as a new edge.
+  void ClearEdgeReadyEvents(uint8_t events);
 
   uint8_t enabled_events() const { return enabled_events_; }
   virtual void SetEnabledEvents(uint8_t events);
@@ -210,6 +267,11 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
 #if !defined(NDEBUG)
   std::string dbg_addr_;
 #endif
+#if defined(WEBRTC_USE_EPOLL)
+  // Readiness reported by edge-triggered epoll that hasn't been used up yet,
+  // as DE_READ, DE_WRITE and DE_CLOSE (for errors and hang-ups).
+  uint8_t edge_ready_events_ = 0;
+#endif
 
  private:
   uint8_t enabled_events_ = 0;
@@ -242,6 +304,17 @@ class SocketDispatcher : public Dispatcher, public PhysicalSocket {
   int Close() override;
 
 #if defined(WEBRTC_USE_EPOLL)
+  SocketDispatcher* AsSocketDispatcher() override { return this; }
+
+  // Used by PhysicalSocketServer in edge-triggered epoll mode.
+  uint8_t edge_ready_events() const { return edge_ready_events_; }
+  void set_edge_ready_events(uint8_t events) { edge_ready_events_ = events; }
+  // Returns true if epoll reported readiness for events the socket currently
+  // requests.
+  bool HasRequestedEdgeReadyEvents();
+  bool in_edge_ready_list() const { return in_edge_ready_list_; }
+  void set_in_edge_ready_list(bool in_list) { in_edge_ready_list_ = in_list; }
+
  protected:
   void StartBatchedEventUpdates();
   void FinishBatchedEventUpdates();
@@ -262,6 +335,7 @@ class SocketDispatcher : public Dispatcher, public PhysicalSocket {
   void MaybeUpdateDispatcher(uint8_t old_events);
 
   int saved_enabled_events_ = -1;
+  bool in_edge_ready_list_ = false;
 #endif
 };
 
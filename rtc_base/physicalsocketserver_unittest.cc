@@ -8,10 +8,14 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <algorithm>
 #include <memory>
 #include <signal.h>
 #include <stdarg.h>
+#include <vector>
 
+#include "rtc_base/asyncudpsocket.h"
+#include "rtc_base/cpu_time.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/networkmonitor.h"
@@ -498,6 +502,411 @@ TEST_F(PhysicalSocketTest,
   server_->set_network_binder(nullptr);
 }
 
+// Sends datagrams over loopback between two AsyncUDPSockets, optionally with
+// batched send and/or receive, and counts what is delivered through
+// SignalReadPacket. Must be used on a thread whose socket server is |ss|.
+class UdpLoopbackReceiver : public sigslot::has_slots<> {
+ public:
+  UdpLoopbackReceiver(PhysicalSocketServer* ss,
+                      size_t recv_batch_size,
+                      int send_batch_size)
+      : receiver_(AsyncUDPSocket::Create(ss, SocketAddress("127.0.0.1", 0))),
+        sender_(AsyncUDPSocket::Create(ss, SocketAddress("127.0.0.1", 0))) {
+    RTC_DCHECK_EQ(ss, Thread::Current()->socketserver());
+    receiver_->SetReceiveBatchSize(recv_batch_size);
+    receiver_->SetOption(Socket::OPT_RCVBUF, 4 * 1024 * 1024);
+    sender_->SetOption(Socket::OPT_SEND_BATCH_SIZE, send_batch_size);
+    receiver_->SignalReadPacket.connect(this,
+                                        &UdpLoopbackReceiver::OnReadPacket);
+    sender_->SignalSentPacket.connect(this, &UdpLoopbackReceiver::OnSentPacket);
+  }
+
+  // Sends in bursts small enough to fit the receive buffer and drains the
+  // receiver in between, until |num_packets| have been received.
+  void Run(int num_packets, size_t packet_size, int burst_size) {
+    std::vector<char> payload(packet_size, 'x');
+    const SocketAddress dest = receiver_->GetLocalAddress();
+    while (packets_received_ < num_packets) {
+      const int target = std::min(packets_received_ + burst_size, num_packets);
+      for (int i = packets_received_; i < target; ++i)
+        sender_->SendTo(payload.data(), payload.size(), dest, PacketOptions());
+      // Move on to the next burst if loopback dropped something.
+      const int64_t deadline_ms = TimeMillis() + 100;
+      while (packets_received_ < target && TimeMillis() < deadline_ms)
+        Thread::Current()->ProcessMessages(0);
+    }
+  }
+
+  int packets_received() const { return packets_received_; }
+  size_t bytes_received() const { return bytes_received_; }
+  int packets_sent() const { return packets_sent_; }
+
+ private:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const PacketTime& packet_time) {
+    EXPECT_EQ(sender_->GetLocalAddress(), remote_addr);
+    ++packets_received_;
+    bytes_received_ += size;
+  }
+
+  void OnSentPacket(AsyncPacketSocket* socket, const SentPacket& packet) {
+    ++packets_sent_;
+  }
+
+  std::unique_ptr<AsyncUDPSocket> receiver_;
+  std::unique_ptr<AsyncUDPSocket> sender_;
+  int packets_received_ = 0;
+  size_t bytes_received_ = 0;
+  int packets_sent_ = 0;
+};
+
+TEST_F(PhysicalSocketTest, BatchedUdpReceiveDeliversAllPackets) {
+  MAYBE_SKIP_IPV4;
+  UdpLoopbackReceiver receiver(server_.get(), 16, 1);
+  receiver.Run(100, 1200, 10);
+  EXPECT_EQ(100, receiver.packets_received());
+  EXPECT_EQ(100u * 1200u, receiver.bytes_received());
+}
+
+// Counts read events of a socket and the packets its AsyncUDPSocket delivers.
+class ReadEventCounter : public sigslot::has_slots<> {
+ public:
+  ReadEventCounter(AsyncSocket* socket, AsyncUDPSocket* udp_socket) {
+    socket->SignalReadEvent.connect(this, &ReadEventCounter::OnReadEvent);
+    udp_socket->SignalReadPacket.connect(this, &ReadEventCounter::OnReadPacket);
+  }
+
+  void OnReadEvent(AsyncSocket* socket) { ++read_events_; }
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const PacketTime& packet_time) {
+    ++packets_;
+  }
+  int read_events() const { return read_events_; }
+  int packets() const { return packets_; }
+
+ private:
+  int read_events_ = 0;
+  int packets_ = 0;
+};
+
+TEST_F(PhysicalSocketTest, BatchedUdpReceiveReadsQueuedPacketsInOneEvent) {
+  MAYBE_SKIP_IPV4;
+  const int kNumPackets = 8;
+  const char kPayload[100] = {0};
+  std::unique_ptr<AsyncSocket> sender(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, sender->Bind(SocketAddress("127.0.0.1", 0)));
+  AsyncSocket* socket = server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM);
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(socket, SocketAddress("127.0.0.1", 0)));
+  ASSERT_TRUE(receiver);
+  receiver->SetReceiveBatchSize(16);
+  ReadEventCounter counter(socket, receiver.get());
+  const SocketAddress dest = receiver->GetLocalAddress();
+  for (int i = 0; i < kNumPackets; ++i)
+    ASSERT_EQ(static_cast<int>(sizeof(kPayload)),
+              sender->SendTo(kPayload, sizeof(kPayload), dest));
+  // Loopback queues the datagrams synchronously, so a single dispatch of the
+  // socket server sees all of them.
+  server_->Wait(0, true);
+  EXPECT_EQ(1, counter.read_events());
+  EXPECT_EQ(kNumPackets, counter.packets());
+}
+
+// Closes the socket it reads from on the first packet.
+class ClosingReadHandler : public sigslot::has_slots<> {
+ public:
+  explicit ClosingReadHandler(AsyncUDPSocket* socket) : socket_(socket) {
+    socket_->SignalReadPacket.connect(this, &ClosingReadHandler::OnReadPacket);
+  }
+
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const PacketTime& packet_time) {
+    ++packets_;
+    socket_->Close();
+  }
+  int packets() const { return packets_; }
+
+ private:
+  std::unique_ptr<AsyncUDPSocket> socket_;
+  int packets_ = 0;
+};
+
+TEST_F(PhysicalSocketTest, BatchedUdpReceiveStopsWhenHandlerClosesSocket) {
+  MAYBE_SKIP_IPV4;
+  const char kPayload[100] = {0};
+  std::unique_ptr<AsyncSocket> sender(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, sender->Bind(SocketAddress("127.0.0.1", 0)));
+  AsyncUDPSocket* receiver =
+      AsyncUDPSocket::Create(server_.get(), SocketAddress("127.0.0.1", 0));
+  ASSERT_TRUE(receiver);
+  receiver->SetReceiveBatchSize(8);
+  const SocketAddress dest = receiver->GetLocalAddress();
+  ClosingReadHandler handler(receiver);
+  // Queue several datagrams before the first read event, so that they are
+  // read as one batch.
+  for (int i = 0; i < 4; ++i)
+    sender->SendTo(kPayload, sizeof(kPayload), dest);
+  const int64_t deadline_ms = TimeMillis() + 100;
+  while (TimeMillis() < deadline_ms)
+    Thread::Current()->ProcessMessages(10);
+  EXPECT_EQ(1, handler.packets());
+}
+
+TEST_F(PhysicalSocketTest, BatchedUdpSendDeliversAllPackets) {
+  MAYBE_SKIP_IPV4;
+  // Bursts of 10 with a batch size of 4 exercise both the flush on a full
+  // batch and the flush posted to the thread.
+  UdpLoopbackReceiver receiver(server_.get(), 1, 4);
+  receiver.Run(100, 1200, 10);
+  EXPECT_EQ(100, receiver.packets_received());
+  EXPECT_EQ(100u * 1200u, receiver.bytes_received());
+  EXPECT_EQ(100, receiver.packets_sent());
+}
+
+// Counts the packets an AsyncPacketSocket reports as sent.
+class SentPacketCounter : public sigslot::has_slots<> {
+ public:
+  explicit SentPacketCounter(AsyncPacketSocket* socket) {
+    socket->SignalSentPacket.connect(this, &SentPacketCounter::OnSentPacket);
+  }
+
+  void OnSentPacket(AsyncPacketSocket* socket, const SentPacket& packet) {
+    ++packets_;
+  }
+  int packets() const { return packets_; }
+
+ private:
+  int packets_ = 0;
+};
+
+TEST_F(PhysicalSocketTest, BatchedUdpSendSkipsPacketsThatFail) {
+  MAYBE_SKIP_IPV4;
+  AsyncSocket* socket = server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM);
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(socket, SocketAddress("127.0.0.1", 0)));
+  ASSERT_TRUE(receiver);
+  ReadEventCounter read_counter(socket, receiver.get());
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(server_.get(), SocketAddress("127.0.0.1", 0)));
+  ASSERT_TRUE(sender);
+  sender->SetOption(Socket::OPT_SEND_BATCH_SIZE, 4);
+  SentPacketCounter sent_counter(sender.get());
+  const SocketAddress dest = receiver->GetLocalAddress();
+  // The second packet is too large for a UDP datagram and fails with
+  // EMSGSIZE.
+  const std::vector<char> small(100);
+  const std::vector<char> too_large(70000);
+  sender->SendTo(small.data(), small.size(), dest, PacketOptions());
+  sender->SendTo(too_large.data(), too_large.size(), dest, PacketOptions());
+  sender->SendTo(small.data(), small.size(), dest, PacketOptions());
+  sender->SendTo(small.data(), small.size(), dest, PacketOptions());
+  EXPECT_EQ(3, sent_counter.packets());
+  EXPECT_EQ_WAIT(3, read_counter.packets(), kTimeout);
+}
+
+TEST_F(PhysicalSocketTest, BatchedUdpSendFlushesOnDestruction) {
+  MAYBE_SKIP_IPV4;
+  AsyncSocket* socket = server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM);
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(socket, SocketAddress("127.0.0.1", 0)));
+  ASSERT_TRUE(receiver);
+  ReadEventCounter read_counter(socket, receiver.get());
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(server_.get(), SocketAddress("127.0.0.1", 0)));
+  ASSERT_TRUE(sender);
+  sender->SetOption(Socket::OPT_SEND_BATCH_SIZE, 4);
+  const char kPayload[100] = {0};
+  const SocketAddress dest = receiver->GetLocalAddress();
+  sender->SendTo(kPayload, sizeof(kPayload), dest, PacketOptions());
+  sender->SendTo(kPayload, sizeof(kPayload), dest, PacketOptions());
+  sender.reset();
+  EXPECT_EQ_WAIT(2, read_counter.packets(), kTimeout);
+}
+
+#if defined(WEBRTC_USE_EPOLL)
+
+class PhysicalSocketEdgeTriggeredTest : public PhysicalSocketTest {
+ protected:
+  void SetUp() override {
+    PhysicalSocketTest::SetUp();
+    ASSERT_TRUE(server_->SetEdgeTriggeredEpoll(true));
+  }
+};
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestConnectIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestConnectIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestConnectAcceptErrorIPv4) {
+  MAYBE_SKIP_IPV4;
+  ConnectInternalAcceptError(kIPv4Loopback);
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestServerCloseIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestServerCloseIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestCloseInClosedCallbackIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestCloseInClosedCallbackIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestTcpIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestTcpIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestWritableAfterPartialWriteIPv4) {
+  MAYBE_SKIP_IPV4;
+  WritableAfterPartialWrite(kIPv4Loopback);
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestUdpIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestUdpIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, UdpReceiveDrainsQueuedPackets) {
+  MAYBE_SKIP_IPV4;
+  // One datagram per read event, so each burst needs the socket to be
+  // dispatched again without a new edge.
+  UdpLoopbackReceiver receiver(server_.get(), 1, 1);
+  receiver.Run(100, 1200, 10);
+  EXPECT_EQ(100, receiver.packets_received());
+
+  UdpLoopbackReceiver batched_receiver(server_.get(), 4, 1);
+  batched_receiver.Run(100, 1200, 10);
+  EXPECT_EQ(100, batched_receiver.packets_received());
+
+  PhysicalSocketServer::EpollStats stats = server_->GetEpollStats();
+  EXPECT_GT(stats.wakeups, 0u);
+  EXPECT_GE(stats.events, stats.wakeups);
+  EXPECT_EQ(0u, stats.interest_updates);
+}
+
+TEST_F(PhysicalSocketTest, SwitchEpollModeWithExistingSockets) {
+  MAYBE_SKIP_IPV4;
+  UdpLoopbackReceiver receiver(server_.get(), 1, 1);
+  receiver.Run(50, 1200, 10);
+  EXPECT_GT(server_->GetEpollStats().interest_updates, 0u);
+
+  ASSERT_TRUE(server_->SetEdgeTriggeredEpoll(true));
+  receiver.Run(100, 1200, 10);
+  EXPECT_EQ(100, receiver.packets_received());
+
+  ASSERT_TRUE(server_->SetEdgeTriggeredEpoll(false));
+  receiver.Run(150, 1200, 10);
+  EXPECT_EQ(150, receiver.packets_received());
+}
+
+class ReadPacketCounter : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const PacketTime& packet_time) {
+    ++packets_;
+  }
+  int packets() const { return packets_; }
+
+ private:
+  int packets_ = 0;
+};
+
+// Sends one datagram to each of many UDP sockets per round and reports the
+// epoll counters.
+void RunEpollManyUdpSockets(bool edge_triggered, size_t recv_batch_size) {
+  const int kNumSockets = 500;
+  const int kNumRounds = 200;
+  const char kPayload[100] = {0};
+  PhysicalSocketServer ss;
+  AutoSocketServerThread thread(&ss);
+  ASSERT_TRUE(ss.SetEdgeTriggeredEpoll(edge_triggered));
+  std::unique_ptr<AsyncSocket> sender(
+      ss.CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, sender->Bind(SocketAddress("127.0.0.1", 0)));
+  std::vector<std::unique_ptr<AsyncUDPSocket>> receivers;
+  ReadPacketCounter counter;
+  for (int i = 0; i < kNumSockets; ++i) {
+    receivers.emplace_back(
+        AsyncUDPSocket::Create(&ss, SocketAddress("127.0.0.1", 0)));
+    ASSERT_TRUE(receivers.back());
+    receivers.back()->SetReceiveBatchSize(recv_batch_size);
+    receivers.back()->SignalReadPacket.connect(
+        &counter, &ReadPacketCounter::OnReadPacket);
+  }
+  int64_t start_ns = GetProcessCpuTimeNanos();
+  for (int round = 1; round <= kNumRounds; ++round) {
+    for (const auto& receiver : receivers) {
+      sender->SendTo(kPayload, sizeof(kPayload), receiver->GetLocalAddress());
+    }
+    const int64_t deadline_ms = TimeMillis() + 1000;
+    while (counter.packets() < round * kNumSockets &&
+           TimeMillis() < deadline_ms) {
+      Thread::Current()->ProcessMessages(0);
+    }
+  }
+  int64_t elapsed_ns = GetProcessCpuTimeNanos() - start_ns;
+  PhysicalSocketServer::EpollStats stats = ss.GetEpollStats();
+  LOG(LS_INFO) << (edge_triggered ? "Edge" : "Level")
+               << "-triggered, receive batch size " << recv_batch_size << ": "
+               << counter.packets() << " packets in "
+               << elapsed_ns / kNumNanosecsPerMillisec << " CPU ms, "
+               << stats.wakeups << " wakeups, "
+               << static_cast<double>(stats.events) /
+                      std::max<uint64_t>(stats.wakeups, 1)
+               << " events per wakeup (max " << stats.max_events_per_wakeup
+               << "), " << stats.interest_updates << " epoll_ctl updates, "
+               << stats.dispatch_time_us / 1000 << " ms dispatching.";
+}
+
+TEST(PhysicalSocketServerPerfTest, DISABLED_EpollManyUdpSockets) {
+  for (size_t recv_batch_size : {1, 8}) {
+    RunEpollManyUdpSockets(false, recv_batch_size);
+    RunEpollManyUdpSockets(true, recv_batch_size);
+  }
+}
+
+#endif  // WEBRTC_USE_EPOLL
+
+// Reports delivered packets per second of process CPU time over loopback for
+// a range of receive and send batch sizes. Both ends run on this thread, so
+// the numbers include the cost of sending and receiving.
+TEST(PhysicalSocketServerPerfTest, DISABLED_BatchedUdpSendAndReceive) {
+  const int kNumPackets = 1000000;
+  const size_t kPacketSize = 1200;
+  const int kBurstSize = 1000;
+  for (size_t batch_size : {1, 8, 32, 64}) {
+    for (bool batch_send : {false, true}) {
+      PhysicalSocketServer ss;
+      AutoSocketServerThread thread(&ss);
+      UdpLoopbackReceiver receiver(&ss, batch_size,
+                                   batch_send ? batch_size : 1);
+      int64_t start_ns = GetProcessCpuTimeNanos();
+      receiver.Run(kNumPackets, kPacketSize, kBurstSize);
+      int64_t elapsed_ns = GetProcessCpuTimeNanos() - start_ns;
+      LOG(LS_INFO) << "Batch size " << batch_size
+                   << (batch_send ? " (send and receive): " : " (receive): ")
+                   << receiver.packets_received() * 1e9 / elapsed_ns
+                   << " packets per CPU second.";
+    }
+  }
+}
+
 class PosixSignalDeliveryTest : public testing::Test {
  public:
   static void RecordSignal(int signum) {
@@ -185,6 +185,10 @@ class Socket {
     OPT_RTP_SENDTIME_EXTN_ID,  // This is a non-traditional socket option param.
                                // This is specific to libjingle and will be used
                                // if SendTime option is needed at socket level.
+    OPT_SEND_BATCH_SIZE,  // Non-traditional as well: maximum number of UDP
+                          // packets an AsyncUDPSocket coalesces into a
+                          // single batched send. 1 (default) disables.
+    OPT_REUSEPORT,  // SO_REUSEPORT; must be set before Bind().
   };
   virtual int GetOption(Option opt, int* value) = 0;
   virtual int SetOption(Option opt, int value) = 0;
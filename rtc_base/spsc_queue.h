@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_SPSC_QUEUE_H_
+#define RTC_BASE_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/constructormagic.h"
+
+namespace rtc {
+
+// A fixed-capacity, lock-free ring buffer for exactly one producer thread and
+// one consumer thread. Elements are moved in and out, so a T that owns a
+// reference-counted payload (e.g. CopyOnWriteBuffer) crosses threads without
+// copying or allocating. Unlike Thread::Post, pushing takes no lock and
+// allocates no Message.
+//
+// Producer:
+//   if (!queue.TryPush(std::move(item)))
+//     HandleFull(...);
+// Consumer:
+//   T item;
+//   while (queue.TryPop(&item))
+//     Consume(std::move(item));
+template <typename T>
+class SpscQueue {
+ public:
+  // |capacity| must be a power of two.
+  explicit SpscQueue(size_t capacity)
+      : mask_(capacity - 1), slots_(new T[capacity]) {
+    RTC_DCHECK_GT(capacity, 0);
+    RTC_DCHECK_EQ(0u, capacity & mask_) << "Capacity must be a power of two.";
+    head_.value.store(0, std::memory_order_relaxed);
+    tail_.value.store(0, std::memory_order_relaxed);
+  }
+
+  // Producer only. Returns false, leaving |item| untouched, if the queue is
+  // full.
+  bool TryPush(T&& item) {
+    const size_t tail = tail_.value.load(std::memory_order_relaxed);
+    if (tail - head_.value.load(std::memory_order_acquire) > mask_)
+      return false;
+    slots_[tail & mask_] = std::move(item);
+    tail_.value.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns false if the queue is empty.
+  bool TryPop(T* item) {
+    const size_t head = head_.value.load(std::memory_order_relaxed);
+    if (head == tail_.value.load(std::memory_order_acquire))
+      return false;
+    *item = std::move(slots_[head & mask_]);
+    head_.value.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when called concurrently with the other thread.
+  size_t Size() const {
+    return tail_.value.load(std::memory_order_acquire) -
+           head_.value.load(std::memory_order_acquire);
+  }
+  bool Empty() const { return Size() == 0; }
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  // Padded so that the consumer's |head_| and the producer's |tail_| don't
+  // share a cache line.
+  struct PaddedIndex {
+    std::atomic<size_t> value;
+    char padding[64 - sizeof(std::atomic<size_t>)];
+  };
+
+  const size_t mask_;
+  const std::unique_ptr<T[]> slots_;
+  PaddedIndex head_;
+  PaddedIndex tail_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(SpscQueue);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_SPSC_QUEUE_H_
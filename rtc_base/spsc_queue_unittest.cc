@@ -0,0 +1,207 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/spsc_queue.h"
+
+#include <atomic>
+#include <memory>
+
+#include "rtc_base/asyncinvoker.h"
+#include "rtc_base/bind.h"
+#include "rtc_base/copyonwritebuffer.h"
+#include "rtc_base/event.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+
+namespace rtc {
+
+namespace {
+
+const int kNumItems = 10000;
+
+void ProduceItems(void* param) {
+  SpscQueue<int>* queue = static_cast<SpscQueue<int>*>(param);
+  for (int i = 0; i < kNumItems; ++i) {
+    int item = i;
+    while (!queue->TryPush(std::move(item)))
+      Thread::SleepMs(0);
+  }
+}
+
+// A media packet as handed from the network thread to the worker thread.
+struct HandOffPacket {
+  CopyOnWriteBuffer payload;
+  int64_t enqueue_time_ns = 0;
+};
+
+// Receives packets on |thread_| and records hand-off latency.
+class PacketConsumer {
+ public:
+  PacketConsumer(int expected_packets)
+      : thread_(Thread::Create()),
+        expected_packets_(expected_packets),
+        done_(false, false),
+        queue_(1024),
+        drain_pending_(false) {
+    thread_->Start();
+  }
+  ~PacketConsumer() { thread_->Stop(); }
+
+  // Current path: one posted task per packet.
+  void PostPacket(HandOffPacket packet) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, thread_.get(),
+        Bind(&PacketConsumer::OnPacket, this, packet.payload,
+             packet.enqueue_time_ns));
+  }
+
+  // Queue path: one posted task per burst, like BaseChannel.
+  void QueuePacket(HandOffPacket packet) {
+    while (!queue_.TryPush(std::move(packet)))
+      Thread::SleepMs(0);
+    if (!drain_pending_.exchange(true)) {
+      invoker_.AsyncInvoke<void>(RTC_FROM_HERE, thread_.get(),
+                                 Bind(&PacketConsumer::Drain, this));
+    }
+  }
+
+  void Wait() { EXPECT_TRUE(done_.Wait(60000)); }
+  double mean_latency_us() const {
+    return total_latency_ns_ / 1000.0 / received_;
+  }
+
+ private:
+  void Drain() {
+    drain_pending_.store(false);
+    HandOffPacket packet;
+    while (queue_.TryPop(&packet))
+      OnPacket(packet.payload, packet.enqueue_time_ns);
+  }
+
+  void OnPacket(const CopyOnWriteBuffer& payload, int64_t enqueue_time_ns) {
+    total_latency_ns_ += TimeNanos() - enqueue_time_ns;
+    if (++received_ == expected_packets_)
+      done_.Set();
+  }
+
+  std::unique_ptr<Thread> thread_;
+  AsyncInvoker invoker_;
+  const int expected_packets_;
+  Event done_;
+  SpscQueue<HandOffPacket> queue_;
+  std::atomic<bool> drain_pending_;
+  int received_ = 0;
+  int64_t total_latency_ns_ = 0;
+};
+
+}  // namespace
+
+TEST(SpscQueueTest, BasicOperation) {
+  SpscQueue<int> queue(4);
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_TRUE(queue.TryPush(1));
+  EXPECT_TRUE(queue.TryPush(2));
+  EXPECT_EQ(2u, queue.Size());
+
+  int item = 0;
+  EXPECT_TRUE(queue.TryPop(&item));
+  EXPECT_EQ(1, item);
+  EXPECT_TRUE(queue.TryPop(&item));
+  EXPECT_EQ(2, item);
+  EXPECT_FALSE(queue.TryPop(&item));
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(SpscQueueTest, FullQueue) {
+  SpscQueue<int> queue(2);
+  EXPECT_TRUE(queue.TryPush(1));
+  EXPECT_TRUE(queue.TryPush(2));
+  EXPECT_FALSE(queue.TryPush(3));
+
+  int item = 0;
+  EXPECT_TRUE(queue.TryPop(&item));
+  EXPECT_EQ(1, item);
+  EXPECT_TRUE(queue.TryPush(3));
+  EXPECT_TRUE(queue.TryPop(&item));
+  EXPECT_EQ(2, item);
+  EXPECT_TRUE(queue.TryPop(&item));
+  EXPECT_EQ(3, item);
+}
+
+TEST(SpscQueueTest, FailedPushKeepsItem) {
+  SpscQueue<CopyOnWriteBuffer> queue(1);
+  EXPECT_TRUE(queue.TryPush(CopyOnWriteBuffer("a", 1)));
+  CopyOnWriteBuffer item("b", 1);
+  EXPECT_FALSE(queue.TryPush(std::move(item)));
+  EXPECT_EQ(1u, item.size());
+}
+
+TEST(SpscQueueTest, MovesPayloadWithoutCopying) {
+  SpscQueue<CopyOnWriteBuffer> queue(2);
+  CopyOnWriteBuffer packet("payload", 7);
+  const uint8_t* data = packet.cdata();
+  EXPECT_TRUE(queue.TryPush(std::move(packet)));
+
+  CopyOnWriteBuffer received;
+  EXPECT_TRUE(queue.TryPop(&received));
+  EXPECT_EQ(data, received.cdata());
+}
+
+TEST(SpscQueueTest, ConcurrentProducerAndConsumer) {
+  SpscQueue<int> queue(64);
+  PlatformThread producer(&ProduceItems, &queue, "SpscProducer");
+  producer.Start();
+  for (int expected = 0; expected < kNumItems;) {
+    int item;
+    if (queue.TryPop(&item)) {
+      ASSERT_EQ(expected, item);
+      ++expected;
+    } else {
+      Thread::SleepMs(0);
+    }
+  }
+  producer.Stop();
+  EXPECT_TRUE(queue.Empty());
+}
+
+// Compares handing packets to another thread with one posted task per packet
+// (what BaseChannel used to do) against SpscQueue with one task per burst.
+TEST(SpscQueueTest, DISABLED_PacketHandOffPerformance) {
+  const int kNumPackets = 1000000;
+  const int kBurstSize = 16;
+  CopyOnWriteBuffer payload(1200);
+  for (bool use_queue : {false, true}) {
+    PacketConsumer consumer(kNumPackets);
+    int64_t start_ns = TimeNanos();
+    for (int i = 0; i < kNumPackets; ++i) {
+      HandOffPacket packet;
+      packet.payload = payload;
+      packet.enqueue_time_ns = TimeNanos();
+      if (use_queue) {
+        consumer.QueuePacket(std::move(packet));
+      } else {
+        consumer.PostPacket(std::move(packet));
+      }
+      // Roughly mimic packets arriving in bursts from one socket read.
+      if (i % kBurstSize == kBurstSize - 1)
+        Thread::SleepMs(0);
+    }
+    consumer.Wait();
+    int64_t elapsed_ns = TimeNanos() - start_ns;
+    LOG(LS_INFO) << (use_queue ? "SpscQueue" : "Thread::Post") << ": "
+                 << kNumPackets * 1e9 / elapsed_ns << " packets/s, "
+                 << consumer.mean_latency_us() << " us mean latency.";
+  }
+}
+
+}  // namespace rtc
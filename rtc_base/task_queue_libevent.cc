@@ -15,6 +15,9 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "base/third_party/libevent/event.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
@@ -24,6 +27,7 @@
 #include "rtc_base/safe_conversions.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/task_queue_posix.h"
+#include "rtc_base/timer_wheel.h"
 #include "rtc_base/timeutils.h"
 
 namespace rtc {
@@ -58,14 +62,6 @@ void IgnoreSigPipeSignalOnCurrentThread() {
   pthread_sigmask(SIG_BLOCK, &sigpipe_mask, nullptr);
 }
 
-struct TimerEvent {
-  explicit TimerEvent(std::unique_ptr<QueuedTask> task)
-      : task(std::move(task)) {}
-  ~TimerEvent() { event_del(&ev); }
-  event ev;
-  std::unique_ptr<QueuedTask> task;
-};
-
 bool SetNonBlocking(int fd) {
   const int flags = fcntl(fd, F_GETFL);
   RTC_CHECK(flags != -1);
@@ -132,7 +128,7 @@ class TaskQueue::Impl : public RefCountInterface {
   static void ThreadMain(void* context);
   static void OnWakeup(int socket, short flags, void* context);  // NOLINT
   static void RunTask(int fd, short flags, void* context);       // NOLINT
-  static void RunTimer(int fd, short flags, void* context);      // NOLINT
+  static void OnTimer(int fd, short flags, void* context);       // NOLINT
 
   class ReplyTaskOwner;
   class PostAndReplyTask;
@@ -143,11 +139,18 @@ class TaskQueue::Impl : public RefCountInterface {
   void PrepareReplyTask(scoped_refptr<ReplyTaskOwnerRef> reply_task);
 
   struct QueueContext;
+
+  // Arms |timer_event_| for the earliest pending delayed task, unless it is
+  // already armed for that time.
+  void ScheduleTimer(QueueContext* ctx);
+
   TaskQueue* const queue_;
   int wakeup_pipe_in_ = -1;
   int wakeup_pipe_out_ = -1;
   event_base* event_base_;
   std::unique_ptr<event> wakeup_event_;
+  // A single libevent timer that fires for the earliest delayed task.
+  std::unique_ptr<event> timer_event_;
   PlatformThread thread_;
   rtc::CriticalSection pending_lock_;
   std::list<std::unique_ptr<QueuedTask>> pending_ RTC_GUARDED_BY(pending_lock_);
@@ -156,11 +159,15 @@ class TaskQueue::Impl : public RefCountInterface {
 };
 
 struct TaskQueue::Impl::QueueContext {
-  explicit QueueContext(TaskQueue::Impl* q) : queue(q), is_active(true) {}
+  explicit QueueContext(TaskQueue::Impl* q)
+      : queue(q), is_active(true), delayed_tasks(TimeMillis()) {}
   TaskQueue::Impl* queue;
   bool is_active;
-  // Holds a list of events pending timers for cleanup when the loop exits.
-  std::list<TimerEvent*> pending_timers_;
+  // Delayed tasks, keyed on the time they should run. Tasks still pending
+  // when the loop exits are deleted along with the context.
+  TimerWheel<std::unique_ptr<QueuedTask>> delayed_tasks;
+  // The time |timer_event_| is armed for, or -1 if it isn't armed.
+  int64_t timer_deadline_ms = -1;
 };
 
 // Posting a reply task is tricky business. This class owns the reply task
@@ -276,6 +283,7 @@ TaskQueue::Impl::Impl(const char* queue_name,
     : queue_(queue),
       event_base_(event_base_new()),
       wakeup_event_(new event()),
+      timer_event_(new event()),
       thread_(&TaskQueue::Impl::ThreadMain,
               this,
               queue_name,
@@ -291,6 +299,7 @@ TaskQueue::Impl::Impl(const char* queue_name,
   EventAssign(wakeup_event_.get(), event_base_, wakeup_pipe_out_,
               EV_READ | EV_PERSIST, OnWakeup, this);
   event_add(wakeup_event_.get(), 0);
+  EventAssign(timer_event_.get(), event_base_, -1, 0, OnTimer, this);
   thread_.Start();
 }
 
@@ -309,6 +318,7 @@ TaskQueue::Impl::~Impl() {
   thread_.Stop();
 
   event_del(wakeup_event_.get());
+  event_del(timer_event_.get());
 
   IgnoreSigPipeSignalOnCurrentThread();
 
@@ -370,15 +380,13 @@ void TaskQueue::Impl::PostTask(std::unique_ptr<QueuedTask> task) {
 void TaskQueue::Impl::PostDelayedTask(std::unique_ptr<QueuedTask> task,
                                       uint32_t milliseconds) {
   if (IsCurrent()) {
-    TimerEvent* timer = new TimerEvent(std::move(task));
-    EventAssign(&timer->ev, event_base_, -1, 0, &TaskQueue::Impl::RunTimer,
-                timer);
     QueueContext* ctx =
         static_cast<QueueContext*>(pthread_getspecific(GetQueuePtrTls()));
-    ctx->pending_timers_.push_back(timer);
-    timeval tv = {rtc::dchecked_cast<int>(milliseconds / 1000),
-                  rtc::dchecked_cast<int>(milliseconds % 1000) * 1000};
-    event_add(&timer->ev, &tv);
+    const int64_t now_ms = TimeMillis();
+    if (now_ms < ctx->delayed_tasks.current_time_ms())
+      ctx->delayed_tasks.RewindTo(now_ms);
+    ctx->delayed_tasks.Insert(now_ms + milliseconds, std::move(task));
+    ScheduleTimer(ctx);
   } else {
     PostTask(std::unique_ptr<QueuedTask>(
         new SetTimerTask(std::move(task), milliseconds)));
@@ -405,9 +413,6 @@ void TaskQueue::Impl::ThreadMain(void* context) {
     event_base_loop(me->event_base_, 0);
 
   pthread_setspecific(GetQueuePtrTls(), nullptr);
-
-  for (TimerEvent* timer : queue_context.pending_timers_)
-    delete timer;
 }
 
 // static
@@ -467,14 +472,32 @@ void TaskQueue::Impl::RunTask(int fd, short flags, void* context) {  // NOLINT
 }
 
 // static
-void TaskQueue::Impl::RunTimer(int fd, short flags, void* context) {  // NOLINT
-  TimerEvent* timer = static_cast<TimerEvent*>(context);
-  if (!timer->task->Run())
-    timer->task.release();
+void TaskQueue::Impl::OnTimer(int fd, short flags, void* context) {  // NOLINT
+  TaskQueue::Impl* me = static_cast<TaskQueue::Impl*>(context);
   QueueContext* ctx =
       static_cast<QueueContext*>(pthread_getspecific(GetQueuePtrTls()));
-  ctx->pending_timers_.remove(timer);
-  delete timer;
+  RTC_DCHECK_EQ(me, ctx->queue);
+  ctx->timer_deadline_ms = -1;
+  std::vector<std::unique_ptr<QueuedTask>> expired;
+  ctx->delayed_tasks.Advance(TimeMillis(), &expired);
+  for (std::unique_ptr<QueuedTask>& task : expired) {
+    if (!task->Run())
+      task.release();
+  }
+  me->ScheduleTimer(ctx);
+}
+
+void TaskQueue::Impl::ScheduleTimer(QueueContext* ctx) {
+  int64_t deadline_ms;
+  if (!ctx->delayed_tasks.NextDeadline(&deadline_ms))
+    return;
+  if (ctx->timer_deadline_ms != -1 && ctx->timer_deadline_ms <= deadline_ms)
+    return;
+  ctx->timer_deadline_ms = deadline_ms;
+  const int64_t delay_ms = std::max<int64_t>(0, TimeUntil(deadline_ms));
+  timeval tv = {rtc::dchecked_cast<int>(delay_ms / 1000),
+                rtc::dchecked_cast<int>(delay_ms % 1000) * 1000};
+  event_add(timer_event_.get(), &tv);
 }
 
 void TaskQueue::Impl::PrepareReplyTask(
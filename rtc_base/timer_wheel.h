@@ -0,0 +1,397 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TIMER_WHEEL_H_
+#define RTC_BASE_TIMER_WHEEL_H_
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/constructormagic.h"
+
+namespace rtc {
+
+// A hierarchical timer wheel with millisecond resolution. Insert and Cancel
+// are O(1); a timer is moved to a finer level at most once per level before
+// it expires, so Advance is amortized O(1) per timer plus O(levels) per
+// distinct expiry time, regardless of how far the clock jumps.
+//
+// Timers that expire in the same Advance call are returned ordered by
+// deadline, and timers with the same deadline in insertion order, matching
+// what a priority queue keyed on (deadline, sequence number) would produce.
+//
+// Not thread safe; callers provide their own locking.
+//
+//   TimerWheel<Task> wheel(TimeMillis());
+//   TimerWheel<Task>::TimerId id = wheel.Insert(TimeMillis() + 100, task);
+//   ...
+//   std::vector<Task> expired;
+//   wheel.Advance(TimeMillis(), &expired);
+template <typename T>
+class TimerWheel {
+ public:
+  typedef uint64_t TimerId;
+  static const TimerId kInvalidTimerId = 0;
+
+  explicit TimerWheel(int64_t now_ms) : current_ms_(now_ms) {
+    for (Bucket& bucket : buckets_)
+      bucket.head = bucket.tail = kNone;
+    for (uint64_t& occupied : occupied_)
+      occupied = 0;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // The time the wheel was last advanced to. Deadlines at or before this time
+  // expire on the next call to Advance.
+  int64_t current_time_ms() const { return current_ms_; }
+
+  // Adds a timer that expires once the wheel is advanced to |deadline_ms|.
+  // The returned id stays unique for the lifetime of the wheel and can be
+  // passed to Cancel until the timer expires.
+  TimerId Insert(int64_t deadline_ms, T value) {
+    const uint32_t index = AllocateNode();
+    Node& node = nodes_[index];
+    node.value = std::move(value);
+    node.deadline_ms = deadline_ms;
+    node.sequence = next_sequence_++;
+    Place(index);
+    ++size_;
+    return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+  }
+
+  // Removes a pending timer. Returns false if |id| already expired or was
+  // cancelled.
+  bool Cancel(TimerId id) {
+    const uint64_t index = (id & 0xffffffffu) - 1;
+    if (id == kInvalidTimerId || index >= nodes_.size())
+      return false;
+    Node& node = nodes_[index];
+    if (node.bucket == kNoBucket || node.generation != (id >> 32))
+      return false;
+    Unlink(static_cast<uint32_t>(index));
+    FreeNode(static_cast<uint32_t>(index));
+    return true;
+  }
+
+  // Removes every pending timer for which |pred(T*)| returns true. The
+  // predicate may move the value out. Returns the number of removed timers.
+  template <typename Predicate>
+  size_t RemoveIf(Predicate pred) {
+    size_t removed = 0;
+    for (uint32_t i = 0; i < nodes_.size(); ++i) {
+      if (nodes_[i].bucket != kNoBucket && pred(&nodes_[i].value)) {
+        Unlink(i);
+        FreeNode(i);
+        ++removed;
+      }
+    }
+    return removed;
+  }
+
+  // Moves the wheel to |now_ms| and appends the values of all timers with a
+  // deadline at or before |now_ms| to |expired|. If |now_ms| is earlier than
+  // current_time_ms() (e.g. because a fake clock was installed), pending
+  // timers are re-placed relative to the new time and keep their deadlines.
+  void Advance(int64_t now_ms, std::vector<T>* expired) {
+    RTC_DCHECK(expired);
+    if (now_ms < current_ms_) {
+      RewindTo(now_ms);
+    } else {
+      while (current_ms_ < now_ms) {
+        const int64_t next_event_ms = NextEventTime();
+        if (next_event_ms > now_ms) {
+          current_ms_ = now_ms;
+          break;
+        }
+        current_ms_ = next_event_ms;
+        ProcessTick();
+      }
+    }
+    DrainDue(expired);
+  }
+
+  // Re-places all pending timers relative to |now_ms|, which must not be
+  // later than current_time_ms(). Needed before inserting timers computed
+  // from a clock that went backwards.
+  void RewindTo(int64_t now_ms) {
+    RTC_DCHECK_LE(now_ms, current_ms_);
+    std::vector<uint32_t> pending;
+    for (uint32_t i = 0; i < nodes_.size(); ++i) {
+      if (nodes_[i].bucket != kNoBucket && nodes_[i].bucket != kDueBucket) {
+        Unlink(i);
+        pending.push_back(i);
+      }
+    }
+    current_ms_ = now_ms;
+    for (uint32_t index : pending)
+      Place(index);
+  }
+
+  // Sets |deadline_ms| to the earliest pending deadline and returns true, or
+  // returns false if there are no pending timers.
+  bool NextDeadline(int64_t* deadline_ms) const {
+    if (buckets_[kDueBucket].head != kNone) {
+      *deadline_ms = MinDeadline(kDueBucket);
+      return true;
+    }
+    const uint64_t now = static_cast<uint64_t>(current_ms_);
+    for (int level = 0; level < kNumLevels; ++level) {
+      const uint64_t mask = PendingSlots(level, now);
+      if (!mask)
+        continue;
+      const int slot = CountTrailingZeros(mask);
+      if (level == 0) {
+        // All timers in a level 0 slot share the same deadline.
+        *deadline_ms = static_cast<int64_t>((now & ~kSlotMask) | slot);
+      } else {
+        *deadline_ms = MinDeadline(level * kSlotsPerLevel + slot);
+      }
+      return true;
+    }
+    if (buckets_[kFarBucket].head != kNone) {
+      *deadline_ms = MinDeadline(kFarBucket);
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  static const int kBitsPerLevel = 6;
+  static const int kSlotsPerLevel = 1 << kBitsPerLevel;
+  static const uint64_t kSlotMask = kSlotsPerLevel - 1;
+  // Six levels cover 2^36 ms (about two years); anything further out waits
+  // in a single overflow bucket.
+  static const int kNumLevels = 6;
+  static const int kWheelBits = kNumLevels * kBitsPerLevel;
+  static const int kFarBucket = kNumLevels * kSlotsPerLevel;
+  static const int kDueBucket = kFarBucket + 1;
+  static const int kNumBuckets = kDueBucket + 1;
+  static const uint16_t kNoBucket = 0xffff;
+  static const uint32_t kNone = 0xffffffffu;
+
+  struct Node {
+    T value;
+    int64_t deadline_ms = 0;
+    uint64_t sequence = 0;
+    uint32_t prev = kNone;
+    uint32_t next = kNone;
+    uint32_t generation = 0;
+    uint16_t bucket = kNoBucket;
+  };
+
+  struct Bucket {
+    uint32_t head;
+    uint32_t tail;
+  };
+
+  static int CountTrailingZeros(uint64_t x) {
+    RTC_DCHECK_NE(0u, x);
+#if defined(_MSC_VER)
+    unsigned long index;  // NOLINT
+    _BitScanForward64(&index, x);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(x);
+#endif
+  }
+
+  // Slots at |level| that become due after |now|, as a bitmask.
+  uint64_t PendingSlots(int level, uint64_t now) const {
+    const uint64_t digit = (now >> (level * kBitsPerLevel)) & kSlotMask;
+    if (digit == kSlotMask)
+      return 0;
+    return occupied_[level] & (~uint64_t{0} << (digit + 1));
+  }
+
+  // Returns the next time at which a level 0 slot expires or a coarser slot
+  // has to be cascaded, or INT64_MAX if there is none.
+  int64_t NextEventTime() const {
+    const uint64_t now = static_cast<uint64_t>(current_ms_);
+    for (int level = 0; level < kNumLevels; ++level) {
+      const uint64_t mask = PendingSlots(level, now);
+      if (!mask)
+        continue;
+      const int shift = level * kBitsPerLevel;
+      const uint64_t base = (now >> (shift + kBitsPerLevel))
+                            << (shift + kBitsPerLevel);
+      return static_cast<int64_t>(
+          base | (static_cast<uint64_t>(CountTrailingZeros(mask)) << shift));
+    }
+    if (buckets_[kFarBucket].head != kNone)
+      return static_cast<int64_t>(((now >> kWheelBits) + 1) << kWheelBits);
+    return INT64_MAX;
+  }
+
+  // Handles the wheel reaching |current_ms_|: cascades the coarser slots that
+  // start at this time and moves the matching level 0 slot to the due list.
+  void ProcessTick() {
+    const uint64_t now = static_cast<uint64_t>(current_ms_);
+    if ((now & ((uint64_t{1} << kWheelBits) - 1)) == 0)
+      Cascade(kFarBucket);
+    for (int level = kNumLevels - 1; level > 0; --level) {
+      const int shift = level * kBitsPerLevel;
+      if (now & ((uint64_t{1} << shift) - 1))
+        continue;
+      Cascade(level * kSlotsPerLevel + ((now >> shift) & kSlotMask));
+    }
+    Cascade(static_cast<int>(now & kSlotMask));
+  }
+
+  void Cascade(int bucket) {
+    uint32_t index = buckets_[bucket].head;
+    if (index == kNone)
+      return;
+    buckets_[bucket].head = buckets_[bucket].tail = kNone;
+    if (bucket < kFarBucket)
+      occupied_[bucket / kSlotsPerLevel] &=
+          ~(uint64_t{1} << (bucket % kSlotsPerLevel));
+    while (index != kNone) {
+      const uint32_t next = nodes_[index].next;
+      nodes_[index].bucket = kNoBucket;
+      Place(index);
+      index = next;
+    }
+  }
+
+  // Links |index| into the bucket matching its deadline. A timer lives at the
+  // level of the most significant digit in which its deadline differs from
+  // the current time.
+  void Place(uint32_t index) {
+    const int64_t deadline_ms = nodes_[index].deadline_ms;
+    if (deadline_ms <= current_ms_) {
+      Link(index, kDueBucket);
+      return;
+    }
+    const uint64_t deadline = static_cast<uint64_t>(deadline_ms);
+    const uint64_t diff = deadline ^ static_cast<uint64_t>(current_ms_);
+    int level = 0;
+    while (level < kNumLevels && (diff >> ((level + 1) * kBitsPerLevel)))
+      ++level;
+    if (level == kNumLevels) {
+      Link(index, kFarBucket);
+      return;
+    }
+    const uint64_t slot = (deadline >> (level * kBitsPerLevel)) & kSlotMask;
+    occupied_[level] |= uint64_t{1} << slot;
+    Link(index, static_cast<int>(level * kSlotsPerLevel + slot));
+  }
+
+  void Link(uint32_t index, int bucket) {
+    Node& node = nodes_[index];
+    node.bucket = static_cast<uint16_t>(bucket);
+    node.next = kNone;
+    node.prev = buckets_[bucket].tail;
+    if (node.prev == kNone)
+      buckets_[bucket].head = index;
+    else
+      nodes_[node.prev].next = index;
+    buckets_[bucket].tail = index;
+  }
+
+  void Unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    const int bucket = node.bucket;
+    if (node.prev == kNone)
+      buckets_[bucket].head = node.next;
+    else
+      nodes_[node.prev].next = node.next;
+    if (node.next == kNone)
+      buckets_[bucket].tail = node.prev;
+    else
+      nodes_[node.next].prev = node.prev;
+    if (bucket < kFarBucket && buckets_[bucket].head == kNone) {
+      occupied_[bucket / kSlotsPerLevel] &=
+          ~(uint64_t{1} << (bucket % kSlotsPerLevel));
+    }
+    node.bucket = kNoBucket;
+  }
+
+  int64_t MinDeadline(int bucket) const {
+    int64_t min_deadline_ms = INT64_MAX;
+    for (uint32_t index = buckets_[bucket].head; index != kNone;
+         index = nodes_[index].next) {
+      min_deadline_ms = std::min(min_deadline_ms, nodes_[index].deadline_ms);
+    }
+    return min_deadline_ms;
+  }
+
+  void DrainDue(std::vector<T>* expired) {
+    uint32_t index = buckets_[kDueBucket].head;
+    if (index == kNone)
+      return;
+    due_scratch_.clear();
+    for (; index != kNone; index = nodes_[index].next)
+      due_scratch_.push_back(index);
+    buckets_[kDueBucket].head = buckets_[kDueBucket].tail = kNone;
+    std::sort(due_scratch_.begin(), due_scratch_.end(),
+              [this](uint32_t a, uint32_t b) {
+                const Node& lhs = nodes_[a];
+                const Node& rhs = nodes_[b];
+                return lhs.deadline_ms < rhs.deadline_ms ||
+                       (lhs.deadline_ms == rhs.deadline_ms &&
+                        lhs.sequence < rhs.sequence);
+              });
+    for (uint32_t due : due_scratch_) {
+      expired->push_back(std::move(nodes_[due].value));
+      nodes_[due].bucket = kNoBucket;
+      FreeNode(due);
+    }
+  }
+
+  uint32_t AllocateNode() {
+    if (free_head_ == kNone) {
+      nodes_.emplace_back();
+      return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+    const uint32_t index = free_head_;
+    free_head_ = nodes_[index].next;
+    return index;
+  }
+
+  // Releases the node's value and bumps its generation so stale ids no
+  // longer match.
+  void FreeNode(uint32_t index) {
+    Node& node = nodes_[index];
+    node.value = T();
+    ++node.generation;
+    node.prev = kNone;
+    node.next = free_head_;
+    free_head_ = index;
+    --size_;
+  }
+
+  int64_t current_ms_;
+  uint64_t next_sequence_ = 0;
+  size_t size_ = 0;
+  std::vector<Node> nodes_;
+  uint32_t free_head_ = kNone;
+  Bucket buckets_[kNumBuckets];
+  uint64_t occupied_[kNumLevels];
+  std::vector<uint32_t> due_scratch_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+template <typename T>
+const typename TimerWheel<T>::TimerId TimerWheel<T>::kInvalidTimerId;
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_TIMER_WHEEL_H_
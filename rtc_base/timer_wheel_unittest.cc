@@ -0,0 +1,310 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/timer_wheel.h"
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/gunit.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
+
+namespace rtc {
+
+namespace {
+
+// Reference implementation: expiry order of a map keyed on
+// (deadline, insertion order).
+class ReferenceTimers {
+ public:
+  uint64_t Insert(int64_t deadline_ms, int value) {
+    uint64_t sequence = next_sequence_++;
+    timers_[std::make_pair(deadline_ms, sequence)] = value;
+    return sequence;
+  }
+  void Cancel(int64_t deadline_ms, uint64_t sequence) {
+    timers_.erase(std::make_pair(deadline_ms, sequence));
+  }
+  void Advance(int64_t now_ms, std::vector<int>* expired) {
+    while (!timers_.empty() && timers_.begin()->first.first <= now_ms) {
+      expired->push_back(timers_.begin()->second);
+      timers_.erase(timers_.begin());
+    }
+  }
+
+ private:
+  uint64_t next_sequence_ = 0;
+  std::map<std::pair<int64_t, uint64_t>, int> timers_;
+};
+
+}  // namespace
+
+TEST(TimerWheelTest, ExpiresInDeadlineOrder) {
+  TimerWheel<int> wheel(1000);
+  wheel.Insert(1300, 3);
+  wheel.Insert(1010, 1);
+  wheel.Insert(1100, 2);
+  EXPECT_EQ(3u, wheel.size());
+
+  std::vector<int> expired;
+  wheel.Advance(1009, &expired);
+  EXPECT_TRUE(expired.empty());
+  wheel.Advance(1200, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2}), expired);
+  wheel.Advance(1300, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), expired);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, SameDeadlineExpiresInInsertionOrder) {
+  TimerWheel<int> wheel(0);
+  // The first timer is placed on a coarse level and cascaded later, the
+  // others go directly to finer levels as the wheel approaches the deadline.
+  wheel.Insert(5000, 1);
+  std::vector<int> expired;
+  wheel.Advance(4990, &expired);
+  wheel.Insert(5000, 2);
+  wheel.Advance(4999, &expired);
+  wheel.Insert(5000, 3);
+  wheel.Advance(5000, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), expired);
+}
+
+TEST(TimerWheelTest, PastDeadlineExpiresOnNextAdvance) {
+  TimerWheel<int> wheel(100);
+  wheel.Insert(50, 1);
+  wheel.Insert(100, 2);
+  int64_t deadline_ms;
+  ASSERT_TRUE(wheel.NextDeadline(&deadline_ms));
+  EXPECT_EQ(50, deadline_ms);
+  std::vector<int> expired;
+  wheel.Advance(100, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2}), expired);
+  EXPECT_FALSE(wheel.NextDeadline(&deadline_ms));
+}
+
+TEST(TimerWheelTest, Cancel) {
+  TimerWheel<int> wheel(0);
+  TimerWheel<int>::TimerId first = wheel.Insert(10, 1);
+  TimerWheel<int>::TimerId second = wheel.Insert(100000, 2);
+  EXPECT_TRUE(wheel.Cancel(first));
+  EXPECT_FALSE(wheel.Cancel(first));
+  EXPECT_FALSE(wheel.Cancel(TimerWheel<int>::kInvalidTimerId));
+  EXPECT_EQ(1u, wheel.size());
+
+  // A reused node must not be cancellable through the stale id.
+  TimerWheel<int>::TimerId third = wheel.Insert(20, 3);
+  EXPECT_NE(first, third);
+  EXPECT_FALSE(wheel.Cancel(first));
+
+  std::vector<int> expired;
+  wheel.Advance(100000, &expired);
+  EXPECT_EQ(std::vector<int>({3, 2}), expired);
+  EXPECT_FALSE(wheel.Cancel(second));
+}
+
+TEST(TimerWheelTest, NextDeadline) {
+  TimerWheel<int> wheel(123);
+  int64_t deadline_ms;
+  EXPECT_FALSE(wheel.NextDeadline(&deadline_ms));
+  wheel.Insert(200000, 1);
+  ASSERT_TRUE(wheel.NextDeadline(&deadline_ms));
+  EXPECT_EQ(200000, deadline_ms);
+  wheel.Insert(150, 2);
+  ASSERT_TRUE(wheel.NextDeadline(&deadline_ms));
+  EXPECT_EQ(150, deadline_ms);
+  wheel.Insert(199999, 3);
+  std::vector<int> expired;
+  wheel.Advance(150, &expired);
+  ASSERT_TRUE(wheel.NextDeadline(&deadline_ms));
+  EXPECT_EQ(199999, deadline_ms);
+}
+
+TEST(TimerWheelTest, FarDeadlines) {
+  const int64_t kYearMs = 365LL * 24 * 3600 * 1000;
+  TimerWheel<int> wheel(0);
+  wheel.Insert(10 * kYearMs, 2);
+  wheel.Insert(3 * kYearMs, 1);
+  int64_t deadline_ms;
+  ASSERT_TRUE(wheel.NextDeadline(&deadline_ms));
+  EXPECT_EQ(3 * kYearMs, deadline_ms);
+  std::vector<int> expired;
+  wheel.Advance(10 * kYearMs - 1, &expired);
+  EXPECT_EQ(std::vector<int>({1}), expired);
+  wheel.Advance(10 * kYearMs, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2}), expired);
+}
+
+TEST(TimerWheelTest, RewindKeepsDeadlines) {
+  TimerWheel<int> wheel(1000000);
+  wheel.Insert(1000500, 2);
+  // E.g. a fake clock was installed and time restarts at zero.
+  wheel.RewindTo(0);
+  EXPECT_EQ(0, wheel.current_time_ms());
+  wheel.Insert(100, 1);
+  std::vector<int> expired;
+  wheel.Advance(100, &expired);
+  EXPECT_EQ(std::vector<int>({1}), expired);
+  wheel.Advance(1000500, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2}), expired);
+}
+
+TEST(TimerWheelTest, RemoveIf) {
+  TimerWheel<int> wheel(0);
+  for (int i = 0; i < 10; ++i)
+    wheel.Insert(i * 1000, i);
+  std::vector<int> removed;
+  EXPECT_EQ(5u, wheel.RemoveIf([&removed](int* value) {
+    if (*value % 2)
+      return false;
+    removed.push_back(*value);
+    return true;
+  }));
+  EXPECT_EQ(std::vector<int>({0, 2, 4, 6, 8}), removed);
+  std::vector<int> expired;
+  wheel.Advance(10000, &expired);
+  EXPECT_EQ(std::vector<int>({1, 3, 5, 7, 9}), expired);
+}
+
+TEST(TimerWheelTest, ReleasesValues) {
+  std::shared_ptr<int> value(new int(1));
+  {
+    TimerWheel<std::shared_ptr<int>> wheel(0);
+    TimerWheel<std::shared_ptr<int>>::TimerId id = wheel.Insert(10, value);
+    wheel.Insert(20, value);
+    EXPECT_EQ(3, value.use_count());
+    wheel.Cancel(id);
+    EXPECT_EQ(2, value.use_count());
+  }
+  EXPECT_EQ(1, value.use_count());
+}
+
+TEST(TimerWheelTest, MatchesReferenceOrder) {
+  webrtc::Random random(12345);
+  TimerWheel<int> wheel(0);
+  ReferenceTimers reference;
+  struct Pending {
+    TimerWheel<int>::TimerId id;
+    int64_t deadline_ms;
+    uint64_t sequence;
+  };
+  std::vector<Pending> pending;
+  int64_t now_ms = 0;
+  std::vector<int> expired;
+  std::vector<int> expected;
+  for (int i = 0; i < 20000; ++i) {
+    switch (random.Rand(3)) {
+      case 0:
+      case 1: {
+        // Mix of short and long delays, with some duplicate deadlines.
+        int64_t delay_ms = random.Rand(2) ? random.Rand(100)
+                                          : random.Rand(1 << 20);
+        int64_t deadline_ms = now_ms + delay_ms;
+        pending.push_back({wheel.Insert(deadline_ms, i), deadline_ms,
+                           reference.Insert(deadline_ms, i)});
+        break;
+      }
+      case 2:
+        if (!pending.empty()) {
+          size_t index = random.Rand(pending.size() - 1);
+          if (wheel.Cancel(pending[index].id))
+            reference.Cancel(pending[index].deadline_ms,
+                             pending[index].sequence);
+          pending[index] = pending.back();
+          pending.pop_back();
+        }
+        break;
+      case 3:
+        now_ms += random.Rand(2) ? random.Rand(10) : random.Rand(100000);
+        wheel.Advance(now_ms, &expired);
+        reference.Advance(now_ms, &expected);
+        ASSERT_EQ(expected, expired);
+        break;
+    }
+  }
+  now_ms += 1 << 21;
+  wheel.Advance(now_ms, &expired);
+  reference.Advance(now_ms, &expected);
+  EXPECT_EQ(expected, expired);
+  EXPECT_TRUE(wheel.empty());
+}
+
+// Models many connections that each keep a periodic timer (e.g. STUN pings)
+// and frequently cancel and re-arm another (e.g. retransmissions).
+TEST(TimerWheelTest, DISABLED_Performance) {
+  const int kNumTimers = 100000;
+  const int64_t kDurationMs = 10000;
+  webrtc::Random random(42);
+  std::vector<int64_t> periods(kNumTimers);
+  for (int64_t& period : periods)
+    period = 20 + random.Rand(2480);
+
+  // std::multimap stands in for a priority queue that supports cancellation.
+  {
+    typedef std::multimap<int64_t, int> Timers;
+    Timers timers;
+    std::vector<Timers::iterator> retransmits(kNumTimers);
+    for (int i = 0; i < kNumTimers; ++i) {
+      timers.insert(std::make_pair(periods[i], i));
+      retransmits[i] = timers.insert(std::make_pair(periods[i] * 4, -1));
+    }
+    int64_t start_ns = TimeNanos();
+    size_t fired = 0;
+    for (int64_t now_ms = 1; now_ms <= kDurationMs; ++now_ms) {
+      while (!timers.empty() && timers.begin()->first <= now_ms) {
+        int i = timers.begin()->second;
+        timers.erase(timers.begin());
+        if (i < 0)
+          continue;
+        ++fired;
+        timers.insert(std::make_pair(now_ms + periods[i], i));
+        timers.erase(retransmits[i]);
+        retransmits[i] =
+            timers.insert(std::make_pair(now_ms + periods[i] * 4, -1));
+      }
+    }
+    int64_t elapsed_ns = TimeNanos() - start_ns;
+    LOG(LS_INFO) << "std::multimap: " << fired << " timers fired in "
+                 << elapsed_ns / kNumNanosecsPerMillisec << " ms.";
+  }
+
+  {
+    TimerWheel<int> timers(0);
+    std::vector<TimerWheel<int>::TimerId> retransmits(kNumTimers);
+    for (int i = 0; i < kNumTimers; ++i) {
+      timers.Insert(periods[i], i);
+      retransmits[i] = timers.Insert(periods[i] * 4, -1);
+    }
+    int64_t start_ns = TimeNanos();
+    size_t fired = 0;
+    std::vector<int> expired;
+    for (int64_t now_ms = 1; now_ms <= kDurationMs; ++now_ms) {
+      expired.clear();
+      timers.Advance(now_ms, &expired);
+      for (int i : expired) {
+        if (i < 0)
+          continue;
+        ++fired;
+        timers.Insert(now_ms + periods[i], i);
+        timers.Cancel(retransmits[i]);
+        retransmits[i] = timers.Insert(now_ms + periods[i] * 4, -1);
+      }
+    }
+    int64_t elapsed_ns = TimeNanos() - start_ns;
+    LOG(LS_INFO) << "TimerWheel: " << fired << " timers fired in "
+                 << elapsed_ns / kNumNanosecsPerMillisec << " ms.";
+  }
+}
+
+}  // namespace rtc
@@ -590,6 +590,11 @@ int Win32Socket::TranslateOption(Option opt, int* slevel, int* sopt) {
     case OPT_DSCP:
       LOG(LS_WARNING) << "Socket::OPT_DSCP not supported.";
       return -1;
+    case OPT_SEND_BATCH_SIZE:
+      return -1;  // Not an OS socket option; handled by AsyncUDPSocket.
+    case OPT_REUSEPORT:
+      LOG(LS_WARNING) << "Socket::OPT_REUSEPORT not supported.";
+      return -1;
     default:
       RTC_NOTREACHED();
       return -1;
@@ -47,20 +47,13 @@
 #include "rtc_base/logging.h"
 #include "rtc_base/ptr_util.h"
 #include "rtc_base/rate_statistics.h"
+#include "rtc_tools/event_log_visualizer/send_side_bwe_replay.h"
 
 namespace webrtc {
 namespace plotting {
 
 namespace {
 
-void SortPacketFeedbackVector(std::vector<PacketFeedback>* vec) {
-  auto pred = [](const PacketFeedback& packet_feedback) {
-    return packet_feedback.arrival_time_ms == PacketFeedback::kNotReceived;
-  };
-  vec->erase(std::remove_if(vec->begin(), vec->end(), pred), vec->end());
-  std::sort(vec->begin(), vec->end(), PacketFeedbackComparator());
-}
-
 std::string SsrcToString(uint32_t ssrc) {
   std::stringstream ss;
   ss << "SSRC " << ssrc;
@@ -530,34 +523,6 @@ EventLogAnalyzer::EventLogAnalyzer(const ParsedRtcEventLog& log)
   }
 }
 
-class BitrateObserver : public SendSideCongestionController::Observer,
-                        public RemoteBitrateObserver {
- public:
-  BitrateObserver() : last_bitrate_bps_(0), bitrate_updated_(false) {}
-
-  void OnNetworkChanged(uint32_t bitrate_bps,
-                        uint8_t fraction_loss,
-                        int64_t rtt_ms,
-                        int64_t probing_interval_ms) override {
-    last_bitrate_bps_ = bitrate_bps;
-    bitrate_updated_ = true;
-  }
-
-  void OnReceiveBitrateChanged(const std::vector<uint32_t>& ssrcs,
-                               uint32_t bitrate) override {}
-
-  uint32_t last_bitrate_bps() const { return last_bitrate_bps_; }
-  bool GetAndResetBitrateUpdated() {
-    bool bitrate_updated = bitrate_updated_;
-    bitrate_updated_ = false;
-    return bitrate_updated;
-  }
-
- private:
-  uint32_t last_bitrate_bps_;
-  bool bitrate_updated_;
-};
-
 bool EventLogAnalyzer::IsRtxSsrc(StreamId stream_id) const {
   return rtx_ssrcs_.count(stream_id) == 1;
 }
@@ -1108,118 +1073,21 @@ void EventLogAnalyzer::CreateStreamBitrateGraph(
 }
 
 void EventLogAnalyzer::CreateSendSideBweSimulationGraph(Plot* plot) {
-  std::multimap<uint64_t, const LoggedRtpPacket*> outgoing_rtp;
-  std::multimap<uint64_t, const LoggedRtcpPacket*> incoming_rtcp;
-
-  for (const auto& kv : rtp_packets_) {
-    if (kv.first.GetDirection() == PacketDirection::kOutgoingPacket) {
-      for (const LoggedRtpPacket& rtp_packet : kv.second)
-        outgoing_rtp.insert(std::make_pair(rtp_packet.timestamp, &rtp_packet));
-    }
-  }
-
-  for (const auto& kv : rtcp_packets_) {
-    if (kv.first.GetDirection() == PacketDirection::kIncomingPacket) {
-      for (const LoggedRtcpPacket& rtcp_packet : kv.second)
-        incoming_rtcp.insert(
-            std::make_pair(rtcp_packet.timestamp, &rtcp_packet));
-    }
-  }
-
-  SimulatedClock clock(0);
-  BitrateObserver observer;
-  RtcEventLogNullImpl null_event_log;
-  PacketRouter packet_router;
-  PacedSender pacer(&clock, &packet_router, &null_event_log);
-  SendSideCongestionController cc(&clock, &observer, &null_event_log, &pacer);
-  // TODO(holmer): Log the call config and use that here instead.
-  static const uint32_t kDefaultStartBitrateBps = 300000;
-  cc.SetBweBitrates(0, kDefaultStartBitrateBps, -1);
+  SendSideBweReplay replay((SendSideBweReplay::Config()));
+  replay.AddEvents(parsed_log_);
+  SendSideBweReplay::Result result = replay.Run();
 
   TimeSeries time_series("Delay-based estimate", LINE_DOT_GRAPH);
+  for (const SendSideBweReplay::Sample& sample : result.estimates) {
+    float x = static_cast<float>(sample.log_time_us - begin_time_) / 1000000;
+    time_series.points.emplace_back(x, sample.bitrate_bps / 1000);
+  }
   TimeSeries acked_time_series("Acked bitrate", LINE_DOT_GRAPH);
-
-  auto rtp_iterator = outgoing_rtp.begin();
-  auto rtcp_iterator = incoming_rtcp.begin();
-
-  auto NextRtpTime = [&]() {
-    if (rtp_iterator != outgoing_rtp.end())
-      return static_cast<int64_t>(rtp_iterator->first);
-    return std::numeric_limits<int64_t>::max();
-  };
-
-  auto NextRtcpTime = [&]() {
-    if (rtcp_iterator != incoming_rtcp.end())
-      return static_cast<int64_t>(rtcp_iterator->first);
-    return std::numeric_limits<int64_t>::max();
-  };
-
-  auto NextProcessTime = [&]() {
-    if (rtcp_iterator != incoming_rtcp.end() ||
-        rtp_iterator != outgoing_rtp.end()) {
-      return clock.TimeInMicroseconds() +
-             std::max<int64_t>(cc.TimeUntilNextProcess() * 1000, 0);
-    }
-    return std::numeric_limits<int64_t>::max();
-  };
-
-  RateStatistics acked_bitrate(250, 8000);
-
-  int64_t time_us = std::min(NextRtpTime(), NextRtcpTime());
-  int64_t last_update_us = 0;
-  while (time_us != std::numeric_limits<int64_t>::max()) {
-    clock.AdvanceTimeMicroseconds(time_us - clock.TimeInMicroseconds());
-    if (clock.TimeInMicroseconds() >= NextRtcpTime()) {
-      RTC_DCHECK_EQ(clock.TimeInMicroseconds(), NextRtcpTime());
-      const LoggedRtcpPacket& rtcp = *rtcp_iterator->second;
-      if (rtcp.type == kRtcpTransportFeedback) {
-        cc.OnTransportFeedback(
-            *static_cast<rtcp::TransportFeedback*>(rtcp.packet.get()));
-        std::vector<PacketFeedback> feedback = cc.GetTransportFeedbackVector();
-        SortPacketFeedbackVector(&feedback);
-        rtc::Optional<uint32_t> bitrate_bps;
-        if (!feedback.empty()) {
-          for (const PacketFeedback& packet : feedback)
-            acked_bitrate.Update(packet.payload_size, packet.arrival_time_ms);
-          bitrate_bps = acked_bitrate.Rate(feedback.back().arrival_time_ms);
-        }
-        uint32_t y = 0;
-        if (bitrate_bps)
-          y = *bitrate_bps / 1000;
-        float x = static_cast<float>(clock.TimeInMicroseconds() - begin_time_) /
-                  1000000;
-        acked_time_series.points.emplace_back(x, y);
-      }
-      ++rtcp_iterator;
-    }
-    if (clock.TimeInMicroseconds() >= NextRtpTime()) {
-      RTC_DCHECK_EQ(clock.TimeInMicroseconds(), NextRtpTime());
-      const LoggedRtpPacket& rtp = *rtp_iterator->second;
-      if (rtp.header.extension.hasTransportSequenceNumber) {
-        RTC_DCHECK(rtp.header.extension.hasTransportSequenceNumber);
-        cc.AddPacket(rtp.header.ssrc,
-                     rtp.header.extension.transportSequenceNumber,
-                     rtp.total_length, PacedPacketInfo());
-        rtc::SentPacket sent_packet(
-            rtp.header.extension.transportSequenceNumber, rtp.timestamp / 1000);
-        cc.OnSentPacket(sent_packet);
-      }
-      ++rtp_iterator;
-    }
-    if (clock.TimeInMicroseconds() >= NextProcessTime()) {
-      RTC_DCHECK_EQ(clock.TimeInMicroseconds(), NextProcessTime());
-      cc.Process();
-    }
-    if (observer.GetAndResetBitrateUpdated() ||
-        time_us - last_update_us >= 1e6) {
-      uint32_t y = observer.last_bitrate_bps() / 1000;
-      float x = static_cast<float>(clock.TimeInMicroseconds() - begin_time_) /
-                1000000;
-      time_series.points.emplace_back(x, y);
-      last_update_us = time_us;
-    }
-    time_us = std::min({NextRtpTime(), NextRtcpTime(), NextProcessTime()});
+  for (const SendSideBweReplay::Sample& sample : result.acked_bitrates) {
+    float x = static_cast<float>(sample.log_time_us - begin_time_) / 1000000;
+    acked_time_series.points.emplace_back(x, sample.bitrate_bps / 1000);
   }
+
   // Add the data set to the plot.
   plot->AppendTimeSeries(std::move(time_series));
   plot->AppendTimeSeries(std::move(acked_time_series));
@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_tools/event_log_visualizer/send_side_bwe_replay.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "api/optional.h"
+#include "logging/rtc_event_log/rtc_event_log.h"
+#include "modules/congestion_controller/include/send_side_congestion_controller.h"
+#include "modules/pacing/paced_sender.h"
+#include "modules/pacing/packet_router.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_utility.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/rate_statistics.h"
+#include "rtc_base/socket.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+namespace {
+
+constexpr int64_t kNoEventUs = std::numeric_limits<int64_t>::max();
+// Longest time between two samples of the estimate.
+constexpr int64_t kMaxSampleIntervalUs = 1000000;
+
+class EstimateObserver : public SendSideCongestionController::Observer {
+ public:
+  void OnNetworkChanged(uint32_t bitrate_bps,
+                        uint8_t fraction_loss,
+                        int64_t rtt_ms,
+                        int64_t probing_interval_ms) override {
+    bitrate_bps_ = bitrate_bps;
+    updated_ = true;
+  }
+
+  uint32_t bitrate_bps() const { return bitrate_bps_; }
+  bool GetAndResetUpdated() {
+    bool updated = updated_;
+    updated_ = false;
+    return updated;
+  }
+
+ private:
+  uint32_t bitrate_bps_ = 0;
+  bool updated_ = false;
+};
+
+}  // namespace
+
+void SortPacketFeedbackVector(std::vector<PacketFeedback>* vec) {
+  auto pred = [](const PacketFeedback& packet_feedback) {
+    return packet_feedback.arrival_time_ms == PacketFeedback::kNotReceived;
+  };
+  vec->erase(std::remove_if(vec->begin(), vec->end(), pred), vec->end());
+  std::sort(vec->begin(), vec->end(), PacketFeedbackComparator());
+}
+
+SendSideBweReplay::SendSideBweReplay(const Config& config) : config_(config) {
+  // TODO(ivoc): Remove this once this mapping is stored in the event log for
+  //             audio streams. Tracking bug: webrtc:6399
+  default_extension_map_.Register<TransportSequenceNumber>(
+      RtpExtension::kTransportSequenceNumberDefaultId);
+}
+
+void SendSideBweReplay::AddEvents(const ParsedRtcEventLog& parsed_log) {
+  // Keep only the packets the congestion controller would have seen.
+  for (size_t i = 0; i < parsed_log.GetNumberOfEvents(); ++i) {
+    ParsedRtcEventLog::EventType event_type = parsed_log.GetEventType(i);
+    PacketDirection direction;
+    if (event_type == ParsedRtcEventLog::RTP_EVENT) {
+      uint8_t header[IP_PACKET_SIZE];
+      size_t header_length;
+      size_t total_length;
+      RtpHeaderExtensionMap* extension_map = parsed_log.GetRtpHeader(
+          i, &direction, header, &header_length, &total_length, nullptr);
+      if (direction != kOutgoingPacket)
+        continue;
+      RtpUtility::RtpHeaderParser rtp_parser(header, header_length);
+      RTPHeader parsed_header;
+      rtp_parser.Parse(&parsed_header, extension_map ? extension_map
+                                                     : &default_extension_map_);
+      if (!parsed_header.extension.hasTransportSequenceNumber)
+        continue;
+      outgoing_rtp_.push_back(
+          {parsed_log.GetTimestamp(i), parsed_header.ssrc,
+           parsed_header.extension.transportSequenceNumber, total_length});
+    } else if (event_type == ParsedRtcEventLog::RTCP_EVENT) {
+      uint8_t packet[IP_PACKET_SIZE];
+      size_t length;
+      parsed_log.GetRtcpPacket(i, &direction, packet, &length);
+      if (direction != kIncomingPacket)
+        continue;
+      // Incoming RTCP packets are logged once for audio and once for video.
+      // Only keep the first.
+      if (!incoming_rtcp_.empty() &&
+          incoming_rtcp_.back().packet.size() == length &&
+          memcmp(incoming_rtcp_.back().packet.data(), packet, length) == 0) {
+        continue;
+      }
+      incoming_rtcp_.push_back({parsed_log.GetTimestamp(i),
+                                std::vector<uint8_t>(packet, packet + length)});
+    }
+  }
+}
+
+SendSideBweReplay::Result SendSideBweReplay::Run() const {
+  // Events are logged from several threads, so they may be slightly out of
+  // order.
+  std::vector<const OutgoingRtpPacket*> outgoing_rtp;
+  outgoing_rtp.reserve(outgoing_rtp_.size());
+  for (const OutgoingRtpPacket& rtp : outgoing_rtp_)
+    outgoing_rtp.push_back(&rtp);
+  std::stable_sort(
+      outgoing_rtp.begin(), outgoing_rtp.end(),
+      [](const OutgoingRtpPacket* a, const OutgoingRtpPacket* b) {
+        return a->time_us < b->time_us;
+      });
+  std::vector<const IncomingRtcpPacket*> incoming_rtcp;
+  incoming_rtcp.reserve(incoming_rtcp_.size());
+  for (const IncomingRtcpPacket& rtcp : incoming_rtcp_)
+    incoming_rtcp.push_back(&rtcp);
+  std::stable_sort(
+      incoming_rtcp.begin(), incoming_rtcp.end(),
+      [](const IncomingRtcpPacket* a, const IncomingRtcpPacket* b) {
+        return a->time_us < b->time_us;
+      });
+
+  SimulatedClock clock(0);
+  EstimateObserver observer;
+  RtcEventLogNullImpl null_event_log;
+  PacketRouter packet_router;
+  PacedSender pacer(&clock, &packet_router, &null_event_log);
+  SendSideCongestionController cc(&clock, &observer, &null_event_log, &pacer);
+  cc.SetBweBitrates(config_.min_bitrate_bps, config_.start_bitrate_bps,
+                    config_.max_bitrate_bps);
+  RateStatistics acked_bitrate(250, 8000);
+
+  Result result;
+  size_t rtp_index = 0;
+  size_t rtcp_index = 0;
+  auto NextRtpTime = [&]() {
+    if (rtp_index < outgoing_rtp.size())
+      return outgoing_rtp[rtp_index]->time_us;
+    return kNoEventUs;
+  };
+  auto NextRtcpTime = [&]() {
+    if (rtcp_index < incoming_rtcp.size())
+      return incoming_rtcp[rtcp_index]->time_us;
+    return kNoEventUs;
+  };
+  auto NextProcessTime = [&]() {
+    if (rtp_index < outgoing_rtp.size() || rtcp_index < incoming_rtcp.size()) {
+      return clock.TimeInMicroseconds() +
+             std::max<int64_t>(cc.TimeUntilNextProcess() * 1000, 0);
+    }
+    return kNoEventUs;
+  };
+
+  rtc::Optional<int64_t> last_sample_us;
+  int64_t time_us = std::min(NextRtpTime(), NextRtcpTime());
+  while (time_us != kNoEventUs) {
+    clock.AdvanceTimeMicroseconds(time_us - clock.TimeInMicroseconds());
+    if (time_us >= NextRtcpTime()) {
+      const std::vector<uint8_t>& packet = incoming_rtcp[rtcp_index]->packet;
+      ++rtcp_index;
+      rtcp::CommonHeader header;
+      const uint8_t* packet_end = packet.data() + packet.size();
+      for (const uint8_t* block = packet.data(); block < packet_end;
+           block = header.NextPacket()) {
+        if (!header.Parse(block, packet_end - block))
+          break;
+        if (header.type() != rtcp::TransportFeedback::kPacketType ||
+            header.fmt() != rtcp::TransportFeedback::kFeedbackMessageType) {
+          continue;
+        }
+        rtcp::TransportFeedback transport_feedback;
+        if (!transport_feedback.Parse(header))
+          continue;
+        ++result.transport_feedback_packets;
+        cc.OnTransportFeedback(transport_feedback);
+        std::vector<PacketFeedback> feedback = cc.GetTransportFeedbackVector();
+        SortPacketFeedbackVector(&feedback);
+        rtc::Optional<uint32_t> bitrate_bps;
+        if (!feedback.empty()) {
+          for (const PacketFeedback& packet : feedback)
+            acked_bitrate.Update(packet.payload_size, packet.arrival_time_ms);
+          bitrate_bps = acked_bitrate.Rate(feedback.back().arrival_time_ms);
+        }
+        result.acked_bitrates.emplace_back(time_us, bitrate_bps.value_or(0));
+      }
+    }
+    if (time_us >= NextRtpTime()) {
+      const OutgoingRtpPacket& rtp = *outgoing_rtp[rtp_index];
+      ++rtp_index;
+      ++result.rtp_packets;
+      cc.AddPacket(rtp.ssrc, rtp.transport_sequence_number, rtp.total_length,
+                   PacedPacketInfo());
+      cc.OnSentPacket(
+          rtc::SentPacket(rtp.transport_sequence_number, rtp.time_us / 1000));
+    }
+    if (time_us >= NextProcessTime())
+      cc.Process();
+    if (observer.GetAndResetUpdated() || !last_sample_us ||
+        time_us - *last_sample_us >= kMaxSampleIntervalUs) {
+      result.estimates.emplace_back(time_us, observer.bitrate_bps());
+      last_sample_us.emplace(time_us);
+    }
+    time_us = std::min({NextRtpTime(), NextRtcpTime(), NextProcessTime()});
+  }
+  return result;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_TOOLS_EVENT_LOG_VISUALIZER_SEND_SIDE_BWE_REPLAY_H_
+#define RTC_TOOLS_EVENT_LOG_VISUALIZER_SEND_SIDE_BWE_REPLAY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+
+namespace webrtc {
+
+// Removes the packets that were not received from |vec| and sorts the rest
+// the way the congestion controller processes them.
+void SortPacketFeedbackVector(std::vector<PacketFeedback>* vec);
+
+// Replays the outgoing RTP packets and incoming transport feedback of an event
+// log through the current SendSideCongestionController, and with it the
+// DelayBasedBwe and ProbeController, driven by a SimulatedClock. Everything
+// runs on the calling thread and as fast as the log can be read, so the
+// result only depends on the log, the config and the congestion control code.
+class SendSideBweReplay {
+ public:
+  struct Config {
+    // TODO(holmer): Log the call config and use that instead.
+    int min_bitrate_bps = 0;
+    int start_bitrate_bps = 300000;
+    int max_bitrate_bps = -1;
+  };
+
+  struct Sample {
+    Sample(int64_t log_time_us, uint32_t bitrate_bps)
+        : log_time_us(log_time_us), bitrate_bps(bitrate_bps) {}
+    int64_t log_time_us;
+    uint32_t bitrate_bps;
+  };
+
+  struct Result {
+    // The estimate reported to the congestion controller's observer, sampled
+    // when it changes and at least once per second.
+    std::vector<Sample> estimates;
+    // Bitrate of the acknowledged packets, sampled on each transport
+    // feedback.
+    std::vector<Sample> acked_bitrates;
+    size_t rtp_packets = 0;
+    size_t transport_feedback_packets = 0;
+  };
+
+  explicit SendSideBweReplay(const Config& config);
+
+  // Collects the packets to replay from the events currently parsed by
+  // |parsed_log|, which may be the whole log or the next chunk of a log that
+  // is being streamed.
+  void AddEvents(const ParsedRtcEventLog& parsed_log);
+
+  Result Run() const;
+
+ private:
+  struct OutgoingRtpPacket {
+    int64_t time_us;
+    uint32_t ssrc;
+    uint16_t transport_sequence_number;
+    size_t total_length;
+  };
+
+  struct IncomingRtcpPacket {
+    int64_t time_us;
+    std::vector<uint8_t> packet;
+  };
+
+  const Config config_;
+  // Used for streams without a logged config.
+  RtpHeaderExtensionMap default_extension_map_;
+  std::vector<OutgoingRtpPacket> outgoing_rtp_;
+  std::vector<IncomingRtcpPacket> incoming_rtcp_;
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_TOOLS_EVENT_LOG_VISUALIZER_SEND_SIDE_BWE_REPLAY_H_
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <iostream>
+#include <string>
+
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+#include "rtc_base/flags.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_tools/event_log_visualizer/send_side_bwe_replay.h"
+#include "test/field_trial.h"
+
+DEFINE_int(min_bitrate, 0, "Minimum bitrate given to the BWE, in bps.");
+DEFINE_int(start_bitrate, 300000, "Start bitrate given to the BWE, in bps.");
+DEFINE_int(max_bitrate, -1, "Maximum bitrate given to the BWE, in bps.");
+DEFINE_bool(acked_bitrate,
+            true,
+            "Use --noacked_bitrate to exclude the acknowledged bitrate.");
+DEFINE_string(
+    force_fieldtrials,
+    "",
+    "Field trials control experimental feature code which can be forced. "
+    "E.g. running with --force_fieldtrials=WebRTC-FooFeature/Enabled/"
+    " will assign the group Enabled to field trial WebRTC-FooFeature. Multiple "
+    "trials are separated by \"/\"");
+DEFINE_bool(help, false, "Prints this message.");
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage =
+      "Replays the outgoing RTP packets and incoming transport feedback of a "
+      "WebRTC event log\nthrough the send-side congestion controller, on a "
+      "simulated clock, and prints the\nresulting bitrate estimates as\n"
+      "  estimate <log time ms> <bps>\n"
+      "  acked <log time ms> <bps>\n"
+      "The output is deterministic, so it can be diffed between revisions.\n"
+      "Example usage:\n" +
+      program_name + " <logfile> > estimates.txt\n" + "Run " + program_name +
+      " --help for a list of command line options\n";
+
+  rtc::FlagList::SetFlagsFromCommandLine(&argc, argv, true);
+  if (argc != 2 || FLAG_help) {
+    std::cout << usage;
+    if (FLAG_help)
+      rtc::FlagList::Print(nullptr, false);
+    return 0;
+  }
+
+  webrtc::test::InitFieldTrialsFromString(FLAG_force_fieldtrials);
+
+  webrtc::SendSideBweReplay::Config config;
+  config.min_bitrate_bps = FLAG_min_bitrate;
+  config.start_bitrate_bps = FLAG_start_bitrate;
+  config.max_bitrate_bps = FLAG_max_bitrate;
+  webrtc::SendSideBweReplay replay(config);
+
+  // Only the packets used by the replay are kept, so the log is streamed in
+  // chunks rather than parsed as a whole.
+  const size_t kEventsPerChunk = 10000;
+  std::string filename = argv[1];
+  webrtc::ParsedRtcEventLog parsed_log;
+  int64_t start_ms = rtc::TimeMillis();
+  size_t num_events = 0;
+  if (parsed_log.StartStreamingFile(filename)) {
+    while (parsed_log.ParseNextEvents(kEventsPerChunk)) {
+      num_events += parsed_log.GetNumberOfEvents();
+      replay.AddEvents(parsed_log);
+    }
+  }
+  if (parsed_log.StreamingFailed()) {
+    std::cerr << "Could not parse the entire log file." << std::endl;
+    std::cerr << "Proceeding to replay the first " << num_events
+              << " events in the file." << std::endl;
+  }
+  webrtc::SendSideBweReplay::Result result = replay.Run();
+  int64_t elapsed_ms = rtc::TimeMillis() - start_ms;
+
+  for (const auto& sample : result.estimates) {
+    printf("estimate %" PRId64 " %u\n", sample.log_time_us / 1000,
+           sample.bitrate_bps);
+  }
+  if (FLAG_acked_bitrate) {
+    for (const auto& sample : result.acked_bitrates) {
+      printf("acked %" PRId64 " %u\n", sample.log_time_us / 1000,
+             sample.bitrate_bps);
+    }
+  }
+
+  int64_t log_duration_ms = 0;
+  if (!result.estimates.empty()) {
+    log_duration_ms = (result.estimates.back().log_time_us -
+                       result.estimates.front().log_time_us) /
+                      1000;
+  }
+  std::cerr << "Replayed " << result.rtp_packets << " RTP packets and "
+            << result.transport_feedback_packets
+            << " transport feedback packets, " << log_duration_ms
+            << " ms of log, in " << elapsed_ms << " ms." << std::endl;
+  return 0;
+}
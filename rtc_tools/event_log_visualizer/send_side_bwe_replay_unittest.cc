@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_tools/event_log_visualizer/send_side_bwe_replay.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "api/rtpparameters.h"
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "rtc_base/buffer.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr uint32_t kSsrc = 0x11223344;
+constexpr int64_t kPacketSize = 1200;
+constexpr int64_t kStartTimeUs = 1000000;
+constexpr int64_t kSendIntervalUs = 8000;
+constexpr int64_t kBottleneckBps = 1000000;
+constexpr int64_t kFeedbackIntervalUs = 100000;
+constexpr int64_t kPropagationDelayUs = 20000;
+
+void AddOutgoingRtpPacket(int64_t time_us,
+                          uint16_t sequence_number,
+                          rtclog::EventStream* stream) {
+  // Twelve byte RTP header followed by a one-byte header extension with the
+  // transport sequence number under its default id.
+  const uint8_t header[] = {
+      0x90, 96, static_cast<uint8_t>(sequence_number >> 8),
+      static_cast<uint8_t>(sequence_number), 0, 0, 0, 0,
+      static_cast<uint8_t>(kSsrc >> 24), static_cast<uint8_t>(kSsrc >> 16),
+      static_cast<uint8_t>(kSsrc >> 8), static_cast<uint8_t>(kSsrc), 0xBE,
+      0xDE, 0, 1, (RtpExtension::kTransportSequenceNumberDefaultId << 4) | 1,
+      static_cast<uint8_t>(sequence_number >> 8),
+      static_cast<uint8_t>(sequence_number), 0};
+  rtclog::Event* event = stream->add_stream();
+  event->set_timestamp_us(time_us);
+  event->set_type(rtclog::Event::RTP_EVENT);
+  event->mutable_rtp_packet()->set_incoming(false);
+  event->mutable_rtp_packet()->set_packet_length(kPacketSize);
+  event->mutable_rtp_packet()->set_header(header, sizeof(header));
+}
+
+void AddIncomingRtcpPacket(int64_t time_us,
+                           const rtc::Buffer& packet,
+                           rtclog::EventStream* stream) {
+  rtclog::Event* event = stream->add_stream();
+  event->set_timestamp_us(time_us);
+  event->set_type(rtclog::Event::RTCP_EVENT);
+  event->mutable_rtcp_packet()->set_incoming(true);
+  event->mutable_rtcp_packet()->set_packet_data(packet.data(), packet.size());
+}
+
+// Creates a log of a single stream that is sent at 1.2 Mbps over a 1 Mbps
+// bottleneck, with transport feedback every 100 ms.
+std::string CreateBottleneckLog(int64_t duration_us) {
+  rtclog::EventStream stream;
+  int64_t last_arrival_time_us = 0;
+  uint16_t sequence_number = 0;
+  uint16_t base_sequence_number = 0;
+  uint8_t feedback_sequence_number = 0;
+  std::vector<int64_t> arrival_times_us;
+  int64_t next_feedback_time_us = kStartTimeUs + kFeedbackIntervalUs;
+  for (int64_t time_us = kStartTimeUs; time_us < kStartTimeUs + duration_us;
+       time_us += kSendIntervalUs) {
+    AddOutgoingRtpPacket(time_us, sequence_number++, &stream);
+    last_arrival_time_us = std::max(
+        time_us + kPropagationDelayUs,
+        last_arrival_time_us + kPacketSize * 8 * 1000000 / kBottleneckBps);
+    arrival_times_us.push_back(last_arrival_time_us);
+
+    if (time_us < next_feedback_time_us)
+      continue;
+    rtcp::TransportFeedback feedback;
+    feedback.SetSenderSsrc(1);
+    feedback.SetMediaSsrc(kSsrc);
+    feedback.SetFeedbackSequenceNumber(feedback_sequence_number++);
+    bool base_set = false;
+    size_t acked = 0;
+    for (; acked < arrival_times_us.size(); ++acked) {
+      if (arrival_times_us[acked] > time_us)
+        break;
+      uint16_t acked_sequence_number = base_sequence_number + acked;
+      if (!base_set) {
+        feedback.SetBase(acked_sequence_number, arrival_times_us[acked]);
+        base_set = true;
+      }
+      if (!feedback.AddReceivedPacket(acked_sequence_number,
+                                      arrival_times_us[acked])) {
+        break;
+      }
+    }
+    if (base_set) {
+      AddIncomingRtcpPacket(time_us, feedback.Build(), &stream);
+      arrival_times_us.erase(arrival_times_us.begin(),
+                             arrival_times_us.begin() + acked);
+      base_sequence_number += acked;
+    }
+    next_feedback_time_us += kFeedbackIntervalUs;
+  }
+  std::string log;
+  stream.SerializeToString(&log);
+  return log;
+}
+
+SendSideBweReplay::Result Replay(const std::string& log) {
+  ParsedRtcEventLog parsed_log;
+  EXPECT_TRUE(parsed_log.ParseString(log));
+  SendSideBweReplay replay((SendSideBweReplay::Config()));
+  replay.AddEvents(parsed_log);
+  return replay.Run();
+}
+
+}  // namespace
+
+TEST(SendSideBweReplayTest, ReplayIsDeterministic) {
+  const std::string log = CreateBottleneckLog(10000000);
+  SendSideBweReplay::Result first = Replay(log);
+  SendSideBweReplay::Result second = Replay(log);
+
+  EXPECT_EQ(1250u, first.rtp_packets);
+  EXPECT_GT(first.transport_feedback_packets, 90u);
+  ASSERT_FALSE(first.estimates.empty());
+  ASSERT_FALSE(first.acked_bitrates.empty());
+  EXPECT_GT(first.estimates.back().bitrate_bps, 0u);
+
+  EXPECT_EQ(first.rtp_packets, second.rtp_packets);
+  EXPECT_EQ(first.transport_feedback_packets,
+            second.transport_feedback_packets);
+  ASSERT_EQ(first.estimates.size(), second.estimates.size());
+  for (size_t i = 0; i < first.estimates.size(); ++i) {
+    EXPECT_EQ(first.estimates[i].log_time_us, second.estimates[i].log_time_us);
+    EXPECT_EQ(first.estimates[i].bitrate_bps, second.estimates[i].bitrate_bps);
+  }
+  ASSERT_EQ(first.acked_bitrates.size(), second.acked_bitrates.size());
+  for (size_t i = 0; i < first.acked_bitrates.size(); ++i) {
+    EXPECT_EQ(first.acked_bitrates[i].log_time_us,
+              second.acked_bitrates[i].log_time_us);
+    EXPECT_EQ(first.acked_bitrates[i].bitrate_bps,
+              second.acked_bitrates[i].bitrate_bps);
+  }
+}
+
+TEST(SendSideBweReplayTest, EmptyLogGivesNoEstimates) {
+  SendSideBweReplay::Result result = Replay(std::string());
+  EXPECT_EQ(0u, result.rtp_packets);
+  EXPECT_EQ(0u, result.transport_feedback_packets);
+  EXPECT_TRUE(result.estimates.empty());
+  EXPECT_TRUE(result.acked_bitrates.empty());
+}
+
+}  // namespace webrtc
@@ -10,6 +10,8 @@
 
 #include "video/transport_adapter.h"
 
+#include <utility>
+
 #include "rtc_base/checks.h"
 
 namespace webrtc {
@@ -29,6 +31,14 @@ bool TransportAdapter::SendRtp(const uint8_t* packet,
   return transport_->SendRtp(packet, length, options);
 }
 
+bool TransportAdapter::SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                                     const PacketOptions& options) {
+  if (enabled_.Value() == 0)
+    return false;
+
+  return transport_->SendRtpBuffer(std::move(packet), options);
+}
+
 bool TransportAdapter::SendRtcp(const uint8_t* packet, size_t length) {
   if (enabled_.Value() == 0)
     return false;
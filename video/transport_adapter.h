@@ -24,6 +24,8 @@ class TransportAdapter : public Transport {
   bool SendRtp(const uint8_t* packet,
                size_t length,
                const PacketOptions& options) override;
+  bool SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                     const PacketOptions& options) override;
   bool SendRtcp(const uint8_t* packet, size_t length) override;
 
   void Enable();
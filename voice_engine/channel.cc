@@ -366,6 +366,23 @@ bool Channel::SendRtp(const uint8_t* data,
   return true;
 }
 
+bool Channel::SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                            const PacketOptions& options) {
+  rtc::CritScope cs(&_callbackCritSect);
+
+  if (_transportPtr == NULL) {
+    LOG(LS_ERROR) << "Channel::SendPacket() failed to send RTP packet due to"
+                  << " invalid transport object";
+    return false;
+  }
+
+  if (!_transportPtr->SendRtpBuffer(std::move(packet), options)) {
+    LOG(LS_ERROR) << "Channel::SendPacket() RTP transmission failed";
+    return false;
+  }
+  return true;
+}
+
 bool Channel::SendRtcp(const uint8_t* data, size_t len) {
   rtc::CritScope cs(&_callbackCritSect);
   if (_transportPtr == NULL) {
@@ -267,6 +267,8 @@ class Channel
   bool SendRtp(const uint8_t* data,
                size_t len,
                const PacketOptions& packet_options) override;
+  bool SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                     const PacketOptions& packet_options) override;
   bool SendRtcp(const uint8_t* data, size_t len) override;
 
   // From AudioMixer::Source.